@@ -0,0 +1,452 @@
+// vim:ts=4 et sw=4
+//----------------------------------------------------------------------------
+/// \file  bench.cpp
+//----------------------------------------------------------------------------
+/// \brief Driver of the utxx_bench executable.
+///
+/// Runs registered benchmarks with iteration calibration, warmup and a
+/// number of repetitions, reports mean/median/min/max and the 95% Student-t
+/// confidence interval of nanoseconds per operation in text, JSON or CSV
+/// form, and optionally compares results against a previously saved JSON
+/// baseline (the process exit code is 2 when a regression is detected).
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/get_option.hpp>
+#include <utxx/path.hpp>
+#include <utxx/time_val.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <cmath>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace utxx {
+namespace bench {
+
+namespace {
+    struct entry {
+        string    name;
+        bench_fun fun;
+    };
+
+    vector<entry>& registry() {
+        static vector<entry> s_registry;
+        return s_registry;
+    }
+
+    struct result {
+        string  name;
+        long    iterations;
+        int     reps;
+        double  mean, median, stddev, min, max, ci95;
+        shared_ptr<perf_histogram> hist;
+    };
+
+    struct baseline {
+        double  mean;
+        double  ci95;
+    };
+
+    /// Two-sided 95% quantile of Student's t-distribution for
+    /// \a a_df degrees of freedom
+    double student_t95(int a_df) {
+        static const double s_t[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+             2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+             2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        return a_df < 1 ? 0.0 : a_df <= 30 ? s_t[a_df-1] : 1.960;
+    }
+
+    /// Parse a CPU list such as "2,3" or "2-5,8"
+    vector<int> parse_cpus(const string& a_list) {
+        vector<int> cpus;
+        for (const char* p = a_list.c_str(); *p; ) {
+            int from, to, len;
+            int n = sscanf(p, "%d%n-%d%n", &from, &len, &to, &len);
+            if (n < 1 || from < 0 || (n == 2 && to < from) ||
+                (p[len] != ',' && p[len] != '\0'))
+                throw runtime_error("Invalid CPU list: " + a_list);
+            for (int i = from, e = n == 2 ? to : from; i <= e; ++i)
+                cpus.push_back(i);
+            p += len + (p[len] == ',');
+        }
+        return cpus;
+    }
+
+    /// Run \a a_entry once with \a a_iters iterations
+    /// @return nanoseconds per item
+    double run_once(const entry& a_entry, long a_iters,
+                    const vector<int>& a_cpus, perf_histogram& a_hist)
+    {
+        state st(a_iters, a_cpus, a_hist);
+        st.resume();
+        a_entry.fun(st);
+        st.pause();
+        return st.elapsed_nsec() / max(1l, st.items());
+    }
+
+    /// Find the number of iterations that runs for at least \a a_min_time sec
+    long calibrate(const entry& a_entry, double a_min_time, const vector<int>& a_cpus)
+    {
+        static const long s_max_iters = 1000000000l;
+        perf_histogram scratch;
+        const double min_ns = a_min_time * 1e9;
+
+        for (long n = 1;;) {
+            state st(n, a_cpus, scratch);
+            st.resume();
+            a_entry.fun(st);
+            st.pause();
+            double ns = st.elapsed_nsec();
+            if (ns >= min_ns || n >= s_max_iters)
+                return n;
+            // Overshoot by 40% so that the next attempt is likely the last one
+            double mult = ns < 1.0 ? 100.0 : min(100.0, max(2.0, 1.4 * min_ns / ns));
+            n = min(s_max_iters, long(n * mult));
+        }
+    }
+
+    result run(const entry& a_entry, long a_iters, int a_reps, double a_min_time,
+               const vector<int>& a_cpus)
+    {
+        result r;
+        r.name       = a_entry.name;
+        r.iterations = a_iters > 0 ? a_iters : calibrate(a_entry, a_min_time, a_cpus);
+        r.reps       = a_reps;
+        r.hist       = make_shared<perf_histogram>(a_entry.name);
+
+        // Warmup
+        perf_histogram scratch;
+        run_once(a_entry, r.iterations, a_cpus, scratch);
+
+        vector<double> samples;
+        samples.reserve(a_reps);
+        for (int i=0; i < a_reps; ++i)
+            samples.push_back(run_once(a_entry, r.iterations, a_cpus, *r.hist));
+
+        sort(samples.begin(), samples.end());
+        double sum = 0, sq = 0;
+        for (auto s : samples) sum += s;
+        r.mean = sum / a_reps;
+        for (auto s : samples) sq += (s - r.mean) * (s - r.mean);
+        r.stddev = a_reps > 1 ? sqrt(sq / (a_reps - 1)) : 0.0;
+        r.median = a_reps & 1 ? samples[a_reps/2]
+                              : (samples[a_reps/2-1] + samples[a_reps/2]) / 2;
+        r.min    = samples.front();
+        r.max    = samples.back();
+        r.ci95   = student_t95(a_reps-1) * r.stddev / sqrt(double(a_reps));
+        return r;
+    }
+
+    map<string, baseline> read_baseline(const string& a_file) {
+        boost::property_tree::ptree pt;
+        boost::property_tree::read_json(a_file, pt);
+        map<string, baseline> res;
+        for (auto& b : pt.get_child("benchmarks"))
+            res[b.second.get<string>("name")] =
+                baseline{b.second.get<double>("mean_ns"),
+                         b.second.get<double>("ci95_ns", 0.0)};
+        return res;
+    }
+
+    string json_escape(const string& a_str) {
+        string s;
+        for (auto c : a_str)
+            switch (c) {
+                case '"':  s += "\\\""; break;
+                case '\\': s += "\\\\"; break;
+                case '\n': s += "\\n";  break;
+                default:   s += c;
+            }
+        return s;
+    }
+
+    void print_text(ostream& out, const vector<result>& a_res, bool a_hist) {
+        char buf[256];
+        snprintf(buf, sizeof(buf), "%-40s %12s %5s %11s %10s %11s %11s %11s\n",
+                 "Benchmark", "Iterations", "Reps", "Mean(ns)", "+/-CI95",
+                 "Median(ns)", "Min(ns)", "Max(ns)");
+        out << buf << string(118, '-') << '\n';
+        for (auto& r : a_res) {
+            snprintf(buf, sizeof(buf),
+                     "%-40s %12ld %5d %11.2f %9.2f%% %11.2f %11.2f %11.2f\n",
+                     r.name.c_str(), r.iterations, r.reps, r.mean,
+                     r.mean > 0 ? 100.0 * r.ci95 / r.mean : 0.0,
+                     r.median, r.min, r.max);
+            out << buf;
+        }
+        if (a_hist)
+            for (auto& r : a_res)
+                if (r.hist->count())
+                    r.hist->dump(out);
+    }
+
+    void print_json(ostream& out, const vector<result>& a_res,
+                    const string& a_cpus, int a_reps, double a_min_time)
+    {
+        char host[128] = "";
+        ::gethostname(host, sizeof(host)-1);
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+                 "{\n  \"context\": {\n"
+                 "    \"host\": \"%s\",\n"
+                 "    \"date\": \"%s\",\n"
+                 "    \"cpus\": \"%s\",\n"
+                 "    \"repetitions\": %d,\n"
+                 "    \"min_time\": %.3f\n"
+                 "  },\n  \"benchmarks\": [",
+                 json_escape(host).c_str(),
+                 now_utc().to_string(DATE_TIME).c_str(),
+                 json_escape(a_cpus).c_str(), a_reps, a_min_time);
+        out << buf;
+        const char* delim = "\n";
+        for (auto& r : a_res) {
+            snprintf(buf, sizeof(buf),
+                     "%s    {\"name\": \"%s\", \"iterations\": %ld, "
+                     "\"repetitions\": %d, \"mean_ns\": %.4f, \"median_ns\": %.4f, "
+                     "\"stddev_ns\": %.4f, \"min_ns\": %.4f, \"max_ns\": %.4f, "
+                     "\"ci95_ns\": %.4f}",
+                     delim, json_escape(r.name).c_str(), r.iterations, r.reps,
+                     r.mean, r.median, r.stddev, r.min, r.max, r.ci95);
+            out << buf;
+            delim = ",\n";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    void print_csv(ostream& out, const vector<result>& a_res) {
+        out << "name,iterations,repetitions,mean_ns,median_ns,stddev_ns,"
+               "min_ns,max_ns,ci95_ns\n";
+        char buf[256];
+        for (auto& r : a_res) {
+            snprintf(buf, sizeof(buf), "%s,%ld,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                     r.name.c_str(), r.iterations, r.reps, r.mean, r.median,
+                     r.stddev, r.min, r.max, r.ci95);
+            out << buf;
+        }
+    }
+
+    /// Compare results against the baseline. A benchmark is reported as a
+    /// regression when its mean is slower by more than \a a_threshold percent
+    /// and the confidence intervals of both runs don't overlap.
+    /// @return number of detected regressions
+    int compare(ostream& out, const vector<result>& a_res,
+                const map<string, baseline>& a_base, double a_threshold)
+    {
+        char buf[256];
+        snprintf(buf, sizeof(buf), "\n%-40s %11s %11s %9s  %s\n",
+                 "Benchmark", "Base(ns)", "Now(ns)", "Delta", "Status");
+        out << buf << string(86, '-') << '\n';
+        int regressions = 0;
+        for (auto& r : a_res) {
+            auto it = a_base.find(r.name);
+            if (it == a_base.end()) {
+                snprintf(buf, sizeof(buf), "%-40s %11s %11.2f %9s  new\n",
+                         r.name.c_str(), "-", r.mean, "-");
+                out << buf;
+                continue;
+            }
+            auto&  b     = it->second;
+            double delta = b.mean > 0 ? 100.0 * (r.mean - b.mean) / b.mean : 0.0;
+            const char* status = "ok";
+            if (delta > a_threshold && r.mean - r.ci95 > b.mean + b.ci95) {
+                status = "REGRESSION";
+                ++regressions;
+            } else if (delta < -a_threshold && r.mean + r.ci95 < b.mean - b.ci95)
+                status = "improved";
+            snprintf(buf, sizeof(buf), "%-40s %11.2f %11.2f %+8.1f%%  %s\n",
+                     r.name.c_str(), b.mean, r.mean, delta, status);
+            out << buf;
+        }
+        return regressions;
+    }
+}
+
+int pin_thread(int a_cpu) {
+    if (a_cpu < 0)
+        return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(a_cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+}
+
+registrar::registrar(const char* a_group, const char* a_name, bench_fun a_fun) {
+    registry().push_back(entry{string(a_group) + '/' + a_name, a_fun});
+}
+
+} // namespace bench
+} // namespace utxx
+
+using namespace utxx;
+using namespace utxx::bench;
+
+void usage(std::string const& a_err = "")
+{
+    if (!a_err.empty())
+        std::cerr << "Error: " << a_err << endl << endl;
+
+    std::cerr << utxx::path::program::name()
+        << " [Options]\n"
+        << "Run utxx micro-benchmarks\n\n"
+        << "    -l, --list               - list benchmarks and exit\n"
+        << "    -f, --filter=RegEx       - run benchmarks whose Group/Name match RegEx\n"
+        << "    -r, --repetitions=N      - number of measured repetitions (default 10)\n"
+        << "    -t, --min-time=S         - minimum duration of a repetition in seconds\n"
+        << "                               used to calibrate iterations (default 0.1)\n"
+        << "    -n, --iterations=N       - use fixed number of iterations\n"
+        << "    -c, --cpus=List          - pin the benchmark thread to the first CPU in\n"
+        << "                               the List (e.g. \"2,3\" or \"2-5\"), the rest are\n"
+        << "                               used by helper threads of a benchmark\n"
+        << "    -o, --format=Fmt         - output format: text (default), json, csv\n"
+        << "    --out=File               - write results to File instead of stdout\n"
+        << "    --histogram              - print latency histograms in text mode\n"
+        << "    -b, --baseline=File      - compare results with a JSON baseline\n"
+        << "                               (exit code is 2 on regression)\n"
+        << "    --threshold=Pct          - regression threshold in percent (default 5)\n"
+        << "    -h, --help               - help\n"
+        << endl;
+
+    exit(1);
+}
+
+int main(int argc, char* argv[])
+{
+    string  filter, cpu_list, format = "text", out_file, base_file;
+    int     reps      = 10;
+    long    iters     = 0;
+    double  min_time  = 0.1;
+    double  threshold = 5.0;
+    bool    list = false, hist = false;
+
+    try {
+        opts_parser opts(argc, argv);
+        while (opts.next()) {
+            if (opts.match("-l", "--list",        &list))       continue;
+            if (opts.match("-f", "--filter",      &filter))     continue;
+            if (opts.match("-r", "--repetitions", &reps))       continue;
+            if (opts.match("-t", "--min-time",    &min_time))   continue;
+            if (opts.match("-n", "--iterations",  &iters))      continue;
+            if (opts.match("-c", "--cpus",        &cpu_list))   continue;
+            if (opts.match("-o", "--format",      &format))     continue;
+            if (opts.match("",   "--out",         &out_file))   continue;
+            if (opts.match("",   "--histogram",   &hist))       continue;
+            if (opts.match("-b", "--baseline",    &base_file))  continue;
+            if (opts.match("",   "--threshold",   &threshold))  continue;
+            if (opts.is_help())                                 usage();
+
+            usage(string("Invalid option: ") + opts());
+        }
+    } catch (std::exception& e) {
+        usage(e.what());
+    }
+
+    if (reps < 1)
+        usage("Number of repetitions must be positive");
+    if (format != "text" && format != "json" && format != "csv")
+        usage("Invalid output format: " + format);
+
+    auto& all = registry();
+    sort(all.begin(), all.end(),
+         [](const entry& a, const entry& b) { return a.name < b.name; });
+
+    vector<const entry*> selected;
+    try {
+        regex rx(filter.empty() ? string(".*") : filter);
+        for (auto& e : all)
+            if (regex_search(e.name, rx))
+                selected.push_back(&e);
+    } catch (std::regex_error& e) {
+        usage("Invalid filter: " + filter);
+    }
+
+    if (list) {
+        for (auto e : selected)
+            cout << e->name << endl;
+        return 0;
+    }
+
+    vector<int> cpus;
+    map<string, baseline> base;
+    try {
+        if (!cpu_list.empty())
+            cpus = parse_cpus(cpu_list);
+        if (!base_file.empty())
+            base = read_baseline(base_file);
+    } catch (std::exception& e) {
+        usage(e.what());
+    }
+
+    if (!cpus.empty() && pin_thread(cpus[0]) != 0)
+        usage("Cannot pin thread to CPU " + std::to_string(cpus[0]));
+
+    high_res_timer::calibrate(100000, 5);
+
+    vector<result> results;
+    for (auto e : selected) {
+        results.push_back(run(*e, iters, reps, min_time, cpus));
+        if (format == "text" && out_file.empty())
+            cerr << "  " << e->name << ": " << results.back().mean << " ns/op" << endl;
+    }
+
+    ofstream file;
+    if (!out_file.empty()) {
+        file.open(out_file);
+        if (!file) {
+            cerr << "Cannot open file " << out_file << endl;
+            return 1;
+        }
+    }
+    ostream& out = out_file.empty() ? cout : file;
+
+    if (format == "json")
+        print_json(out, results, cpu_list, reps, min_time);
+    else if (format == "csv")
+        print_csv(out, results);
+    else
+        print_text(out, results, hist);
+
+    if (base_file.empty())
+        return 0;
+
+    // Keep stdout machine-readable when results are printed there
+    ostream& rep = format != "text" && out_file.empty() ? cerr : cout;
+    return compare(rep, results, base, threshold) ? 2 : 0;
+}
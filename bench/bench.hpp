@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------
+/// \file  bench.hpp
+//----------------------------------------------------------------------------
+/// \brief Micro-benchmark harness of the utxx_bench executable.
+///
+/// A benchmark is a function taking a bench::state. It runs
+/// state.iterations() operations, and the harness calls it repeatedly
+/// (calibration, warmup and a number of measured repetitions) to obtain
+/// nanoseconds per operation with a confidence interval:
+/// \code
+/// UTXX_BENCH(convert, itoa_left_long) {
+///     char buf[32];
+///     for (long i=0, n=state.iterations(); i < n; ++i)
+///         bench::do_not_optimize(itoa_left(buf, i));
+/// }
+/// \endcode
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#pragma once
+
+#include <utxx/high_res_timer.hpp>
+#include <utxx/perf_histogram.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace utxx {
+namespace bench {
+
+/// Prevent the compiler from optimizing away the computation of \a a_val
+template <class T>
+inline void do_not_optimize(T const& a_val) {
+    asm volatile("" : : "r,m"(a_val) : "memory");
+}
+
+/// Force all pending memory writes to be considered observable
+inline void clobber() { asm volatile("" : : : "memory"); }
+
+/// Pin the calling thread to \a a_cpu (no-op if \a a_cpu < 0)
+/// @return 0 on success, or errno value otherwise
+int pin_thread(int a_cpu);
+
+//----------------------------------------------------------------------------
+/// Benchmark execution state passed to the benchmark function
+//----------------------------------------------------------------------------
+class state {
+    long                m_iterations;
+    long                m_items;
+    const std::vector<int>& m_cpus;
+    high_res_timer      m_timer;
+    bool                m_paused;
+    perf_histogram&     m_histogram;
+public:
+    state(long a_iterations, const std::vector<int>& a_cpus, perf_histogram& a_hist)
+        : m_iterations(a_iterations), m_items(a_iterations), m_cpus(a_cpus)
+        , m_paused(true), m_histogram(a_hist)
+    {}
+
+    /// Number of operations that the benchmark must execute
+    long iterations() const { return m_iterations; }
+
+    /// Override the number of items processed when it differs from
+    /// iterations() (the result is reported per item)
+    void items(long a_items)  { m_items = a_items; }
+    long items()        const { return m_items;    }
+
+    /// Exclude setup/teardown code from the measurement
+    void pause()  { if (!m_paused) { m_timer.stop_incr();  m_paused = true;  } }
+    void resume() { if ( m_paused) { m_timer.start_incr(); m_paused = false; } }
+
+    /// CPU assigned to the i-th thread of a benchmark (from the --cpus list),
+    /// or -1 if the thread shouldn't be pinned
+    int cpu(size_t i) const { return i < m_cpus.size() ? m_cpus[i] : -1; }
+
+    /// Optional latency histogram of individual samples (e.g.
+    /// `perf_histogram::sample s(state.histogram());`), it's reported
+    /// along with the benchmark results in text mode
+    perf_histogram& histogram() { return m_histogram; }
+
+    /// Measured time in nanoseconds
+    double elapsed_nsec() const { return m_timer.elapsed_nsec_incr(); }
+};
+
+typedef std::function<void (state&)> bench_fun;
+
+/// Register a benchmark under \a a_group (e.g. "queue") and \a a_name
+struct registrar {
+    registrar(const char* a_group, const char* a_name, bench_fun a_fun);
+};
+
+} // namespace bench
+} // namespace utxx
+
+/// Define and register a benchmark function having access to \c state
+#define UTXX_BENCH(Group, Name)                                             \
+    static void bench_##Group##_##Name(utxx::bench::state& state);          \
+    static utxx::bench::registrar                                           \
+        s_bench_##Group##_##Name(#Group, #Name, &bench_##Group##_##Name);   \
+    static void bench_##Group##_##Name(utxx::bench::state& state)
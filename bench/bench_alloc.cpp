@@ -0,0 +1,296 @@
+//----------------------------------------------------------------------------
+/// \file  bench_alloc.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of memory allocators.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/allocator.hpp>
+#include <utxx/alloc_fixed_pool.hpp>
+#include <utxx/atomic.hpp>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace utxx;
+using namespace utxx::memory;
+
+namespace {
+    static const size_t s_sizes[] = { 24, 60, 120, 250 };
+
+    /// Anonymous shared memory region used by pow2_allocator
+    struct shm_region {
+        void*  addr;
+        size_t size;
+
+        shm_region(size_t sz) : size(sz) {
+            addr = ::mmap(NULL, sz, PROT_READ|PROT_WRITE,
+                          MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+            if (addr == MAP_FAILED)
+                throw std::bad_alloc();
+        }
+        ~shm_region() { ::munmap(addr, size); }
+    };
+
+    /// Allocate/release buffers of different sizes keeping a window of
+    /// live buffers (message-passing pattern)
+    template <class Alloc, class Free>
+    void window_loop(long a_iters, Alloc a_alloc, Free a_free) {
+        void* window[64] = {0};
+        for (long i=0; i < a_iters; ++i) {
+            void*& p = window[i & 63];
+            if (p) a_free(p);
+            p = a_alloc(s_sizes[i & 3]);
+        }
+        for (auto p : window)
+            if (p) a_free(p);
+    }
+
+    template <class Alloc>
+    void pow2_bench(bench::state& state) {
+        state.pause();
+        shm_region shm(64 << 20);
+        Alloc      alloc(shm.addr, shm.size, true);
+        state.resume();
+        window_loop(state.iterations(),
+                    [&](size_t n) { return alloc.allocate(n); },
+                    [&](void*  p) { alloc.release(p); });
+        state.pause();
+        alloc.detach_thread();
+    }
+
+    /// Run the window loop in \a Procs processes sharing the allocator.
+    /// The iterations are split between the processes, and the time is
+    /// measured until the slowest one is done.
+    template <class Alloc, int Procs>
+    void pow2_procs_bench(bench::state& state) {
+        state.pause();
+        shm_region     shm(256 << 20);
+        Alloc          alloc(shm.addr, shm.size, true);
+        shm_region     ctl(4096);
+        volatile long* ready = static_cast<volatile long*>(ctl.addr);
+        volatile long* start = ready + 8;
+        long           iters = state.iterations() / Procs;
+        state.items(iters * Procs);
+
+        std::vector<pid_t> pids;
+        for (int i=0; i < Procs; ++i) {
+            pid_t pid = ::fork();
+            if (pid == 0) {
+                atomic::inc(ready);
+                while (!*start);
+                window_loop(iters,
+                            [&](size_t n) { return alloc.allocate(n); },
+                            [&](void*  p) { alloc.release(p); });
+                alloc.detach_thread();
+                ::_exit(0);
+            }
+            if (pid < 0)
+                throw std::runtime_error("fork failed");
+            pids.push_back(pid);
+        }
+        while (*ready < Procs);
+        state.resume();
+        *start = 1;
+        for (auto pid : pids)
+            ::waitpid(pid, nullptr, 0);
+        state.pause();
+    }
+
+    struct order { long id; double px; long qty; char sym[8]; };
+
+    /// Run the window loop over a shared fixed_size_object_pool in
+    /// \a Threads threads, either directly or through a thread_cache.
+    /// The iterations are split between the threads, and the time is
+    /// measured until the slowest one is done.
+    template <bool Cached, int Threads>
+    void fixed_pool_threads_bench(bench::state& state) {
+        typedef heap_fixed_size_object_pool pool_t;
+        state.pause();
+        std::vector<char> mem(pool_t::storage_size<sizeof(order), 8192>::value);
+        auto&         pool  = pool_t::create(&mem[0], mem.size(), sizeof(order));
+        long          iters = state.iterations() / Threads;
+        volatile long ready = 0;
+        volatile bool start = false;
+        state.items(iters * Threads);
+
+        auto worker = [&](int a_thread) {
+            bench::pin_thread(state.cpu(a_thread));
+            pool_t::thread_cache cache(pool);
+            atomic::inc(&ready);
+            while (!start);
+            if (Cached)
+                window_loop(iters,
+                            [&](size_t)  { return cache.allocate(); },
+                            [&](void* p) { cache.free(p); });
+            else
+                window_loop(iters,
+                            [&](size_t)  { return pool.allocate(); },
+                            [&](void* p) { pool.free(p); });
+        };
+
+        std::vector<std::thread> thr;
+        for (int i=0; i < Threads; ++i)
+            thr.emplace_back(worker, i);
+        while (ready < Threads);
+        state.resume();
+        start = true;
+        for (auto& t : thr)
+            t.join();
+        state.pause();
+    }
+}
+
+UTXX_BENCH(alloc, malloc_free)
+{
+    window_loop(state.iterations(),
+                [](size_t n) { return ::malloc(n); },
+                [](void*  p) { ::free(p); });
+}
+
+UTXX_BENCH(alloc, pow2_allocator_shared)
+{
+    pow2_bench<pow2_allocator<8, 32, 32, 0>>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_cached)
+{
+    pow2_bench<pow2_allocator<>>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_shared_2procs)
+{
+    pow2_procs_bench<pow2_allocator<8, 32, 32, 0>, 2>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_cached_2procs)
+{
+    pow2_procs_bench<pow2_allocator<>, 2>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_shared_4procs)
+{
+    pow2_procs_bench<pow2_allocator<8, 32, 32, 0>, 4>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_cached_4procs)
+{
+    pow2_procs_bench<pow2_allocator<>, 4>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_shared_8procs)
+{
+    pow2_procs_bench<pow2_allocator<8, 32, 32, 0>, 8>(state);
+}
+
+UTXX_BENCH(alloc, pow2_allocator_cached_8procs)
+{
+    pow2_procs_bench<pow2_allocator<>, 8>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool)
+{
+    typedef heap_fixed_size_object_pool pool_t;
+    state.pause();
+    std::vector<char> mem(pool_t::storage_size<sizeof(order), 4096>::value);
+    auto& pool = pool_t::create(&mem[0], mem.size(), sizeof(order));
+    state.resume();
+    window_loop(state.iterations(),
+                [&](size_t)  { return pool.allocate(); },
+                [&](void* p) { pool.free(p); });
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache)
+{
+    typedef heap_fixed_size_object_pool pool_t;
+    state.pause();
+    std::vector<char> mem(pool_t::storage_size<sizeof(order), 4096>::value);
+    auto& pool = pool_t::create(&mem[0], mem.size(), sizeof(order));
+    {
+        pool_t::thread_cache cache(pool);
+        state.resume();
+        window_loop(state.iterations(),
+                    [&](size_t)  { return cache.allocate(); },
+                    [&](void* p) { cache.free(p); });
+        state.pause();
+    }
+}
+
+UTXX_BENCH(alloc, fixed_pool_2threads)
+{
+    fixed_pool_threads_bench<false, 2>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache_2threads)
+{
+    fixed_pool_threads_bench<true, 2>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_4threads)
+{
+    fixed_pool_threads_bench<false, 4>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache_4threads)
+{
+    fixed_pool_threads_bench<true, 4>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_8threads)
+{
+    fixed_pool_threads_bench<false, 8>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache_8threads)
+{
+    fixed_pool_threads_bench<true, 8>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_16threads)
+{
+    fixed_pool_threads_bench<false, 16>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache_16threads)
+{
+    fixed_pool_threads_bench<true, 16>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_32threads)
+{
+    fixed_pool_threads_bench<false, 32>(state);
+}
+
+UTXX_BENCH(alloc, fixed_pool_thread_cache_32threads)
+{
+    fixed_pool_threads_bench<true, 32>(state);
+}
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------
+/// \file  bench_base64.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of base64 encoding and decoding of a 1K payload.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/base64.hpp>
+#include <boost/archive/iterators/binary_from_base64.hpp>
+#include <boost/archive/iterators/base64_from_binary.hpp>
+#include <boost/archive/iterators/transform_width.hpp>
+#include <string>
+#include <stdlib.h>
+
+using namespace utxx;
+
+namespace {
+    static const size_t PAYLOAD = 1024;
+
+    const std::string& payload() {
+        static std::string s_data;
+        if (s_data.empty()) {
+            srand(1);
+            for (size_t i=0; i < PAYLOAD; ++i)
+                s_data += char(rand());
+        }
+        return s_data;
+    }
+
+    const std::string& encoded() {
+        static const std::string s_enc = base64::encode(payload());
+        return s_enc;
+    }
+}
+
+/// Boost archive iterators (the former encode_base64)
+UTXX_BENCH(base64, encode_boost_iterators)
+{
+    using namespace boost::archive::iterators;
+    using it = base64_from_binary<transform_width<std::string::const_iterator, 6, 8>>;
+    auto& s  = payload();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        std::string res(it(s.begin()), it(s.end()));
+        res.append((3 - s.size() % 3) % 3, '=');
+        bench::do_not_optimize(res.size());
+    }
+}
+
+/// Returning std::string
+UTXX_BENCH(base64, encode_string)
+{
+    auto& s = payload();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(base64::encode(s).size());
+}
+
+/// Into a caller-provided buffer
+UTXX_BENCH(base64, encode_to)
+{
+    auto& s = payload();
+    char  buf[base64::encoded_size(PAYLOAD)];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(base64::encode_to(buf, s.data(), s.size()));
+}
+
+/// Boost archive iterators (the former decode_base64)
+UTXX_BENCH(base64, decode_boost_iterators)
+{
+    using namespace boost::archive::iterators;
+    using it = transform_width<binary_from_base64<std::string::const_iterator>, 8, 6>;
+    auto& s  = encoded();
+    auto  e  = s.begin() + s.find('=');
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        std::string res(it(s.begin()), it(e));
+        bench::do_not_optimize(res.size());
+    }
+}
+
+/// Returning std::vector
+UTXX_BENCH(base64, decode_vector)
+{
+    auto& s = encoded();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(base64::decode(s).size());
+}
+
+/// Into a caller-provided buffer with strict validation
+UTXX_BENCH(base64, decode_to_strict)
+{
+    auto& s = encoded();
+    char  buf[base64::decoded_size(base64::encoded_size(PAYLOAD))];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(base64::decode_to(buf, s.data(), s.size()));
+}
+
+/// Into a caller-provided buffer skipping line breaks every 76 characters
+UTXX_BENCH(base64, decode_to_relaxed_mime)
+{
+    state.pause();
+    std::string s;
+    for (size_t i=0; i < encoded().size(); i += 76)
+        s.append(encoded(), i, 76).append("\r\n");
+    char buf[base64::decoded_size(base64::encoded_size(PAYLOAD) * 2)];
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(base64::decode_to(buf, s.data(), s.size(),
+                               base64::STANDARD, base64::RELAXED));
+}
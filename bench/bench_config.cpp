@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------
+/// \file  bench_config.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of configuration parsing and validation.
+///
+/// A reference-data-like SCON file (50 MB by default, override with the
+/// UTXX_BENCH_CONFIG_MB environment variable) is generated on first use.
+/// Parsing results are reported per megabyte of input, and validation
+/// results per configuration node.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/variant_tree_parser.hpp>
+#include "generated/bench_config.generated.hpp"
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+using namespace utxx;
+
+namespace {
+    /// Generated configuration file removed at exit
+    class config_file {
+        std::string m_name;
+        long        m_mbytes;
+    public:
+        config_file() : m_name("/tmp/utxx_bench_config.config") {
+            const char* p = getenv("UTXX_BENCH_CONFIG_MB");
+            m_mbytes = p ? std::max(1, atoi(p)) : 50;
+
+            std::ofstream out(m_name);
+            out << "instruments {\n";
+            char buf[512];
+            for (long i=0, size=0; size < (m_mbytes << 20); ++i) {
+                int n = snprintf(buf, sizeof(buf),
+                    "  instrument { symbol = \"SYM%06ld\", exchange = NYSE, "
+                    "tick-size = 0.01, lot-size = %ld, currency = USD, "
+                    "active = true, description = \"Instrument %ld\\tcommon\" }\n",
+                    i, 100 + i % 7, i);
+                out.write(buf, n);
+                size += n;
+            }
+            out << "}\n";
+        }
+        ~config_file() { ::unlink(m_name.c_str()); }
+
+        const std::string& name()   const { return m_name;   }
+        long               mbytes() const { return m_mbytes; }
+
+        static const config_file& instance() {
+            static config_file s_file;
+            return s_file;
+        }
+    };
+
+    template <class Read>
+    void parse_loop(bench::state& state, Read a_read) {
+        state.pause();
+        auto& file = config_file::instance();
+        state.items(state.iterations() * file.mbytes());
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            variant_tree pt;
+            state.resume();
+            a_read(file.name(), pt);
+            state.pause();
+            bench::do_not_optimize(pt);
+        }
+    }
+}
+
+/// Reading through std::ifstream (the stream interface of read_config)
+UTXX_BENCH(config, read_scon_ifstream)
+{
+    parse_loop(state, [](const std::string& a_file, variant_tree& a_tree) {
+        std::ifstream in(a_file);
+        read_config(in, a_tree, FORMAT_SCON, a_file);
+    });
+}
+
+/// Reading a memory-mapped file
+UTXX_BENCH(config, read_scon_mmap)
+{
+    parse_loop(state, [](const std::string& a_file, variant_tree& a_tree) {
+        read_config(a_file, a_tree);
+    });
+}
+
+/// Validation of a configuration having ~20k nodes in repeated sections
+UTXX_BENCH(config, validate_20k_nodes)
+{
+    state.pause();
+    static const char* s_exchanges[] = { "NYSE", "NSDQ", "ARCA" };
+    variant_tree pt;
+    long nodes = 0;
+    for (int i=0; nodes < 20000; ++i) {
+        variant_tree instr;
+        char symbol[16];
+        snprintf(symbol, sizeof(symbol), "SYM%06d", i);
+        instr.put("symbol",    variant(symbol));
+        instr.put("exchange",  variant(s_exchanges[i % 3]));
+        instr.put("tick-size", 0.01);
+        instr.put("lot-size",  variant(100l));
+        instr.put("active",    i % 5 != 0);
+        nodes += 6;
+        if (i % 4 == 0) {
+            instr.put("limits.max-pos", variant(5000l));
+            nodes += 2;
+        }
+        pt.add_child("instruments.instrument", instr);
+    }
+    auto* validator = bench_config::cfg_validator::instance();
+    state.items(state.iterations() * nodes);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        validator->validate(pt, false);
+}
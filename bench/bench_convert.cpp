@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------
+/// \file  bench_convert.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of number/string conversions.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/convert.hpp>
+#include <utxx/fast_itoa.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace utxx;
+
+namespace {
+    /// Values spanning from 1 to 19 digits
+    inline long value(long i) { return (i * 2654435761l) >> (i & 31); }
+}
+
+UTXX_BENCH(convert, snprintf_long)
+{
+    char buf[32];
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        snprintf(buf, sizeof(buf), "%ld", value(i));
+        bench::do_not_optimize(buf);
+    }
+}
+
+UTXX_BENCH(convert, itoa_left_long)
+{
+    char buf[32];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(itoa_left(buf, value(i)));
+}
+
+UTXX_BENCH(convert, fast_itoa_long)
+{
+    char buf[32];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(fast_itoa(value(i), buf));
+}
+
+UTXX_BENCH(convert, strtol)
+{
+    char buf[32];
+    long sum = 0;
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        state.pause();
+        fast_itoa(value(i), buf);
+        state.resume();
+        sum += ::strtol(buf, nullptr, 10);
+    }
+    bench::do_not_optimize(sum);
+}
+
+UTXX_BENCH(convert, fast_atoi_long)
+{
+    static const int s_count = 1024;
+    char buf[s_count][24];
+    size_t len[s_count];
+    for (int i=0; i < s_count; ++i)
+        len[i] = fast_itoa(value(i), buf[i]) - buf[i];
+    long sum = 0, v = 0;
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto j = i & (s_count-1);
+        fast_atoi<long, false>(buf[j], len[j], v);
+        sum += v;
+    }
+    bench::do_not_optimize(sum);
+}
+
+UTXX_BENCH(convert, ftoa_left)
+{
+    char buf[32];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(ftoa_left(double(value(i)) / 1024, buf, sizeof(buf), 6));
+}
+
+UTXX_BENCH(convert, atof)
+{
+    static const int s_count = 1024;
+    char buf[s_count][32];
+    size_t len[s_count];
+    for (int i=0; i < s_count; ++i)
+        len[i] = ftoa_left(double(value(i)) / 1024, buf[i], sizeof(buf[i]), 6);
+    double sum = 0, v = 0;
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto j = i & (s_count-1);
+        utxx::atof(buf[j], buf[j] + len[j], v);
+        sum += v;
+    }
+    bench::do_not_optimize(sum);
+}
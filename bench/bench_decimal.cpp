@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------
+/// \file  bench_decimal.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of decimal parsing, formatting and batch operations.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/decimal_batch.hpp>
+#include <random>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace utxx;
+
+namespace {
+    const size_t s_count = 4096;
+
+    /// Prices with 2 to 8 decimal places
+    struct prices {
+        std::vector<decimal>     values;
+        std::vector<decimal>     others;
+        std::vector<long>        qty;
+        std::vector<std::string> text;
+
+        prices() {
+            std::mt19937_64 rng(1);
+            for (size_t i=0; i < s_count; ++i) {
+                int e = -2 - int(rng() % 7);
+                values.push_back(decimal(e, long(rng() % 100000000)));
+                others.push_back(decimal(e, long(rng() % 100000000)));
+                qty.push_back(long(rng() % 1000) + 1);
+                text.push_back(values.back().to_string());
+            }
+        }
+
+        static const prices& instance() { static prices s; return s; }
+    };
+
+    template <class F>
+    void batch_loop(bench::state& state, F a_fun) {
+        auto& p = prices::instance();
+        state.items(state.iterations() * s_count);
+        for (long i=0, n=state.iterations(); i < n; ++i)
+            a_fun(p);
+    }
+}
+
+UTXX_BENCH(decimal, parse_strtod)
+{
+    auto& p = prices::instance();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto& s = p.text[i & (s_count-1)];
+        decimal d(strtod(s.c_str(), nullptr), 8);
+        bench::do_not_optimize(d);
+    }
+}
+
+UTXX_BENCH(decimal, parse)
+{
+    auto& p = prices::instance();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto& s = p.text[i & (s_count-1)];
+        decimal d;
+        d.parse(s.c_str(), s.c_str() + s.size());
+        bench::do_not_optimize(d);
+    }
+}
+
+UTXX_BENCH(decimal, write)
+{
+    auto& p = prices::instance();
+    char  buf[decimal::max_width()];
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(p.values[i & (s_count-1)].write(buf));
+}
+
+UTXX_BENCH(decimal, dot_scalar)
+{
+    batch_loop(state, [](const prices& p) {
+        long s = 0;
+        for (size_t i=0; i < s_count; ++i)
+            s += detail::decimal_rescale(p.values[i], -8) * p.qty[i];
+        bench::do_not_optimize(s);
+    });
+}
+
+UTXX_BENCH(decimal, dot_batch)
+{
+    batch_loop(state, [](const prices& p) {
+        bench::do_not_optimize(decimal_batch::dot(p.values.data(), p.qty.data(), s_count, -8));
+    });
+}
+
+UTXX_BENCH(decimal, sum_batch)
+{
+    batch_loop(state, [](const prices& p) {
+        bench::do_not_optimize(decimal_batch::sum(p.values.data(), s_count, -8));
+    });
+}
+
+UTXX_BENCH(decimal, compare_scalar)
+{
+    int8_t res[s_count];
+    batch_loop(state, [&res](const prices& p) {
+        for (size_t i=0; i < s_count; ++i)
+            res[i] = detail::decimal_compare(p.values[i], p.others[i]);
+        bench::do_not_optimize(res);
+    });
+}
+
+UTXX_BENCH(decimal, compare_batch)
+{
+    int8_t res[s_count];
+    batch_loop(state, [&res](const prices& p) {
+        decimal_batch::compare(p.values.data(), p.others.data(), s_count, res);
+        bench::do_not_optimize(res);
+    });
+}
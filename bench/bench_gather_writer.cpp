@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------
+/// \file  bench_gather_writer.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of fanning out a message to many connections.
+///
+/// A 64K snapshot with a per-connection header is sent to 256 connections
+/// emulated by /dev/null, so that only the cost of assembling the outgoing
+/// data is measured. Results are reported per connection.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/gather_writer.hpp>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace utxx;
+
+namespace {
+    static const int s_clients  = 256;
+    static const int s_snapshot = 64*1024;
+
+    struct header {
+        uint32_t seqno;
+        uint32_t len;
+        uint64_t client;
+    };
+
+    struct nodel { void operator()() {} };
+}
+
+/// Copy the header and the snapshot to a per-connection buffer and write it
+UTXX_BENCH(fanout, copy)
+{
+    state.pause();
+    std::string snap(s_snapshot, 'x');
+    std::vector<std::string> bufs(s_clients);
+    int fd = ::open("/dev/null", O_WRONLY);
+    state.items(state.iterations() * s_clients);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        for (int c=0; c < s_clients; ++c) {
+            header h{uint32_t(i), uint32_t(s_snapshot), uint64_t(c)};
+            auto& b = bufs[c];
+            b.assign((const char*)&h, sizeof(h));
+            b.append(snap);
+            bench::do_not_optimize(::write(fd, b.data(), b.size()));
+        }
+    state.pause();
+    ::close(fd);
+}
+
+/// Queue the header and a shared reference to the snapshot and write them
+/// with one writev(2) call
+UTXX_BENCH(fanout, gather_writer)
+{
+    state.pause();
+    std::string snap(s_snapshot, 'x');
+    std::vector<gather_writer> writers(s_clients);
+    int fd = ::open("/dev/null", O_WRONLY);
+    state.items(state.iterations() * s_clients);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        shared_const_buffer buf(boost::asio::buffer(snap), nodel());
+        for (int c=0; c < s_clients; ++c) {
+            header h{uint32_t(i), uint32_t(s_snapshot), uint64_t(c)};
+            auto& w = writers[c];
+            w.append(&h, sizeof(h));
+            w.append(buf);
+            bench::do_not_optimize(w.flush(fd));
+        }
+    }
+    state.pause();
+    ::close(fd);
+}
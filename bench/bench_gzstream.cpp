@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------
+/// \file  bench_gzstream.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of serial and parallel gzip streams.
+///
+/// Results are reported per megabyte of uncompressed text, so that the
+/// throughput in MB/s is 1e9 / (ns per item).
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/gzstream.hpp>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef UTXX_HAVE_LIBZ
+
+using namespace utxx;
+
+namespace {
+    /// 8 MB of log lines
+    struct synthetic_log {
+        static const long MBYTES = 8;
+        std::string text;
+        std::string file;
+
+        synthetic_log() : file(std::string(P_tmpdir) + "/bench_gzstream.gz") {
+            char buf[256];
+            srand(1);
+            for (long i=0; text.size() < (MBYTES << 20); ++i) {
+                int n = snprintf(buf, sizeof(buf),
+                            "20161008-10:%02ld:%02ld.%06ld [D] MD %s bid=%d.%02d "
+                            "ask=%d.%02d seq=%ld\n",
+                            i / 60 % 60, i % 60, i % 1000000, i & 1 ? "AAPL" : "MSFT",
+                            100 + rand() % 10, rand() % 100,
+                            110 + rand() % 10, rand() % 100, i);
+                text.append(buf, n);
+            }
+        }
+        ~synthetic_log() { ::unlink(file.c_str()); }
+
+        static const synthetic_log& instance() {
+            static synthetic_log s_log;
+            return s_log;
+        }
+    };
+
+    void compress(bench::state& state, const gzopts& a_opts) {
+        state.pause();
+        auto& log = synthetic_log::instance();
+        state.items(state.iterations() * synthetic_log::MBYTES);
+        state.resume();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            ogzstream out(log.file, std::ios::out, a_opts);
+            out.write(log.text.data(), log.text.size());
+        }
+    }
+
+    void decompress(bench::state& state, const gzopts& a_opts) {
+        state.pause();
+        auto& log = synthetic_log::instance();
+        {
+            ogzstream out(log.file);
+            out.write(log.text.data(), log.text.size());
+        }
+        std::string res(log.text.size(), '\0');
+        state.items(state.iterations() * synthetic_log::MBYTES);
+        state.resume();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            igzstream in(log.file, std::ios::in, a_opts);
+            in.read(&res[0], res.size());
+            bench::do_not_optimize(in.gcount());
+        }
+    }
+}
+
+/// Single gzFile written from the calling thread
+UTXX_BENCH(gzstream, compress_serial)
+{
+    compress(state, gzopts());
+}
+
+/// Blocks compressed on 2 threads
+UTXX_BENCH(gzstream, compress_2_threads)
+{
+    compress(state, gzopts(Z_DEFAULT_COMPRESSION, 2));
+}
+
+/// Blocks compressed on 4 threads
+UTXX_BENCH(gzstream, compress_4_threads)
+{
+    compress(state, gzopts(Z_DEFAULT_COMPRESSION, 4));
+}
+
+/// Decompression with the default 8K buffers
+UTXX_BENCH(gzstream, decompress)
+{
+    decompress(state, gzopts());
+}
+
+/// Decompression with 1M buffers
+UTXX_BENCH(gzstream, decompress_1m_buffer)
+{
+    decompress(state, gzopts(0, 0, 0, 1024*1024));
+}
+
+#endif // UTXX_HAVE_LIBZ
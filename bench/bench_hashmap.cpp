@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------
+/// \file  bench_hashmap.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of hash maps.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/hashmap.hpp>
+#include <utxx/atomic_hash_map.hpp>
+#include <unordered_map>
+#include <random>
+#include <vector>
+
+using namespace utxx;
+
+namespace {
+    static const size_t s_entries = 100000;
+
+    /// Random order ids inserted into maps and looked up in random order
+    const std::vector<long>& keys() {
+        static std::vector<long> s_keys = [] {
+            std::mt19937_64 rng(1);
+            std::vector<long> v(s_entries);
+            for (auto& k : v) k = long(rng() >> 1);
+            return v;
+        }();
+        return s_keys;
+    }
+
+    template <class Map>
+    void find_loop(bench::state& state, const Map& a_map) {
+        auto& k = keys();
+        long sum = 0;
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            auto it = a_map.find(k[(i * 7919) % s_entries]);
+            sum += it->second;
+        }
+        bench::do_not_optimize(sum);
+    }
+
+    template <class Map>
+    void insert_loop(bench::state& state) {
+        auto& k = keys();
+        long  n = state.iterations();
+        for (long i=0; i < n; i += s_entries) {
+            state.pause();
+            {
+                Map m;
+                state.resume();
+                for (long j=i, e = std::min(n, i+long(s_entries)); j < e; ++j)
+                    m[k[j-i]] = j;
+                bench::do_not_optimize(m.size());
+                state.pause();
+            }
+            state.resume();
+        }
+    }
+}
+
+UTXX_BENCH(hashmap, std_unordered_map_find)
+{
+    static const std::unordered_map<long, long> s_map = [] {
+        std::unordered_map<long, long> m;
+        for (auto k : keys()) m[k] = k;
+        return m;
+    }();
+    find_loop(state, s_map);
+}
+
+UTXX_BENCH(hashmap, flat_hash_map_find)
+{
+    static const detail::flat_hash_map<long, long> s_map = [] {
+        detail::flat_hash_map<long, long> m;
+        for (auto k : keys()) m[k] = k;
+        return m;
+    }();
+    find_loop(state, s_map);
+}
+
+UTXX_BENCH(hashmap, atomic_hash_map_find)
+{
+    typedef atomic_hash_map<long, long> map_t;
+    static map_t* s_map = [] {
+        auto m = new map_t(s_entries * 2);
+        for (auto k : keys()) m->insert(k, k);
+        return m;
+    }();
+    find_loop(state, *s_map);
+}
+
+UTXX_BENCH(hashmap, std_unordered_map_insert)
+{
+    insert_loop<std::unordered_map<long, long>>(state);
+}
+
+UTXX_BENCH(hashmap, flat_hash_map_insert)
+{
+    insert_loop<detail::flat_hash_map<long, long>>(state);
+}
@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------
+/// \file  bench_io_buffer.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of parsing a stream of messages from an I/O buffer.
+///
+/// Length-prefixed messages arrive in reads that don't align with message
+/// boundaries. Results are reported per message.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/buffer.hpp>
+#include <utxx/mirrored_io_buffer.hpp>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+
+using namespace utxx;
+
+namespace {
+    /// Stream of messages of 20 to MaxMsg bytes prefixed by a 2-byte length
+    /// read in chunks of about ReadSize bytes
+    template <int ReadSize, int MaxMsg>
+    struct message_stream {
+        std::string       data;
+        std::vector<int>  reads;    // Sizes of reads
+        long              count;
+
+        message_stream() : count(0) {
+            srand(1);
+            while (data.size() < (8 << 20)) {
+                uint16_t len = 20 + rand() % (MaxMsg - 20);
+                data.append((const char*)&len, sizeof(len));
+                data.append(len, char('a' + count++ % 26));
+            }
+            for (size_t n = 0; n < data.size(); n += reads.back())
+                reads.push_back(std::min<size_t>(data.size() - n,
+                                                 ReadSize - rand() % (ReadSize / 10)));
+        }
+
+        static const message_stream& instance() {
+            static message_stream s_stream;
+            return s_stream;
+        }
+    };
+
+    template <int ReadSize, int MaxMsg, class Buffer>
+    void parse(bench::state& state, Buffer& a_buf) {
+        state.pause();
+        auto& s = message_stream<ReadSize, MaxMsg>::instance();
+        state.items(state.iterations() * s.count);
+        state.resume();
+        long sum = 0;
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            const char* p = s.data.data();
+            for (auto k : s.reads) {
+                // Emulate a read(2) from a socket
+                memcpy(a_buf.wr_ptr(), p, k);
+                a_buf.commit(k);
+                p += k;
+                while (a_buf.size() >= 2) {
+                    uint16_t len;
+                    memcpy(&len, a_buf.rd_ptr(), 2);
+                    if (a_buf.size() < 2u + len)
+                        break;
+                    sum += a_buf.read(2 + len)[2];
+                }
+                a_buf.crunch();
+            }
+        }
+        bench::do_not_optimize(sum);
+    }
+}
+
+/// Messages of up to 400 bytes in TCP segments, moving partial messages
+/// to the front of the buffer after each read
+UTXX_BENCH(io_buffer, basic_io_buffer_small)
+{
+    dynamic_io_buffer buf(16*1024);
+    parse<1448, 400>(state, buf);
+}
+
+/// Messages of up to 400 bytes in TCP segments, mirrored ring buffer
+UTXX_BENCH(io_buffer, mirrored_io_buffer_small)
+{
+    mirrored_io_buffer buf(16*1024);
+    parse<1448, 400>(state, buf);
+}
+
+/// Messages of up to 32K in 64K reads, moving partial messages to the
+/// front of the buffer after each read
+UTXX_BENCH(io_buffer, basic_io_buffer_large)
+{
+    dynamic_io_buffer buf(128*1024);
+    parse<65536, 32768>(state, buf);
+}
+
+/// Messages of up to 32K in 64K reads, mirrored ring buffer
+UTXX_BENCH(io_buffer, mirrored_io_buffer_large)
+{
+    mirrored_io_buffer buf(128*1024);
+    parse<65536, 32768>(state, buf);
+}
@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------------
+/// \file  bench_leb128.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of LEB128 encoding and decoding of integer streams.
+///
+/// Results are reported per integer, so that the throughput in integers
+/// per second is 1e9 / (ns per item).
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/leb128.hpp>
+#include <random>
+#include <vector>
+
+using namespace utxx;
+
+namespace {
+    static const size_t COUNT = 64 * 1024;
+
+    /// Encoded stream of COUNT integers of up to \a Bits bits
+    template <int Bits>
+    struct stream {
+        std::vector<uint64_t> values;
+        std::vector<char>     data;
+
+        stream() : values(COUNT), data(max_encoded_uleb128_size(COUNT)) {
+            std::mt19937_64 rng(Bits);
+            for (auto& v : values)
+                v = rng() >> (64 - rng() % Bits - 1);
+            data.resize(encode_uleb128(values.data(), COUNT, data.data()));
+        }
+
+        static const stream& instance() {
+            static stream s_stream;
+            return s_stream;
+        }
+    };
+
+    template <int Bits>
+    void decode_single(bench::state& state) {
+        state.pause();
+        auto& s = stream<Bits>::instance();
+        std::vector<uint64_t> out(COUNT);
+        state.items(state.iterations() * COUNT);
+        state.resume();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            const char* p = s.data.data();
+            for (auto& v : out)
+                v = decode_uleb128(p);
+            bench::do_not_optimize(out.back());
+        }
+    }
+
+    template <int Bits>
+    void decode_bulk(bench::state& state) {
+        state.pause();
+        auto& s = stream<Bits>::instance();
+        std::vector<uint64_t> out(COUNT);
+        state.items(state.iterations() * COUNT);
+        state.resume();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            const char* p = s.data.data();
+            bench::do_not_optimize
+                (decode_uleb128(p, p + s.data.size(), out.data(), COUNT));
+        }
+    }
+}
+
+/// One value at a time, values of 1 byte
+UTXX_BENCH(leb128, decode_single_1byte)  { decode_single<7>(state);  }
+/// Bulk decoding, values of 1 byte
+UTXX_BENCH(leb128, decode_bulk_1byte)    { decode_bulk<7>(state);    }
+/// One value at a time, values of 1-3 bytes
+UTXX_BENCH(leb128, decode_single_3bytes) { decode_single<21>(state); }
+/// Bulk decoding, values of 1-3 bytes
+UTXX_BENCH(leb128, decode_bulk_3bytes)   { decode_bulk<21>(state);   }
+/// One value at a time, values of 1-10 bytes
+UTXX_BENCH(leb128, decode_single_any)    { decode_single<64>(state); }
+/// Bulk decoding, values of 1-10 bytes
+UTXX_BENCH(leb128, decode_bulk_any)      { decode_bulk<64>(state);   }
+
+/// Bulk encoding, values of 1-3 bytes
+UTXX_BENCH(leb128, encode_bulk_3bytes)
+{
+    state.pause();
+    auto& s = stream<21>::instance();
+    std::vector<char> out(max_encoded_uleb128_size(COUNT));
+    state.items(state.iterations() * COUNT);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(encode_uleb128(s.values.data(), COUNT, out.data()));
+}
+
+/// Delta decoding of nanosecond time stamps
+UTXX_BENCH(leb128, decode_delta_timestamps)
+{
+    state.pause();
+    std::mt19937_64 rng(1);
+    std::vector<int64_t> ts(COUNT);
+    int64_t t = 1476000000000000000, base = 0;
+    for (auto& v : ts)
+        v = t += rng() % 100000;
+    std::vector<char> data(max_encoded_uleb128_size(COUNT));
+    data.resize(encode_delta_uleb128(ts.data(), COUNT, data.data(), base));
+    state.items(state.iterations() * COUNT);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        const char* p = data.data();
+        base = 0;
+        bench::do_not_optimize
+            (decode_delta_uleb128(p, p + data.size(), ts.data(), COUNT, base));
+    }
+}
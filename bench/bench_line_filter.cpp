@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------
+/// \file  bench_line_filter.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of regex line filtering of a synthetic log.
+///
+/// Results are reported per megabyte of log text, so that the throughput
+/// in MB/s is 1e9 / (ns per item).
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/line_filter.hpp>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace utxx;
+
+namespace {
+    static const char* s_pattern = "ORDER ([0-9]+) FILLED qty=([0-9]+)";
+
+    /// 16 MB of log lines, 1% of which match s_pattern
+    struct synthetic_log {
+        static const long MBYTES = 16;
+        std::string text;
+
+        synthetic_log() {
+            char buf[256];
+            srand(1);
+            for (long i=0; text.size() < (MBYTES << 20); ++i) {
+                int n = i % 100 == 0
+                      ? snprintf(buf, sizeof(buf),
+                            "20161004-10:%02ld:%02ld.%06ld [I] ORDER %ld FILLED qty=%d\n",
+                            i / 60 % 60, i % 60, i % 1000000, i, rand() % 1000)
+                      : snprintf(buf, sizeof(buf),
+                            "20161004-10:%02ld:%02ld.%06ld [D] MD %s bid=%d.%02d "
+                            "ask=%d.%02d seq=%ld\n",
+                            i / 60 % 60, i % 60, i % 1000000, i & 1 ? "AAPL" : "MSFT",
+                            100 + rand() % 10, rand() % 100,
+                            110 + rand() % 10, rand() % 100, i);
+                text.append(buf, n);
+            }
+        }
+
+        static const synthetic_log& instance() {
+            static synthetic_log s_log;
+            return s_log;
+        }
+    };
+
+    template <class Scan>
+    void scan_loop(bench::state& state, Scan a_scan) {
+        state.pause();
+        auto& log = synthetic_log::instance();
+        state.items(state.iterations() * synthetic_log::MBYTES);
+        state.resume();
+        const char* begin = log.text.c_str();
+        const char* end   = begin + log.text.size();
+        for (long i=0, n=state.iterations(); i < n; ++i)
+            bench::do_not_optimize(a_scan(begin, end));
+    }
+}
+
+/// std::regex tried on every line (the former tailagg implementation)
+UTXX_BENCH(line_filter, regex_per_line)
+{
+    std::regex  re(s_pattern);
+    std::cmatch m;
+    scan_loop(state, [&](const char* a_begin, const char* a_end) {
+        size_t n = 0;
+        for (const char* p = a_begin, *q; p < a_end; p = q + 1) {
+            q = (const char*)memchr(p, '\n', a_end - p);
+            n += std::regex_search(p, q, m, re);
+        }
+        return n;
+    });
+}
+
+/// Literal pre-filter searched on every line
+UTXX_BENCH(line_filter, match_per_line)
+{
+    line_filter filter(s_pattern);
+    std::cmatch m;
+    scan_loop(state, [&](const char* a_begin, const char* a_end) {
+        size_t n = 0;
+        for (const char* p = a_begin, *q; p < a_end; p = q + 1) {
+            q = (const char*)memchr(p, '\n', a_end - p);
+            n += filter.match(p, q, m);
+        }
+        return n;
+    });
+}
+
+/// Literal pre-filter searched in the whole buffer
+UTXX_BENCH(line_filter, scan)
+{
+    line_filter filter(s_pattern);
+    scan_loop(state, [&](const char* a_begin, const char* a_end) {
+        return filter.scan(a_begin, a_end,
+                           [](const char*, const char*, const std::cmatch&) {});
+    });
+}
+
+/// Substring search alone
+UTXX_BENCH(line_filter, find_substr)
+{
+    scan_loop(state, [&](const char* a_begin, const char* a_end) {
+        size_t n = 0;
+        for (const char* p = a_begin; (p = find_substr(p, a_end, " FILLED", 7)) != a_end; ++p)
+            ++n;
+        return n;
+    });
+}
+
+/// Substring search with memmem(3) for reference
+UTXX_BENCH(line_filter, memmem)
+{
+    scan_loop(state, [&](const char* a_begin, const char* a_end) {
+        size_t n = 0;
+        for (const char* p = a_begin;
+             (p = (const char*)memmem(p, a_end - p, " FILLED", 7)); ++p)
+            ++n;
+        return n;
+    });
+}
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------
+/// \file  bench_logger.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of the logger and the multi-file async logger.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/logger/logger.hpp>
+#include <utxx/multi_file_async_logger.hpp>
+#include <utxx/variant_tree.hpp>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace utxx;
+
+namespace {
+    static const char s_log_file[]   = "/tmp/utxx_bench_logger.log";
+    static const char s_async_file[] = "/tmp/utxx_bench_async_logger.log";
+
+    void logger_init(const char* a_timestamp) {
+        variant_tree pt;
+        pt.put("logger.timestamp",          variant(a_timestamp));
+        pt.put("logger.min-level-filter",   variant("info"));
+        pt.put("logger.show-ident",         false);
+        pt.put("logger.show-location",      false);
+        pt.put("logger.silent-finish",      true);
+        pt.put("logger.file.stdout-levels", variant("info|warning|error|fatal|alert"));
+        pt.put("logger.file.filename",      variant(s_log_file));
+        pt.put("logger.file.append",        false);
+        pt.put("logger.file.no-header",     true);
+        logger::instance().init(pt);
+    }
+
+    /// Caller-side cost of logging a message (every 16th call is also
+    /// sampled into the latency histogram)
+    void log_loop(bench::state& state, const char* a_timestamp) {
+        state.pause();
+        logger_init(a_timestamp);
+        state.resume();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            if (i & 15)
+                LOG_INFO("Order %ld filled at %.2f qty %d", i, 100.25, 10);
+            else {
+                perf_histogram::sample s(state.histogram());
+                LOG_INFO("Order %ld filled at %.2f qty %d", i, 100.25, 10);
+            }
+        }
+        state.pause();
+        logger::instance().finalize();
+        ::unlink(s_log_file);
+    }
+}
+
+UTXX_BENCH(logger, log_info)
+{
+    log_loop(state, "none");
+}
+
+UTXX_BENCH(logger, log_info_time_usec)
+{
+    log_loop(state, "time-usec");
+}
+
+UTXX_BENCH(logger, log_filtered_out)
+{
+    state.pause();
+    logger_init("none");
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        LOG_DEBUG("Order %ld filled at %.2f qty %d", i, 100.25, 10);
+    state.pause();
+    logger::instance().finalize();
+    ::unlink(s_log_file);
+}
+
+UTXX_BENCH(logger, multi_file_async_write)
+{
+    static const char s_msg[] = "Order 123456 filled at 100.25 qty 10\n";
+    state.pause();
+    multi_file_async_logger log;
+    auto fd = log.open_file(s_async_file, false);
+    if (fd.fd() < 0 || log.start() != 0)
+        throw std::runtime_error("Cannot start multi_file_async_logger");
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        char* p = log.allocate(sizeof(s_msg)-1);
+        memcpy(p, s_msg, sizeof(s_msg)-1);
+        if ((i & 15) == 0) {
+            perf_histogram::sample s(state.histogram());
+            log.write(fd, "", p, sizeof(s_msg)-1);
+        } else
+            log.write(fd, "", p, sizeof(s_msg)-1);
+    }
+    state.pause();
+    log.stop();
+    ::unlink(s_async_file);
+}
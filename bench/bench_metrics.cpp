@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------
+/// \file  bench_metrics.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of metrics updates.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/metrics.hpp>
+#include <utxx/thread_cached_int.hpp>
+#include <atomic>
+
+using namespace utxx;
+
+/// Shared atomic counter for reference
+UTXX_BENCH(metrics, atomic_fetch_add)
+{
+    static std::atomic<long> s_count(0);
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        s_count.fetch_add(1, std::memory_order_relaxed);
+    bench::do_not_optimize(s_count);
+}
+
+UTXX_BENCH(metrics, thread_cached_int)
+{
+    struct tag {};
+    static thread_cached_int<long, tag> s_count;
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        ++s_count;
+    bench::do_not_optimize(s_count.read_fast());
+}
+
+UTXX_BENCH(metrics, counter_inc)
+{
+    static auto& s_count = metrics_registry::instance().counter("bench.counter");
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        s_count.inc();
+    bench::do_not_optimize(s_count);
+}
+
+UTXX_BENCH(metrics, gauge_set)
+{
+    static auto& s_gauge = metrics_registry::instance().gauge("bench.gauge");
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        s_gauge.set(i);
+    bench::do_not_optimize(s_gauge);
+}
+
+UTXX_BENCH(metrics, histogram_add)
+{
+    static auto& s_hist = metrics_registry::instance().histogram("bench.histogram");
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        s_hist.add((i & 1023) * 100);
+    bench::do_not_optimize(s_hist);
+}
+
+/// Sweep of all registered metrics by the collector
+UTXX_BENCH(metrics, snapshot)
+{
+    state.pause();
+    std::unique_ptr<metrics_snapshot> snap(new metrics_snapshot());
+    auto& reg = metrics_registry::instance();
+    for (int i=0; i < 100; ++i)
+        reg.counter("bench.counter." + std::to_string(i)).inc();
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        reg.snapshot(*snap);
+    bench::do_not_optimize(snap->count);
+}
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------------
+/// \file  bench_queue.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of concurrent queues.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/concurrent_spsc_queue.hpp>
+#include <utxx/concurrent_mpsc_queue.hpp>
+#include <utxx/container/concurrent_priority_queue.hpp>
+#include <sched.h>
+#include <thread>
+
+using namespace utxx;
+
+namespace {
+    /// Spin briefly, then yield the CPU (keeps cross-thread benchmarks
+    /// meaningful when there are fewer cores than threads)
+    inline void backoff(int& a_spins) {
+        if (++a_spins < 64)
+            asm volatile("pause" ::: "memory");
+        else {
+            a_spins = 0;
+            ::sched_yield();
+        }
+    }
+}
+
+UTXX_BENCH(queue, spsc_push_pop)
+{
+    concurrent_spsc_queue<long> q(1024);
+    long v = 0;
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        q.push(i);
+        q.pop(v);
+    }
+    bench::do_not_optimize(v);
+}
+
+UTXX_BENCH(queue, spsc_two_threads)
+{
+    state.pause();
+    concurrent_spsc_queue<long> q(1024);
+    const long n = state.iterations();
+    volatile bool ready = false;
+
+    std::thread producer([&] {
+        bench::pin_thread(state.cpu(1));
+        while (!ready);
+        for (long i=0; i < n; ++i)
+            for (int spins = 0; !q.push(i); backoff(spins));
+    });
+
+    ready = true;
+    state.resume();
+    long v = 0, sum = 0;
+    for (long i=0; i < n; ++i) {
+        for (int spins = 0; !q.pop(v); backoff(spins));
+        sum += v;
+    }
+    state.pause();
+    producer.join();
+    bench::do_not_optimize(sum);
+}
+
+UTXX_BENCH(queue, mpsc_push_pop_all)
+{
+    typedef concurrent_mpsc_queue<long> queue_t;
+    static const int s_batch = 64;
+    queue_t q;
+    long sum = 0, n = state.iterations();
+    for (long i=0; i < n; i += s_batch) {
+        for (long j=i, e = std::min(n, i+s_batch); j < e; ++j)
+            q.push(j);
+        for (auto p = q.pop_all(); p; ) {
+            auto next = p->next();
+            sum += p->data();
+            q.free(p);
+            p = next;
+        }
+    }
+    bench::do_not_optimize(sum);
+}
+
+UTXX_BENCH(queue, priority_put_get)
+{
+    container::concurrent_priority_queue<long, 8> q;
+    long v = 0;
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        q.put(i & 7, i);
+        q.get(v);
+    }
+    bench::do_not_optimize(v);
+}
+
+/// Two producers putting cancels (priority 0) and new orders (priority 1)
+/// in a 1:4 ratio, and a consumer blocked in dequeue()
+UTXX_BENCH(queue, priority_mixed_two_producers)
+{
+    state.pause();
+    container::concurrent_priority_queue<long, 2> q;
+    const long n = state.iterations();
+    volatile bool ready = false;
+
+    auto produce = [&](int a_thread) {
+        bench::pin_thread(state.cpu(a_thread));
+        while (!ready);
+        for (long i=a_thread-1; i < n; i += 2)
+            for (int spins = 0; !q.put(i % 5 == 0 ? 0 : 1, i); backoff(spins));
+    };
+    std::thread p1(produce, 1), p2(produce, 2);
+
+    ready = true;
+    state.resume();
+    long v = 0, sum = 0;
+    for (long i=0; i < n; ++i) {
+        q.dequeue(v);
+        sum += v;
+    }
+    state.pause();
+    p1.join();
+    p2.join();
+    bench::do_not_optimize(sum);
+}
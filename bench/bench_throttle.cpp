@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------
+/// \file  bench_throttle.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of rate throttlers.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/rate_throttler.hpp>
+#include <utxx/gcra_throttle.hpp>
+
+using namespace utxx;
+
+UTXX_BENCH(throttle, time_spacing)
+{
+    time_val now(1000, 0);
+    time_spacing_throttle thr(1000, 1);
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(thr.add(1, now.add_nsec(i << 8)));
+}
+
+UTXX_BENCH(throttle, gcra)
+{
+    long now = time_val(1000, 0).nanoseconds();
+    gcra_throttle thr(1000, msecs(1));
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(thr.try_acquire(1, now + (i << 8)));
+}
+
+UTXX_BENCH(throttle, gcra_now)
+{
+    gcra_throttle thr(1000, msecs(1));
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(thr.try_acquire());
+}
+
+UTXX_BENCH(throttle, gcra_tsc_now)
+{
+    state.pause();
+    if (!high_res_timer::global_scale_factor())
+        high_res_timer::calibrate(100000, 1);
+    basic_gcra_throttle<gcra_tsc_clock> thr(1000, msecs(1));
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(thr.try_acquire());
+}
+
+/// Keyed limits of 20000 sessions accessed at random
+UTXX_BENCH(throttle, gcra_table_20k)
+{
+    state.pause();
+    long now = time_val(1000, 0).nanoseconds();
+    gcra_table tbl(20000, 100, secs(1));
+    uint64_t keys[1024];
+    for (auto& k : keys) k = 1 + rand() % 20000;
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(tbl.try_acquire(keys[i & 1023], 1, now + (i << 8)));
+}
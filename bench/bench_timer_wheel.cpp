@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------
+/// \file  bench_timer_wheel.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of timer wheel with a large number of live timers.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/timer_wheel.hpp>
+#include <map>
+#include <vector>
+#include <stdlib.h>
+
+using namespace utxx;
+
+namespace {
+    static const long LIVE_TIMERS = 500000;
+
+    /// Random delays up to 10s in nanoseconds
+    const std::vector<long>& delays() {
+        static std::vector<long> s_delays;
+        if (s_delays.empty()) {
+            srand(1);
+            s_delays.resize(1 << 16);
+            for (auto& d : s_delays)
+                d = (long(rand()) << 20 | rand()) % 10000000000l;
+        }
+        return s_delays;
+    }
+}
+
+/// Schedule a timer and cancel the oldest one, keeping 500k timers alive
+UTXX_BENCH(timer_wheel, schedule_cancel_500k)
+{
+    state.pause();
+    auto& d = delays();
+    auto  m = d.size() - 1;
+    timer_wheel w(usecs(100), LIVE_TIMERS+1, 0);
+    std::vector<timer_wheel::timer_id> ids(LIVE_TIMERS);
+    for (long i=0; i < LIVE_TIMERS; ++i)
+        ids[i] = w.schedule_at(d[i & m], i);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto& id = ids[i % LIVE_TIMERS];
+        w.cancel(id);
+        id = w.schedule_at(d[i & m], i);
+    }
+    bench::do_not_optimize(w.size());
+}
+
+/// Ordered map of timers for reference (similar to a heap timer queue)
+UTXX_BENCH(timer_wheel, multimap_schedule_cancel_500k)
+{
+    state.pause();
+    typedef std::multimap<long, long> map_t;
+    auto& d = delays();
+    auto  m = d.size() - 1;
+    map_t timers;
+    std::vector<map_t::iterator> ids(LIVE_TIMERS);
+    for (long i=0; i < LIVE_TIMERS; ++i)
+        ids[i] = timers.emplace(d[i & m], i);
+    state.resume();
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        auto& id = ids[i % LIVE_TIMERS];
+        timers.erase(id);
+        id = timers.emplace(d[i & m], i);
+    }
+    bench::do_not_optimize(timers.size());
+}
+
+/// Expiration of timers spread over 10s (reported per fired timer)
+UTXX_BENCH(timer_wheel, expire)
+{
+    state.pause();
+    auto& d = delays();
+    auto  m = d.size() - 1;
+    long  n = state.iterations(), fired = 0;
+    timer_wheel w(usecs(100), n, 0);
+    for (long i=0; i < n; ++i)
+        w.schedule_at(d[i & m], i);
+    state.resume();
+    for (long now = 0; !w.empty(); now += 1000000)
+        fired += w.expire(now, [](timer_wheel::timer_id, uint64_t) {});
+    bench::do_not_optimize(fired);
+}
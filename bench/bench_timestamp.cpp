@@ -0,0 +1,121 @@
+//----------------------------------------------------------------------------
+/// \file  bench_timestamp.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of timestamp formatting.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/timestamp.hpp>
+#include <utxx/time_val.hpp>
+#include <vector>
+
+using namespace utxx;
+
+namespace {
+    template <stamp_type Type>
+    void format_loop(bench::state& state) {
+        char buf[64];
+        const time_val now = now_utc();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            // Advance by ~1ms to defeat caching of identical stamps
+            timestamp::format(Type, now.add_nsec(i << 20), buf, sizeof(buf));
+            bench::do_not_optimize(buf);
+        }
+    }
+
+    template <stamp_type Type>
+    void formatter_loop(bench::state& state) {
+        char buf[64];
+        time_formatter f(Type);
+        const time_val now = now_utc();
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            f.write(buf, now.add_nsec(i << 20));
+            bench::do_not_optimize(buf);
+        }
+    }
+}
+
+UTXX_BENCH(timestamp, now_utc)
+{
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(now_utc());
+}
+
+UTXX_BENCH(timestamp, format_time_usec)
+{
+    format_loop<TIME_WITH_USEC>(state);
+}
+
+UTXX_BENCH(timestamp, format_date_time_usec)
+{
+    format_loop<DATE_TIME_WITH_USEC>(state);
+}
+
+UTXX_BENCH(timestamp, format_date_time_nsec)
+{
+    format_loop<DATE_TIME_WITH_NSEC>(state);
+}
+
+UTXX_BENCH(timestamp, time_val_to_string)
+{
+    const time_val now = now_utc();
+    for (long i=0, n=state.iterations(); i < n; ++i)
+        bench::do_not_optimize(now.add_nsec(i << 20).to_string(DATE_TIME_WITH_USEC));
+}
+
+UTXX_BENCH(timestamp, formatter_time_usec)
+{
+    formatter_loop<TIME_WITH_USEC>(state);
+}
+
+UTXX_BENCH(timestamp, formatter_date_time_usec)
+{
+    formatter_loop<DATE_TIME_WITH_USEC>(state);
+}
+
+UTXX_BENCH(timestamp, formatter_date_time_nsec)
+{
+    formatter_loop<DATE_TIME_WITH_NSEC>(state);
+}
+
+/// Rendering of 1024 timestamps per batch
+UTXX_BENCH(timestamp, formatter_batch_date_time_usec)
+{
+    static const int N = 1024;
+    time_formatter f(DATE_TIME_WITH_USEC);
+    std::vector<time_val> tvs(N);
+    std::vector<char>     out(N * f.size());
+    const time_val now = now_utc();
+    state.items(state.iterations() * N);
+    for (long i=0, n=state.iterations(); i < n; ++i) {
+        for (int j=0; j < N; ++j)
+            tvs[j] = now.add_nsec((i*N + j) << 20);
+        f.write(tvs.data(), N, out.data());
+        bench::do_not_optimize(out);
+    }
+}
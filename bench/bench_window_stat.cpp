@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------
+/// \file  bench_window_stat.cpp
+//----------------------------------------------------------------------------
+/// \brief Benchmarks of sliding window statistics updates.
+///
+/// Every tick updates the statistics of one of 20000 instruments, so the
+/// state of the updated window is mostly out of the CPU cache.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include "bench.hpp"
+#include <utxx/window_stat.hpp>
+#include <utxx/running_stat.hpp>
+#include <vector>
+#include <stdlib.h>
+
+using namespace utxx;
+
+namespace {
+    static const int INSTRUMENTS = 20000;
+
+    struct ticks {
+        std::vector<int>    instr;
+        std::vector<double> px;
+
+        ticks() : instr(1 << 16), px(1 << 16) {
+            srand(1);
+            for (size_t i=0; i < instr.size(); ++i) {
+                instr[i] = rand() % INSTRUMENTS;
+                px[i]    = 100.0 + double(rand()) / RAND_MAX;
+            }
+        }
+
+        static const ticks& instance() { static ticks s_ticks; return s_ticks; }
+    };
+
+    template <class Stat, class Add>
+    void tick_loop(bench::state& state, std::vector<Stat>& a_stats, Add a_add) {
+        auto& t = ticks::instance();
+        auto  m = t.instr.size() - 1;
+        for (long i=0, n=state.iterations(); i < n; ++i) {
+            auto& s = a_stats[t.instr[i & m]];
+            a_add(s, i, t.px[i & m]);
+            bench::do_not_optimize(s);
+        }
+    }
+}
+
+/// Cumulative mean/variance (no window) for reference
+UTXX_BENCH(window_stat, running_variance)
+{
+    std::vector<basic_running_variance<double>> stats(INSTRUMENTS);
+    tick_loop(state, stats, [](basic_running_variance<double>& s, long, double px) {
+        s.add(px);
+        bench::do_not_optimize(s.variance());
+    });
+}
+
+/// Sum and min/max over a 64-sample window
+UTXX_BENCH(window_stat, moving_average_64)
+{
+    std::vector<basic_moving_average<double, 64, true>> stats(INSTRUMENTS);
+    tick_loop(state, stats, [](basic_moving_average<double, 64, true>& s, long, double px) {
+        s.add(px);
+        bench::do_not_optimize(s.minmax());
+    });
+}
+
+/// Mean/variance/min/max over a 64-sample window
+UTXX_BENCH(window_stat, count_64)
+{
+    std::vector<basic_window_stat<double>> stats(INSTRUMENTS, basic_window_stat<double>(size_t(64)));
+    tick_loop(state, stats, [](basic_window_stat<double>& s, long, double px) {
+        s.add(px);
+        bench::do_not_optimize(s.variance() + s.min() + s.max());
+    });
+}
+
+/// Mean/variance/min/max/EWMA/median over a 1-minute window
+UTXX_BENCH(window_stat, time_1min_median)
+{
+    std::vector<basic_window_stat<double>> stats
+        (INSTRUMENTS, basic_window_stat<double>(secs(60), {0.5}));
+    time_val now(1000, 0);
+    tick_loop(state, stats, [&now](basic_window_stat<double>& s, long i, double px) {
+        s.add(now.add_nsec(i << 10), px);
+        bench::do_not_optimize(s.variance() + s.min() + s.max() +
+                               s.average().value() + s.quantile(0));
+    });
+}
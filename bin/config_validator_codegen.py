@@ -391,17 +391,14 @@ class ConfigGenerator(object):
             f.write("        %s() {\n" % name)
             f.write('            m_root = "%s";\n' % (root.attrib['root'] if root.attrib.get('root') else ""))
 
-            self.process_options(f, root)
+            entries = []
+            self.process_options(root, entries)
+            self.write_options(f, entries)
 
             f.write("            preprocess();\n")
             f.write("        }\n"
                     "    };\n\n"
-                    "} // namespace %s")
-
-    def value_to_string(self, val, type):
-        if val  == None:     return ""
-        if type == 'string': return '"' + val + '"'
-        return val
+                    "} // namespace %s\n" % root.attrib['namespace'])
 
     def string_to_type(self, type):
         if not type:            return 'config::STRING'
@@ -415,16 +412,46 @@ class ConfigGenerator(object):
         print >> sys.stderr, "Invalid option type '%s'" % (type)
         exit(6)
 
-    def process_options(self, f, root, level=0, arg='m_options'):
-        ws  = '  ' * (level+6)
-        ws1 = '  ' + ws
-        ws2 = '  ' + ws1
-
-        for node in sorted(set(root.xpath("./option"))):
-            f.write(ws  + "{\n")
-            f.write(ws1 + "ovec l_children%d; sset l_names; vset l_values;\n" % (level))
-            self.process_options(f, node, level+1, 'l_children'+str(level))
-
+    def write_options(self, f, entries):
+        """
+        Write the static option table and name/value choice lists
+        """
+        ws  = ' ' * 12
+        ws1 = ws + '    '
+        ws2 = ws1 + '  '
+        cstr = lambda s: 'nullptr' if s == None else '"%s"' % s
+
+        for i, e in enumerate(entries):
+            for kind in ['names', 'values']:
+                if not e[kind]: continue
+                f.write("%sstatic const config::choice_def s_%s%d[] = {\n" % (ws, kind, i))
+                for val, descr in e[kind]:
+                    f.write("%s{%s, %s},\n" % (ws1, cstr(val), cstr(descr)))
+                f.write("%s{nullptr, nullptr}\n%s};\n" % (ws1, ws))
+
+        f.write("%sstatic const config::option_def s_options[] = {\n" % ws)
+        for i, e in enumerate(entries):
+            f.write("%s// #%d\n"
+                    "%s{%d, %s(), %s, %s,\n"
+                    '%s"%s", %s /*unique*/, %s /*required*/, %s /*validate*/,\n'
+                    "%s%s /*default*/, %s /*min*/, %s /*max*/,\n"
+                    '%s"%s" /*defaults*/, %s /*recursive*/, %s, %s},\n' % (
+                    ws1, i,
+                    ws1, e['parent'], format_name(e['name']), e['type'], e['valtype'],
+                    ws2, e['desc'], e['unique'], e['required'], e['validate'],
+                    ws2, cstr(e['default']), cstr(e['min']), cstr(e['max']),
+                    ws2, e['defaults'], e['recursive'],
+                         ('s_names%d'  % i) if e['names']  else 'nullptr',
+                         ('s_values%d' % i) if e['values'] else 'nullptr'))
+        f.write("%s};\n" % ws)
+        f.write("%sadd_options(s_options, sizeof(s_options) / sizeof(s_options[0]));\n" % ws)
+
+    def process_options(self, root, entries, parent=-1):
+        """
+        Append options under root to the list of table entries in depth-first
+        order, so that every option follows its parent
+        """
+        for node in root.xpath("./option"):
             subopts = len(node.xpath("./option"))
             
             valid_opt_attrs = [
@@ -492,23 +519,15 @@ class ConfigGenerator(object):
                 text = "Option '%s' error: %s\n  path: %s" % (name, err, node_path_to_string(node,ids='_ID_'))
                 raise Exception(text)
 
+            names  = []
+            values = []
             for n in node.xpath("./name"):
                 self.check_valid_attribs(n.attrib.keys(), ['val','desc'], n.tag, n)
-                val   = n.attrib.get('val')
-                descr = n.attrib.get('desc')
-                f.write('%sl_names.insert(VAL_%s()%s);%s\n' % \
-                        (ws1, format_name(val), \
-                         ", \"" + descr + "\"" if descr else "", \
-                         " // " + descr if descr else ""))
+                names.append((n.attrib.get('val'), n.attrib.get('desc')))
 
             for n in node.xpath("./value"):
                 self.check_valid_attribs(n.attrib.keys(), ['val','desc'], n.tag, n)
-                val   = n.attrib.get('val')
-                descr = n.attrib.get('desc')
-                f.write('%sl_values.insert(variant(%s)%s);%s\n' % \
-                        (ws1, self.value_to_string(val, valtype), \
-                         ", \"" + descr + "\"" if descr else "", \
-                         " // " + descr if descr else ""))
+                values.append((n.attrib.get('val'), n.attrib.get('desc')))
 
             if tp:
                 str_tp = self.string_to_type(tp)
@@ -521,26 +540,24 @@ class ConfigGenerator(object):
 
             valtp = 'string' if not tp and subopts else valtype;
 
-            if default == None:
-                defval = "v()"
-            elif len(default) == 0:
-                defval = "variant(\"\")"
-            else:
-                defval = ('v("%s")' % default)
-
-            f.write("%sadd_option(%s,\n" % (ws1, arg))
-            f.write("%sconfig::option(%s(), %s, %s,\n"
-                    '%s  "%s", %s /*unique*/, %s /*required*/, %s /*validate*/,\n'
-                    "%s  %s /*default*/, v(%s) /*min*/, v(%s) /*max*/,\n"
-                    "%s  l_names, l_values, l_children%d, \"%s\", %s));\n"
-                    "%s}\n" % (
-                    ws2, format_name(name), str_tp, self.string_to_type(valtp),
-                    ws2, desc, unique, required, validate,
-                    ws2, defval,
-                        ('"%s"' % min) if min else "",
-                        ('"%s"' % max) if max else "",
-                    ws2, level, defaults, recursive,
-                    ws))
+            entries.append({
+                'parent':    parent,
+                'name':      name,
+                'type':      str_tp,
+                'valtype':   self.string_to_type(valtp),
+                'desc':      desc,
+                'unique':    unique,
+                'required':  required,
+                'validate':  validate,
+                'default':   default,
+                'min':       min if min else None,
+                'max':       max if max else None,
+                'defaults':  defaults,
+                'recursive': recursive,
+                'names':     names,
+                'values':    values})
+
+            self.process_options(node, entries, len(entries)-1)
 
 
 if __name__ == '__main__':
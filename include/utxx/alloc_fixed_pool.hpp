@@ -4,6 +4,9 @@
 /// \brief This module implements a concurrent lock-free fixed size pool
 /// manager for objects allocated in the heap or shared memory.
 /// Modeled after IBM free-list algorithm.
+/// A thread_cache front-end can be used by each thread to allocate and free
+/// objects without atomic operations, moving objects between its local
+/// free list and the pool in chains using a single CAS.
 //----------------------------------------------------------------------------
 // Copyright (c) 2010 Serge Aleynikov <saleyn@gmail.com>
 // Created: 2009-11-21
@@ -36,6 +39,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/type_traits.hpp>
 #include <boost/type_traits/is_same.hpp>
 #include <boost/interprocess/offset_ptr.hpp>
+#include <boost/noncopyable.hpp>
 
 #include <utxx/math.hpp>
 #include <utxx/meta.hpp>
@@ -59,16 +63,27 @@ class fixed_size_object_pool {
 
     typedef struct {
         #ifdef USE_PID_RECOVERY
-        unsigned short freed; // set to true when free is called
+        unsigned short freed; // One of OBJ_ALLOCATED, OBJ_FREE, OBJ_CACHED
         unsigned short owner;
         #endif
         pointer_type   next;
     } object_t;
 
+    #ifdef USE_PID_RECOVERY
+    enum {
+          OBJ_ALLOCATED             // Owned by the application
+        , OBJ_FREE                  // Located in the pool's free list
+        , OBJ_CACHED                // Located in some thread_cache of the owner
+    };
+    #endif
+
+    // The free list head holds the index of the first free object in the
+    // lower 16 bits, and the version incremented on every change of the head
+    // in the remaining bits.
     static const unsigned int   s_magic        = 0xFFEE8899;
-    static const unsigned int   s_index_mask   = 0x0000FFFF;
-    static const unsigned int   s_version_mask = 0xFFFF0000;
-    static const unsigned int   s_version_inc  = 0x00010000;
+    static const size_t         s_index_mask   = 0x0000FFFF;
+    static const size_t         s_version_mask = ~s_index_mask;
+    static const size_t         s_version_inc  = 0x00010000;
 
     const unsigned int          m_magic;
     const size_t                m_object_size;
@@ -102,7 +117,64 @@ class fixed_size_object_pool {
         static pid_t pid = ::getpid();
         return pid;
     }
+
+    static object_t* next_object(const object_t* p) {
+        return reinterpret_cast<object_t*>(&*p->next);
+    }
+
+    /// Remove a chain of up to \a n objects from the free list using a
+    /// single CAS.  The objects remain linked through object_t::next
+    /// (the link of the last one is undefined).  On return \a n holds the
+    /// number of objects in the chain.
+    object_t* pop_chain(size_t& n);
+
+    /// Return a chain of \a n objects linked through object_t::next
+    /// to the free list using a single CAS.
+    void      push_chain(object_t* first, object_t* last, size_t n);
+
 public:
+    /// Per-thread front-end of the pool.  It keeps a local free list
+    /// of up to 2*batch objects that are allocated and freed without atomic
+    /// operations.  Objects are moved between the local free list and the
+    /// pool in chains of <batch> objects using a single CAS.  Cached objects
+    /// are returned to the pool by flush() or on destruction.
+    /// The cache must be used by one thread only, and it must not outlive
+    /// the pool.  Objects allocated from a cache may be freed directly to
+    /// the pool or to any other cache of the same pool and vice versa.
+    class thread_cache : private boost::noncopyable {
+        fixed_size_object_pool& m_pool;
+        object_t*               m_head;
+        size_t                  m_count;
+        const size_t            m_batch;
+    public:
+        explicit thread_cache(fixed_size_object_pool& a_pool, size_t a_batch = 32)
+            : m_pool(a_pool), m_head(NULL), m_count(0)
+            , m_batch(a_batch ? a_batch : 1)
+        {}
+
+        ~thread_cache() { flush(); }
+
+        /// Allocate an object.  Returns NULL if the pool is exhausted.
+        void*  allocate();
+
+        /// Free an object to the local free list.
+        void   free(void* object);
+
+        /// Return all cached objects to the pool.
+        void   flush();
+
+        /// Number of objects in the local free list.
+        size_t cached()  const { return m_count; }
+
+        /// Number of objects moved at once between the cache and the pool.
+        size_t batch()   const { return m_batch; }
+
+        fixed_size_object_pool& pool() { return m_pool; }
+
+    private:
+        void   release(size_t n);
+    };
+
     /// Initialize the pool of fixed size objects.
     static fixed_size_object_pool& create(void* storage, size_t bytes, size_t object_size) {
         return *new (static_cast<fixed_size_object_pool*>(storage))
@@ -156,7 +228,10 @@ public:
     void info(void* p, size_t& obj_idx, size_t& next_idx) const;
     #endif
 
-    /// Reclaim allocated objects owned by <died_pid> by moving them to free list.
+    /// Reclaim objects owned by <died_pid> by moving them to free list.
+    /// This includes the objects allocated by the process as well as the ones
+    /// left in its thread caches.  Only has effect when compiled with
+    /// USE_PID_RECOVERY.
     void reclaim_objects(pid_t died_pid);
 };
 
@@ -207,6 +282,7 @@ fixed_size_object_pool<PointerType>
         object_t& pg = reinterpret_cast<object_t&>(*p);
         pg.next  = p == last ? NULL : p + m_object_size;
         #ifdef USE_PID_RECOVERY
+        pg.freed = OBJ_FREE;
         pg.owner = 0;
         #endif
         #ifdef DEBUG
@@ -251,7 +327,7 @@ void* fixed_size_object_pool<PointerType>
 
         if (atomic::cas(&m_free_list, old_head, new_head)) {
             #ifdef USE_PID_RECOVERY
-            p->freed = 0;
+            p->freed = OBJ_ALLOCATED;
             p->owner = get_pid();
             #endif
             #ifdef DEBUG
@@ -275,7 +351,8 @@ void fixed_size_object_pool<PointerType>
     BOOST_ASSERT(((p - m_begin) % m_object_size) == 0); // "Invalid object alignment!"
 
     #ifdef USE_PID_RECOVERY
-    obj->freed = 1;
+    obj->freed = OBJ_FREE;
+    obj->owner = 0;
     #endif
 
     size_t old_head, new_head;
@@ -305,15 +382,161 @@ void fixed_size_object_pool<PointerType>
 {
     #ifdef USE_PID_RECOVERY
     // Walk through all objects and move objects owned by died_pid
-    // to free list.
-    for (pointer_type p = m_begin; offset < m_end; offset += m_object_size) {
+    // (allocated or cached in its thread caches) to free list.
+    for (pointer_type p = m_begin; p < m_end; p += m_object_size) {
         object_t& pg = reinterpret_cast<object_t&>(*p);
-        if (pg.owner == died_pid && pg.freed == 1) {
-            pg.owner = 0;
+        if (pg.owner == (unsigned short)died_pid && pg.freed != OBJ_FREE)
             free(&pg + 1);
+    }
+    #endif
+}
+
+template <class PointerType>
+typename fixed_size_object_pool<PointerType>::object_t*
+fixed_size_object_pool<PointerType>
+::pop_chain(size_t& n)
+{
+    BOOST_ASSERT(m_magic == s_magic);
+    BOOST_ASSERT(n > 0);
+
+    size_t    old_head, new_head, cnt;
+    object_t* first;
+
+    do {
+        old_head = m_free_list;
+
+        if ((old_head & s_index_mask) == 0) {
+            n = 0;
+            return NULL;
         }
+
+        // Objects never leave the pool's storage, so it's safe to walk the
+        // chain while it's being modified - the versioned head guarantees
+        // that the CAS fails if the free list has changed.
+        first = head_to_object(old_head);
+        object_t* last = first;
+        for (cnt = 1; cnt < n && last->next; ++cnt)
+            last = next_object(last);
+
+        new_head = last->next ? object_to_head(old_head, last->next)
+                              : new_head_version(old_head);
+    } while (!atomic::cas(&m_free_list, old_head, new_head));
+
+    n = cnt;
+
+    #ifdef USE_PID_RECOVERY
+    object_t* p = first;
+    for (size_t i = 0; i < cnt; ++i, p = next_object(p)) {
+        p->freed = OBJ_CACHED;
+        p->owner = get_pid();
+    }
+    #endif
+    #ifdef DEBUG
+    atomic::add(&m_available, -long(cnt));
+    #endif
+    return first;
+}
+
+template <class PointerType>
+void fixed_size_object_pool<PointerType>
+::push_chain(object_t* first, object_t* last, size_t n)
+{
+    BOOST_ASSERT(first && last && n > 0);
+
+    #ifdef USE_PID_RECOVERY
+    for (object_t* p = first; ; p = next_object(p)) {
+        p->freed = OBJ_FREE;
+        p->owner = 0;
+        if (p == last) break;
+    }
+    #endif
+
+    const pointer_type pf = reinterpret_cast<char*>(first);
+    size_t old_head, new_head;
+
+    do {
+        old_head   = m_free_list;
+        last->next = (old_head & s_index_mask) == 0
+                   ? NULL
+                   : reinterpret_cast<char*>(head_to_object(old_head));
+        new_head   = object_to_head(old_head, pf);
+    } while (!atomic::cas(&m_free_list, old_head, new_head));
+
+    #ifdef DEBUG
+    atomic::add(&m_available, long(n));
+    #endif
+}
+
+//-----------------------------------------------------------------------------
+// thread_cache
+//-----------------------------------------------------------------------------
+
+template <class PointerType>
+void* fixed_size_object_pool<PointerType>::thread_cache
+::allocate()
+{
+    if (m_count == 0) {
+        size_t n = m_batch;
+        m_head   = m_pool.pop_chain(n);
+        m_count  = n;
+        if (!n)
+            return NULL;
     }
+
+    object_t* p = m_head;
+    m_head = --m_count ? next_object(p) : NULL;
+
+    #ifdef USE_PID_RECOVERY
+    p->freed = OBJ_ALLOCATED;
     #endif
+    return (void*)(++p);
+}
+
+template <class PointerType>
+void fixed_size_object_pool<PointerType>::thread_cache
+::free(void* object)
+{
+    if (object == NULL) return;
+
+    object_t* obj = static_cast<object_t*>(object) - 1;
+
+    BOOST_ASSERT(m_pool.m_begin <= reinterpret_cast<char*>(obj) &&
+                 reinterpret_cast<char*>(obj) < m_pool.m_end);
+
+    #ifdef USE_PID_RECOVERY
+    obj->freed = OBJ_CACHED;
+    obj->owner = get_pid();
+    #endif
+
+    obj->next = reinterpret_cast<char*>(m_head);
+    m_head    = obj;
+
+    if (++m_count >= 2*m_batch)
+        release(m_batch);
+}
+
+template <class PointerType>
+void fixed_size_object_pool<PointerType>::thread_cache
+::release(size_t n)
+{
+    BOOST_ASSERT(n > 0 && n <= m_count);
+
+    object_t* first = m_head;
+    object_t* last  = first;
+    for (size_t i = 1; i < n; ++i)
+        last = next_object(last);
+
+    m_count -= n;
+    m_head   = m_count ? next_object(last) : NULL;
+    m_pool.push_chain(first, last, n);
+}
+
+template <class PointerType>
+void fixed_size_object_pool<PointerType>::thread_cache
+::flush()
+{
+    if (m_count)
+        release(m_count);
 }
 
 #ifdef DEBUG
@@ -23,9 +23,12 @@
 /// can be used with standard STL containers. However, those
 /// containers would have to guarantee their own thread safety.
 ///
-/// FIXME: in current implementation the allocator is not cache 
-/// friendly as it doesn't have processor-specific heaps and 
-/// manages all memory in a single heap provided at construction.
+///   Free blocks are cached in per-thread magazines kept in the shared
+/// memory segment, so that the threads don't contend on the shared free
+/// lists on every allocation, and the blocks cached by a dead process can
+/// be reclaimed with pow2_allocator::reclaim_resources().  The magazine of
+/// a thread that exited without calling detach_thread() is taken over by
+/// another thread once all magazines are in use.
 //----------------------------------------------------------------------------
 // Created: 2010-07-10
 //----------------------------------------------------------------------------
@@ -60,6 +63,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <string.h>
 #include <errno.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdexcept>
 #include <string>
 #include <sstream>
@@ -67,6 +73,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <utxx/meta.hpp>
 #include <utxx/math.hpp>
 #include <utxx/atomic.hpp>
+#include <utxx/error.hpp>
+#include <utxx/compiler_hints.hpp>
 
 #ifdef ALLOC_TRACE
 #  include <iomanip>
@@ -125,6 +133,39 @@ private:
     bool            m_truncated;
 };
 
+namespace detail {
+    /// Identity of the calling thread used to tag ownership of allocator
+    /// magazines in shared memory.  The value is composed as
+    /// <tt>(pid << 32 | tid)</tt> and is refreshed in the child after fork().
+    struct pow2_thread_id {
+        static uint64_t get() {
+            static thread_local uint64_t s_id;
+            static thread_local long     s_gen = -1;
+            if (LIKELY(s_gen == generation()))
+                return s_id;
+            s_gen = generation();
+            s_id  = (uint64_t(::getpid()) << 32) | uint32_t(::syscall(SYS_gettid));
+            return s_id;
+        }
+
+        static pid_t pid(uint64_t id) { return pid_t(id >> 32); }
+        static pid_t tid(uint64_t id) { return pid_t(uint32_t(id)); }
+
+        /// False if the thread identified by \a id no longer exists
+        static bool alive(uint64_t id) {
+            return ::syscall(SYS_tgkill, pid(id), tid(id), 0) == 0 || errno != ESRCH;
+        }
+
+    private:
+        static void on_fork()   { ++generation(); }
+
+        static long& generation() {
+            static long s_gen = (::pthread_atfork(NULL, NULL, &on_fork), 0);
+            return s_gen;
+        }
+    };
+} // namespace detail
+
 /**
  * Simple concurrent allocator that manages memory
  * by allocating blocks of power of 2 size-classes.
@@ -134,18 +175,41 @@ private:
  * size block of the requested allocation.  Otherwise the block
  * of requested size is fetched from the free list.
  * The allocator is safe for concurrent use.
+ *
+ * Each size-class has a shared free list with a versioned head
+ * (32-bit offset + 32-bit version), which makes it immune to the ABA
+ * problem.  In front of the shared free lists each thread owns a
+ * "magazine" (located in shared memory) that caches up to
+ * 2*BatchSize free blocks per size-class.  Allocations and releases
+ * are served from the magazine without atomic operations, and blocks
+ * are moved between the magazine and the shared free list in chains of
+ * BatchSize nodes using a single CAS.  If all MaxMagazines magazines
+ * are taken, a magazine owned by a thread that no longer exists (e.g. it
+ * exited without calling detach_thread()) is drained to the shared free
+ * lists and taken over.  Otherwise the thread falls back to the shared
+ * free lists.
+ * Setting MaxMagazines to 0 disables thread caching.
  */
-template <int MinSize = 8, int MaxPow2Size = 32>
+template <
+      int MinSize      = 8
+    , int MaxPow2Size  = 32
+    , int BatchSize    = 32
+    , int MaxMagazines = 64
+>
 class pow2_allocator {
 public:
     static const unsigned int max_bucket = MaxPow2Size-1;
+    /// Number of nodes moved between a magazine and a shared free list at once
+    static const int batch_size    = BatchSize;
+    /// Max number of threads in all attached processes that can own a magazine
+    static const int max_magazines = MaxMagazines;
 
     typedef struct {
         int   next_free;
-        pid_t pid       : 16;  // Pid of the process that allocated this node
-        char  size_class: 8;
-        bool  allocated : 8;
-    } node;
+        pid_t pid;             // Pid of the process that allocated this node
+        char  size_class;
+        bool  allocated;
+    } __attribute__((aligned(8))) node;
 
 protected:
     // Max object size that allocator can allocate
@@ -154,54 +218,100 @@ protected:
     static const long min_size = MinSize;
     // Magic version number written in the beginning of base address
     enum { MAGIC = 0xFFDE1234 };
+    // Owner of a magazine of a dead thread while it's being drained
+    static const uint64_t RECLAIMING = ~0ul;
+
+    BOOST_STATIC_ASSERT(BatchSize > 0);
+
+    static node* to_node(char* base, int offset) {
+        return reinterpret_cast<node*>(base + offset);
+    }
 
-    // Stack used by each size-class specific free list
+    static int to_offset(char* base, const node* nd) {
+        return reinterpret_cast<const char*>(nd) - base;
+    }
+
+    // Stack used by each size-class specific free list.  Since the stack is
+    // located in shared memory mapped at different addresses by different
+    // processes, nodes are referenced by offsets from the allocator's base
+    // address passed to each call.  The head is a pair of the offset of the
+    // top node (lower 32 bits) and a version (upper 32 bits) incremented on
+    // every successful modification.
     class stack {
-        int   m_head;
-        char* m_base_addr;
+        volatile uint64_t m_head;
         #ifdef ALLOC_STATS
         int   m_push_count;
         #endif
+
+        static int      head_offset(uint64_t h)         { return int(h & 0xFFFFFFFF); }
+        static uint64_t new_head(uint64_t old, int off) {
+            return ((old >> 32) + 1) << 32 | uint32_t(off);
+        }
     public:
         stack() : m_head(0) {}
-        stack(void* addr) : m_base_addr((char*)addr), m_head(0) {}
 
-        void push(node* nd) {
-            BOOST_ASSERT((char*)nd >= m_base_addr);
-                // "Wrong address range (base: " << m_base_addr << ", addr: " << nd << ')');
-            nd->allocated = false;
-            long curr;
+        void push(char* base, node* nd) { push(base, nd, nd); }
+
+        /// Push a chain of nodes [first, last] linked through next_free.
+        void push(char* base, node* first, node* last) {
+            BOOST_ASSERT((char*)first > base && (char*)last > base);
+            int      off = to_offset(base, first);
+            uint64_t curr;
             do {
                 curr = m_head;
-                nd->next_free = curr;
-            } while (!atomic::cas(&m_head, curr, (char*)nd-m_base_addr));
+                last->next_free = head_offset(curr);
+            } while (!atomic::cas(&m_head, curr, new_head(curr, off)));
             #ifdef ALLOC_STATS
             atomic_add(m_push_count, 1);
             #endif
         }
 
-        node* pop() {
-            volatile int curr;
-            node* nd;
+        node* pop(char* base) {
+            int   n  = 1;
+            node* nd = pop(base, n);
+            if (nd) {
+                nd->allocated = true;
+                nd->next_free = 0;
+            }
+            return nd;
+        }
+
+        /// Pop a chain of up to \a n nodes using a single CAS.
+        /// The nodes remain linked through next_free (the link of the last
+        /// one is undefined).  On return \a n holds the number of nodes in
+        /// the chain.
+        node* pop(char* base, int& n) {
+            uint64_t curr;
+            node*    first;
+            int      next, cnt;
             do {
                 curr = m_head;
-                if (curr == 0)
+                int off = head_offset(curr);
+                if (off == 0) {
+                    n = 0;
                     return NULL;
-                nd = reinterpret_cast<node*>(m_base_addr + curr);
-            } while (!atomic::cas(&m_head, curr, nd->next_free));
-
-            nd->allocated = true;
-            nd->next_free = 0;
-            return nd;
+                }
+                // Nodes never leave the memory segment, so walking a chain
+                // that may be concurrently modified is safe - the versioned
+                // CAS below rejects the result if the list has changed.
+                first     = to_node(base, off);
+                node* nd  = first;
+                for (cnt = 1; cnt < n && nd->next_free; ++cnt)
+                    nd = to_node(base, nd->next_free);
+                next = nd->next_free;
+            } while (!atomic::cas(&m_head, curr, new_head(curr, next)));
+
+            n = cnt;
+            return first;
         }
 
         /// Returns number of items in the stack
-        int length() const {
+        int length(char* base) const {
             int len = 0;
-            int tmp = m_head;
+            int tmp = head_offset(m_head);
             while (tmp != 0) {
                 len++;
-                tmp = reinterpret_cast<node*>(m_base_addr + tmp)->next_free;
+                tmp = to_node(base, tmp)->next_free;
             }
             return len;
         }
@@ -211,11 +321,23 @@ protected:
         #endif
     };
 
+    // Per-thread cache of free nodes located in shared memory, so that
+    // the nodes cached by a dead process can be reclaimed.
+    struct magazine {
+        volatile uint64_t owner;   // (pid << 32 | tid) of the owner, 0 if unused,
+                                   // RECLAIMING while being drained
+        struct {
+            int head;              // Offset of the first cached node
+            int count;             // Number of cached nodes
+        } list[MaxPow2Size];
+    } __attribute__((aligned(UTXX_CL_SIZE)));
+
     struct header {
         const unsigned int magic;
-        stack  freelist[MaxPow2Size];
-        size_t total_size;
-        size_t offset;
+        stack    freelist[MaxPow2Size];
+        size_t   total_size;
+        size_t   offset;
+        magazine magazines[MaxMagazines > 0 ? MaxMagazines : 1];
 
         header() : magic(pow2_allocator::MAGIC), total_size(0), offset(0) {}
         header(size_t sz)
@@ -224,10 +346,24 @@ protected:
             , offset(sizeof(header))
         {
             for (int i=0; i < MaxPow2Size; ++i)
-                new (&freelist[i]) stack(this);
+                new (&freelist[i]) stack();
+            memset(magazines, 0, sizeof(magazines));
         }
     };
 
+    // Thread-local mapping of allocator headers to magazine indexes
+    struct thread_slot {
+        const header* hdr;
+        int           idx;       // -1 if no magazine is available
+    };
+
+    enum { THREAD_SLOTS = 4 };
+
+    static thread_slot* thread_slots() {
+        static thread_local thread_slot s_slots[THREAD_SLOTS];
+        return s_slots;
+    }
+
     pow2_allocator() {}
 
 private:
@@ -238,11 +374,21 @@ private:
     int             m_pool_hits;
     #endif
 
+    char*  base() const { return reinterpret_cast<char*>(m_header); }
+
     /// Allocate a chunk from the main memory pool given to allocator.
     /// @param <sz> size of a chunk to allocate
     /// @param <size_class> size-class for this chunk
     void* allocate_main_memory(size_t sz, size_t size_class);
 
+    /// Find the magazine owned by the calling thread or claim a new one.
+    /// @return NULL if all magazines are taken by live threads.
+    magazine* thread_magazine();
+    magazine* claim_magazine(uint64_t id, thread_slot& slot);
+
+    /// Move \a n nodes of \a size_class from magazine to the shared free list.
+    void drain(magazine& mag, int size_class, int n);
+
 public:
     /// Initialize shared memory allocator
     /// @param <total_mem_size> is the total memory managed by the allocator
@@ -260,10 +406,24 @@ public:
     void* allocate(size_t sz);
     void  release(void* p);
 
+    /// Return the magazine of the calling thread (if any) to the shared
+    /// free lists and release it.  Should be called by threads that
+    /// allocated from this allocator before they exit.  Otherwise the
+    /// blocks cached by the thread stay in its magazine until another
+    /// thread finds all magazines taken and takes it over.
+    void  detach_thread();
+
+    /// @return number of blocks in the shared free list of a given size-class
     int freelist_size(int bucket) {
-        return (bucket < MaxPow2Size) ? m_header->freelist[bucket].length() : -1;
+        return (bucket < MaxPow2Size) ? m_header->freelist[bucket].length(base()) : -1;
     }
 
+    /// @return number of blocks of a given size-class cached in magazines
+    int cached_size(int bucket) const;
+
+    /// @return number of magazines owned by threads
+    int magazines_in_use()      const;
+
     /// @return size of memory currently used or pooled
     size_t used_memory()        const { return m_header->offset - sizeof(header); }
     /// @return total memory managed by this allocator
@@ -281,16 +441,18 @@ public:
     static const size_t header_size() { return sizeof(header); }
 
     /// Beginning of addressable range managed by this allocator
-    const char* begin() const { return static_cast<const char*>(m_header) + sizeof(header); }
-    char*       begin()       { return static_cast<char*>(m_header)       + sizeof(header); }
+    const char* begin() const { return base() + sizeof(header); }
+    char*       begin()       { return base() + sizeof(header); }
     /// End of addressable range managed by this allocator
     const char* end()   const { return begin() + m_header->total_size; }
 
     /// Reclaim all allocated memory blocks owned by process <pid> by
-    /// marking them available and moving to the free list.  This method
-    /// can be used when implemening an inter-process memory manager, which
-    /// detects a death of a process which previously attached to the
-    /// shared memory using this allocator.
+    /// marking them available and moving to the free list.  Free blocks
+    /// cached in magazines of the threads of process <pid> are also
+    /// returned to the free lists.  This method can be used when
+    /// implemening an inter-process memory manager, which detects a death
+    /// of a process which previously attached to the shared memory using
+    /// this allocator.
     void reclaim_resources(pid_t pid);
 
     /// @return size of space overhead for each allocated chunk.
@@ -367,7 +529,7 @@ public:
 
     /// Ask allocator to release memory at pointer with size bytes.
     void deallocate(pointer p, size_type size = 0) {
-        struct BaseT::node* nd = BaseT::ptr_to_node(p);
+        typename BaseT::node* nd = BaseT::ptr_to_node(p);
         BOOST_ASSERT(size == 0 || size < (1 << nd->size_class));
             // "Invalid size of item (size=" << size << ", expected=" <<
             // nd->size_class << ")");
@@ -415,8 +577,17 @@ inline bool operator!= (const shmem_allocator<T,Policy>& a, const shmem_allocato
 //-----------------------------------------------------------------------------
 // IMPLEMENTATION
 //-----------------------------------------------------------------------------
-template <int MinSize, int MaxPow2Size>
-pow2_allocator<MinSize, MaxPow2Size>
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+const int pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>::batch_size;
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+const int pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>::max_magazines;
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+const uint64_t pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>::RECLAIMING;
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
 ::pow2_allocator(void* base_addr, size_t total_mem_size, bool initialize)
     : m_header(static_cast<header*>(base_addr))
     , m_pid_id(::getpid())
@@ -439,8 +610,8 @@ pow2_allocator<MinSize, MaxPow2Size>
             ", initialize=" << initialize << ')');
 }
 
-template <int MinSize, int MaxPow2Size>
-void* pow2_allocator<MinSize, MaxPow2Size>
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void* pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
 ::allocate_main_memory(size_t sz, size_t size_class)
 {
     size_t curr;
@@ -457,7 +628,7 @@ void* pow2_allocator<MinSize, MaxPow2Size>
     } while(!atomic::cas(&m_header->offset, curr, new_offset));
 
     node* p       = reinterpret_cast<node*>((char*)m_header + curr);
-    p->pid        = m_pid_id;
+    p->pid        = detail::pow2_thread_id::pid(detail::pow2_thread_id::get());
     p->size_class = size_class;
     p->allocated  = true;
     p->next_free  = 0;
@@ -469,8 +640,101 @@ void* pow2_allocator<MinSize, MaxPow2Size>
     return static_cast<void*>(++p);
 }
 
-template <int MinSize, int MaxPow2Size>
-void* pow2_allocator<MinSize, MaxPow2Size>
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+typename pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>::magazine*
+pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::thread_magazine()
+{
+    if (MaxMagazines == 0)
+        return NULL;
+
+    uint64_t     id    = detail::pow2_thread_id::get();
+    thread_slot* slots = thread_slots();
+
+    for (int i=0; i < THREAD_SLOTS; ++i) {
+        thread_slot& s = slots[i];
+        if (s.hdr != m_header)
+            continue;
+        if (s.idx < 0)
+            return NULL;
+        magazine* mag = &m_header->magazines[s.idx];
+        if (LIKELY(mag->owner == id))
+            return mag;
+        // The magazine was reclaimed or we are in a forked child
+        return claim_magazine(id, s);
+    }
+
+    // Use an empty slot or evict the last one.  The magazine of an evicted
+    // slot remains owned by this thread and is found again by claim_magazine()
+    thread_slot* s = &slots[THREAD_SLOTS-1];
+    for (int i=0; i < THREAD_SLOTS; ++i)
+        if (!slots[i].hdr) { s = &slots[i]; break; }
+
+    s->hdr = m_header;
+    return claim_magazine(id, *s);
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+typename pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>::magazine*
+pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::claim_magazine(uint64_t id, thread_slot& slot)
+{
+    // Look for a magazine already owned by this thread
+    for (int i=0; i < MaxMagazines; ++i)
+        if (m_header->magazines[i].owner == id) {
+            slot.idx = i;
+            return &m_header->magazines[i];
+        }
+
+    for (int i=0; i < MaxMagazines; ++i) {
+        magazine& mag = m_header->magazines[i];
+        if (mag.owner == 0 && atomic::cas(&mag.owner, 0ul, id)) {
+            slot.idx = i;
+            return &mag;
+        }
+    }
+
+    // Take over the magazine of a thread that exited without detaching
+    for (int i=0; i < MaxMagazines; ++i) {
+        magazine& mag   = m_header->magazines[i];
+        uint64_t  owner = mag.owner;
+        if (owner == 0 || owner == RECLAIMING ||
+            detail::pow2_thread_id::alive(owner) ||
+            !atomic::cas(&mag.owner, owner, id))
+            continue;
+        for (int j=0; j < MaxPow2Size; ++j) {
+            auto& l = mag.list[j];
+            if (l.count)
+                drain(mag, j, l.count);
+            l.head = 0;
+        }
+        slot.idx = i;
+        return &mag;
+    }
+
+    slot.idx = -1;
+    return NULL;
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::drain(magazine& mag, int size_class, int n)
+{
+    auto& l = mag.list[size_class];
+    BOOST_ASSERT(n > 0 && n <= l.count);
+
+    node* first = to_node(base(), l.head);
+    node* last  = first;
+    for (int i=1; i < n; ++i)
+        last = to_node(base(), last->next_free);
+
+    l.head   = last->next_free;
+    l.count -= n;
+    m_header->freelist[size_class].push(base(), first, last);
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void* pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
 ::allocate(size_t sz)
 {
     size_t alloc_sz = sz + sizeof(node);
@@ -482,11 +746,30 @@ void* pow2_allocator<MinSize, MaxPow2Size>
     if (size_class > max_bucket)
         return NULL;
 
-    node* nd = m_header->freelist[size_class].pop();
-    if (nd == NULL)
-        return allocate_main_memory(size, size_class);
+    node*     nd;
+    magazine* mag = thread_magazine();
+
+    if (mag) {
+        auto& l = mag->list[(int)size_class];
+        if (l.count == 0) {
+            int   n     = BatchSize;
+            node* chain = m_header->freelist[(int)size_class].pop(base(), n);
+            if (!chain)
+                return allocate_main_memory(size, size_class);
+            l.head  = to_offset(base(), chain);
+            l.count = n;
+        }
+        nd       = to_node(base(), l.head);
+        l.head   = --l.count ? nd->next_free : 0;
+        nd->allocated = true;
+        nd->next_free = 0;
+    } else {
+        nd = m_header->freelist[(int)size_class].pop(base());
+        if (nd == NULL)
+            return allocate_main_memory(size, size_class);
+    }
 
-    nd->pid = m_pid_id;
+    nd->pid = detail::pow2_thread_id::pid(detail::pow2_thread_id::get());
 
     #ifdef ALLOC_STATS
     atomic_add(m_pool_hits, 1);
@@ -494,13 +777,13 @@ void* pow2_allocator<MinSize, MaxPow2Size>
 
     TRACEIT("Allocated<" << m_pid_id << '>' << std::setw(9) 
             << size << '/' << sz << " bytes (offset="
-            << reinterpret_cast<int>(nd)-reinterpret_cast<int>(m_header)
+            << to_offset(base(), nd)
             << ", addr=" << (nd+1) << ") - from pool[" << (int)size_class << ']');
     return ++nd;
 }
 
-template <int MinSize, int MaxPow2Size>
-void pow2_allocator<MinSize, MaxPow2Size>
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
 ::release(void* p)
 {
     if (!p) return;
@@ -514,29 +797,116 @@ void pow2_allocator<MinSize, MaxPow2Size>
 
     TRACEIT("Released<" << m_pid_id << "> " << std::setw(9)
             << (1 << size_class) << " bytes to pool[" << (int)size_class
-            << "] (offset=" << reinterpret_cast<int>(nd)-reinterpret_cast<int>(m_header)
+            << "] (offset=" << to_offset(base(), nd)
             << ", addr=" << (nd+1) << ", old_pid=" << nd->pid << ')');
-    m_header->freelist[size_class].push(nd);
+
+    nd->allocated = false;
+
+    magazine* mag = thread_magazine();
+
+    if (!mag) {
+        m_header->freelist[(int)size_class].push(base(), nd);
+        return;
+    }
+
+    auto& l = mag->list[(int)size_class];
+    nd->next_free = l.head;
+    l.head        = to_offset(base(), nd);
+    if (++l.count >= 2*BatchSize)
+        drain(*mag, size_class, BatchSize);
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::detach_thread()
+{
+    if (MaxMagazines == 0)
+        return;
+
+    uint64_t     id    = detail::pow2_thread_id::get();
+    thread_slot* slots = thread_slots();
+
+    for (int i=0; i < THREAD_SLOTS; ++i)
+        if (slots[i].hdr == m_header)
+            slots[i].hdr = NULL;
+
+    for (int i=0; i < MaxMagazines; ++i) {
+        magazine& mag = m_header->magazines[i];
+        if (mag.owner != id)
+            continue;
+        for (int j=0; j < MaxPow2Size; ++j)
+            if (mag.list[j].count)
+                drain(mag, j, mag.list[j].count);
+        atomic::cas(&mag.owner, id, 0ul);
+    }
 }
 
-template <int MinSize, int MaxPow2Size>
-void pow2_allocator<MinSize, MaxPow2Size>
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+int pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::cached_size(int bucket) const
+{
+    if (bucket >= MaxPow2Size)
+        return -1;
+    int n = 0;
+    for (int i=0; i < MaxMagazines; ++i)
+        if (m_header->magazines[i].owner)
+            n += m_header->magazines[i].list[bucket].count;
+    return n;
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+int pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
+::magazines_in_use() const
+{
+    int n = 0;
+    for (int i=0; i < MaxMagazines; ++i)
+        if (m_header->magazines[i].owner)
+            ++n;
+    return n;
+}
+
+template <int MinSize, int MaxPow2Size, int BatchSize, int MaxMagazines>
+void pow2_allocator<MinSize, MaxPow2Size, BatchSize, MaxMagazines>
 ::reclaim_resources(pid_t pid) {
     // cannot reclaim own resources - we are still alive and may
     // have active references to allocated blocks
-    if (pid == m_pid_id)
+    if (pid == ::getpid())
         return;
 
-    char* p   = m_header->begin();
-    char* end = m_header->end();
+    // Return free blocks cached by the threads of the dead process.  A
+    // magazine is claimed before being drained, so that a concurrent
+    // takeover by claim_magazine() doesn't drain it a second time
+    for (int i=0; i < MaxMagazines; ++i) {
+        magazine& mag   = m_header->magazines[i];
+        uint64_t  owner = mag.owner;
+        if (owner == 0 || owner == RECLAIMING ||
+            detail::pow2_thread_id::pid(owner) != pid ||
+            !atomic::cas(&mag.owner, owner, RECLAIMING))
+            continue;
+        for (int j=0; j < MaxPow2Size; ++j) {
+            auto& l = mag.list[j];
+            if (l.count)
+                drain(mag, j, l.count);
+            l.head = 0;
+        }
+        atomic::cas(&mag.owner, RECLAIMING, 0ul);
+    }
+
+    char* p   = begin();
+    char* end = base() + m_header->offset;
 
     while (p < end) {
-        node* nd = static_cast<node*>(p);
-        if (nd->pid == pid && nd->allocated)
-            release(p+sizeof(node));
+        node* nd = reinterpret_cast<node*>(p);
+        // Stop at a block that is being carved out of the main memory
+        if (nd->size_class < int(log<min_size, 2>::value))
+            break;
+        if (nd->allocated && nd->pid == pid) {
+            nd->allocated = false;
+            m_header->freelist[(int)nd->size_class].push(base(), nd);
+        }
         p += (1 << nd->size_class);
     }
 }
 
 } // namespace memory
-} // namespace utxx
\ No newline at end of file
+} // namespace utxx
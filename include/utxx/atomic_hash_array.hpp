@@ -287,8 +287,28 @@ private:
     };
 
     template <class T>
-    simple_ret_t internal_insert(const KeyT& key, T&& value);
-    simple_ret_t internal_find  (const KeyT& key) const;
+    simple_ret_t internal_insert(const KeyT& key, T&& value) {
+        size_t probes;
+        return internal_insert(key, std::forward<T>(value), key_to_anchor_idx(key), probes);
+    }
+    simple_ret_t internal_find(const KeyT& key) const {
+        size_t probes;
+        return internal_find(key, key_to_anchor_idx(key), probes);
+    }
+
+    // Same as above starting at a precomputed anchor cell.  The number of
+    // collisions before the probe terminated is stored in probes.
+    template <class T>
+    simple_ret_t internal_insert(const KeyT& key, T&& value,
+                                 size_t anchor, size_t& probes);
+    simple_ret_t internal_find  (const KeyT& key,
+                                 size_t anchor, size_t& probes) const;
+
+    // Bring the cell at idx into cache ahead of probing it
+    void prefetch_cell(size_t idx, bool for_write) const {
+        if (for_write) __builtin_prefetch(&m_cells[idx], 1);
+        else           __builtin_prefetch(&m_cells[idx], 0);
+    }
 
     static std::atomic<KeyT>* cell_pkey(const value_type& r) {
         // We need some illegal casting here in order to actually store
@@ -60,17 +60,19 @@ atomic_hash_array(size_t capacity, const config& c) noexcept
  *
  *   Sets ret.second to value found and ret.index to index
  *   of key and returns true, or if key does not exist returns false and
- *   ret.index is set to m_capacity.
+ *   ret.index is set to m_capacity.  The probe starts at the anchor cell
+ *   of the key, and the number of collisions is returned in probes.
  */
 template <class KeyT, class ValueT, class HashFcn, class EqualFcn>
 typename atomic_hash_array<KeyT, ValueT, HashFcn, EqualFcn>::simple_ret_t
 atomic_hash_array<KeyT, ValueT, HashFcn, EqualFcn>::
-internal_find(const KeyT& key_in) const {
+internal_find(const KeyT& key_in, size_t anchor, size_t& probes) const {
     assert(!is_empty_eq(key_in));
     assert(!is_locked_eq(key_in));
     assert(!is_erased_eq(key_in));
-    for (size_t idx = key_to_anchor_idx(key_in), probes = 0;
-         ;      idx = probe_next(idx, probes))
+    assert(anchor == key_to_anchor_idx(key_in));
+    probes = 0;
+    for (size_t idx = anchor; ; idx = probe_next(idx, probes))
     {
         const KeyT key = load_key_acquire(m_cells[idx]);
         if (likely(is_key_eq(key, key_in)))
@@ -96,21 +98,22 @@ internal_find(const KeyT& key_in) const {
  *   ret.index = m_capacity.  Also sets ret.second to cell value, thus if insert
  *   successful this will be what we just inserted, if there is a key collision
  *   this will be the previously inserted value, and if the map is full it is
- *   default.
+ *   default.  The number of collisions is returned in numProbes.
  */
 template <class KeyT, class ValueT, class HashFcn, class EqualFcn>
 template <class T>
 typename atomic_hash_array<KeyT, ValueT, HashFcn, EqualFcn>::simple_ret_t
 atomic_hash_array<KeyT, ValueT, HashFcn, EqualFcn>::
-internal_insert(const KeyT& key_in, T&& value) {
+internal_insert(const KeyT& key_in, T&& value, size_t anchor, size_t& numProbes) {
     const short NO_NEW_INSERTS = 1;
     const short NO_PENDING_INSERTS = 2;
     assert(!is_empty_eq(key_in));
     assert(!is_locked_eq(key_in));
     assert(!is_erased_eq(key_in));
+    assert(anchor == key_to_anchor_idx(key_in));
 
-    size_t idx = key_to_anchor_idx(key_in);
-    size_t numProbes = 0;
+    size_t idx = anchor;
+    numProbes  = 0;
     for (;;) {
         assert(idx < m_capacity);
         value_type* cell = &m_cells[idx];
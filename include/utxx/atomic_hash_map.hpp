@@ -245,6 +245,33 @@ public:
     iterator       find(const key_type& k);
     const_iterator find(const key_type& k) const;
 
+    /// Find values associated with \a n keys
+    ///
+    /// Each key is hashed and its anchor cell in the primary sub map is
+    /// prefetched s_batch_size keys ahead of being probed, so that cache
+    /// misses of independent lookups overlap instead of being paid serially.
+    ///
+    /// @param keys   array of \a n keys to look up
+    /// @param out    receives an iterator (or end()) for each key
+    /// @param probes if not null, receives the number of cells examined for
+    ///               each key (1 if it was resolved at its anchor cell)
+    void find_batch(const key_type* keys, size_t n, iterator* out,
+                    uint32_t* probes = nullptr);
+    void find_batch(const key_type* keys, size_t n, const_iterator* out,
+                    uint32_t* probes = nullptr) const;
+
+    /// Insert \a n value pairs into the map
+    ///
+    /// Same as calling insert() for each record, with the anchor cells of
+    /// the records prefetched for writing ahead of time like find_batch().  If not
+    /// null, \a out and \a probes receive the insert() result and the
+    /// number of cells examined for each record.  If the map becomes full,
+    /// atomic_hash_map_full_error is thrown and the records past the failed
+    /// one are not inserted.
+    void insert_batch(const value_type* recs, size_t n,
+                      std::pair<iterator,bool>* out = nullptr,
+                      uint32_t* probes = nullptr);
+
     /// Erase a value associated with key from the map
     ///
     /// @return 1 if the key is found and erased, and 0 otherwise.
@@ -374,9 +401,28 @@ private:
         simple_ret_t() {}
     };
 
+    // Number of keys hashed and prefetched ahead by the batch functions
+    static const size_t    s_batch_size        = 16;
+
+    template <class T>
+    simple_ret_t internal_insert (const KeyT& k, T&& value) {
+        uint32_t probes;
+        return internal_insert(k, std::forward<T>(value),
+            m_submaps[0].load(std::memory_order_relaxed)->key_to_anchor_idx(k), probes);
+    }
+    simple_ret_t internal_find   (const KeyT& k) const {
+        uint32_t probes;
+        return internal_find(k,
+            m_submaps[0].load(std::memory_order_relaxed)->key_to_anchor_idx(k), probes);
+    }
+
+    // Same as above given the anchor cell of the key in the primary sub map.
+    // The number of cells examined in all sub maps is stored in probes.
     template <class T>
-    simple_ret_t internal_insert (const KeyT& k, T&& value);
-    simple_ret_t internal_find   (const KeyT& k) const;
+    simple_ret_t internal_insert (const KeyT& k, T&& value,
+                                  size_t anchor0, uint32_t& probes);
+    simple_ret_t internal_find   (const KeyT& k,
+                                  size_t anchor0, uint32_t& probes) const;
     simple_ret_t internal_find_at(uint32_t  idx) const;
 
     char_alloc              m_allocator;
@@ -43,6 +43,11 @@ template <class KeyT, class ValueT,
 const PSubMap atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
 s_locked_ptr = PSubMap(reinterpret_cast<SubMap*>(0x88ul << 48)); // invalid pointer
 
+template <class KeyT, class ValueT,
+          class HashFcn, class EqualFcn, class Alloc, class SubMap, class PSubMap>
+const size_t atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
+s_batch_size;
+
 // atomic_hash_map constructor -- Atomic wrapper that allows growth
 // This class has a lot of overhead (184 Bytes) so only use for big maps
 template <class KeyT, class ValueT,
@@ -96,7 +101,9 @@ template <class T>
 typename atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
 simple_ret_t
 atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
-internal_insert(const key_type& key, T&& value) {
+internal_insert(const key_type& key, T&& value, size_t anchor0, uint32_t& probes) {
+    size_t n;
+    probes = 0;
   beginInsertInternal:
     // this maintains our state
     int next_map_idx = m_alloc_num_maps.load(std::memory_order_acquire);
@@ -104,7 +111,9 @@ internal_insert(const key_type& key, T&& value) {
     for (int i=0; i < next_map_idx; ++i) {
         // insert in each map successively.  If one succeeds, we're done!
         auto map = m_submaps[i].load(std::memory_order_relaxed);
-        ret = map->internal_insert(key, std::forward<T>(value));
+        ret = map->internal_insert(key, std::forward<T>(value),
+                                   i ? map->key_to_anchor_idx(key) : anchor0, n);
+        probes += n + 1;
         if (ret.idx == map->m_capacity)
             continue;  //map is full, so try the next one
 
@@ -157,7 +166,8 @@ internal_insert(const key_type& key, T&& value) {
     PSubMap map = m_submaps[next_map_idx].load(std::memory_order_relaxed);
     assert(map);
     assert(map != s_locked_ptr);
-    ret = map->internal_insert(key, std::forward<T>(value));
+    ret = map->internal_insert(key, std::forward<T>(value), map->key_to_anchor_idx(key), n);
+    probes += n + 1;
     if (ret.idx != map->m_capacity)
         return simple_ret_t(next_map_idx, ret.idx, ret.success);
 
@@ -194,9 +204,11 @@ template <class KeyT, class ValueT,
 typename atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
 simple_ret_t
 atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
-internal_find(const KeyT& k) const {
+internal_find(const KeyT& k, size_t anchor0, uint32_t& probes) const {
+    size_t n;
     PSubMap const primaryMap = m_submaps[0].load(std::memory_order_relaxed);
-    typename SubMap::simple_ret_t ret = primaryMap->internal_find(k);
+    typename SubMap::simple_ret_t ret = primaryMap->internal_find(k, anchor0, n);
+    probes = n + 1;
     if (likely(ret.idx != primaryMap->m_capacity))
         return simple_ret_t(0, ret.idx, ret.success);
 
@@ -204,7 +216,8 @@ internal_find(const KeyT& k) const {
     for (int i=1; i < maps_count; ++i) {
         // Check each map successively.  If one succeeds, we're done!
         PSubMap const map = m_submaps[i].load(std::memory_order_relaxed);
-        ret = map->internal_find(k);
+        ret = map->internal_find(k, map->key_to_anchor_idx(k), n);
+        probes += n + 1;
         if (likely(ret.idx != map->m_capacity))
             return simple_ret_t(i, ret.idx, ret.success);
     }
@@ -212,6 +225,78 @@ internal_find(const KeyT& k) const {
     return simple_ret_t(maps_count, 0, false);
 }
 
+// find_batch -- keys are hashed and their anchor cells prefetched
+// s_batch_size positions ahead of the key being probed
+template <class KeyT, class ValueT,
+          class HashFcn, class EqualFcn, class Alloc, class SubMap, class PSubMap>
+void atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
+find_batch(const KeyT* keys, size_t n, iterator* out, uint32_t* probes) {
+    PSubMap const primaryMap = m_submaps[0].load(std::memory_order_relaxed);
+    size_t anchors[s_batch_size];
+    size_t ahead = std::min(s_batch_size, n);
+    for (size_t i=0; i < ahead; ++i) {
+        anchors[i] = primaryMap->key_to_anchor_idx(keys[i]);
+        primaryMap->prefetch_cell(anchors[i], false);
+    }
+    for (size_t i=0; i < n; ++i) {
+        size_t&      anchor = anchors[i % s_batch_size];
+        uint32_t     cells;
+        simple_ret_t ret = internal_find(keys[i], anchor, cells);
+        out[i] = ret.success
+               ? iterator(this, ret.i,
+                          m_submaps[ret.i].load(std::memory_order_relaxed)->make_iter(ret.j))
+               : end();
+        if (probes) probes[i] = cells;
+        if (i + s_batch_size < n) {
+            anchor = primaryMap->key_to_anchor_idx(keys[i + s_batch_size]);
+            primaryMap->prefetch_cell(anchor, false);
+        }
+    }
+}
+
+template <class KeyT, class ValueT,
+          class HashFcn, class EqualFcn, class Alloc, class SubMap, class PSubMap>
+void atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
+find_batch(const KeyT* keys, size_t n, const_iterator* out, uint32_t* probes) const {
+    iterator its[s_batch_size];
+    for (size_t i=0; i < n; i += s_batch_size) {
+        size_t cnt = std::min(s_batch_size, n - i);
+        const_cast<atomic_hash_map*>(this)->find_batch
+            (keys + i, cnt, its, probes ? probes + i : nullptr);
+        std::copy(its, its + cnt, out + i);
+    }
+}
+
+// insert_batch -- same as find_batch() with anchor cells prefetched for writing
+template <class KeyT, class ValueT,
+          class HashFcn, class EqualFcn, class Alloc, class SubMap, class PSubMap>
+void atomic_hash_map<KeyT, ValueT, HashFcn, EqualFcn, Alloc, SubMap, PSubMap>::
+insert_batch(const value_type* recs, size_t n, std::pair<iterator,bool>* out,
+             uint32_t* probes) {
+    PSubMap const primaryMap = m_submaps[0].load(std::memory_order_relaxed);
+    size_t anchors[s_batch_size];
+    size_t ahead = std::min(s_batch_size, n);
+    for (size_t i=0; i < ahead; ++i) {
+        anchors[i] = primaryMap->key_to_anchor_idx(recs[i].first);
+        primaryMap->prefetch_cell(anchors[i], true);
+    }
+    for (size_t i=0; i < n; ++i) {
+        size_t&      anchor = anchors[i % s_batch_size];
+        uint32_t     cells;
+        simple_ret_t ret = internal_insert(recs[i].first, recs[i].second, anchor, cells);
+        if (out) {
+            auto map = m_submaps[ret.i].load(std::memory_order_relaxed);
+            out[i] = std::make_pair(iterator(this, ret.i, map->make_iter(ret.j)),
+                                    ret.success);
+        }
+        if (probes) probes[i] = cells;
+        if (i + s_batch_size < n) {
+            anchor = primaryMap->key_to_anchor_idx(recs[i + s_batch_size].first);
+            primaryMap->prefetch_cell(anchor, true);
+        }
+    }
+}
+
 // internal_find_at -- see encode_idx() for details.
 template <class KeyT, class ValueT,
           class HashFcn, class EqualFcn, class Alloc, class SubMap, class PSubMap>
@@ -3,6 +3,11 @@
 /// \author Serge Aleynikov
 //----------------------------------------------------------------------------
 /// \brief  Functions for base64 encoding/decoding
+///
+/// Encoding and decoding of large buffers is vectorized with AVX2 or SSSE3
+/// (when enabled at compile time) using the approach of W. Mula and
+/// D. Lemire ("Faster Base64 Encoding and Decoding using AVX2
+/// Instructions"), with a table-driven scalar fallback.
 //----------------------------------------------------------------------------
 // Copyright (c) 2018 Serge Aleynikov <saleyn@gmail.com>
 // Created: 2018-04-10
@@ -39,13 +44,17 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/algorithm/string.hpp>
 */
 #include <string>
-#include <sstream>
-#include <cmath>
 #include <boost/utility.hpp>
-#include <boost/tuple/tuple.hpp>
 #include <boost/cstdint.hpp>
 #include <vector>
-#include <utxx/print.hpp>
+#include <string.h>
+#include <utxx/compiler_hints.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
 
 //-----------------------------------------------------------------------------
 // Base64
@@ -83,94 +92,69 @@ inline std::string encode_base64(const std::string& str) {
 class base64 : public boost::noncopyable {
 public:
     enum encoding { STANDARD, URL };
-  
+
+    /// Validation of decoded input
+    enum validation {
+        STRICT,     ///< Only alphabet characters with optional trailing '='
+                    ///< padding, and zero unused bits in the last character
+        RELAXED     ///< Skip characters outside of the alphabet (e.g. line
+                    ///< breaks) and stop at the first '='
+    };
+
+    /// Size of the base64 encoding of \a a_len bytes
+    static constexpr size_t encoded_size(size_t a_len, bool eq_trail = true) {
+        return eq_trail ? (a_len + 2) / 3 * 4 : (a_len * 4 + 2) / 3;
+    }
+
+    /// Size of the buffer sufficient for decoding \a a_len characters
+    static constexpr size_t decoded_size(size_t a_len) {
+        return (a_len + 3) / 4 * 3;
+    }
+
     static std::string encode(
         const std::string& s, encoding enc = STANDARD, bool eq_trail = true)
     {
         return encode(
             reinterpret_cast<const uint8_t*>(s.c_str()), s.size(), enc, eq_trail);
     }
-  
+
     static std::string encode(
         const uint8_t* s, unsigned int size, encoding enc = STANDARD, bool eq_trail = true)
     {
-        buffered_print os;
-        os.reserve(((4 * size / 3) + 3) & ~3);
-  
-        for (uint i=0; i < size;) {
-            auto c1 = s[i++] & 0xff;
-            if (i == size) {
-                os << enctable(enc)[c1 >> 2] << enctable(enc)[(c1 & 0x3) << 4];
-                if (eq_trail) os << "==";
-                break;
-            }
-            auto c2 = s[i++];
-            if (i == size) {
-                os << enctable(enc)[  c1 >> 2]
-                   << enctable(enc)[((c1 & 0x3) << 4)|((c2 & 0xf0) >> 4)]
-                   << enctable(enc)[ (c2 & 0xf) << 2];
-                if (eq_trail) os << '=';
-                break;
-            }
-            auto c3 = s[i++];
-            os << enctable(enc)[  c1 >> 2]
-               << enctable(enc)[((c1 & 0x3) << 4) | ((c2 & 0xf0) >> 4)]
-               << enctable(enc)[((c2 & 0xf) << 2) | ((c3 & 0xc0) >> 6)]
-               << enctable(enc)[  c3 & 0x3f];
-        }
-        return os.to_string();
+        std::string res(encoded_size(size, eq_trail), '\0');
+        encode_to(&res[0], s, size, enc, eq_trail);
+        return res;
     }
-  
+
+    /// Encode \a a_len bytes of \a a_src into \a a_dst
+    /// @param a_dst buffer of at least encoded_size(a_len, eq_trail) bytes
+    /// @return number of characters written
+    static size_t encode_to(char* a_dst, const void* a_src, size_t a_len,
+                            encoding enc = STANDARD, bool eq_trail = true);
+
+    /// Decode \a a_len characters of \a a_src into \a a_dst
+    /// @param a_dst buffer of at least decoded_size(a_len) bytes
+    /// @return number of bytes written or -1 if the input is not valid
+    static long decode_to(void* a_dst, const char* a_src, size_t a_len,
+                          encoding enc = STANDARD, validation mode = STRICT);
+
     static std::vector<char> decode(const std::string& s, encoding enc = STANDARD) {
         std::vector<char> dest;
         decode(s, dest, enc);
         return dest;
     }
-  
-    /// Decode base64 string into "dest"
+
+    /// Decode base64 string into "dest" skipping characters outside of the
+    /// alphabet
     /// @param dest can be an STL container or string
     template <typename T>
     static void decode(const std::string& s, T& dest, encoding enc = STANDARD) {
-        auto size = s.size();
-        auto dest_sz = static_cast<float>(size * 3) / 4;
-    
-        dest.clear();
-        dest.reserve(static_cast<unsigned int>(std::ceil(dest_sz)));
-    
-        for (uint i=0; i < size;) {
-            char c1;
-            do {c1 = dectable(enc)[s[i++] & 0xff];} while (i < size && c1 == -1);
-            if (c1 == -1) break;
-      
-            char c2;
-            do {c2 = dectable(enc)[s[i++] & 0xff];} while (i < size && c2 == -1);
-            if (c2 == -1) break;
-      
-            dest.push_back(static_cast<uint8_t>(((c1 << 2)|((c2 & 0x30) >> 4)) & 0xff));
-      
-            char c3;
-            do {
-                c3 = s[i++] & 0xff;
-                if (c3 == 61) return;
-                c3 = dectable(enc)[int(c3)];
-            } while (i < size && c3 == -1);
-      
-            if (c3 == -1) break;
-      
-            dest.push_back(static_cast<uint8_t>((((c2 & 0xf) << 4)|((c3 & 0x3c) >> 2)) & 0xff));
-      
-            char c4;
-            do {
-                c4 = s[i++] & 0xff;
-                if (c4 == 61) return;
-                c4 = dectable(enc)[int(c4)];
-            } while (i < size && c4 == -1);
-            if (c4 == -1) break;
-      
-            dest.push_back(static_cast<uint8_t>((((c3 & 0x03) << 6)| c4) & 0xff));
-        }
+        dest.resize(decoded_size(s.size()));
+        auto n = dest.empty() ? 0
+               : decode_to(&dest[0], s.c_str(), s.size(), enc, RELAXED);
+        dest.resize(n);
     }
-  
+
 private:
     static const char* enctable(encoding enc) {
         static const char s_enctable[][65] =  {
@@ -179,34 +163,282 @@ private:
         };
         return s_enctable[enc];
     };
-  
-    static const char* dectable(encoding enc) {
-        static const char s_dectable[][128] = {
+
+    /// Character values (0..63), or 0xFF for characters not in the alphabet
+    static const uint8_t* dectable(encoding enc) {
+        struct tables {
+            uint8_t t[2][256];
+            tables() {
+                memset(t, 0xFF, sizeof(t));
+                for (int e = STANDARD; e <= URL; ++e)
+                    for (int i=0; i < 64; ++i)
+                        t[e][uint8_t(enctable(encoding(e))[i])] = i;
+            }
+        };
+        static const tables s_tables;
+        return s_tables.t[enc];
+    }
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    /// Vector lookup tables of an alphabet (see decode_to() for details)
+    struct simd_tables {
+        int8_t enc_shift[16];   // Offset of a character by its range index
+        int8_t dec_lo[16];      // Invalid class bits by the lower nibble
+        int8_t dec_hi[16];      // Invalid class bits by the higher nibble
+        int8_t dec_roll[16];    // Offset of a value by the higher nibble
+        char   dec_special;     // Character sharing the higher nibble with
+        int8_t dec_special_add; // others, and its adjustment of the index
+    };
+
+    static const simd_tables& simd(encoding enc) {
+        static const simd_tables s_tables[] = {
             // STD
             {
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
-                52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
-                -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-                15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
-                -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-                41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+                {'a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+                 '0'-52, '0'-52, '0'-52, '+'-62, '/'-63, 'A',    0,      0     },
+                {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A},
+                {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+                {0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0},
+                '/', -1
             },
             // URL
             {
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-                -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
-                52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
-                -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-                15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
-                -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-                41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+                {'a'-26, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52, '0'-52,
+                 '0'-52, '0'-52, '0'-52, '-'-62, '_'-63, 'A',    0,      0     },
+                {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                 0x11, 0x11, 0x13, 0x3B, 0x3B, 0x3A, 0x3B, 0x33},
+                {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x20,
+                 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+                {0, 0, 17, 4, -65, -65, -71, -71, -32, 0, 0, 0, 0, 0, 0, 0},
+                '_', 3
             }
         };
-        return s_dectable[enc];
+        return s_tables[enc];
     }
+#endif
 };
 
+//------------------------------------------------------------------------------
+// Implementation
+//------------------------------------------------------------------------------
+inline size_t base64::encode_to(char* a_dst, const void* a_src, size_t a_len,
+                                encoding enc, bool eq_trail)
+{
+    auto  p = static_cast<const uint8_t*>(a_src);
+    auto  e = p + a_len;
+    char* o = a_dst;
+
+    // Each 12 input bytes are spread into 16 bytes holding 6-bit indices,
+    // which are turned into characters by adding an offset looked up by
+    // the range of the index: 0..25 'A'-'Z', 26..51 'a'-'z', 52..61
+    // '0'-'9', 62, 63.
+#if defined(__AVX2__)
+    {
+        auto& t     = simd(enc);
+        auto  shift = _mm256_broadcastsi128_si256
+                        (_mm_loadu_si128((const __m128i*)t.enc_shift));
+        auto  shuf  = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                                       1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        for (; e - p >= 28; p += 24, o += 32) {
+            auto in = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)),
+                _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+            in      = _mm256_shuffle_epi8(in, shuf);
+            auto t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+            auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+            auto t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+            auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+            auto ix = _mm256_or_si256(t1, t3);
+            auto r  = _mm256_subs_epu8(ix, _mm256_set1_epi8(51));
+            auto lt = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), ix);
+            r       = _mm256_or_si256(r, _mm256_and_si256(lt, _mm256_set1_epi8(13)));
+            r       = _mm256_add_epi8(_mm256_shuffle_epi8(shift, r), ix);
+            _mm256_storeu_si256((__m256i*)o, r);
+        }
+    }
+#endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+    {
+        auto& t     = simd(enc);
+        auto  shift = _mm_loadu_si128((const __m128i*)t.enc_shift);
+        auto  shuf  = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+        for (; e - p >= 16; p += 12, o += 16) {
+            auto in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)p), shuf);
+            auto t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            auto t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            auto ix = _mm_or_si128(t1, t3);
+            auto r  = _mm_subs_epu8(ix, _mm_set1_epi8(51));
+            auto lt = _mm_cmpgt_epi8(_mm_set1_epi8(26), ix);
+            r       = _mm_or_si128(r, _mm_and_si128(lt, _mm_set1_epi8(13)));
+            r       = _mm_add_epi8(_mm_shuffle_epi8(shift, r), ix);
+            _mm_storeu_si128((__m128i*)o, r);
+        }
+    }
+#endif
+
+    auto tab = enctable(enc);
+
+    for (; e - p >= 3; p += 3) {
+        uint32_t v = uint32_t(p[0]) << 16 | uint32_t(p[1]) << 8 | p[2];
+        *o++ = tab[ v >> 18      ];
+        *o++ = tab[(v >> 12) & 63];
+        *o++ = tab[(v >>  6) & 63];
+        *o++ = tab[ v        & 63];
+    }
+
+    if (p != e) {
+        uint32_t v = uint32_t(p[0]) << 16 | (e - p == 2 ? uint32_t(p[1]) << 8 : 0);
+        *o++ = tab[ v >> 18      ];
+        *o++ = tab[(v >> 12) & 63];
+        if (e - p == 2)
+            *o++ = tab[(v >> 6) & 63];
+        else if (eq_trail)
+            *o++ = '=';
+        if (eq_trail)
+            *o++ = '=';
+    }
+
+    return o - a_dst;
+}
+
+inline long base64::decode_to(void* a_dst, const char* a_src, size_t a_len,
+                              encoding enc, validation mode)
+{
+    auto     p   = a_src;
+    auto     e   = a_src + a_len;
+    auto     o   = static_cast<uint8_t*>(a_dst);
+    auto     tab = dectable(enc);
+    uint32_t acc = 0;   // Bits of a partial quantum of 4 characters
+    int      n   = 0;   // Number of characters in the partial quantum
+
+    if (mode == STRICT) {
+        int pad = a_len && e[-1] == '=' ? (a_len > 1 && e[-2] == '=' ? 2 : 1) : 0;
+        if (pad && (a_len & 3))
+            return -1;
+        e -= pad;
+        if (((e - p) & 3) == 1)
+            return -1;
+    }
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+    // A vector of characters is validated by classifying each character by
+    // its lower and higher nibbles: the class bits of the two nibbles have
+    // no common bit only for characters of the alphabet. Values are then
+    // found by adding an offset looked up by the higher nibble (adjusted
+    // for the character sharing its nibble with another range), and 6-bit
+    // values are packed into 3-byte groups by multiply-add instructions.
+    // Each block stores a full vector, but only when the remaining input
+    // guarantees that the buffer of decoded_size(a_len) has room for it.
+    auto& t = simd(enc);
+  #if defined(__AVX2__)
+    auto lo_lut2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t.dec_lo));
+    auto hi_lut2 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t.dec_hi));
+    auto roll2   = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t.dec_roll));
+    auto decode32 = [&](const char* a_in, uint8_t* a_out) {
+        auto in  = _mm256_loadu_si256((const __m256i*)a_in);
+        auto hin = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        auto lon = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        auto bad = _mm256_and_si256(_mm256_shuffle_epi8(lo_lut2, lon),
+                                    _mm256_shuffle_epi8(hi_lut2, hin));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(bad, _mm256_setzero_si256())))
+            return false;
+        auto sp  = _mm256_and_si256(_mm256_cmpeq_epi8(in, _mm256_set1_epi8(t.dec_special)),
+                                    _mm256_set1_epi8(t.dec_special_add));
+        auto v   = _mm256_add_epi8(in, _mm256_shuffle_epi8(roll2, _mm256_add_epi8(hin, sp)));
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+        _mm256_storeu_si256((__m256i*)a_out, v);
+        return true;
+    };
+  #endif
+    auto lo_lut = _mm_loadu_si128((const __m128i*)t.dec_lo);
+    auto hi_lut = _mm_loadu_si128((const __m128i*)t.dec_hi);
+    auto roll   = _mm_loadu_si128((const __m128i*)t.dec_roll);
+    auto decode16 = [&](const char* a_in, uint8_t* a_out) {
+        auto in  = _mm_loadu_si128((const __m128i*)a_in);
+        auto hin = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+        auto lon = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+        auto bad = _mm_and_si128(_mm_shuffle_epi8(lo_lut, lon),
+                                 _mm_shuffle_epi8(hi_lut, hin));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(bad, _mm_setzero_si128())))
+            return false;
+        auto sp  = _mm_and_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8(t.dec_special)),
+                                 _mm_set1_epi8(t.dec_special_add));
+        auto v   = _mm_add_epi8(in, _mm_shuffle_epi8(roll, _mm_add_epi8(hin, sp)));
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, _mm_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*)a_out, v);
+        return true;
+    };
+#endif
+
+    while (true) {
+        if (n == 0) {
+#if defined(__AVX2__)
+            while (e - p >= 44 && decode32(p, o)) { p += 32; o += 24; }
+#endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+            while (e - p >= 24 && decode16(p, o)) { p += 16; o += 12; }
+#endif
+            for (; e - p >= 4; p += 4, o += 3) {
+                uint32_t a = tab[uint8_t(p[0])], b = tab[uint8_t(p[1])],
+                         c = tab[uint8_t(p[2])], d = tab[uint8_t(p[3])];
+                if ((a | b | c | d) & 0x80)
+                    break;
+                uint32_t v = a << 18 | b << 12 | c << 6 | d;
+                o[0] = uint8_t(v >> 16);
+                o[1] = uint8_t(v >>  8);
+                o[2] = uint8_t(v);
+            }
+        }
+        if (p == e)
+            break;
+
+        // Slow path: a character outside of the alphabet or a partial quantum
+        auto v = tab[uint8_t(*p++)];
+        if (unlikely(v & 0x80)) {
+            if (mode == STRICT)
+                return -1;
+            if (p[-1] == '=')
+                break;
+            continue;
+        }
+        acc = acc << 6 | v;
+        if (++n == 4) {
+            *o++ = uint8_t(acc >> 16);
+            *o++ = uint8_t(acc >>  8);
+            *o++ = uint8_t(acc);
+            acc  = n = 0;
+        }
+    }
+
+    switch (n) {
+        case 2:
+            if (mode == STRICT && (acc & 0xf))
+                return -1;
+            *o++ = uint8_t(acc >> 4);
+            break;
+        case 3:
+            if (mode == STRICT && (acc & 0x3))
+                return -1;
+            *o++ = uint8_t(acc >> 10);
+            *o++ = uint8_t(acc >>  2);
+            break;
+        default:
+            break;
+    }
+
+    return o - static_cast<uint8_t*>(a_dst);
+}
+
 } // namespace utxx
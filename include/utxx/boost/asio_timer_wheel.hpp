@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------
+/// \file   asio_timer_wheel.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Timer wheel driven by boost::asio::io_service.
+///
+/// A single steady_timer is armed for the next expiration of the wheel,
+/// so that a large number of timers costs one asio timer instead of one
+/// per timer. All calls must be made from the thread running the
+/// io_service (or its strand).
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/timer_wheel.hpp>
+#include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <functional>
+
+namespace utxx {
+
+template <class Data = uint64_t>
+class asio_timer_wheel {
+public:
+    typedef basic_timer_wheel<Data, nsec_clock>     wheel_type;
+    typedef typename wheel_type::timer_id           timer_id;
+    typedef std::function<void (timer_id, Data&)>   handler_type;
+
+    /// @param a_handler  called for every expired timer
+    /// @param a_resolution tick of the wheel
+    /// @param a_reserve  number of timers to preallocate
+    asio_timer_wheel(boost::asio::io_service& a_io, const handler_type& a_handler,
+                     time_val a_resolution, size_t a_reserve = 0)
+        : m_timer(a_io), m_wheel(a_resolution, a_reserve)
+        , m_handler(a_handler), m_armed(LONG_MAX)
+    {}
+
+    ~asio_timer_wheel() { m_timer.cancel(); }
+
+    timer_id schedule_after(time_val a_delay, const Data& a_data = Data()) {
+        auto id = m_wheel.schedule_after(a_delay, a_data);
+        arm();
+        return id;
+    }
+
+    timer_id schedule_at(long a_time, const Data& a_data = Data()) {
+        auto id = m_wheel.schedule_at(a_time, a_data);
+        arm();
+        return id;
+    }
+
+    /// Cancel a timer (the asio timer is left armed, and wakes up idle)
+    bool cancel(timer_id a_id) { return m_wheel.cancel(a_id); }
+
+    size_t            size()  const { return m_wheel.size(); }
+    wheel_type&       wheel()       { return m_wheel;        }
+    const wheel_type& wheel() const { return m_wheel;        }
+
+private:
+    boost::asio::steady_timer m_timer;
+    wheel_type                m_wheel;
+    handler_type              m_handler;
+    long                      m_armed;  // Wheel time the asio timer is set to
+
+    /// Set the asio timer if the wheel's next expiration is earlier
+    void arm() {
+        long next = m_wheel.next_expiration();
+        if (next >= m_armed)
+            return;
+        m_armed = next;
+        long delay = std::max(0L, next - nsec_clock::now());
+        m_timer.expires_from_now(std::chrono::nanoseconds(delay));
+        m_timer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec == boost::asio::error::operation_aborted)
+                return;
+            m_armed = LONG_MAX;
+            m_wheel.expire(m_handler);
+            arm();
+        });
+    }
+};
+
+} // namespace utxx
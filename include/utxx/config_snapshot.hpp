@@ -0,0 +1,347 @@
+//----------------------------------------------------------------------------
+/// \file   config_snapshot.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Immutable flat snapshot of a variant_tree for hot-path lookups.
+///
+/// A config_publisher compiles a (validated) variant_tree into a
+/// config_snapshot: every node holding a value is stored as a typed entry
+/// in a contiguous array, with all strings (paths and string values) in
+/// a single character arena. Paths are interned into keys whose ids are
+/// stable across reloads, so a key obtained once can be used for O(1)
+/// lookups in any later snapshot:
+/// \code
+///     config_publisher pub;
+///     auto qty = pub.key("strategy.max-qty");
+///     pub.publish(tree);                  // Also on every config reload
+///
+///     config_reader cfg(pub);             // One per thread
+///     on_event() {
+///         long max_qty = cfg->get<long>(qty);
+///         ...
+///     }
+/// \endcode
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#pragma once
+
+#include <utxx/variant_tree.hpp>
+#include <utxx/variant_tree_error.hpp>
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <string.h>
+
+namespace utxx {
+
+class config_publisher;
+
+//----------------------------------------------------------------------------
+/// Interned configuration path
+//----------------------------------------------------------------------------
+class config_key {
+    uint32_t m_id;
+
+    friend class config_publisher;
+    friend class config_snapshot;
+    explicit config_key(uint32_t a_id) : m_id(a_id) {}
+public:
+    config_key() : m_id(~0u) {}
+
+    uint32_t id()    const { return m_id;        }
+    bool     valid() const { return m_id != ~0u; }
+};
+
+//----------------------------------------------------------------------------
+/// Immutable flat configuration snapshot
+//----------------------------------------------------------------------------
+class config_snapshot : boost::noncopyable {
+    struct entry {
+        variant::value_type type;
+        uint32_t            path;       // Offset of the path in the arena
+        union {
+            bool            b;
+            long            i;
+            double          d;
+            struct {
+                uint32_t    off;        // Offset of the string in the arena
+                uint32_t    len;
+            } s;
+        };
+    };
+
+    std::vector<entry>      m_entries;  // Indexed by config_key::id()
+    std::vector<uint32_t>   m_index;    // Key ids sorted by path
+    std::vector<char>       m_arena;
+    uint64_t                m_generation;
+
+    friend class config_publisher;
+
+    config_snapshot() : m_generation(0) {}
+
+    const char* str(uint32_t a_off) const { return &m_arena[a_off]; }
+
+    uint32_t add_str(const std::string& a_str) {
+        uint32_t off = m_arena.size();
+        m_arena.insert(m_arena.end(), a_str.c_str(), a_str.c_str() + a_str.size() + 1);
+        return off;
+    }
+
+    const entry& at(config_key a_key) const {
+        if (!has(a_key))
+            throw variant_tree_error(std::string(), "Path not found (key #",
+                                     a_key.id(), ')');
+        return m_entries[a_key.id()];
+    }
+
+    [[noreturn]] void throw_bad_type(const entry& e, const char* a_type) const {
+        static const char* s_types[] = { "null", "bool", "int", "double", "string" };
+        throw variant_tree_error(std::string(str(e.path)), "Cannot convert value of type ",
+                                 s_types[e.type], " to ", a_type);
+    }
+
+    // Typed accessors dispatched on the requested type
+    bool get(const entry& e, bool*) const {
+        if (e.type != variant::TYPE_BOOL) throw_bad_type(e, "bool");
+        return e.b;
+    }
+    double get(const entry& e, double*) const {
+        if (e.type == variant::TYPE_DOUBLE) return e.d;
+        if (e.type == variant::TYPE_INT)    return double(e.i);
+        throw_bad_type(e, "double");
+    }
+    const char* get(const entry& e, const char**) const {
+        if (e.type != variant::TYPE_STRING) throw_bad_type(e, "string");
+        return str(e.s.off);
+    }
+    std::string get(const entry& e, std::string*) const {
+        if (e.type != variant::TYPE_STRING) throw_bad_type(e, "string");
+        return std::string(str(e.s.off), e.s.len);
+    }
+    template <class T>
+    typename std::enable_if<std::is_integral<T>::value, T>::type
+    get(const entry& e, T*) const {
+        if (e.type != variant::TYPE_INT) throw_bad_type(e, "int");
+        return T(e.i);
+    }
+public:
+    /// Version of the snapshot incremented on every publish
+    uint64_t generation() const { return m_generation; }
+
+    /// Number of values in the snapshot
+    size_t   size()       const { return m_index.size(); }
+
+    /// True if the snapshot has a value for \a a_key
+    bool has(config_key a_key) const {
+        return a_key.id() < m_entries.size() &&
+               m_entries[a_key.id()].type != variant::TYPE_NULL;
+    }
+
+    /// Get the value of \a a_key (O(1)). Supported types are bool,
+    /// integral types, double, const char* and std::string.
+    /// Throws variant_tree_error if the value is missing or has a
+    /// different type.
+    template <class T>
+    T get(config_key a_key) const { return get(at(a_key), (T*)nullptr); }
+
+    /// Get the value of \a a_key or \a a_default if it's missing
+    template <class T>
+    T get(config_key a_key, const T& a_default) const {
+        return has(a_key) ? get(m_entries[a_key.id()], (T*)nullptr) : a_default;
+    }
+
+    /// Find the key of \a a_path in this snapshot using binary search
+    /// (meant for non-critical lookups; prefer config_publisher::key())
+    config_key find(const char* a_path) const {
+        auto it = std::lower_bound(m_index.begin(), m_index.end(), a_path,
+            [this](uint32_t id, const char* p) {
+                return strcmp(str(m_entries[id].path), p) < 0;
+            });
+        return it != m_index.end() && strcmp(str(m_entries[*it].path), a_path) == 0
+             ? config_key(*it) : config_key();
+    }
+
+    /// Path of the value identified by \a a_key
+    const char* path(config_key a_key) const {
+        return has(a_key) ? str(m_entries[a_key.id()].path) : "";
+    }
+
+    /// Convert the value of \a a_key back to variant
+    variant to_variant(config_key a_key) const {
+        if (!has(a_key)) return variant();
+        auto& e = m_entries[a_key.id()];
+        switch (e.type) {
+            case variant::TYPE_BOOL:   return variant(e.b);
+            case variant::TYPE_INT:    return variant(e.i);
+            case variant::TYPE_DOUBLE: return variant(e.d);
+            case variant::TYPE_STRING: return variant(std::string(str(e.s.off), e.s.len));
+            default:                   return variant();
+        }
+    }
+};
+
+//----------------------------------------------------------------------------
+/// Compiler of variant_tree into snapshots that are published atomically
+//----------------------------------------------------------------------------
+class config_publisher : boost::noncopyable {
+    mutable std::mutex                          m_mutex;
+    std::unordered_map<std::string, uint32_t>   m_keys;
+    std::shared_ptr<const config_snapshot>      m_current;
+    std::atomic<uint64_t>                       m_generation;
+
+    uint32_t intern(const std::string& a_path) {
+        auto res = m_keys.emplace(a_path, m_keys.size());
+        return res.first->second;
+    }
+
+    void flatten(config_snapshot& a_snap, const variant_tree_base& a_tree,
+                 const std::string& a_path)
+    {
+        for (auto& child : a_tree) {
+            auto path = a_path.empty() ? child.first : a_path + '.' + child.first;
+            auto id   = intern(path);
+            if (id >= a_snap.m_entries.size()) {
+                config_snapshot::entry e;
+                e.type = variant::TYPE_NULL;
+                e.path = 0;
+                a_snap.m_entries.resize(id+1, e);
+            }
+            auto& e = a_snap.m_entries[id];
+            // Like variant_tree::find(), the first of duplicate keys wins
+            if (e.type == variant::TYPE_NULL && !child.second.data().is_null()) {
+                auto& v = child.second.data();
+                e.type  = v.type();
+                e.path  = a_snap.add_str(path);
+                switch (e.type) {
+                    case variant::TYPE_BOOL:   e.b = v.to_bool();   break;
+                    case variant::TYPE_INT:    e.i = v.to_int();    break;
+                    case variant::TYPE_DOUBLE: e.d = v.to_double(); break;
+                    default:
+                        e.s.off = a_snap.add_str(v.to_str());
+                        e.s.len = v.to_str().size();
+                }
+                a_snap.m_index.push_back(id);
+            }
+            flatten(a_snap, child.second, path);
+        }
+    }
+public:
+    config_publisher() : m_generation(0) {}
+
+    /// Intern \a a_path (e.g. "a.b.c") and return its key. The key is valid
+    /// for all snapshots of this publisher, including the ones published
+    /// before the call.
+    config_key key(const std::string& a_path) {
+        std::lock_guard<std::mutex> g(m_mutex);
+        return config_key(intern(a_path));
+    }
+
+    /// Validate \a a_tree (if it has a schema validator), compile it to a
+    /// snapshot and atomically make it current. On validation error the
+    /// current snapshot remains unchanged.
+    /// @return the published snapshot
+    std::shared_ptr<const config_snapshot> publish(const variant_tree& a_tree) {
+        if (a_tree.validator())
+            a_tree.validate();
+
+        std::shared_ptr<config_snapshot> snap(new config_snapshot);
+        {
+            std::lock_guard<std::mutex> g(m_mutex);
+            flatten(*snap, a_tree.to_base(), std::string());
+            // Cover keys interned but absent in this tree
+            config_snapshot::entry e;
+            e.type = variant::TYPE_NULL;
+            e.path = 0;
+            snap->m_entries.resize(m_keys.size(), e);
+            snap->m_generation = m_generation.load(std::memory_order_relaxed) + 1;
+            std::sort(snap->m_index.begin(), snap->m_index.end(),
+                [&](uint32_t a, uint32_t b) {
+                    return strcmp(snap->str(snap->m_entries[a].path),
+                                  snap->str(snap->m_entries[b].path)) < 0;
+                });
+            std::atomic_store(&m_current, std::shared_ptr<const config_snapshot>(snap));
+            m_generation.store(snap->m_generation, std::memory_order_release);
+        }
+        return snap;
+    }
+
+    /// Current snapshot (nullptr if nothing was published)
+    std::shared_ptr<const config_snapshot> snapshot() const {
+        return std::atomic_load(&m_current);
+    }
+
+    /// Generation of the current snapshot (0 if nothing was published)
+    uint64_t generation() const {
+        return m_generation.load(std::memory_order_acquire);
+    }
+};
+
+//----------------------------------------------------------------------------
+/// Per-thread accessor of the current snapshot of a config_publisher.
+/// It holds a reference to the snapshot and checks for a newer one with
+/// a single atomic load per access.
+//----------------------------------------------------------------------------
+class config_reader {
+    const config_publisher&                 m_publisher;
+    std::shared_ptr<const config_snapshot>  m_snapshot;
+    uint64_t                                m_generation;
+public:
+    explicit config_reader(const config_publisher& a_pub)
+        : m_publisher(a_pub), m_generation(0)
+    {}
+
+    /// Refresh the snapshot if a newer one was published
+    /// @return true if the snapshot changed
+    bool refresh() {
+        if (m_publisher.generation() == m_generation)
+            return false;
+        m_snapshot   = m_publisher.snapshot();
+        m_generation = m_snapshot ? m_snapshot->generation() : 0;
+        return true;
+    }
+
+    /// Get the current snapshot (a newer one is picked up if published).
+    /// Throws std::runtime_error if nothing has been published yet.
+    const config_snapshot& get() {
+        refresh();
+        if (!m_snapshot)
+            throw std::runtime_error("Configuration was not published");
+        return *m_snapshot;
+    }
+
+    const config_snapshot& operator*()  { return get();  }
+    const config_snapshot* operator->() { return &get(); }
+};
+
+} // namespace utxx
@@ -217,6 +217,37 @@ namespace config {
 
     const char* type_to_string(option_type_t a_type);
 
+    //--------------------------------------------------------------------------
+    /// Name or value choice of an option in the static option table
+    //--------------------------------------------------------------------------
+    struct choice_def {
+        const char*     val;            // NULL terminates a list of choices
+        const char*     desc;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Static option table entry generated by config_validator_codegen.py.
+    /// Entries are in depth-first document order, so that every option
+    /// follows its parent.
+    //--------------------------------------------------------------------------
+    struct option_def {
+        int                 parent;     // Index of the parent entry or -1
+        const char*         name;
+        option_type_t       opt_type;
+        option_type_t       value_type;
+        const char*         desc;
+        bool                unique;
+        bool                required;
+        bool                validate;
+        const char*         def;        // NULL if there's no default
+        const char*         min;        // NULL if unset
+        const char*         max;        // NULL if unset
+        const char*         defaults;   // Fallback defaults branch path
+        bool                recursive;
+        const choice_def*   names;      // NULL if no name choices
+        const choice_def*   values;     // NULL if no value choices
+    };
+
     struct validator;
 
     /// Performs custom validation of unrecognized options
@@ -269,6 +300,10 @@ namespace config {
         /// Optional custom validator for this node
         mutable custom_validator    m_custom_validator;
 
+        /// Cached result of validator::has_required_child_options() for the
+        /// children of this node set by validator::preprocess() (-1 if unset)
+        mutable int                 m_has_required_child = -1;
+
         option()
             : opt_type(UNDEF), value_type(UNDEF), required(true), unique(true)
             , recursive(false)
@@ -417,6 +452,10 @@ namespace config {
             a.insert(std::make_pair(a_opt.name, a_opt));
         }
 
+        /// Populate m_options from the static option table of \a a_count
+        /// entries generated by config_validator_codegen.py
+        void add_options(const option_def* a_defs, size_t a_count);
+
         void preprocess();
 
     private:
@@ -481,6 +520,17 @@ namespace config {
         bool has_required_child_options(const option_map& a_opts,
             tree_path& a_req_option_path) const;
 
+        /// Same as has_required_child_options(a_opt.children, ...) using
+        /// the value cached by preprocess()
+        bool has_required_child_options(const option& a_opt) const {
+            if (a_opt.m_has_required_child >= 0)
+                return a_opt.m_has_required_child > 0;
+            tree_path path;
+            return has_required_child_options(a_opt.children, path);
+        }
+
+        void index_options(const option_map& a_opts) const;
+
         static std::ostream& dump(std::ostream& a_out, const std::string& a_indent,
             int a_level, const option_map& a_opts, bool a_colorize = true,
             bool a_braces = false);
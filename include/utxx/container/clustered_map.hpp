@@ -109,7 +109,7 @@ class clustered_map {
             return false;
         else if (m_mru[1]->first == a_hi) {
             std::swap(m_mru[0], m_mru[1]);
-            a_it = m_mru[1];
+            a_it = m_mru[0];
         } else
             return false;
         return true;
@@ -236,7 +236,7 @@ class clustered_map<Key, Data, LowBits, SortOrder>::iterator
 
     int find_first_level2() {
         if (m_level1 == m_owner->end())
-            return s_level2_init_value;
+            return bitmap_t::cend;
         return boost::is_same<SortOrder, ascending>::value
             ? m_level1->second.index.first()
             : m_level1->second.index.last();
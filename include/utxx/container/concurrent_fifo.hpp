@@ -38,6 +38,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #define _UTXX_CONCURRENT_FIFO_HPP_
 
 #include <utxx/container/detail/base_fifo.hpp>
+#include <boost/static_assert.hpp>
+#include <atomic>
 
 namespace utxx {
 namespace container {
@@ -98,6 +100,94 @@ public:
     blocking_unbound_fifo() : base_t(m_allocator) {}
 };
 
+//-----------------------------------------------------------------------------
+/// @class bound_mpmc_queue
+/// Bounded multi-producer/multi-consumer queue stored in a ring of \a Size
+/// cells (D. Vyukov's algorithm). Each cell carries a sequence number
+/// telling whether it's ready to be written or read at a given position,
+/// so that enqueue and dequeue each take a single CAS on the tail or head
+/// index and no memory is allocated.
+//-----------------------------------------------------------------------------
+template <typename T, int Size>
+class bound_mpmc_queue : boost::noncopyable {
+    BOOST_STATIC_ASSERT((Size & (Size-1)) == 0);
+
+    struct cell {
+        std::atomic<size_t> seq;
+        T                   data;
+    };
+
+    static const size_t s_mask = Size - 1;
+
+    char                m_pad0[atomic::cacheline::size];
+    cell                m_cells[Size];
+    char                m_pad1[atomic::cacheline::size];
+    std::atomic<size_t> m_tail;
+    char                m_pad2[atomic::cacheline::size - sizeof(size_t)];
+    std::atomic<size_t> m_head;
+    char                m_pad3[atomic::cacheline::size - sizeof(size_t)];
+public:
+    bound_mpmc_queue() : m_tail(0), m_head(0) {
+        for (size_t i=0; i < Size; ++i)
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /// @return false if the queue is full
+    bool enqueue(const T& item) {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        for (;;) {
+            cell&  c   = m_cells[pos & s_mask];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            long   dif = long(seq) - long(pos);
+            if (dif == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                    c.data = item;
+                    c.seq.store(pos+1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0)
+                return false;
+            else
+                pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// @return false if the queue is empty
+    bool dequeue(T& item) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            cell&  c   = m_cells[pos & s_mask];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            long   dif = long(seq) - long(pos+1);
+            if (dif == 0) {
+                if (m_head.compare_exchange_weak(pos, pos+1, std::memory_order_relaxed)) {
+                    item = c.data;
+                    c.seq.store(pos + Size, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0)
+                return false;
+            else
+                pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns true if the next item to dequeue is not yet available.
+    bool empty() const {
+        size_t pos = m_head.load(std::memory_order_acquire);
+        return m_cells[pos & s_mask].seq.load(std::memory_order_acquire) != pos+1;
+    }
+
+    /// Approximate number of items in the queue.
+    size_t size() const {
+        long n = long(m_tail.load(std::memory_order_relaxed))
+               - long(m_head.load(std::memory_order_relaxed));
+        return n < 0 ? 0 : size_t(n);
+    }
+
+    static constexpr int capacity() { return Size; }
+};
+
 } // namespace container
 } // namespace utxx
 
@@ -3,6 +3,15 @@
 /// \author Serge Aleynikov
 //----------------------------------------------------------------------------
 /// \brief Concurrent priority queue
+///
+/// A multi-producer/multi-consumer queue with a fixed number of priority
+/// levels (0 is the highest priority). Each level is a separate lock-free
+/// queue, and a 64-bit word holds the bitmask of non-empty levels in its
+/// low bits and a version counter in the remaining bits. Consumers pick
+/// the highest non-empty level with a single bit scan, and the version
+/// protects updates of the bitmask from the ABA problem. E.g. an order
+/// scheduler can put cancel/replace requests at priority 0 so that they
+/// overtake new orders queued at priority 1.
 //----------------------------------------------------------------------------
 // Created: 2010-02-03
 //----------------------------------------------------------------------------
@@ -33,68 +42,180 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #ifndef _UTXX_CONCURRENT_PRI_QUEUE_HPP_
 #define _UTXX_CONCURRENT_PRI_QUEUE_HPP_
 
-#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <utxx/atomic.hpp>
 #include <utxx/bitmap.hpp>
+#include <utxx/futex.hpp>
+#include <utxx/container/concurrent_fifo.hpp>
+#include <atomic>
+#include <time.h>
+
+namespace utxx {
+namespace container {
+
+//-----------------------------------------------------------------------------
+/// @class concurrent_priority_queue
+/// @tparam T          type of queued items
+/// @tparam Priorities number of priority levels (1..56)
+/// @tparam Queue      concurrent MPMC queue of a single level implementing:
+///                    bool enqueue(const T&), bool dequeue(T&), bool empty()
+//-----------------------------------------------------------------------------
+template <typename T, int Priorities, typename Queue = bound_mpmc_queue<T, 1024>>
+class concurrent_priority_queue : boost::noncopyable {
+    BOOST_STATIC_ASSERT(0 < Priorities && Priorities <= 56);
+
+    typedef bitmap_low<Priorities, uint64_t> bitmask_t;
+
+    static const uint64_t s_mask    = (1ul << Priorities) - 1;
+    static const uint64_t s_version = 1ul << Priorities;
+
+    std::atomic<uint64_t> m_idx;    // Non-empty levels bitmask and version
+    char                  m_pad0[atomic::cacheline::size - sizeof(uint64_t)];
+    std::atomic<int>      m_event;  // Futex incremented to wake up consumers
+    std::atomic<int>      m_waiters;
+    std::atomic<bool>     m_terminated;
+    char                  m_pad1[atomic::cacheline::size - 2*sizeof(int) - 1];
+    Queue                 m_queues[Priorities];
+
+    static bitmask_t bitmask(uint64_t a_idx) { return bitmask_t(a_idx & s_mask); }
+
+    /// Set or clear the non-empty bit of \a a_pri incrementing the version
+    static uint64_t update(uint64_t a_old, int a_pri, bool a_set) {
+        uint64_t bit  = 1ul << a_pri;
+        uint64_t mask = a_set ? (a_old | bit) : (a_old & ~bit);
+        return ((a_old & ~s_mask) + s_version) | (mask & s_mask);
+    }
+
+    /// Clear the bit of level \a a_pri unless items were added to it
+    void clear_if_empty(int a_pri) {
+        uint64_t old = m_idx.load();
+        // A producer sets the bit after enqueuing an item, so the check of
+        // emptiness must follow the load of the old value: if the producer
+        // sets the bit after that, the version changes and the CAS fails.
+        while ((old & (1ul << a_pri)) && m_queues[a_pri].empty())
+            if (m_idx.compare_exchange_weak(old, update(old, a_pri, false)))
+                break;
+    }
 
-template <typename T, int Priorities, typename Queue>
-class concurrent_priority_queue {
-    union versioned_bitmask {
-        uint64_t index;
-        struct {
-            bitmap_low<Priorities> bitmask : Priorities;
-            uint32_t version               : 64 - Priorities;
-        } s;
-    };
-
-    volatile versioned_bitmask m_idx;
-    char __pad[64 - sizeof(versioned_bitmask)];
-    Queue m_queues[N];
-
-    static const int s_max_version = 64 - Priorities - 1;
-
-    static uint64_t inc_version(uint64_t value) {
-        versioned_bitmask u.index = value;
-        u.s.version = (u.s.version+1) & s_max_version;
-        return u.index;
+    void notify() {
+        if (m_waiters.load() > 0) {
+            m_event.fetch_add(1);
+            futex_wake_slow(reinterpret_cast<int*>(&m_event), 1);
+        }
     }
+
 public:
     static const int max_priority = Priorities - 1;
 
-    concurrent_priority_queue() {
-        STATIC_ASSERT(0 < Priorities && Priorities <= 56, Invalid_priority_bound);
-    }
+    concurrent_priority_queue()
+        : m_idx(0), m_event(0), m_waiters(0), m_terminated(false)
+    {}
 
-    bool get(T& item) {
-        versioned_bitmask old = m_idx;
-        int pri = old.s.bitmask.first();
-        if (pri == old.s.bitmask.end())
+    /// Enqueue \a a_item with priority \a a_pri (0 is the highest).
+    /// @return false if the queue of that level is full
+    bool put(int a_pri, const T& a_item) {
+        BOOST_ASSERT(0 <= a_pri && a_pri <= max_priority);
+        if (!m_queues[a_pri].enqueue(a_item))
             return false;
-        if (m_queues[pri].get(item)) {
-            while(1) {
-                if (!m_queues[pri].empty())
-                    break;
-                old.s.bitmask.clear(pri);
-                if (atomic::cas(m_idx.index, old.index, inc_version(old.index)))
-                    break;
-                old = m_idx;
-            } 
-            return true;
+        uint64_t old = m_idx.load();
+        while (!m_idx.compare_exchange_weak(old, update(old, a_pri, true)));
+        notify();
+        return true;
+    }
+
+    /// Dequeue the oldest item of the highest non-empty priority.
+    /// @param a_pri if not NULL, it's set to the priority of the item
+    /// @return false if the queue is empty
+    bool get(T& a_item, int* a_pri = NULL) {
+        uint64_t idx = m_idx.load();
+        for (int pri; (pri = bitmask(idx).first()) != Priorities; ) {
+            if (m_queues[pri].dequeue(a_item)) {
+                if (m_queues[pri].empty())
+                    clear_if_empty(pri);
+                if (a_pri) *a_pri = pri;
+                return true;
+            }
+            // The level was emptied by another consumer
+            clear_if_empty(pri);
+            idx = m_idx.load();
         }
         return false;
     }
 
-    bool put(int priority, T& item) {
-        versioned_bitmask old = m_idx;
-        if (!m_queues[priority].put(item))
-            return false;
-        while(1) {
-            old.s.bitmask.set(priority);
-            if (atomic::cas(m_idx.index, old.index, inc_version(old.index)))
-                break;
-            old = m_idx;
+    /// Dequeue an item waiting up to \a a_timeout if the queue is empty.
+    /// @param a_timeout relative timeout (NULL means infinity)
+    /// @return 0 on success, -1 on timeout, -2 if the queue was terminated
+    int dequeue(T& a_item, const struct timespec* a_timeout = NULL, int* a_pri = NULL) {
+        struct timespec deadline;
+        if (a_timeout) {
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_sec  += a_timeout->tv_sec;
+            deadline.tv_nsec += a_timeout->tv_nsec;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
         }
-        return true;
+
+        while (true) {
+            if (get(a_item, a_pri))
+                return 0;
+            if (m_terminated.load())
+                return -2;
+
+            int ev = m_event.load();
+            m_waiters.fetch_add(1);
+            // Check again after registering as a waiter, so that a producer
+            // either sees the waiter or its item is seen here
+            if (get(a_item, a_pri)) {
+                m_waiters.fetch_sub(1);
+                return 0;
+            }
+
+            struct timespec rel, *prel = NULL;
+            if (a_timeout) {
+                struct timespec now;
+                clock_gettime(CLOCK_MONOTONIC, &now);
+                long ns = (deadline.tv_sec - now.tv_sec) * 1000000000L
+                        +  deadline.tv_nsec - now.tv_nsec;
+                if (ns <= 0) {
+                    m_waiters.fetch_sub(1);
+                    return -1;
+                }
+                rel.tv_sec  = ns / 1000000000L;
+                rel.tv_nsec = ns % 1000000000L;
+                prel = &rel;
+            }
+
+            if (!m_terminated.load())
+                futex_wait_slow(reinterpret_cast<int*>(&m_event), ev, prel);
+            m_waiters.fetch_sub(1);
+        }
+    }
+
+    /// Wake up all consumers blocked in dequeue() and make them return -2
+    /// once the queue is drained
+    void terminate() {
+        m_terminated.store(true);
+        m_event.fetch_add(1);
+        futex_wake_slow(reinterpret_cast<int*>(&m_event), INT_MAX);
     }
+
+    bool terminated() const { return m_terminated.load(); }
+
+    /// Returns true if no level has items
+    bool empty() const { return !(m_idx.load() & s_mask); }
+
+    /// Bitmask of non-empty priority levels
+    bitmask_t levels() const { return bitmask(m_idx.load()); }
+
+    /// Queue of priority level \a a_pri
+    Queue&       queue(int a_pri)       { return m_queues[a_pri]; }
+    const Queue& queue(int a_pri) const { return m_queues[a_pri]; }
 };
 
+} // namespace container
+} // namespace utxx
+
 #endif // _UTXX_CONCURRENT_PRI_QUEUE_HPP_
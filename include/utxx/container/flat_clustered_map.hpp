@@ -0,0 +1,400 @@
+//----------------------------------------------------------------------------
+/// \file  flat_clustered_map.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Cache-friendly variant of clustered_map.
+///
+/// Like clustered_map, the container implements fast lookup of data by
+/// non-uniformly distributed keys clustered in groups.  The level-1
+/// index of cluster keys is a sorted flat array searched with SIMD
+/// instructions instead of a std::map, and the cluster data is allocated
+/// contiguously in pages of clusters.  The most recently used cluster and
+/// its neighbors are checked before searching the index, so that lookups
+/// and insertions of dense keys (e.g. price levels of an order book) are
+/// O(1) amortized.
+///
+/// Differences from clustered_map:
+///   - Pointers to data remain valid until the key is erased, but the
+///     iterators are invalidated when a cluster is added or removed.
+///   - Adding or removing a cluster in the middle of the index is O(N) in
+///     the number of clusters (a memmove of the flat index).
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is a part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#ifndef _UTXX_FLAT_CLUSTERED_MAP_HPP_
+#define _UTXX_FLAT_CLUSTERED_MAP_HPP_
+
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <utxx/container/clustered_map.hpp>
+#include <utxx/bits.hpp>
+#include <memory>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace utxx {
+
+namespace detail {
+    /// Find the position of the first element not less than \a a_key in a
+    /// sorted array \a a_data of \a a_size elements.  Binary search narrows
+    /// the range down to a small block scanned with SIMD comparisons.
+    inline size_t simd_lower_bound(const int64_t* a_data, size_t a_size, int64_t a_key) {
+        const int64_t* p = a_data;
+        size_t         n = a_size;
+        while (n > 16) {
+            size_t half = n >> 1;
+            if (p[half] < a_key) {
+                p += half + 1;
+                n -= half + 1;
+            } else
+                n  = half;
+        }
+
+        size_t i = 0, cnt = 0;
+        #if defined(__AVX2__)
+        const __m256i k = _mm256_set1_epi64x(a_key);
+        for (; i + 4 <= n; i += 4) {
+            __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i lt = _mm256_cmpgt_epi64(k, v);
+            cnt += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(lt)));
+        }
+        #elif defined(__SSE4_2__)
+        const __m128i k = _mm_set1_epi64x(a_key);
+        for (; i + 2 <= n; i += 2) {
+            __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+            __m128i lt = _mm_cmpgt_epi64(k, v);
+            cnt += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(lt)));
+        }
+        #endif
+        for (; i < n; ++i)
+            cnt += p[i] < a_key;
+
+        return (p - a_data) + cnt;
+    }
+} // namespace detail
+
+template <
+    class Key,
+    class Data,
+    int   LowBits   = 6,
+    class SortOrder = ascending
+>
+class flat_clustered_map {
+    BOOST_STATIC_ASSERT(sizeof(Key) <= sizeof(int64_t));
+    BOOST_STATIC_ASSERT(LowBits     <= 6);
+    typedef bitmap_low<1 << LowBits> bitmap_t;
+    typedef typename bitmap_t::value_type mask_t;
+    static const size_t s_lo_mask    = (1 << LowBits) - 1;
+    static const bool   s_ascending  = boost::is_same<SortOrder, ascending>::value;
+    static const int    s_page_bits  = 5;
+    static const size_t s_page_size  = 1 << s_page_bits;
+    static const size_t s_npos       = size_t(-1);
+
+    struct cluster {
+        bitmap_t    index;
+        Data        data[1 << LowBits];
+    };
+
+    // Level-1 index.  Cluster keys are stored as int64_t ranks, which
+    // are ordered according to SortOrder for any integral Key type.
+    std::vector<int64_t>                    m_ranks;
+    std::vector<cluster*>                   m_groups;
+    // Cluster storage
+    std::vector<std::unique_ptr<cluster[]>> m_pages;
+    std::vector<cluster*>                   m_free;
+    // Position of the most recently used cluster in the index
+    size_t                                  m_mru;
+
+    static Key hi_key(Key a_key) { return Key(a_key & ~Key(s_lo_mask)); }
+
+    static int64_t rank(Key a_hi) {
+        int64_t r = boost::is_signed<Key>::value
+                  ? int64_t(a_hi)
+                  : int64_t(uint64_t(a_hi) ^ (1ul << 63));
+        return s_ascending ? r : ~r;
+    }
+
+    static Key unrank(int64_t a_rank) {
+        int64_t r = s_ascending ? a_rank : ~a_rank;
+        return boost::is_signed<Key>::value
+             ? Key(r) : Key(uint64_t(r) ^ (1ul << 63));
+    }
+
+    cluster& at_pos(size_t a_pos) const { return *m_groups[a_pos]; }
+
+    /// Find position of the cluster with \a a_rank in the index.
+    /// Returns s_npos if not found, and sets \a a_pos to the insertion point.
+    size_t locate(int64_t a_rank, size_t& a_pos) const {
+        size_t n = m_ranks.size();
+        if (m_mru < n) {
+            int64_t r = m_ranks[m_mru];
+            if (r == a_rank)
+                return (a_pos = m_mru);
+            // Dense keys are most likely found next to the MRU cluster
+            if (r < a_rank) {
+                size_t i = m_mru + 1;
+                if (i == n || m_ranks[i] > a_rank) { a_pos = i; return s_npos; }
+                if (m_ranks[i] == a_rank)          return (a_pos = i);
+            } else {
+                if (m_mru == 0 || m_ranks[m_mru-1] < a_rank) {
+                    a_pos = m_mru;
+                    return s_npos;
+                }
+                if (m_ranks[m_mru-1] == a_rank) return (a_pos = m_mru-1);
+            }
+        }
+        a_pos = detail::simd_lower_bound(m_ranks.data(), n, a_rank);
+        return a_pos < n && m_ranks[a_pos] == a_rank ? a_pos : s_npos;
+    }
+
+    cluster* lookup(Key a_key) {
+        size_t pos;
+        if (locate(rank(hi_key(a_key)), pos) == s_npos)
+            return NULL;
+        m_mru = pos;
+        return &at_pos(pos);
+    }
+
+    void add_page() {
+        m_pages.emplace_back(new cluster[s_page_size]());
+        cluster* p = m_pages.back().get();
+        for (size_t i = s_page_size; i > 0; --i)
+            m_free.push_back(p + i - 1);
+    }
+
+    cluster* new_cluster() {
+        if (m_free.empty())
+            add_page();
+        cluster* c = m_free.back();
+        m_free.pop_back();
+        return c;
+    }
+
+    std::pair<bool, Data*> ensure(Key a_key) {
+        int64_t r  = rank(hi_key(a_key));
+        size_t  lo = a_key & s_lo_mask;
+        size_t  pos;
+        bool    found = locate(r, pos) != s_npos;
+        if (!found) {
+            cluster* c = new_cluster();
+            m_ranks.insert (m_ranks.begin()  + pos, r);
+            m_groups.insert(m_groups.begin() + pos, c);
+        }
+        m_mru = pos;
+        cluster& c = at_pos(pos);
+        found = found && c.index[lo];
+        if (!found) {
+            // Don't expose stale data of a previously erased key
+            c.data[lo] = Data();
+            c.index.set(lo);
+        }
+        return std::make_pair(found, &c.data[lo]);
+    }
+
+    void remove_cluster(size_t a_pos) {
+        m_free.push_back(m_groups[a_pos]);
+        m_ranks.erase (m_ranks.begin()  + a_pos);
+        m_groups.erase(m_groups.begin() + a_pos);
+        if (m_mru >= a_pos && m_mru > 0)
+            --m_mru;
+    }
+
+    // Next/first set bit of a cluster in SortOrder
+    static int next_bit(mask_t a_mask, int a_bit) {
+        if (s_ascending) {
+            mask_t m = a_bit < 0 ? a_mask : a_mask & ~((mask_t(2) << a_bit) - 1);
+            return m ? int(bits::bit_scan_forward(m)) : bitmap_t::cend;
+        } else {
+            mask_t m = a_bit < 0 ? a_mask : a_mask & ((mask_t(1) << a_bit) - 1);
+            return m ? int(bits::bit_scan_reverse(m)) : bitmap_t::cend;
+        }
+    }
+
+public:
+    typedef Key     key_type;
+    typedef Data    mapped_type;
+
+    class iterator;
+    typedef iterator const_iterator;
+
+    flat_clustered_map() : m_mru(0) {}
+
+    /// Preallocate space for \a a_groups key clusters
+    void reserve(size_t a_groups) {
+        m_ranks.reserve(a_groups);
+        m_groups.reserve(a_groups);
+        while (m_pages.size() * s_page_size < a_groups)
+            add_page();
+    }
+
+    iterator        begin() const { return iterator(this, 0); }
+    iterator        end()   const { return iterator(this, m_ranks.size(), bitmap_t::cend); }
+
+    /// Total number of clustered key groups
+    size_t group_count() const { return m_ranks.size(); }
+    /// Number of items in the cluster group associated with the \a a_key.
+    size_t item_count(Key a_key) const {
+        size_t pos;
+        return locate(rank(hi_key(a_key)), pos) == s_npos
+             ? 0 : at_pos(pos).index.count();
+    }
+
+    /// Return the data pointer associated with the \a a_key entry
+    /// in the container. If the \a a_key is not found, return NULL.
+    Data* at(Key a_key) {
+        cluster* c  = lookup(a_key);
+        size_t   lo = a_key & s_lo_mask;
+        return c && c->index[lo] ? &c->data[lo] : NULL;
+    }
+
+    iterator find(Key a_key) {
+        cluster* c  = lookup(a_key);
+        size_t   lo = a_key & s_lo_mask;
+        return c && c->index[lo] ? iterator(this, m_mru, lo) : end();
+    }
+
+    /// Insert an entry in the container associated with the \a a_key.
+    Data& insert(Key a_key) { return *ensure(a_key).second; }
+
+    /// Insert \a a_key and \a a_data pair in the container
+    void insert(Key a_key, const Data& a_data) { *ensure(a_key).second = a_data; }
+
+    /// Return data associated with the \a a_key. If the \a a_key
+    /// is not present in the container, it will be inserted.
+    Data& operator[] (Key a_key) { return insert(a_key); }
+
+    /// Erase entry pointed by the iterator \a a_it from the container
+    bool erase(iterator a_it) {
+        if (a_it.m_pos >= m_ranks.size() || a_it.m_level2 == int(bitmap_t::cend))
+            return false;
+        cluster& c = at_pos(a_it.m_pos);
+        if (!c.index.is_set(a_it.m_level2))
+            return false;
+        c.index.clear(a_it.m_level2);
+        if (c.index.empty())
+            remove_cluster(a_it.m_pos);
+        return true;
+    }
+
+    /// Erase given key from the container
+    bool erase(Key a_key) {
+        size_t pos;
+        if (locate(rank(hi_key(a_key)), pos) == s_npos)
+            return false;
+        return erase(iterator(this, pos, a_key & s_lo_mask));
+    }
+
+    /// Clears the container
+    void clear() {
+        m_ranks.clear();
+        m_groups.clear();
+        m_free.clear();
+        m_pages.clear();
+        m_mru = 0;
+    }
+
+    /// Returns true when the container is empty
+    bool empty() const { return m_ranks.empty(); }
+
+    template <class Visitor, class State>
+    void for_each(Visitor& a_visit, State& a_state) {
+        for (size_t i = 0, n = m_ranks.size(); i < n; ++i) {
+            cluster& c   = at_pos(i);
+            Key      hi  = unrank(m_ranks[i]);
+            mask_t   m   = c.index.value();
+            for (int b = next_bit(m, -1); b != int(bitmap_t::cend); b = next_bit(m, b))
+                a_visit(Key(hi | b), c.data[b], a_state);
+        }
+    }
+};
+
+template <class Key, class Data, int LowBits, class SortOrder>
+class flat_clustered_map<Key, Data, LowBits, SortOrder>::iterator
+{
+    const flat_clustered_map* m_owner;
+    size_t                    m_pos;
+    int                       m_level2;
+
+    friend class flat_clustered_map<Key, Data, LowBits, SortOrder>;
+
+    cluster& group() const { return m_owner->at_pos(m_pos); }
+
+    int first_level2() const {
+        return m_pos < m_owner->m_ranks.size()
+             ? next_bit(group().index.value(), -1) : bitmap_t::cend;
+    }
+public:
+    using pointer         = Data*;
+    using reference       = Data&;
+    using const_reference = Data const&;
+
+    iterator() : m_owner(NULL), m_pos(0), m_level2(bitmap_t::cend) {}
+
+    iterator(const flat_clustered_map* a_map, size_t a_pos)
+        : m_owner(a_map), m_pos(a_pos), m_level2(first_level2())
+    {}
+
+    iterator(const flat_clustered_map* a_map, size_t a_pos, int a_level2)
+        : m_owner(a_map), m_pos(a_pos), m_level2(a_level2)
+    {}
+
+    Key key() const {
+        BOOST_ASSERT(m_pos < m_owner->m_ranks.size());
+        return Key(unrank(m_owner->m_ranks[m_pos]) | m_level2);
+    }
+
+    Data&       data()              const   { return group().data[m_level2]; }
+    int         item()              const   { return m_level2; }
+    size_t      item_count()        const   { return group().index.count(); }
+    static int  end_item()                  { return bitmap_t::cend; }
+
+    bool operator== (const iterator& a_rhs) const {
+        return m_pos == a_rhs.m_pos && m_level2 == a_rhs.m_level2;
+    }
+
+    bool operator!= (const iterator& a_rhs) const { return !operator==(a_rhs); }
+
+    pointer         operator->() const  { return &group().data[m_level2]; }
+    reference       operator*()  const  { return  group().data[m_level2]; }
+
+    iterator& operator++() {
+        size_t n = m_owner->m_ranks.size();
+        if (m_pos >= n)
+            return *this;
+        m_level2 = next_bit(group().index.value(), m_level2);
+        while (m_level2 == int(bitmap_t::cend) && ++m_pos < n)
+            m_level2 = next_bit(group().index.value(), -1);
+        return *this;
+    }
+};
+
+} // namespace utxx
+
+#endif // _UTXX_FLAT_CLUSTERED_MAP_HPP_
@@ -46,10 +46,27 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <cmath>
 #include <utxx/compiler_hints.hpp>
 #include <utxx/convert.hpp>
+#include <utxx/fast_itoa.hpp>
 #include <utxx/print.hpp>
 
 namespace utxx {
 
+namespace detail {
+    /// Integer powers of 10 from 10^0 to 10^18
+    inline const long* decimal_pow10() {
+        static const long s_pow10[] = {
+            1l,                 10l,                 100l,
+            1000l,              10000l,              100000l,
+            1000000l,           10000000l,           100000000l,
+            1000000000l,        10000000000l,        100000000000l,
+            1000000000000l,     10000000000000l,     100000000000000l,
+            1000000000000000l,  10000000000000000l,  100000000000000000l,
+            1000000000000000000l
+        };
+        return s_pow10;
+    }
+}
+
 //------------------------------------------------------------------------------
 /// Decimal number representation
 //------------------------------------------------------------------------------
@@ -154,18 +171,27 @@ public:
     explicit
     operator double() const { return value(); }
 
+    /// Max number of characters written by write() (including '\0')
+    static constexpr int max_width() { return 24 + nlimits<int8_t>::max(); }
+
+    /// Write the exact decimal representation to \a a_buf of at least
+    /// max_width() bytes (trailing fractional zeros are truncated, leaving
+    /// at least one digit after the decimal point; zero is written as "0").
+    /// @return pointer to the terminating '\0'
+    char* write(char* a_buf) const;
+
+    /// Parse ASCII "[+-]digits[.digits]" in [a_begin, a_end) without
+    /// conversion to double. The result is normalized.
+    /// @return pointer past the last parsed character or NULL if there are
+    ///         no digits, the mantissa exceeds 56 bits, or the exponent is
+    ///         out of range
+    const char* parse(const char* a_begin, const char* a_end);
+
     template <typename StreamT>
     StreamT& print(StreamT& out) const {
-        double v = value();
-        if (exp() >= 0) {
-            out << long(v >= 0 ? v + 0.5 : v - 0.5);
-            return out;
-        }
-        char buf[128];
-        if (ftoa_left<true>(v, buf, sizeof(buf), -m_exp, true) < 0)
-            out << v;
-        else
-            out << buf;
+        char buf[max_width()];
+        write(buf);
+        out << buf;
         return out;
     }
 
@@ -218,6 +244,102 @@ public:
     }
 };
 
+//------------------------------------------------------------------------------
+// IMPLEMENTATION
+//------------------------------------------------------------------------------
+
+inline char* decimal::write(char* a_buf) const
+{
+    char* p = a_buf;
+    if (UNLIKELY(is_null())) {
+        memcpy(p, "nan", 4);
+        return p + 3;
+    }
+    uint64_t m = m_mant;
+    if (m_mant < 0) {
+        *p++ = '-';
+        m    = -long(m_mant);
+    }
+    if (m_exp >= 0 || !m) {
+        p = fast_itoa(m, p);
+        if (m)
+            for (int i=0; i < m_exp; ++i) *p++ = '0';
+        *p = '\0';
+        return p;
+    }
+
+    char digits[24];
+    int  n = fast_itoa(m, digits) - digits;
+    int  f = -m_exp;                // Number of fractional digits
+    int  z = 0;                     // Trailing zeros to truncate
+    for (; z < f-1 && z < n && digits[n-1-z] == '0'; ++z);
+
+    if (n > f) {
+        memcpy(p, digits, n-f);
+        p += n-f;
+        *p++ = '.';
+        memcpy(p, digits + n-f, f-z);
+        p += f-z;
+    } else {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', f-n);
+        p += f-n;
+        memcpy(p, digits, n-z);
+        p += n-z;
+    }
+    *p = '\0';
+    return p;
+}
+
+inline const char* decimal::parse(const char* a_begin, const char* a_end)
+{
+    auto is_digit = [](char c) { return uint8_t(c - '0') < 10; };
+
+    const char* p   = a_begin;
+    bool        neg = p < a_end && *p == '-';
+    if (p < a_end && (*p == '-' || *p == '+'))
+        ++p;
+
+    const char* q = p;
+    while (q < a_end && is_digit(*q)) ++q;
+
+    // Nonzero digits are accumulated in the mantissa m with exponent e
+    // of its last digit, so trailing zeros are never multiplied in
+    auto     pow10  = detail::decimal_pow10();
+    bool     any    = q != p;
+    int      pos    = q - p;        // Exponent of the previous digit
+    int      e      = 0;
+    int      digits = 0;
+    uint64_t m      = 0;
+
+    auto add = [&](char c) {
+        --pos;
+        if (c == '0')
+            return true;
+        int shift = m ? e - pos : 1;
+        if ((digits += shift) > 18)
+            return false;
+        m = m * pow10[shift] + (c - '0');
+        e = pos;
+        return true;
+    };
+
+    for (; p < q; ++p)
+        if (!add(*p)) return nullptr;
+
+    if (p < a_end && *p == '.')
+        for (++p; p < a_end && is_digit(*p); ++p, any = true)
+            if (!add(*p)) return nullptr;
+
+    if (!any || m > (1ul << 55) - !neg || e < nlimits<int8_t>::min() || e >= nullexp())
+        return nullptr;
+
+    m_mant = neg ? -long(m) : long(m);
+    m_exp  = m ? e : 0;
+    return p;
+}
+
 } // namespace utxx
 
 #endif
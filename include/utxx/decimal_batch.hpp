@@ -0,0 +1,301 @@
+//------------------------------------------------------------------------------
+/// \file   decimal_batch.hpp
+/// \author Serge Aleynikov
+//------------------------------------------------------------------------------
+/// \brief Batch operations over arrays of utxx::decimal.
+///
+/// \code
+///     decimal prices[N]; long qty[N];
+///     decimal notional = decimal_batch::dot(prices, qty, N, -8);
+/// \endcode
+///
+/// The kernels bring decimals to a common exponent and operate on their
+/// mantissas as 64-bit integers, four at a time with AVX2. Blocks having
+/// values that need division (exponent below the target) or null values
+/// are handled by the scalar path. Null values are treated as zero.
+///
+/// Results must fit in the 56-bit mantissa of the target exponent (this is
+/// not checked, like in decimal::normalize(int)).
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//------------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#pragma once
+
+#include <utxx/decimal.hpp>
+
+#if __SIZEOF_LONG__ >= 8
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace utxx {
+
+namespace detail {
+    /// Mantissa of \a a_val at exponent \a a_exp (truncated toward zero)
+    inline long decimal_rescale(decimal a_val, int a_exp) {
+        if (UNLIKELY(a_val.is_null()))
+            return 0;
+        int  d = a_val.exp() - a_exp;
+        long m = a_val.mantissa();
+        return d >= 0
+             ? (d <= 18 ? m * decimal_pow10()[d] : m * long(decimal::pow10(d)))
+             : (d >= -18 ? m / decimal_pow10()[-d] : 0);
+    }
+
+    /// Exact comparison of values of two decimals (-1, 0, 1)
+    inline int decimal_compare(decimal a, decimal b) {
+        long ma = a.is_null() ? 0 : a.mantissa();
+        long mb = b.is_null() ? 0 : b.mantissa();
+        int  ea = ma ? a.exp() : 0;
+        int  eb = mb ? b.exp() : 0;
+        int  sa = (ma > 0) - (ma < 0);
+        int  sb = (mb > 0) - (mb < 0);
+        if (sa != sb || !sa)
+            return sa < sb ? -1 : sa > sb;
+        int d = ea - eb;
+        // Mantissas have at most 17 digits, so beyond this difference the
+        // value with the larger exponent has larger magnitude
+        if (d >  18) return  sa;
+        if (d < -18) return -sa;
+        __int128 x = __int128(ma) * (d > 0 ? decimal_pow10()[ d] : 1);
+        __int128 y = __int128(mb) * (d < 0 ? decimal_pow10()[-d] : 1);
+        return x < y ? -1 : x > y;
+    }
+
+    #if defined(__AVX2__)
+    /// Sign-extended mantissas of four decimals
+    inline __m256i decimal_mant4(__m256i a_raw) {
+        const __m256i sign = _mm256_set1_epi64x(1l << 55);
+        __m256i m = _mm256_srli_epi64(a_raw, 8);
+        return _mm256_sub_epi64(_mm256_xor_si256(m, sign), sign);
+    }
+
+    /// Sign-extended exponents of four decimals
+    inline __m256i decimal_exp4(__m256i a_raw) {
+        const __m256i sign = _mm256_set1_epi64x(0x80);
+        __m256i e = _mm256_and_si256(a_raw, _mm256_set1_epi64x(0xff));
+        return _mm256_sub_epi64(_mm256_xor_si256(e, sign), sign);
+    }
+
+    /// Low 64 bits of the products of four pairs of 64-bit integers
+    inline __m256i mullo_epi64(__m256i a, __m256i b) {
+        __m256i lo = _mm256_mul_epu32(a, b);
+        __m256i hi = _mm256_add_epi64(
+                        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                        _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+    }
+
+    /// Mantissas of four decimals at exponent \a a_exp
+    /// @return false if some value needs the scalar path
+    inline bool decimal_rescale4(const decimal* a_val, __m256i a_exp, __m256i& a_mant) {
+        const __m256i max = _mm256_set1_epi64x(18);
+        __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_val));
+        __m256i d   = _mm256_sub_epi64(decimal_exp4(raw), a_exp);
+        // Null values have exponent 127, which is beyond the max difference
+        __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi64(_mm256_setzero_si256(), d),
+                                      _mm256_cmpgt_epi64(d, max));
+        if (!_mm256_testz_si256(bad, bad))
+            return false;
+        __m256i p   = _mm256_i64gather_epi64(
+                        reinterpret_cast<const long long*>(decimal_pow10()), d, 8);
+        a_mant      = mullo_epi64(decimal_mant4(raw), p);
+        return true;
+    }
+
+    /// Store four mantissas with exponent \a a_exp as decimals
+    inline void decimal_store4(decimal* a_out, __m256i a_mant, __m256i a_exp) {
+        __m256i e = _mm256_and_si256(a_exp, _mm256_set1_epi64x(0xff));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a_out),
+                            _mm256_or_si256(_mm256_slli_epi64(a_mant, 8), e));
+    }
+
+    inline long hsum_epi64(__m256i a) {
+        __m128i s = _mm_add_epi64(_mm256_castsi256_si128(a),
+                                  _mm256_extracti128_si256(a, 1));
+        return _mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1);
+    }
+    #endif
+}
+
+namespace decimal_batch {
+
+//------------------------------------------------------------------------------
+/// Rescale \a a_n decimals to exponent \a a_exp:
+/// a_out[i] = decimal(a_exp, a_in[i] * 10^(a_in[i].exp() - a_exp))
+//------------------------------------------------------------------------------
+inline void rescale(const decimal* a_in, size_t a_n, int a_exp, decimal* a_out)
+{
+    size_t i = 0;
+    #if defined(__AVX2__)
+    const __m256i e = _mm256_set1_epi64x(a_exp);
+    const size_t n4 = a_n & ~size_t(3);
+    for (__m256i m; i < n4; i += 4)
+        if (detail::decimal_rescale4(a_in + i, e, m))
+            detail::decimal_store4(a_out + i, m, e);
+        else
+            for (int k = 0; k < 4; ++k)
+                a_out[i + k] = decimal(a_exp, detail::decimal_rescale(a_in[i + k], a_exp));
+    #endif
+    for (; i < a_n; ++i)
+        a_out[i] = decimal(a_exp, detail::decimal_rescale(a_in[i], a_exp));
+}
+
+//------------------------------------------------------------------------------
+/// Sum of \a a_n decimals at exponent \a a_exp
+//------------------------------------------------------------------------------
+inline decimal sum(const decimal* a_in, size_t a_n, int a_exp)
+{
+    size_t i = 0;
+    long   s = 0;
+    #if defined(__AVX2__)
+    const __m256i e = _mm256_set1_epi64x(a_exp);
+    __m256i acc = _mm256_setzero_si256();
+    const size_t n4 = a_n & ~size_t(3);
+    for (__m256i m; i < n4; i += 4)
+        if (detail::decimal_rescale4(a_in + i, e, m))
+            acc = _mm256_add_epi64(acc, m);
+        else
+            for (int k = 0; k < 4; ++k)
+                s += detail::decimal_rescale(a_in[i + k], a_exp);
+    s += detail::hsum_epi64(acc);
+    #endif
+    for (; i < a_n; ++i)
+        s += detail::decimal_rescale(a_in[i], a_exp);
+    return decimal(a_exp, s);
+}
+
+//------------------------------------------------------------------------------
+/// Multiply \a a_n decimals by integer quantities at exponent \a a_exp:
+/// a_out[i] = a_in[i] * a_qty[i]
+//------------------------------------------------------------------------------
+inline void multiply(const decimal* a_in, const long* a_qty, size_t a_n, int a_exp,
+                     decimal* a_out)
+{
+    size_t i = 0;
+    #if defined(__AVX2__)
+    const __m256i e = _mm256_set1_epi64x(a_exp);
+    const size_t n4 = a_n & ~size_t(3);
+    for (__m256i m; i < n4; i += 4)
+        if (detail::decimal_rescale4(a_in + i, e, m)) {
+            __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_qty + i));
+            detail::decimal_store4(a_out + i, detail::mullo_epi64(m, q), e);
+        } else
+            for (int k = 0; k < 4; ++k)
+                a_out[i + k] = decimal(a_exp,
+                    detail::decimal_rescale(a_in[i + k], a_exp) * a_qty[i + k]);
+    #endif
+    for (; i < a_n; ++i)
+        a_out[i] = decimal(a_exp, detail::decimal_rescale(a_in[i], a_exp) * a_qty[i]);
+}
+
+//------------------------------------------------------------------------------
+/// Sum of products of \a a_n decimals and integer quantities at exponent
+/// \a a_exp (e.g. notional value of positions)
+//------------------------------------------------------------------------------
+inline decimal dot(const decimal* a_in, const long* a_qty, size_t a_n, int a_exp)
+{
+    size_t i = 0;
+    long   s = 0;
+    #if defined(__AVX2__)
+    const __m256i e = _mm256_set1_epi64x(a_exp);
+    __m256i acc = _mm256_setzero_si256();
+    const size_t n4 = a_n & ~size_t(3);
+    for (__m256i m; i < n4; i += 4)
+        if (detail::decimal_rescale4(a_in + i, e, m)) {
+            __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_qty + i));
+            acc = _mm256_add_epi64(acc, detail::mullo_epi64(m, q));
+        } else
+            for (int k = 0; k < 4; ++k)
+                s += detail::decimal_rescale(a_in[i + k], a_exp) * a_qty[i + k];
+    s += detail::hsum_epi64(acc);
+    #endif
+    for (; i < a_n; ++i)
+        s += detail::decimal_rescale(a_in[i], a_exp) * a_qty[i];
+    return decimal(a_exp, s);
+}
+
+//------------------------------------------------------------------------------
+/// Exact comparison of values of \a a_n pairs of decimals:
+/// a_out[i] = -1, 0 or 1 if a_lhs[i] is less, equal or greater than a_rhs[i]
+//------------------------------------------------------------------------------
+inline void compare(const decimal* a_lhs, const decimal* a_rhs, size_t a_n,
+                    int8_t* a_out)
+{
+    size_t i = 0;
+    #if defined(__AVX2__)
+    // The vector path handles exponents differing by up to 2, for which
+    // products of the mantissas can't overflow
+    const __m256i two  = _mm256_set1_epi64x(2);
+    const __m256i zero = _mm256_setzero_si256();
+    const size_t n4 = a_n & ~size_t(3);
+    for (; i < n4; i += 4) {
+        __m256i ra = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_lhs + i));
+        __m256i rb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_rhs + i));
+        __m256i ma = detail::decimal_mant4(ra);
+        __m256i mb = detail::decimal_mant4(rb);
+        __m256i d  = _mm256_sub_epi64(detail::decimal_exp4(ra), detail::decimal_exp4(rb));
+        // Zero mantissas of both operands (incl. nulls) are equal at any exponent
+        __m256i z  = _mm256_and_si256(_mm256_cmpeq_epi64(ma, zero),
+                                      _mm256_cmpeq_epi64(mb, zero));
+        __m256i bad= _mm256_andnot_si256(z,
+                        _mm256_or_si256(_mm256_cmpgt_epi64(d, two),
+                                        _mm256_cmpgt_epi64(_mm256_sub_epi64(zero, two), d)));
+        // Null values have exponent 127, so they also fail the check above
+        // unless both are null or zero
+        if (!_mm256_testz_si256(bad, bad)) {
+            for (int k = 0; k < 4; ++k)
+                a_out[i + k] = detail::decimal_compare(a_lhs[i + k], a_rhs[i + k]);
+            continue;
+        }
+        // Scale the mantissa having the larger exponent by 10^|d|
+        d  = _mm256_andnot_si256(z, d);
+        __m256i nd = _mm256_sub_epi64(zero, d);
+        auto pow10 = reinterpret_cast<const long long*>(detail::decimal_pow10());
+        __m256i pa = _mm256_i64gather_epi64(pow10,
+                        _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, d),  d),  8);
+        __m256i pb = _mm256_i64gather_epi64(pow10,
+                        _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, nd), nd), 8);
+        ma = detail::mullo_epi64(ma, pa);
+        mb = detail::mullo_epi64(mb, pb);
+        __m256i r  = _mm256_sub_epi64(_mm256_cmpgt_epi64(mb, ma),
+                                      _mm256_cmpgt_epi64(ma, mb));
+        alignas(32) long res[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(res), r);
+        for (int j = 0; j < 4; ++j)
+            a_out[i+j] = int8_t(res[j]);
+    }
+    #endif
+    for (; i < a_n; ++i)
+        a_out[i] = detail::decimal_compare(a_lhs[i], a_rhs[i]);
+}
+
+} // namespace decimal_batch
+} // namespace utxx
+
+#endif
@@ -0,0 +1,243 @@
+//----------------------------------------------------------------------------
+/// \file  mapped_istream.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Input streams reading from memory or a memory-mapped file.
+///
+/// Used by configuration parsers to avoid per-character reads through
+/// a filebuf: the standard line and character extractors scan the
+/// get area directly, which here covers the whole input.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#pragma once
+
+#include <boost/noncopyable.hpp>
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace utxx {
+namespace detail {
+
+    //-------------------------------------------------------------------------
+    /// Read-only memory mapping of a whole regular file.
+    ///
+    /// Files of up to s_copy_size bytes are read into memory instead of
+    /// being mapped. Larger files stay mapped, and truncating such a file
+    /// while it is being read raises SIGBUS, so files that may be edited in
+    /// place must be replaced by renaming a new file over them.
+    //-------------------------------------------------------------------------
+    class mapped_file : boost::noncopyable {
+        const char* m_data;
+        size_t      m_size;
+        bool        m_open;
+        bool        m_mapped;
+        std::string m_copy;
+    public:
+        static const size_t s_copy_size = 1024*1024;
+
+        mapped_file() : m_data(nullptr), m_size(0), m_open(false), m_mapped(false) {}
+        explicit mapped_file(const char* a_filename) : mapped_file() {
+            open(a_filename);
+        }
+        ~mapped_file() { close(); }
+
+        /// Map \a a_filename into memory. An empty file is opened with
+        /// size() == 0.
+        /// @return false if the file cannot be opened or is not a regular
+        ///         file (errno is set)
+        bool open(const char* a_filename) {
+            close();
+            int fd = ::open(a_filename, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+                return false;
+            struct stat st;
+            bool ok = ::fstat(fd, &st) == 0;
+            if (ok && !S_ISREG(st.st_mode)) {
+                ok    = false;
+                errno = EINVAL;
+            }
+            if (!ok) {
+                int e = errno;
+                ::close(fd);
+                errno = e;
+                return false;
+            }
+            ok = st.st_size <= off_t(s_copy_size)
+               ? read_all(fd, st.st_size) : map(fd, st.st_size);
+            ::close(fd);
+            m_open = ok;
+            return ok;
+        }
+
+        void close() {
+            if (m_mapped)
+                ::munmap(const_cast<char*>(m_data), m_size);
+            std::string().swap(m_copy);
+            m_data   = nullptr;
+            m_size   = 0;
+            m_open   = false;
+            m_mapped = false;
+        }
+
+        bool        is_open() const { return m_open; }
+        const char* data()    const { return m_data; }
+        size_t      size()    const { return m_size; }
+
+    private:
+        bool read_all(int a_fd, size_t a_size) {
+            m_copy.resize(a_size);
+            size_t n = 0;
+            while (n < a_size) {
+                auto r = ::read(a_fd, &m_copy[n], a_size - n);
+                if (r < 0 && errno == EINTR)
+                    continue;
+                if (r < 0) {
+                    std::string().swap(m_copy);
+                    return false;
+                }
+                if (r == 0)     // The file was truncated
+                    break;
+                n += r;
+            }
+            m_copy.resize(n);
+            m_data = m_copy.data();
+            m_size = n;
+            return true;
+        }
+
+        bool map(int a_fd, size_t a_size) {
+            // Pre-fault the pages since the input is read sequentially
+            void* p = ::mmap(nullptr, a_size, PROT_READ,
+                             MAP_PRIVATE | MAP_POPULATE, a_fd, 0);
+            if (p == MAP_FAILED)
+                return false;
+            m_data   = static_cast<const char*>(p);
+            m_size   = a_size;
+            m_mapped = true;
+            return true;
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// Stream buffer over a memory region (not owned)
+    //-------------------------------------------------------------------------
+    template <class Ch>
+    class basic_memory_buf : public std::basic_streambuf<Ch> {
+        typedef std::basic_streambuf<Ch>    base;
+    public:
+        typedef typename base::pos_type     pos_type;
+        typedef typename base::off_type     off_type;
+
+        basic_memory_buf() {}
+        basic_memory_buf(const Ch* a_data, size_t a_size) { reset(a_data, a_size); }
+
+        void reset(const Ch* a_data, size_t a_size) {
+            Ch* p = const_cast<Ch*>(a_data);
+            this->setg(p, p, p + a_size);
+        }
+
+    protected:
+        pos_type seekoff(off_type a_off, std::ios_base::seekdir a_dir,
+                         std::ios_base::openmode a_mode) override
+        {
+            if (!(a_mode & std::ios_base::in))
+                return pos_type(off_type(-1));
+            Ch* p = a_dir == std::ios_base::beg ? this->eback()
+                  : a_dir == std::ios_base::cur ? this->gptr()
+                  :                               this->egptr();
+            p += a_off;
+            if (p < this->eback() || p > this->egptr())
+                return pos_type(off_type(-1));
+            this->setg(this->eback(), p, this->egptr());
+            return pos_type(p - this->eback());
+        }
+
+        pos_type seekpos(pos_type a_pos, std::ios_base::openmode a_mode) override {
+            return seekoff(off_type(a_pos), std::ios_base::beg, a_mode);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// Input stream over a memory region (not owned)
+    //-------------------------------------------------------------------------
+    template <class Ch>
+    class basic_memory_istream : public std::basic_istream<Ch> {
+        basic_memory_buf<Ch> m_buf;
+    public:
+        basic_memory_istream(const Ch* a_data, size_t a_size)
+            : std::basic_istream<Ch>(nullptr), m_buf(a_data, a_size)
+        {
+            this->init(&m_buf);
+        }
+    };
+
+    //-------------------------------------------------------------------------
+    /// Input stream over a memory-mapped file. Files that can't be mapped
+    /// (pipes, character devices such as /dev/stdin) are read through a
+    /// std::filebuf. Like std::ifstream, the stream is in failed state if
+    /// the file cannot be opened.
+    //-------------------------------------------------------------------------
+    class mapped_istream : public std::istream {
+        mapped_file             m_file;
+        basic_memory_buf<char>  m_buf;
+        std::filebuf            m_fbuf;
+    public:
+        explicit mapped_istream(const char* a_filename)
+            : std::istream(nullptr), m_file(a_filename)
+            , m_buf(m_file.data(), m_file.size())
+        {
+            if (m_file.is_open())
+                this->init(&m_buf);
+            else if (m_fbuf.open(a_filename, std::ios_base::in))
+                this->init(&m_fbuf);
+            else {
+                this->init(&m_buf);
+                this->setstate(std::ios_base::failbit);
+            }
+        }
+
+        explicit mapped_istream(const std::string& a_filename)
+            : mapped_istream(a_filename.c_str())
+        {}
+
+        const mapped_file& file() const { return m_file; }
+    };
+
+    /// Type of stream used for reading configuration files: memory-mapped
+    /// for narrow characters, std::basic_ifstream otherwise
+    template <class Ch> struct config_ifstream       { typedef std::basic_ifstream<Ch> type; };
+    template <>         struct config_ifstream<char> { typedef mapped_istream          type; };
+
+} // namespace detail
+} // namespace utxx
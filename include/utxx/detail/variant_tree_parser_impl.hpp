@@ -170,7 +170,7 @@ namespace detail {
         const std::locale&           a_loc      = std::locale()
     )
     {
-        std::basic_ifstream<Ch> stream(a_filename.c_str());
+        typename config_ifstream<Ch>::type stream(a_filename.c_str());
         if (!stream)
             throw variant_tree_parser_error(
                 "cannot open file for reading", a_filename, 0);
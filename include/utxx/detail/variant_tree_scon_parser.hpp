@@ -15,6 +15,7 @@
 #include <utxx/variant.hpp>
 #include <utxx/string.hpp>
 #include <utxx/path.hpp>
+#include <utxx/detail/mapped_istream.hpp>
 #include <boost/property_tree/detail/file_parser_error.hpp>
 #include <boost/property_tree/detail/info_parser_writer_settings.hpp>
 #include <boost/filesystem.hpp>
@@ -514,7 +515,7 @@ namespace detail {
                     found = resolver(inc_name);
             }
 
-            std::basic_ifstream<Ch> inc_stream(inc_name.c_str());
+            typename config_ifstream<Ch>::type inc_stream(inc_name.c_str());
             if (!inc_stream.good())
                 BOOST_PROPERTY_TREE_THROW(
                     boost::property_tree::file_parser_error(
@@ -593,26 +594,34 @@ namespace detail {
 
         // Expand known escape sequences
         str_t expand_escapes(const Ch *b, bool is_data) {
-            std::basic_stringstream<Ch> result;
+            // Fast path: most keys and values have nothing to expand
+            const Ch* p = b;
+            while (p < text && *p != Ch('\\') && (*p != Ch('$') || !is_data))
+                ++p;
+            if (p == text)
+                return str_t(b, text);
+
+            str_t result(b, p);
+            b = p;
             while (b < text && b) {
                 if (*b == Ch('\\')) {
                     if (++b == text)
                         BOOST_PROPERTY_TREE_THROW(
                             boost::property_tree::file_parser_error(
                                 "character expected after backslash", filename, lineno));
-                    else if (*b == Ch('0')) result << Ch('\0');
-                    else if (*b == Ch('a')) result << Ch('\a');
-                    else if (*b == Ch('b')) result << Ch('\b');
-                    else if (*b == Ch('f')) result << Ch('\f');
-                    else if (*b == Ch('n')) result << Ch('\n');
-                    else if (*b == Ch('r')) result << Ch('\r');
-                    else if (*b == Ch('t')) result << Ch('\t');
-                    else if (*b == Ch('v')) result << Ch('\v');
-                    else if (*b == Ch('"')) result << Ch('"');
-                    else if (*b == Ch('$')) result << Ch('$');
-                    else if (*b == Ch('\''))result << Ch('\'');
-                    else if (*b == Ch('\\'))result << Ch('\\');
-                    else if (*b == Ch('#')) result << Ch('#');
+                    else if (*b == Ch('0')) result += Ch('\0');
+                    else if (*b == Ch('a')) result += Ch('\a');
+                    else if (*b == Ch('b')) result += Ch('\b');
+                    else if (*b == Ch('f')) result += Ch('\f');
+                    else if (*b == Ch('n')) result += Ch('\n');
+                    else if (*b == Ch('r')) result += Ch('\r');
+                    else if (*b == Ch('t')) result += Ch('\t');
+                    else if (*b == Ch('v')) result += Ch('\v');
+                    else if (*b == Ch('"')) result += Ch('"');
+                    else if (*b == Ch('$')) result += Ch('$');
+                    else if (*b == Ch('\''))result += Ch('\'');
+                    else if (*b == Ch('\\'))result += Ch('\\');
+                    else if (*b == Ch('#')) result += Ch('#');
                     else
                         BOOST_PROPERTY_TREE_THROW(boost::property_tree::file_parser_error(
                             std::string("unknown escape sequence: ") + b,
@@ -635,14 +644,14 @@ namespace detail {
                             boost::property_tree::file_parser_error(
                                 std::string("invalid macro '$' directive: ") + orig_text,
                                 filename, lineno));
-                    result << temp.data().to_string();
+                    result += temp.data().to_string();
                     continue;
                 }
                 else
-                    result << *b;
+                    result += *b;
                 ++b;
             }
-            return result.str();
+            return result;
         }
 
         bool iscomment()            const { return *text == Ch('#'); }
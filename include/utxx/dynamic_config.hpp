@@ -6,6 +6,26 @@
 ///
 /// Allows to maintain a set of persistent parameters for a process that can be
 /// updated by other processes in real-time.
+///
+/// Besides direct access through references returned by bind(), parameters
+/// can be accessed by index with set() and get(). These are versioned:
+/// get() is a torn-free read without locking (per-parameter seqlock), every
+/// set() bumps the version of the parameter and the global generation, and
+/// wait() blocks on a futex in the shared file until a watched parameter
+/// changes:
+/// \code
+///     dynamic_config<> dc("/tmp/params.bin");
+///     int  idx  = dc.find("throttle");
+///     auto mask = dc.watch_mask(idx);
+///     for (auto gen = dc.generation(), ver = dc.version(idx);;) {
+///         dc.wait(mask, gen, 1000);
+///         gen = dc.generation();      // Read before the version
+///         if (dc.version(idx) != ver) {
+///             ver = dc.version(idx);
+///             apply_throttle(dc.get<long>(idx));
+///         }
+///     }
+/// \endcode
 //------------------------------------------------------------------------------
 // Copyright (c) 2010 Serge Aleynikov <saleyn@gmail.com>
 // Created: 2016-08-15
@@ -39,6 +59,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <unordered_map>
 #include <type_traits>
 #include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <utxx/futex.hpp>
 #include <utxx/nchar.hpp>
 #include <utxx/hashmap.hpp>
 #include <utxx/persist_blob.hpp>
@@ -109,6 +132,10 @@ namespace utxx {
         /// @return null if parameter doesn't exist
         const char* name(const void* p) const;
 
+        /// Get index of a parameter by name
+        /// @return -1 if parameter doesn't exist
+        int    find(const char* a_name);
+
         template <class T>
         typename std::enable_if<
             std::is_same<T, long>::value        ||
@@ -118,6 +145,45 @@ namespace utxx {
             typename std::add_lvalue_reference<T>::type>::type
         bind(const char* a_name);
 
+        //----------------------------------------------------------------------
+        // Versioned access by index (values written through references
+        // returned by bind() are not versioned)
+        //----------------------------------------------------------------------
+
+        /// Counter incremented by every set() of any parameter
+        uint32_t generation() const {
+            return m_storage->generation().load(std::memory_order_acquire);
+        }
+
+        /// Number of set() calls of the parameter \a a_idx
+        uint32_t version(int a_idx) const {
+            return m_storage->version(a_idx).load(std::memory_order_acquire) >> 1;
+        }
+
+        /// Read the value of parameter \a a_idx without locking. The
+        /// value is never torn by a concurrent set().
+        template <class T>
+        T    get(int a_idx) const;
+
+        /// Set the value of parameter \a a_idx, increment its version and
+        /// the generation, and wake up the processes waiting for it
+        template <class T>
+        void set(int a_idx, const T& a_value);
+        void set(int a_idx, const char* a_value);
+
+        /// Bit of parameter \a a_idx in the mask passed to wait(). Indexes
+        /// equal modulo 32 share a bit.
+        static uint32_t watch_mask(int a_idx) { return 1u << (a_idx & 31); }
+
+        /// Wait until generation() is different from \a a_generation.
+        /// Only set() of parameters in \a a_mask wakes up the caller, but
+        /// if the generation has already changed, the call returns at once.
+        /// @param a_timeout_ms timeout in milliseconds (-1 means infinity)
+        /// @return SIGNALED, CHANGED (before entering the wait), TIMEDOUT
+        ///         or ERROR
+        wakeup_result wait(uint32_t a_mask, uint32_t a_generation,
+                           long a_timeout_ms = -1);
+
     private:
         using mutex_t        = pthread_mutex_t;
         using lock_guard_t   = std::lock_guard<robust_mutex>;
@@ -153,6 +219,13 @@ namespace utxx {
         /// Add a parameter to storage
         int  add(const char* a_name, dparam_t a_tp);
         void update(bool a_with_lock);
+
+        /// Parameter \a a_idx checked to have type \a a_tp
+        dynamic_param& param(int a_idx, dparam_t a_tp) const;
+
+        /// Seqlock write of parameter \a a_idx by \a a_write() (under lock)
+        template <class F>
+        void write(int a_idx, const F& a_write);
     };
 
     //--------------------------------------------------------------------------
@@ -247,7 +320,7 @@ namespace utxx {
 
         void set(long a_data) { assert(m_type == dparam_t::LONG); *((long*)m_data.data()) = a_data; }
         void set(bool a_data) { assert(m_type == dparam_t::BOOL); *((bool*)m_data.data()) = a_data; }
-        void set(double a_dt) { assert(m_type == dparam_t::BOOL); *((double*)m_data.data()) = a_dt; }
+        void set(double a_dt) { assert(m_type == dparam_t::DOUBLE); *((double*)m_data.data()) = a_dt; }
 
         void set(const std::string& a_data) { set(a_data.c_str(), a_data.size()); }
 
@@ -304,11 +377,36 @@ namespace utxx {
             assert(a_idx < MaxParams);
             return (reinterpret_cast<dynamic_param*>(m_data)+a_idx)->to_addr();
         }
+
+        std::atomic<uint32_t>& generation() {
+            return *reinterpret_cast<std::atomic<uint32_t>*>(&m_generation);
+        }
+        const std::atomic<uint32_t>& generation() const {
+            return *reinterpret_cast<const std::atomic<uint32_t>*>(&m_generation);
+        }
+
+        std::atomic<uint32_t>& waiters() {
+            return *reinterpret_cast<std::atomic<uint32_t>*>(&m_waiters);
+        }
+
+        /// Seqlock sequence of a parameter (odd while being written)
+        std::atomic<uint32_t>& version(uint a_idx) {
+            assert(a_idx < MaxParams);
+            return *reinterpret_cast<std::atomic<uint32_t>*>(&m_versions[a_idx]);
+        }
+        const std::atomic<uint32_t>& version(uint a_idx) const {
+            assert(a_idx < MaxParams);
+            return *reinterpret_cast<const std::atomic<uint32_t>*>(&m_versions[a_idx]);
+        }
     private:
-        mutex_t m_mutex;
-        size_t  m_count;
-        name_t  m_names[MaxParams];
-        char    m_data[0];
+        mutex_t  m_mutex;
+        size_t   m_count;
+        uint32_t m_generation;              // Futex word waited on by wait()
+        uint32_t m_waiters;                 // Number of callers of wait()
+        uint32_t m_versions[MaxParams];
+        name_t   m_names[MaxParams];
+        alignas(UTXX_CL_SIZE)
+        char     m_data[MaxParams * sizeof(dynamic_param)];
     };
 
     //==========================================================================
@@ -372,6 +470,15 @@ namespace utxx {
         return it == m_by_addr.end() ? nullptr : m_storage->name(it->second);
     }
 
+    template <int MaxParams>
+    int dynamic_config<MaxParams>
+    ::find(const char* a_name) {
+        update();
+        auto   nm =  to_name(a_name);
+        auto   it =  m_by_name.find(nm.c_str());
+        return it == m_by_name.end() ? -1 : it->second;
+    }
+
     template <int MaxParams>
     template <class T>
     typename std::enable_if<
@@ -431,12 +538,104 @@ namespace utxx {
         if (a_with_lock) g.lock();
 
         for (auto i = m_last_seen_count; i < n; ++i) {
-            const char* p = m_storage->name(i);
-            m_by_name.emplace(std::make_pair(p, i));
-            m_by_addr.emplace(std::make_pair(p, i));
+            m_by_name.emplace(std::make_pair(m_storage->name(i), i));
+            m_by_addr.emplace(std::make_pair(m_storage->data(i), i));
         }
         
         m_last_seen_count = n;
     }
 
+    template <int MaxParams>
+    dynamic_param& dynamic_config<MaxParams>
+    ::param(int a_idx, dparam_t a_tp) const {
+        auto& st = const_cast<storage_t&>(m_storage).dirty_get();
+        if (a_idx < 0 || size_t(a_idx) >= count() || st.get(a_idx).type() != a_tp)
+            UTXX_THROW_BADARG_ERROR("Invalid parameter #", a_idx, " or its type");
+        return st.get(a_idx);
+    }
+
+    template <int MaxParams>
+    template <class T>
+    T dynamic_config<MaxParams>
+    ::get(int a_idx) const {
+        static T* dummy;
+        auto& prm = param(a_idx, type(dummy));
+        auto& seq = m_storage->version(a_idx);
+        T res;
+        while (true) {
+            auto n = seq.load(std::memory_order_acquire);
+            if (!(n & 1)) {
+                memcpy(&res, prm.to_addr(), sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq.load(std::memory_order_relaxed) == n)
+                    return res;
+            }
+            sched_yield();
+        }
+    }
+
+    template <int MaxParams>
+    template <class F>
+    void dynamic_config<MaxParams>
+    ::write(int a_idx, const F& a_write) {
+        auto& seq = m_storage->version(a_idx);
+        auto  n   = seq.load(std::memory_order_relaxed);
+        // A writer that died between the two stores below (the robust
+        // mutex is then recovered) left the sequence odd: round it up
+        n += n & 1;
+        seq.store(n+1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        a_write();
+        seq.store(n+2, std::memory_order_release);
+
+        // Sequentially consistent increment and load pair with the ones in
+        // wait(), so that either the waiter sees the new generation, or the
+        // writer sees the waiter (the counter is only a hint that avoids a
+        // system call when nobody waits)
+        auto& gen = m_storage->generation();
+        gen.fetch_add(1);
+        if (m_storage->waiters().load())
+            futex_wake_bitset(reinterpret_cast<int*>(&gen), watch_mask(a_idx));
+    }
+
+    template <int MaxParams>
+    template <class T>
+    void dynamic_config<MaxParams>
+    ::set(int a_idx, const T& a_value) {
+        static T* dummy;
+        lock_guard_t g(m_mutex);
+        auto& prm = param(a_idx, type(dummy));
+        write(a_idx, [&]() { memcpy(prm.to_addr(), &a_value, sizeof(T)); });
+    }
+
+    template <int MaxParams>
+    void dynamic_config<MaxParams>
+    ::set(int a_idx, const char* a_value) {
+        lock_guard_t g(m_mutex);
+        auto& prm = param(a_idx, dparam_t::STR);
+        write(a_idx, [&]() { prm.set(a_value, strlen(a_value)); });
+    }
+
+    template <int MaxParams>
+    wakeup_result dynamic_config<MaxParams>
+    ::wait(uint32_t a_mask, uint32_t a_generation, long a_timeout_ms) {
+        struct timespec ts, *pts = nullptr;
+        if (a_timeout_ms >= 0) {
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            ts.tv_sec  += a_timeout_ms / 1000;
+            ts.tv_nsec += a_timeout_ms % 1000 * 1000000;
+            if (ts.tv_nsec >= 1000000000) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000;
+            }
+            pts = &ts;
+        }
+        auto& waiters = m_storage->waiters();
+        waiters.fetch_add(1);
+        auto res = futex_wait_bitset(reinterpret_cast<int*>(&m_storage->generation()),
+                                     int(a_generation), a_mask, pts);
+        waiters.fetch_sub(1);
+        return res;
+    }
+
 } // namespace utxx
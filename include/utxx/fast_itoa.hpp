@@ -16,6 +16,7 @@
 #include <emmintrin.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef _MSC_VER
 #define ALIGN_PRE __declspec(align(16))
@@ -142,6 +143,10 @@ public:
     static char* i32toa(int32_t  value, char* buffer);
     static char* u64toa(uint64_t value, char* buffer);
     static char* i64toa(int64_t  value, char* buffer);
+
+    /// Write exactly \a width (1..9) digits of \a value padded with leading
+    /// zeros. The buffer is not NULL-terminated.
+    static char* u32toa_fixed(uint32_t value, char* buffer, unsigned width);
 };
 
 inline char* sse::u32toa(uint32_t value, char* buffer) {
@@ -375,6 +380,22 @@ inline char* sse::i64toa(int64_t value, char* buffer) {
     return sse::u64toa(u, buffer);
 }
 
+inline char* sse::u32toa_fixed(uint32_t value, char* buffer, unsigned width) {
+    assert(width > 0 && width <= 9 && value <= 999999999);
+    if (width == 9) {
+        const uint32_t a = value / 100000000;
+        *buffer++ = '0' + static_cast<char>(a);
+        value    -= a * 100000000;
+        width     = 8;
+    }
+    const __m128i b  = convert8digits(value);
+    const __m128i ba = _mm_add_epi8(_mm_packus_epi16(b, _mm_setzero_si128()), reinterpret_cast<const __m128i*>(ascii_zero())[0]);
+    ALIGN_PRE char tmp[16] ALIGN_SUF;
+    _mm_store_si128(reinterpret_cast<__m128i*>(tmp), ba);
+    memcpy(buffer, tmp + 8 - width, width);
+    return buffer + width;
+}
+
 template <typename T>
 inline char* fast_itoa(T value, char* buffer) {
     return std::numeric_limits<T>::is_signed
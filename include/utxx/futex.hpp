@@ -37,6 +37,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #if __cplusplus >= 201103L
 
 #include <limits.h>
+#include <stdint.h>
 #include <errno.h>
 #include <chrono>
 #include <atomic>
@@ -69,6 +70,18 @@ wakeup_result futex_wait_slow(int* old, int val, const timespec* rel = 0);
 /// @return 0 on success and -1 on error.
 int           futex_wake_slow(int* value, int count = 1);
 
+/// Same as futex_wait_slow(), but the caller is only woken up by
+/// futex_wake_bitset() calls with a \a mask intersecting \a a_mask.
+/// The futex is not process-private, so \a old may be in shared memory.
+/// @param abs absolute CLOCK_MONOTONIC timeout (NULL means infinity)
+wakeup_result futex_wait_bitset(int* old, int val, uint32_t a_mask,
+                                const timespec* abs = 0);
+
+/// Wake up \a count waiters of the futex \a value whose wait mask
+/// intersects \a a_mask. Note: function loops on EINTR.
+/// @return number of woken up waiters or -1 on error.
+int           futex_wake_bitset(int* value, uint32_t a_mask, int count = INT_MAX);
+
 /** Fast futex-based concurrent notification primitive.
  * Supports signal/wait semantics.
  */
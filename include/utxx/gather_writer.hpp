@@ -0,0 +1,244 @@
+//----------------------------------------------------------------------------
+/// \file   gather_writer.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Zero-copy scatter/gather builder of outgoing messages.
+///
+/// Messages are composed of small pieces (e.g. headers) copied to an
+/// internal arena and of references to payloads owned by someone else
+/// (e.g. a market snapshot shared by many client connections). The pieces
+/// are kept in a fixed-capacity iovec array, so that everything queued is
+/// written with a single writev(2)/sendmsg(2) call per flush. After a
+/// partial write the remaining data is written by the next flush without
+/// copying. Refcounted payloads (shared_const_buffer) are held until they
+/// are completely written.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/shared_buffer_queue.hpp>
+#include <utxx/compiler_hints.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/assert.hpp>
+#include <algorithm>
+#include <utility>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Builder of outgoing data with fixed capacity of \a MaxIov iovec entries
+/// and \a ArenaSize bytes of copied data.
+///
+/// The append functions return false if the data doesn't fit, in which case
+/// the caller should flush() the writer first. Adjacent pieces copied to the
+/// arena are coalesced into a single iovec entry. The arena space is reused
+/// once all queued data has been written.
+///
+/// Example of fanning out a snapshot to many clients:
+/// \code
+///   shared_const_buffer snap(boost::asio::buffer(data, size), deleter);
+///   for (auto& c : clients) {
+///       c.writer.append(&c.header, sizeof(c.header));
+///       c.writer.append(snap);          // Only the refcount is incremented
+///       c.writer.flush(c.fd);
+///   }
+/// \endcode
+//-----------------------------------------------------------------------------
+template <size_t MaxIov = 64, size_t ArenaSize = 4096>
+class basic_gather_writer : boost::noncopyable {
+    static_assert(MaxIov > 0 && MaxIov <= IOV_MAX, "Invalid number of iovecs");
+
+    iovec               m_iov [MaxIov];
+    shared_const_buffer m_refs[MaxIov];   ///< Owners of referenced payloads
+    size_t              m_head;           ///< Index of the first unwritten iovec
+    size_t              m_tail;           ///< Index past the last iovec
+    size_t              m_pending;        ///< Total number of unwritten bytes
+    size_t              m_used;           ///< Number of arena bytes used
+    char                m_arena[ArenaSize];
+
+    /// Make room for one more iovec at the tail
+    bool make_room() {
+        if (likely(m_tail < MaxIov))
+            return true;
+        if (!m_head)
+            return false;
+        // Move the unwritten entries (not the data) to the beginning
+        size_t n = m_tail - m_head;
+        memmove(m_iov, m_iov + m_head, n * sizeof(iovec));
+        std::move(m_refs + m_head, m_refs + m_tail, m_refs);
+        std::fill(m_refs + n, m_refs + m_tail, shared_const_buffer());
+        m_head = 0;
+        m_tail = n;
+        return true;
+    }
+
+    void push(const void* a_data, size_t a_size) {
+        m_iov[m_tail].iov_base = const_cast<void*>(a_data);
+        m_iov[m_tail].iov_len  = a_size;
+        ++m_tail;
+        m_pending += a_size;
+    }
+
+    /// The last iovec entry ends at the current arena position
+    bool arena_tail() const {
+        return m_tail > m_head
+            && static_cast<char*>(m_iov[m_tail-1].iov_base) +
+               m_iov[m_tail-1].iov_len == m_arena + m_used;
+    }
+
+public:
+    static constexpr size_t max_iovecs()    { return MaxIov;    }
+    static constexpr size_t arena_size()    { return ArenaSize; }
+
+    basic_gather_writer() : m_head(0), m_tail(0), m_pending(0), m_used(0) {}
+
+    /// Number of bytes queued and not written yet
+    size_t pending()        const { return m_pending;         }
+    /// Number of iovec entries queued and not written yet
+    size_t iovcnt()         const { return m_tail - m_head;   }
+    /// Pointer to the first unwritten iovec entry
+    const iovec* iov()      const { return m_iov + m_head;    }
+    bool   empty()          const { return !m_pending;        }
+    /// Number of free bytes in the arena
+    size_t arena_capacity() const { return ArenaSize - m_used; }
+
+    /// Allocate \a a_size bytes in the arena for the caller to fill in.
+    /// The data is queued right away.
+    /// @return pointer to the space or NULL if it doesn't fit
+    char* alloc(size_t a_size) {
+        if (unlikely(a_size > arena_capacity()))
+            return nullptr;
+        char* p = m_arena + m_used;
+        if (unlikely(!a_size))
+            return p;
+        if (arena_tail()) {
+            m_iov[m_tail-1].iov_len += a_size;
+            m_pending += a_size;
+        } else if (make_room())
+            push(p, a_size);
+        else
+            return nullptr;
+        m_used += a_size;
+        return p;
+    }
+
+    /// Copy \a a_size bytes to the arena and queue them
+    bool append(const void* a_data, size_t a_size) {
+        char* p = alloc(a_size);
+        if (unlikely(!p))
+            return false;
+        memcpy(p, a_data, a_size);
+        return true;
+    }
+
+    /// Queue a reference to a payload that must stay valid until written
+    bool append(const boost::asio::const_buffer& a_buf) {
+        auto n = boost::asio::buffer_size(a_buf);
+        if (!n)
+            return true;
+        if (unlikely(!make_room()))
+            return false;
+        push(boost::asio::buffer_cast<const char*>(a_buf), n);
+        return true;
+    }
+
+    /// Queue a refcounted payload that is released after it is written
+    bool append(const shared_const_buffer& a_buf) {
+        auto n = boost::asio::buffer_size(a_buf);
+        if (!n)
+            return true;
+        if (unlikely(!make_room()))
+            return false;
+        m_refs[m_tail] = a_buf;
+        push(boost::asio::buffer_cast<const char*>(a_buf), n);
+        return true;
+    }
+
+    /// Mark \a a_size bytes at the head of the queue as written. Used when
+    /// writing the iov() entries to a transport other than a file descriptor.
+    void consume(size_t a_size) {
+        BOOST_ASSERT(a_size <= m_pending);
+        m_pending -= a_size;
+        for (; m_head < m_tail && a_size >= m_iov[m_head].iov_len; ++m_head) {
+            a_size -= m_iov[m_head].iov_len;
+            m_refs[m_head] = shared_const_buffer();
+        }
+        if (a_size) {
+            m_iov[m_head].iov_base = static_cast<char*>(m_iov[m_head].iov_base) + a_size;
+            m_iov[m_head].iov_len -= a_size;
+        } else if (m_head == m_tail)
+            m_head = m_tail = m_used = 0;
+    }
+
+    /// Discard all queued data
+    void clear() { consume(m_pending); }
+
+    /// Write queued data to \a a_fd with a single writev(2) call.
+    /// @return number of bytes written (0 if the descriptor is not writable)
+    ///         or -1 on error, in which case errno is set
+    ssize_t flush(int a_fd) {
+        if (empty())
+            return 0;
+        ssize_t n;
+        do n = ::writev(a_fd, iov(), iovcnt()); while (n < 0 && errno == EINTR);
+        return done(n);
+    }
+
+    /// Write queued data to socket \a a_fd with a single sendmsg(2) call.
+    /// @return number of bytes written (0 if the socket is not writable)
+    ///         or -1 on error, in which case errno is set
+    ssize_t send(int a_fd, int a_flags = MSG_NOSIGNAL) {
+        if (empty())
+            return 0;
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov    = m_iov + m_head;
+        msg.msg_iovlen = iovcnt();
+        ssize_t n;
+        do n = ::sendmsg(a_fd, &msg, a_flags); while (n < 0 && errno == EINTR);
+        return done(n);
+    }
+
+private:
+    ssize_t done(ssize_t a_res) {
+        if (a_res >= 0)
+            consume(a_res);
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        return a_res;
+    }
+};
+
+typedef basic_gather_writer<> gather_writer;
+
+} // namespace utxx
@@ -0,0 +1,340 @@
+//----------------------------------------------------------------------------
+/// \file   gcra_throttle.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Lock-free token bucket rate limiters based on the Generic Cell
+/// Rate Algorithm (GCRA).
+///
+/// GCRA keeps a single "theoretical arrival time" (TAT) per limit instead
+/// of a token counter refilled on a timer. A request for N permits at time
+/// "now" is granted if:
+///     max(TAT, now) + N*interval - burst*interval <= now
+/// in which case TAT advances by N*interval. The state is one atomic
+/// integer updated with compare-and-swap, so a limiter can be shared
+/// between threads without locking.
+///
+/// Time is measured in ticks of a Clock policy: gcra_nsec_clock (real time
+/// in nanoseconds) or gcra_tsc_clock (CPU time stamp counter).
+///
+/// This file implements:
+///   - gcra_cell            - the limit's state and algorithm;
+///   - basic_gcra_throttle  - a single limiter;
+///   - basic_gcra_table     - a flat open-addressing table of limiters
+///                            keyed by integers (e.g. per session or per
+///                            message type);
+///   - gcra_consume_all()   - hierarchical limits (e.g. per account within
+///                            per venue) granted all-or-nothing.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/error.hpp>
+#include <utxx/hashmap.hpp>
+#include <utxx/tick_clock.hpp>
+#include <utxx/compiler_hints.hpp>
+#include <initializer_list>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdlib.h>
+
+namespace utxx {
+
+/// Clocks of GCRA limiters (see tick_clock.hpp). high_res_timer::calibrate()
+/// must be called before creating limiters using gcra_tsc_clock.
+typedef nsec_clock gcra_nsec_clock;
+typedef tsc_clock  gcra_tsc_clock;
+
+//-----------------------------------------------------------------------------
+/// State of a GCRA limit: theoretical arrival time and the limit's
+/// parameters in clock ticks.
+//-----------------------------------------------------------------------------
+class gcra_cell {
+    std::atomic<long> m_tat;
+    std::atomic<long> m_interval;   ///< Ticks per permit
+    std::atomic<long> m_tolerance;  ///< burst * m_interval
+public:
+    gcra_cell() : m_tat(0), m_interval(1), m_tolerance(1) {}
+    gcra_cell(long a_interval, long a_burst) : m_tat(0), m_interval(1), m_tolerance(1) {
+        limit(a_interval, a_burst);
+    }
+
+    gcra_cell(const gcra_cell& a)
+        : m_tat(a.m_tat.load(std::memory_order_relaxed))
+        , m_interval(a.interval()), m_tolerance(a.tolerance())
+    {}
+
+    /// Set the limit: one permit per \a a_interval ticks with up to
+    /// \a a_burst permits granted at once. The limit can be changed while
+    /// other threads use the cell, in which case a concurrent consume()
+    /// may combine the old interval with the new burst or vice versa.
+    void limit(long a_interval, long a_burst) {
+        if (a_interval <= 0 || a_burst <= 0)
+            UTXX_THROW_BADARG_ERROR("gcra_cell: invalid interval/burst: ",
+                                    a_interval, '/', a_burst);
+        m_interval.store (a_interval,           std::memory_order_relaxed);
+        m_tolerance.store(a_interval * a_burst, std::memory_order_relaxed);
+    }
+
+    long interval()  const { return m_interval.load(std::memory_order_relaxed);  }
+    long tolerance() const { return m_tolerance.load(std::memory_order_relaxed); }
+    long burst()     const { return std::max(1l, tolerance() / interval());      }
+    long tat()       const { return m_tat.load(std::memory_order_relaxed);       }
+
+    void reset()           { m_tat.store(0, std::memory_order_relaxed); }
+
+    /// Try to take \a a_n permits at time \a a_now.
+    /// @return 0 if granted, or the number of ticks until they can be granted
+    long consume(long a_now, unsigned a_n = 1) {
+        long inc = a_n * interval();
+        long tol = tolerance();
+        long tat = m_tat.load(std::memory_order_relaxed);
+        while (true) {
+            long next = std::max(tat, a_now) + inc;
+            long wait = next - tol - a_now;
+            if (wait > 0)
+                return wait;
+            if (m_tat.compare_exchange_weak(tat, next, std::memory_order_acq_rel,
+                                                       std::memory_order_relaxed))
+                return 0;
+        }
+    }
+
+    /// Return \a a_n permits taken by a successful consume()
+    void refund(unsigned a_n = 1) {
+        m_tat.fetch_sub(a_n * interval(), std::memory_order_acq_rel);
+    }
+
+    /// Ticks until \a a_n permits can be granted (0 if now)
+    long wait(long a_now, unsigned a_n = 1) const {
+        long next = std::max(tat(), a_now) + a_n * interval();
+        return std::max(0l, next - tolerance() - a_now);
+    }
+
+    /// Number of permits that can be granted at \a a_now
+    long available(long a_now) const {
+        return (a_now + tolerance() - std::max(tat(), a_now)) / interval();
+    }
+};
+
+//-----------------------------------------------------------------------------
+/// Rate limiter granting \a rate permits per \a window with a given burst.
+//-----------------------------------------------------------------------------
+template <class Clock = gcra_nsec_clock>
+class basic_gcra_throttle {
+    gcra_cell m_cell;
+public:
+    using clock = Clock;
+
+    /// @param a_rate   number of permits per \a a_window
+    /// @param a_window the rate's time window (e.g. msecs(1), secs(1))
+    /// @param a_burst  max permits granted at once (0 means \a a_rate)
+    basic_gcra_throttle(unsigned a_rate, time_val a_window, unsigned a_burst = 0)
+        : m_cell(interval(a_rate, a_window), a_burst ? a_burst : a_rate)
+    {}
+
+    /// Ticks per permit for \a a_rate permits per \a a_window
+    static long interval(unsigned a_rate, time_val a_window) {
+        if (!a_rate)
+            UTXX_THROW_BADARG_ERROR("gcra_throttle: zero rate");
+        return std::max(1l, Clock::ticks(a_window.nanoseconds()) / long(a_rate));
+    }
+
+    /// Try to take \a a_n permits.
+    bool try_acquire(unsigned a_n = 1, long a_now = Clock::now()) {
+        return m_cell.consume(a_now, a_n) == 0;
+    }
+
+    /// Try to take \a a_n permits.
+    /// @return 0 if granted, or the number of ticks until they can be granted
+    long consume(unsigned a_n = 1, long a_now = Clock::now()) {
+        return m_cell.consume(a_now, a_n);
+    }
+
+    /// Return \a a_n permits taken by a successful try_acquire()
+    void refund(unsigned a_n = 1) { m_cell.refund(a_n); }
+
+    /// Time until \a a_n permits can be granted (0 if now)
+    time_val wait_time(unsigned a_n = 1, long a_now = Clock::now()) const {
+        return nsecs(Clock::nsec(m_cell.wait(a_now, a_n)));
+    }
+
+    /// Number of permits that can be granted now
+    long available(long a_now = Clock::now()) const { return m_cell.available(a_now); }
+
+    long burst()    const { return m_cell.burst(); }
+    void reset()          { m_cell.reset();        }
+
+    gcra_cell&       cell()       { return m_cell; }
+    const gcra_cell& cell() const { return m_cell; }
+};
+
+using gcra_throttle = basic_gcra_throttle<>;
+
+//-----------------------------------------------------------------------------
+/// Flat table of rate limiters keyed by non-zero 64-bit integers.
+//-----------------------------------------------------------------------------
+/// Limiters are created on first use with the table's default limit, or
+/// with set_limit(). Lookup and creation are lock-free (linear probing
+/// with a compare-and-swap of the key), so the table can be shared between
+/// threads. Entries are never removed; the capacity is fixed at
+/// construction.
+template <class Clock = gcra_nsec_clock>
+class basic_gcra_table {
+    struct alignas(32) slot {
+        std::atomic<uint64_t> key;
+        gcra_cell             cell;
+    };
+
+    // Slots are over-aligned, which operator new doesn't honor before C++17
+    struct free_slots { void operator()(slot* p) const { ::free(p); } };
+
+    size_t                              m_mask;
+    std::unique_ptr<slot[], free_slots> m_slots;
+    std::atomic<size_t>                 m_size;
+public:
+    using clock = Clock;
+
+    /// @param a_capacity max number of keys (rounded up to a power of 2
+    ///                   at least twice as large)
+    /// @param a_rate     default number of permits per \a a_window
+    /// @param a_window   default rate's time window
+    /// @param a_burst    default burst (0 means \a a_rate)
+    basic_gcra_table(size_t a_capacity, unsigned a_rate, time_val a_window,
+                     unsigned a_burst = 0)
+        : m_size(0)
+    {
+        size_t n = 16;
+        while (n < 2*a_capacity) n <<= 1;
+        m_mask  = n-1;
+        auto interval = basic_gcra_throttle<Clock>::interval(a_rate, a_window);
+        void* p;
+        if (posix_memalign(&p, alignof(slot), n * sizeof(slot)) != 0)
+            throw std::bad_alloc();
+        m_slots.reset(static_cast<slot*>(p));
+        for (size_t i=0; i < n; ++i) {
+            new (&m_slots[i]) slot();
+            m_slots[i].key.store(0, std::memory_order_relaxed);
+            m_slots[i].cell.limit(interval, a_burst ? a_burst : a_rate);
+        }
+    }
+
+    size_t capacity() const { return m_mask+1; }
+    size_t size()     const { return m_size.load(std::memory_order_relaxed); }
+
+    /// Find the limiter of \a a_key.
+    /// @return NULL if the key is not in the table
+    gcra_cell* find(uint64_t a_key) {
+        assert(a_key);
+        size_t i = detail::hash_int64(a_key);
+        for (size_t n = 0; n <= m_mask; ++n, ++i) {
+            auto& s = m_slots[i & m_mask];
+            auto  k = s.key.load(std::memory_order_acquire);
+            if (k == a_key) return &s.cell;
+            if (k == 0)     return nullptr;
+        }
+        return nullptr;
+    }
+
+    /// Find the limiter of \a a_key, creating it with the default limit.
+    /// Throws runtime_error when the table is full.
+    gcra_cell& get(uint64_t a_key) {
+        assert(a_key);
+        size_t i = detail::hash_int64(a_key);
+        for (size_t n = 0; n <= m_mask; ++n, ++i) {
+            auto& s = m_slots[i & m_mask];
+            auto  k = s.key.load(std::memory_order_acquire);
+            if (likely(k == a_key))
+                return s.cell;
+            if (k == 0) {
+                if (s.key.compare_exchange_strong(k, a_key, std::memory_order_acq_rel)) {
+                    m_size.fetch_add(1, std::memory_order_relaxed);
+                    return s.cell;
+                }
+                if (k == a_key)
+                    return s.cell;
+            }
+        }
+        UTXX_THROW_RUNTIME_ERROR("gcra_table: table is full (capacity=", capacity(), ')');
+    }
+
+    /// Set the limit of \a a_key. A new key uses the default limit until
+    /// the call completes.
+    gcra_cell& set_limit(uint64_t a_key, unsigned a_rate, time_val a_window,
+                         unsigned a_burst = 0) {
+        auto& c = get(a_key);
+        c.limit(basic_gcra_throttle<Clock>::interval(a_rate, a_window),
+                a_burst ? a_burst : a_rate);
+        return c;
+    }
+
+    /// Try to take \a a_n permits of \a a_key.
+    bool try_acquire(uint64_t a_key, unsigned a_n = 1, long a_now = Clock::now()) {
+        return get(a_key).consume(a_now, a_n) == 0;
+    }
+
+    /// Try to take \a a_n permits of \a a_key.
+    /// @return 0 if granted, or the number of ticks until they can be granted
+    long consume(uint64_t a_key, unsigned a_n = 1, long a_now = Clock::now()) {
+        return get(a_key).consume(a_now, a_n);
+    }
+
+    /// Time until \a a_n permits of \a a_key can be granted (0 if now)
+    time_val wait_time(uint64_t a_key, unsigned a_n = 1, long a_now = Clock::now()) {
+        auto c = find(a_key);
+        return c ? nsecs(Clock::nsec(c->wait(a_now, a_n))) : time_val();
+    }
+};
+
+using gcra_table = basic_gcra_table<>;
+
+//-----------------------------------------------------------------------------
+/// Take \a a_n permits from all \a a_cells or from none of them.
+/// Used for hierarchical limits, e.g. {account, venue}: a rejection by a
+/// parent limit refunds the permits taken from its children.
+/// @return 0 if granted, or the number of ticks until all of the limits
+///         could grant the permits
+//-----------------------------------------------------------------------------
+inline long gcra_consume_all(long a_now, unsigned a_n,
+                             std::initializer_list<gcra_cell*> a_cells)
+{
+    for (auto it = a_cells.begin(), e = a_cells.end(); it != e; ++it) {
+        long wait = (*it)->consume(a_now, a_n);
+        if (likely(!wait))
+            continue;
+        for (auto p = a_cells.begin(); p != it; ++p)
+            (*p)->refund(a_n);
+        for (auto p = it+1; p != e; ++p)
+            wait = std::max(wait, (*p)->wait(a_now, a_n));
+        return wait;
+    }
+    return 0;
+}
+
+} // namespace utxx
@@ -34,44 +34,74 @@
 // standard C++ with new header file names and std:: namespace
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <zlib.h>
 #include <assert.h>
 
 namespace utxx   {
+
+namespace detail { class gzparallel; }
+
+//------------------------------------------------------------------------------
+/// Options of opening a gzstream.
+//------------------------------------------------------------------------------
+struct gzopts {
+    /// Compression level (0-9, or Z_DEFAULT_COMPRESSION)
+    int      level;
+    /// When non-zero, output is split into blocks of \a block_size bytes that
+    /// are compressed on a pool of this many threads (pigz-style). The
+    /// result is a single gzip member, with each block's deflate stream
+    /// primed with the last 32K of the previous block, so the compression
+    /// ratio is close to that of a serial stream. Ignored for input.
+    unsigned threads;
+    /// Size of a block compressed by one thread
+    size_t   block_size;
+    /// Size of the stream buffer of a serial stream. Large buffers (e.g.
+    /// 1M) mean fewer, larger reads and writes. On input zlib's buffer is
+    /// made half this size, so that zlib inflates directly into the stream
+    /// buffer instead of copying out of its own.
+    size_t   buffer_size;
+
+    explicit gzopts(int a_level = Z_DEFAULT_COMPRESSION, unsigned a_threads = 0,
+                    size_t a_block_size = 128*1024, size_t a_buffer_size = 8*1024)
+        : level(a_level), threads(a_threads)
+        , block_size(a_block_size), buffer_size(a_buffer_size)
+    {}
+};
 //------------------------------------------------------------------------------
 // Internal classes to implement gzstream. See below for user classes.
 //------------------------------------------------------------------------------
 
 class gzstreambuf : public std::streambuf {
 private:
-    static const int bufferSize = 1024*8;// size of data buff
+    static const int defaultBufferSize = 1024*8;
 
     gzFile           file;               // file handle for compressed file
-    char             buffer[bufferSize]; // data buffer
+    std::unique_ptr<char[]> buffer;      // data buffer
+    int              bufferSize;         // size of data buffer
     char             opened;             // open/close state of stream
     int              mode;               // I/O mode
+    std::unique_ptr<detail::gzparallel> par; // parallel compressor
 
-    int flush_buffer();
+    int  flush_buffer();
+    void init_buffer(int size);
 public:
-    gzstreambuf() : opened(0) {
-        setp( buffer, buffer + (bufferSize-1));
-        setg( buffer + 4,     // beginning of putback area
-              buffer + 4,     // read position
-              buffer + 4);    // end position
-        // ASSERT: both input & output capabilities will not be used together
-    }
+    gzstreambuf();
+    ~gzstreambuf();
+
     int is_open() { return opened; }
-    gzstreambuf* open(const char* name, int mode);
-    gzstreambuf* open(const std::string& name, int mode) {
-        return open(name.c_str(), mode);
+    gzstreambuf* open(const char* name, int mode, const gzopts& opts = gzopts());
+    gzstreambuf* open(const std::string& name, int mode,
+                      const gzopts& opts = gzopts()) {
+        return open(name.c_str(), mode, opts);
     }
     gzstreambuf* close();
-    ~gzstreambuf() { close(); }
 
     virtual int  overflow(int c = EOF);
     virtual int  underflow();
     virtual int  sync();
 
+    /// Handle of the zlib file (nullptr for parallel compression)
     gzFile native_handle() { return file; }
 };
 
@@ -81,12 +111,15 @@ namespace detail {
         gzstreambuf  buf;
     public:
         gzstreambase() { init(&buf); }
-        gzstreambase(const char* name, int mode);
-        gzstreambase(const std::string& name, int mode)
-            : gzstreambase(name.c_str(), mode) {}
+        gzstreambase(const char* name, int mode, const gzopts& opts = gzopts());
+        gzstreambase(const std::string& name, int mode,
+                     const gzopts& opts = gzopts())
+            : gzstreambase(name.c_str(), mode, opts) {}
         ~gzstreambase();
-        void open(const char* name, int mode);
-        void open(const std::string& name, int mode) { open(name.c_str(), mode); }
+        void open(const char* name, int mode, const gzopts& opts = gzopts());
+        void open(const std::string& name, int mode, const gzopts& opts = gzopts()) {
+            open(name.c_str(), mode, opts);
+        }
         void close();
         gzstreambuf* rdbuf() { return &buf; }
     };
@@ -96,37 +129,48 @@ namespace detail {
 // User classes. Use igzstream and ogzstream analogously to ifstream and
 // ofstream respectively. They read and write files based on the gz*
 // function interface of the zlib. Files are compatible with gzip compression.
+// Pass gzopts to ogzstream to compress on multiple threads, or to igzstream
+// to decompress with large buffers, e.g.:
+//     ogzstream out("capture.gz", std::ios::out, gzopts(6, 8));
 //------------------------------------------------------------------------------
 
 class igzstream : public detail::gzstreambase, public std::istream {
 public:
     igzstream() : std::istream( &buf) {}
-    igzstream(const char* name, int mode = std::ios::in)
-        : detail::gzstreambase(name, mode), std::istream(&buf) {}
-    igzstream(const std::string& name, int mode = std::ios::in)
-        : detail::gzstreambase(name, mode), std::istream(&buf) {}
+    igzstream(const char* name, int mode = std::ios::in,
+              const gzopts& opts = gzopts())
+        : detail::gzstreambase(name, mode, opts), std::istream(&buf) {}
+    igzstream(const std::string& name, int mode = std::ios::in,
+              const gzopts& opts = gzopts())
+        : detail::gzstreambase(name, mode, opts), std::istream(&buf) {}
     gzstreambuf* rdbuf() { return gzstreambase::rdbuf(); }
-    void open(const char* name, int open_mode = std::ios::in) {
-        detail::gzstreambase::open(name, open_mode);
+    void open(const char* name, int open_mode = std::ios::in,
+              const gzopts& opts = gzopts()) {
+        detail::gzstreambase::open(name, open_mode, opts);
     }
-    void open(const std::string& name, int mode = std::ios::in) {
-        detail::gzstreambase::open(name, mode);
+    void open(const std::string& name, int mode = std::ios::in,
+              const gzopts& opts = gzopts()) {
+        detail::gzstreambase::open(name, mode, opts);
     }
 };
 
 class ogzstream : public detail::gzstreambase, public std::ostream {
 public:
     ogzstream() : std::ostream( &buf) {}
-    ogzstream(const char* name, int mode = std::ios::out)
-        : detail::gzstreambase(name, mode), std::ostream( &buf) {}
-    ogzstream(const std::string& name, int mode = std::ios::out)
-        : detail::gzstreambase(name, mode), std::ostream(&buf) {}
+    ogzstream(const char* name, int mode = std::ios::out,
+              const gzopts& opts = gzopts())
+        : detail::gzstreambase(name, mode, opts), std::ostream( &buf) {}
+    ogzstream(const std::string& name, int mode = std::ios::out,
+              const gzopts& opts = gzopts())
+        : detail::gzstreambase(name, mode, opts), std::ostream(&buf) {}
     gzstreambuf* rdbuf() { return gzstreambase::rdbuf(); }
-    void open(const char* name, int mode = std::ios::out) {
-        detail::gzstreambase::open(name, mode);
+    void open(const char* name, int mode = std::ios::out,
+              const gzopts& opts = gzopts()) {
+        detail::gzstreambase::open(name, mode, opts);
     }
-    void open(const std::string& name, int mode = std::ios::out) {
-        detail::gzstreambase::open(name, mode);
+    void open(const std::string& name, int mode = std::ios::out,
+              const gzopts& opts = gzopts()) {
+        detail::gzstreambase::open(name, mode, opts);
     }
 };
 
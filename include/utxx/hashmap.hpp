@@ -1,7 +1,8 @@
 //----------------------------------------------------------------------------
 /// \file  hashmap.hpp
 //----------------------------------------------------------------------------
-/// \brief Abstraction of boost and std unordered_map.
+/// \brief Abstraction of boost and std unordered_map and an open-addressing
+///        flat hash map.
 //----------------------------------------------------------------------------
 // Copyright (C) 2009 Serge Aleynikov <saleyn@gmail.com>
 // Created: 2009-09-10
@@ -40,9 +41,25 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <limits.h>
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 #include <utxx/compiler_hints.hpp>
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+#ifdef __SSE4_2__
+#  include <nmmintrin.h>
+#endif
 
 namespace utxx {
+    template <size_t Size> class basic_short_name;
+    class name_t;
+
     struct hash_pair {
     template <typename T, typename U>
         std::size_t operator()(const std::pair<T, U> &x) const {
@@ -216,21 +233,247 @@ namespace detail {
         return h;
     } 
 
+    //-----------------------------------------------------------------------------
+    // CRC32C (Castagnoli) using the SSE4.2 crc32 instruction when available
+    //-----------------------------------------------------------------------------
+    struct crc32c_table {
+        uint32_t data[256];
+        crc32c_table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                    c = (c >> 1) ^ (0x82F63B78 & (0 - (c & 1)));
+                data[i] = c;
+            }
+        }
+    };
+
+    inline uint32_t crc32c_hash(const void* key, size_t len, uint32_t seed = 0)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(key);
+        uint32_t crc = ~seed;
+    #ifdef __SSE4_2__
+        uint64_t c64 = crc;
+        for (; len >= 8; len -= 8, p += 8) {
+            uint64_t v; memcpy(&v, p, 8);
+            c64 = _mm_crc32_u64(c64, v);
+        }
+        crc = c64;
+        if (len & 4) { uint32_t v; memcpy(&v, p, 4); crc = _mm_crc32_u32(crc, v); p += 4; }
+        if (len & 2) { uint16_t v; memcpy(&v, p, 2); crc = _mm_crc32_u16(crc, v); p += 2; }
+        if (len & 1) crc = _mm_crc32_u8(crc, *p);
+    #else
+        static const crc32c_table s_table;
+        while (len--)
+            crc = s_table.data[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    #endif
+        return ~crc;
+    }
+
+    //-----------------------------------------------------------------------------
+    // 64-bit multiply-fold hash for byte strings and integers.  The algorithm
+    // follows wyhash v4 by Wang Yi (public domain): input is consumed in 16-byte
+    // lanes mixed with a 64x64->128 bit multiply, with a branch-light path for
+    // keys up to 16 bytes (tickers, order ids).
+    //-----------------------------------------------------------------------------
+    struct wyp {
+        static constexpr uint64_t p0 = 0x2d358dccaa6c78a5ull;
+        static constexpr uint64_t p1 = 0x8bb84b93962eacc9ull;
+        static constexpr uint64_t p2 = 0x4b33a62ed433d4a3ull;
+        static constexpr uint64_t p3 = 0x4d5a2da51de1aa47ull;
+    };
+
+    inline void wymum(uint64_t& a, uint64_t& b) {
+    #ifdef __SIZEOF_INT128__
+        __uint128_t r = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(r);
+        b = static_cast<uint64_t>(r >> 64);
+    #else
+        uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+        uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        uint64_t t  = rl + (rm0 << 32), c = t < rl;
+        uint64_t lo = t + (rm1 << 32);
+        c += lo < t;
+        a = lo;
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    #endif
+    }
+
+    inline uint64_t wymix(uint64_t a, uint64_t b) { wymum(a, b); return a ^ b; }
+
+    inline uint64_t wyr8(const unsigned char* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+    inline uint64_t wyr4(const unsigned char* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+    inline uint64_t wyr3(const unsigned char* p, size_t k) {
+        return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+    }
+
+    inline uint64_t wy_hash(const void* key, size_t len, uint64_t seed = 0)
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(key);
+        seed ^= wymix(seed ^ wyp::p0, wyp::p1);
+        uint64_t a, b;
+        if (likely(len <= 16)) {
+            if (likely(len >= 4)) {
+                a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+                b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+            } else if (likely(len > 0)) {
+                a = wyr3(p, len);
+                b = 0;
+            } else
+                a = b = 0;
+        } else {
+            size_t i = len;
+            if (unlikely(i >= 48)) {
+                uint64_t see1 = seed, see2 = seed;
+                do {
+                    seed = wymix(wyr8(p)      ^ wyp::p1, wyr8(p +  8) ^ seed);
+                    see1 = wymix(wyr8(p + 16) ^ wyp::p2, wyr8(p + 24) ^ see1);
+                    see2 = wymix(wyr8(p + 32) ^ wyp::p3, wyr8(p + 40) ^ see2);
+                    p += 48; i -= 48;
+                } while (likely(i >= 48));
+                seed ^= see1 ^ see2;
+            }
+            while (unlikely(i > 16)) {
+                seed = wymix(wyr8(p) ^ wyp::p1, wyr8(p + 8) ^ seed);
+                i -= 16; p += 16;
+            }
+            a = wyr8(p + i - 16);
+            b = wyr8(p + i - 8);
+        }
+        a ^= wyp::p1;
+        b ^= seed;
+        wymum(a, b);
+        return wymix(a ^ wyp::p0 ^ len, b ^ wyp::p1);
+    }
+
+    /// Hash an 8-byte integer key (order id, basic_short_name::to_int()).
+    /// Two multiply rounds are needed for keys that differ only in the high
+    /// bits (name_t packs characters from the top) or by large strides.
+    inline uint64_t hash_int64(uint64_t key)
+    {
+        uint64_t a = key ^ wyp::p0, b = key ^ wyp::p1;
+        wymum(a, b);
+        return wymix(a ^ wyp::p0, b ^ wyp::p1);
+    }
+
+    /// Hash \a n keys into \a out.  The keys are independent, so the loop
+    /// lets the CPU overlap the latencies of the multiply/crc instructions
+    /// of several keys, and the hashes can be used to prefetch buckets
+    /// before any of them is probed.
+    template <typename Hash, typename T>
+    inline void hash_batch(const Hash& hash, const T* keys, size_t n, size_t* out)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            out[i]   = hash(keys[i]);
+            out[i+1] = hash(keys[i+1]);
+            out[i+2] = hash(keys[i+2]);
+            out[i+3] = hash(keys[i+3]);
+        }
+        for (; i < n; ++i)
+            out[i] = hash(keys[i]);
+    }
+
     template <typename T>
     struct hash_fun;
 
+    /// String hash functors are transparent: a C string, a std::string and
+    /// a basic_short_name with the same characters have the same hash, so
+    /// that flat_hash_map can be searched without constructing the key type.
     template <>
     struct hash_fun<const char*> {
+        typedef void is_transparent;
+
         size_t operator()(const char* data) const {
             return hsieh_hash(data, strlen(data));
         }
+        size_t operator()(const std::string& data) const {
+            return hsieh_hash(data.c_str(), data.size());
+        }
     };
 
     template <>
     struct hash_fun<std::string> {
+        typedef void is_transparent;
+
         size_t operator()(const std::string& data) const {
             return hsieh_hash(data.c_str(), data.size());
         }
+        size_t operator()(const char* data) const {
+            return hsieh_hash(data, strlen(data));
+        }
+        template <size_t N>
+        size_t operator()(const basic_short_name<N>& data) const {
+            char buf[N];
+            return hsieh_hash(buf, data.write(buf, N));
+        }
+    };
+
+    /// Integer mixer for 8-byte names
+    template <size_t N>
+    struct hash_fun<basic_short_name<N>> {
+        size_t operator()(const basic_short_name<N>& a) const {
+            return hash_int64(a.to_int());
+        }
+    };
+
+    template <>
+    struct hash_fun<name_t> {
+        template <typename T>
+        size_t operator()(const T& a) const { return hash_int64(a.to_int()); }
+    };
+
+    /// Transparent wy_hash-based string hash functor.  Equal strings given as
+    /// std::string, C string or basic_short_name have the same hash.
+    struct fast_str_hash {
+        typedef void is_transparent;
+
+        size_t operator()(const std::string& a) const {
+            return wy_hash(a.c_str(), a.size());
+        }
+        size_t operator()(const char* a) const {
+            return wy_hash(a, strlen(a));
+        }
+        template <size_t N>
+        size_t operator()(const basic_short_name<N>& a) const {
+            char buf[N];
+            return wy_hash(buf, a.write(buf, N));
+        }
+    };
+
+    /// Key equality functor used by flat_hash_map. It is invoked as
+    /// eq(stored_key, lookup_key).
+    template <typename T>
+    struct equal_fun : public src::equal_to<T> {};
+
+    template <>
+    struct equal_fun<const char*> {
+        typedef void is_transparent;
+
+        bool operator()(const char* a, const char* b) const {
+            return a == b || strcmp(a, b) == 0;
+        }
+        bool operator()(const char* a, const std::string& b) const {
+            return b == a;
+        }
+    };
+
+    template <>
+    struct equal_fun<std::string> {
+        typedef void is_transparent;
+
+        bool operator()(const std::string& a, const std::string& b) const {
+            return a == b;
+        }
+        bool operator()(const std::string& a, const char* b) const {
+            return a == b;
+        }
+        template <size_t N>
+        bool operator()(const std::string& a, const basic_short_name<N>& b) const {
+            char   buf[N];
+            size_t n = b.write(buf, N);
+            return a.size() == n && memcmp(a.c_str(), buf, n) == 0;
+        }
     };
 
     inline uint32_t crapwow(const char* key, uint32_t len, uint32_t seed=0) {
@@ -355,5 +598,486 @@ namespace detail {
         return b;
     }
 
+    /// Jump consistent hash (Lamping & Veach) using integer arithmetic only.
+    /// Maps \a key to a bucket in [0, num_buckets) so that growing the
+    /// number of buckets from N to N+1 moves only 1/(N+1) of the keys.
+    inline int32_t jump_consistent_hash(uint64_t key, int32_t num_buckets)
+    {
+        int64_t b = -1, j = 0;
+        while (j < num_buckets) {
+            b   = j;
+            key = key * 2862933555777941757ull + 1;
+            j   = ((b + 1) << 31) / int64_t((key >> 33) + 1);
+        }
+        return b;
+    }
+
+    //-------------------------------------------------------------------------
+    /// Open-addressing hash map with SSE2 control byte probing.
+    //-------------------------------------------------------------------------
+    /// Elements are stored in a flat array of slots (no heap node per
+    /// element).  Every slot has a control byte holding 7 bits of the hash
+    /// or s_empty, so a probe compares 16 control bytes at once and only
+    /// touches the slots whose hash bits match.  Probing is linear at slot
+    /// granularity, which lets erase() shift back the rest of the cluster
+    /// instead of leaving tombstones, so lookups don't degrade over time.
+    ///
+    /// If both \a Hash and \a Equal define \c is_transparent, find(), count()
+    /// and erase() accept any key type they support (e.g. \c const \c char*
+    /// or \c basic_short_name for \c std::string keys).  The result of
+    /// \a Hash is mixed internally, so identity hashes like std::hash<long>
+    /// are fine.
+    ///
+    /// Insertion and erasure invalidate iterators and references.
+    //-------------------------------------------------------------------------
+    template <typename K, typename V,
+              typename Hash  = src::hash<K>,
+              typename Equal = equal_fun<K> >
+    class flat_hash_map {
+    public:
+        typedef K                       key_type;
+        typedef V                       mapped_type;
+        typedef std::pair<const K, V>   value_type;
+        typedef size_t                  size_type;
+        typedef Hash                    hasher;
+        typedef Equal                   key_equal;
+
+    private:
+        static const size_t s_group     = 16;
+        static const size_t s_min_cap   = s_group;
+        static const size_t s_npos      = size_t(-1);
+        static const int8_t s_empty     = -128;
+
+        template <typename H, typename E, typename = void>
+        struct transparent                : std::false_type {};
+        template <typename H, typename E>
+        struct transparent<H, E, typename std::conditional<true, void,
+            std::pair<typename H::is_transparent,
+                      typename E::is_transparent> >::type> : std::true_type {};
+
+        template <typename Q>
+        using if_transparent = typename std::enable_if<
+            transparent<Hash, Equal>::value && !std::is_same<Q, K>::value>::type;
+
+        /// A window of 16 control bytes starting at any slot
+        struct group {
+        #ifdef __SSE2__
+            __m128i ctrl;
+            explicit group(const int8_t* p)
+                : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+            {}
+            uint32_t match(int8_t h2) const {
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+            }
+            // Only s_empty has the sign bit set
+            uint32_t match_empty() const { return _mm_movemask_epi8(ctrl); }
+        #else
+            const int8_t* ctrl;
+            explicit group(const int8_t* p) : ctrl(p) {}
+            uint32_t match(int8_t h2) const {
+                uint32_t m = 0;
+                for (size_t i = 0; i < s_group; ++i) m |= uint32_t(ctrl[i] == h2) << i;
+                return m;
+            }
+            uint32_t match_empty() const { return match(s_empty); }
+        #endif
+        };
+
+        template <bool Const>
+        class iter {
+            typedef typename flat_hash_map::value_type        val_type;
+            typedef typename std::conditional<Const, const val_type, val_type>::type
+                                                              slot_type;
+
+            const int8_t* m_ctrl;
+            const int8_t* m_end;
+            slot_type*    m_slot;
+
+            friend class flat_hash_map;
+            friend class iter<!Const>;
+
+            iter(const int8_t* a_ctrl, const int8_t* a_end, slot_type* a_slot)
+                : m_ctrl(a_ctrl), m_end(a_end), m_slot(a_slot)
+            {}
+
+            /// Advance to the next full slot (control bytes past the end
+            /// are mirrored copies, so the 16-byte load is always valid)
+            void skip() {
+                while (m_ctrl < m_end) {
+                    uint32_t full = ~group(m_ctrl).match_empty() & 0xFFFF;
+                    size_t   n    = full ? __builtin_ctz(full) : s_group;
+                    m_ctrl += n;
+                    m_slot += n;
+                    if (full) break;
+                }
+                if (m_ctrl > m_end)
+                    m_ctrl = m_end;
+            }
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef val_type                  value_type;
+            typedef ptrdiff_t                 difference_type;
+            typedef slot_type*                pointer;
+            typedef slot_type&                reference;
+
+            iter() : m_ctrl(NULL), m_end(NULL), m_slot(NULL) {}
+
+            template <bool C, class = typename std::enable_if<Const && !C>::type>
+            iter(const iter<C>& a) : m_ctrl(a.m_ctrl), m_end(a.m_end), m_slot(a.m_slot) {}
+
+            reference operator*()  const { return *m_slot; }
+            pointer   operator->() const { return  m_slot; }
+
+            iter& operator++()    { ++m_ctrl; ++m_slot; skip(); return *this; }
+            iter  operator++(int) { iter t(*this); ++*this; return t; }
+
+            template <bool C>
+            bool operator==(const iter<C>& a) const { return m_ctrl == a.m_ctrl; }
+            template <bool C>
+            bool operator!=(const iter<C>& a) const { return m_ctrl != a.m_ctrl; }
+        };
+
+        int8_t*     m_ctrl;         // capacity + s_group - 1 control bytes
+        value_type* m_slots;
+        size_t      m_mask;         // capacity - 1
+        size_t      m_size;
+        size_t      m_growth_left;  // inserts left before reaching max load
+        Hash        m_hash;
+        Equal       m_eq;
+
+        static int8_t* empty_group() {
+            alignas(16) static int8_t s_ctrl[s_group] = {
+                s_empty, s_empty, s_empty, s_empty, s_empty, s_empty, s_empty, s_empty,
+                s_empty, s_empty, s_empty, s_empty, s_empty, s_empty, s_empty, s_empty
+            };
+            return s_ctrl;
+        }
+
+        /// Max load factor is 7/8
+        static size_t max_load(size_t a_cap) { return a_cap - a_cap / 8; }
+
+        template <typename Q>
+        size_t hash(const Q& a_key) const {
+            uint64_t h = m_hash(a_key);
+        #ifdef __SIZEOF_INT128__
+            __uint128_t r = static_cast<__uint128_t>(h) * 0x9E3779B97F4A7C15ull;
+            return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+        #else
+            h *= 0x9E3779B97F4A7C15ull;
+            return h ^ (h >> 32);
+        #endif
+        }
+
+        static int8_t h2(size_t h) { return h & 0x7F;  }
+        size_t home(size_t h) const { return (h >> 7) & m_mask; }
+
+        /// Set a control byte and its mirror past the end of the array
+        void set_ctrl(size_t i, int8_t c) {
+            m_ctrl[i] = c;
+            m_ctrl[((i - (s_group - 1)) & m_mask) + (s_group - 1)] = c;
+        }
+
+        template <typename Q>
+        size_t find_index(const Q& a_key, size_t h) const {
+            int8_t tag = h2(h);
+            for (size_t pos = home(h);; pos = (pos + s_group) & m_mask) {
+                group g(m_ctrl + pos);
+                for (uint32_t m = g.match(tag); m; m &= m - 1) {
+                    size_t i = (pos + __builtin_ctz(m)) & m_mask;
+                    if (likely(m_eq(m_slots[i].first, a_key)))
+                        return i;
+                }
+                if (likely(g.match_empty()))
+                    return s_npos;
+            }
+        }
+
+        size_t find_empty(size_t h) const {
+            for (size_t pos = home(h);; pos = (pos + s_group) & m_mask) {
+                uint32_t m = group(m_ctrl + pos).match_empty();
+                if (likely(m))
+                    return (pos + __builtin_ctz(m)) & m_mask;
+            }
+        }
+
+        static void relocate(value_type* a_to, value_type* a_from) {
+            new (a_to) value_type(std::move(const_cast<K&>(a_from->first)),
+                                  std::move(a_from->second));
+            a_from->~value_type();
+        }
+
+        void destroy_all() {
+            if (!m_slots) return;
+            for (size_t i = 0, n = capacity(); i < n; ++i)
+                if (m_ctrl[i] != s_empty)
+                    m_slots[i].~value_type();
+        }
+
+        void deallocate() {
+            if (!m_slots) return;
+            delete [] m_ctrl;
+            ::operator delete(m_slots);
+        }
+
+        void resize(size_t a_cap) {
+            int8_t*     old_ctrl  = m_ctrl;
+            value_type* old_slots = m_slots;
+            size_t      old_cap   = capacity();
+
+            m_ctrl  = new int8_t[a_cap + s_group - 1];
+            try {
+                m_slots = static_cast<value_type*>(::operator new(a_cap * sizeof(value_type)));
+            } catch (...) {
+                delete [] m_ctrl;
+                m_ctrl = old_ctrl;
+                throw;
+            }
+            memset(m_ctrl, s_empty, a_cap + s_group - 1);
+            m_mask        = a_cap - 1;
+            m_growth_left = max_load(a_cap) - m_size;
+
+            for (size_t i = 0; i < old_cap; ++i)
+                if (old_ctrl[i] != s_empty) {
+                    size_t h = hash(old_slots[i].first);
+                    size_t j = find_empty(h);
+                    relocate(m_slots + j, old_slots + i);
+                    set_ctrl(j, h2(h));
+                }
+
+            if (old_slots) {
+                delete [] old_ctrl;
+                ::operator delete(old_slots);
+            }
+        }
+
+        /// Erase the element at slot \a i by shifting back the elements of
+        /// the cluster that follow it and can be moved closer to their home
+        void erase_index(size_t i) {
+            m_slots[i].~value_type();
+            size_t hole = i;
+            for (size_t k = (i + 1) & m_mask; m_ctrl[k] != s_empty; k = (k + 1) & m_mask) {
+                size_t h = home(hash(m_slots[k].first));
+                if (((k - h) & m_mask) >= ((k - hole) & m_mask)) {
+                    relocate(m_slots + hole, m_slots + k);
+                    set_ctrl(hole, m_ctrl[k]);
+                    hole = k;
+                }
+            }
+            set_ctrl(hole, s_empty);
+            --m_size;
+            ++m_growth_left;
+        }
+
+        template <typename Q, typename... Args>
+        std::pair<size_t, bool> emplace_impl(Q&& a_key, Args&&... a_args) {
+            size_t h = hash(a_key);
+            size_t i = find_index(a_key, h);
+            if (i != s_npos)
+                return std::make_pair(i, false);
+            if (unlikely(!m_growth_left))
+                resize(m_slots ? capacity() * 2 : s_min_cap);
+            i = find_empty(h);
+            new (m_slots + i) value_type(std::piecewise_construct,
+                                         std::forward_as_tuple(std::forward<Q>(a_key)),
+                                         std::forward_as_tuple(std::forward<Args>(a_args)...));
+            set_ctrl(i, h2(h));
+            ++m_size;
+            --m_growth_left;
+            return std::make_pair(i, true);
+        }
+
+        template <typename Q>
+        size_t erase_key(const Q& a_key) {
+            size_t i = find_index(a_key, hash(a_key));
+            if (i == s_npos)
+                return 0;
+            erase_index(i);
+            return 1;
+        }
+
+        template <typename Q>
+        size_t find_key(const Q& a_key) const {
+            return find_index(a_key, hash(a_key));
+        }
+
+    public:
+        typedef iter<false> iterator;
+        typedef iter<true>  const_iterator;
+
+    private:
+        iterator iterator_at(size_t i) {
+            return i == s_npos ? end() : iterator(m_ctrl + i, m_ctrl + capacity(), m_slots + i);
+        }
+        const_iterator iterator_at(size_t i) const {
+            return i == s_npos ? end() : const_iterator(m_ctrl + i, m_ctrl + capacity(), m_slots + i);
+        }
+
+    public:
+
+        explicit flat_hash_map(size_t a_capacity = 0,
+                               const Hash& a_hash = Hash(), const Equal& a_eq = Equal())
+            : m_ctrl(empty_group()), m_slots(NULL), m_mask(0), m_size(0)
+            , m_growth_left(0), m_hash(a_hash), m_eq(a_eq)
+        {
+            reserve(a_capacity);
+        }
+
+        flat_hash_map(const flat_hash_map& a)
+            : flat_hash_map(a.size(), a.m_hash, a.m_eq)
+        {
+            for (auto& v : a)
+                emplace_impl(v.first, v.second);
+        }
+
+        flat_hash_map(flat_hash_map&& a)
+            : flat_hash_map(0, a.m_hash, a.m_eq)
+        {
+            swap(a);
+        }
+
+        ~flat_hash_map() { destroy_all(); deallocate(); }
+
+        flat_hash_map& operator=(flat_hash_map a) { swap(a); return *this; }
+
+        void swap(flat_hash_map& a) {
+            std::swap(m_ctrl,        a.m_ctrl);
+            std::swap(m_slots,       a.m_slots);
+            std::swap(m_mask,        a.m_mask);
+            std::swap(m_size,        a.m_size);
+            std::swap(m_growth_left, a.m_growth_left);
+            std::swap(m_hash,        a.m_hash);
+            std::swap(m_eq,          a.m_eq);
+        }
+
+        size_t size()            const { return m_size;                      }
+        bool   empty()           const { return !m_size;                     }
+        size_t capacity()        const { return m_slots ? m_mask + 1 : 0;   }
+        float  load_factor()     const { return m_slots ? float(m_size) / capacity() : 0; }
+        float  max_load_factor() const { return 0.875;                      }
+
+        const Hash&  hash_function() const { return m_hash; }
+        const Equal& key_eq()        const { return m_eq;   }
+
+        /// Make room for \a a_count elements without rehashing
+        void reserve(size_t a_count) {
+            if (a_count <= size() + m_growth_left)
+                return;
+            size_t cap = s_min_cap;
+            while (max_load(cap) < a_count) cap *= 2;
+            resize(cap);
+        }
+
+        /// Remove all elements keeping the allocated capacity
+        void clear() {
+            destroy_all();
+            if (m_slots)
+                memset(m_ctrl, s_empty, capacity() + s_group - 1);
+            m_size        = 0;
+            m_growth_left = m_slots ? max_load(capacity()) : 0;
+        }
+
+        iterator begin() {
+            iterator it(m_ctrl, m_ctrl + capacity(), m_slots);
+            it.skip();
+            return it;
+        }
+        const_iterator begin() const {
+            const_iterator it(m_ctrl, m_ctrl + capacity(), m_slots);
+            it.skip();
+            return it;
+        }
+        iterator       end()         { return iterator(m_ctrl + capacity(), m_ctrl + capacity(), NULL); }
+        const_iterator end()   const { return const_iterator(m_ctrl + capacity(), m_ctrl + capacity(), NULL); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend()   const { return end();   }
+
+        iterator       find(const K& a_key)       { return iterator_at(find_key(a_key)); }
+        const_iterator find(const K& a_key) const { return iterator_at(find_key(a_key)); }
+
+        template <typename Q, typename = if_transparent<Q>>
+        iterator       find(const Q& a_key)       { return iterator_at(find_key(a_key)); }
+        template <typename Q, typename = if_transparent<Q>>
+        const_iterator find(const Q& a_key) const { return iterator_at(find_key(a_key)); }
+
+        size_t count(const K& a_key) const { return find_key(a_key) != s_npos; }
+
+        template <typename Q, typename = if_transparent<Q>>
+        size_t count(const Q& a_key) const { return find_key(a_key) != s_npos; }
+
+        V& at(const K& a_key) {
+            size_t i = find_key(a_key);
+            if (i == s_npos) throw std::out_of_range("flat_hash_map::at");
+            return m_slots[i].second;
+        }
+        const V& at(const K& a_key) const {
+            return const_cast<flat_hash_map*>(this)->at(a_key);
+        }
+
+        V& operator[](const K& a_key) {
+            size_t i = emplace_impl(a_key).first;
+            return m_slots[i].second;
+        }
+        V& operator[](K&& a_key) {
+            size_t i = emplace_impl(std::move(a_key)).first;
+            return m_slots[i].second;
+        }
+
+        /// Insert a value constructed from \a a_args unless \a a_key exists
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const K& a_key, Args&&... a_args) {
+            auto r = emplace_impl(a_key, std::forward<Args>(a_args)...);
+            return std::make_pair(iterator_at(r.first), r.second);
+        }
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& a_key, Args&&... a_args) {
+            auto r = emplace_impl(std::move(a_key), std::forward<Args>(a_args)...);
+            return std::make_pair(iterator_at(r.first), r.second);
+        }
+
+        std::pair<iterator, bool> insert(const value_type& a_value) {
+            return try_emplace(a_value.first, a_value.second);
+        }
+
+        size_t erase(const K& a_key) { return erase_key(a_key); }
+
+        template <typename Q, typename = if_transparent<Q>>
+        size_t erase(const Q& a_key) { return erase_key(a_key); }
+
+        /// Erase the element at \a a_it.  Since the following elements may
+        /// shift into its slot, use erase_if() to erase while iterating.
+        void erase(const_iterator a_it) { erase_index(a_it.m_ctrl - m_ctrl); }
+
+        /// Look up \a a_n keys at once.  Hashes of a batch of keys are
+        /// computed and their probe positions prefetched before any slot is
+        /// compared, so that cache misses of independent lookups overlap.
+        template <typename Q, typename = typename std::enable_if<
+            std::is_same<Q, K>::value || transparent<Hash, Equal>::value>::type>
+        void find_batch(const Q* a_keys, size_t a_n, iterator* a_out) {
+            static const size_t s_batch = 16;
+            size_t h[s_batch];
+            for (size_t i = 0; i < a_n; i += s_batch) {
+                size_t n = std::min(s_batch, a_n - i);
+                for (size_t j = 0; j < n; ++j) {
+                    h[j] = hash(a_keys[i+j]);
+                    size_t pos = home(h[j]);
+                    __builtin_prefetch(m_ctrl  + pos);
+                    __builtin_prefetch(m_slots + pos);
+                }
+                for (size_t j = 0; j < n; ++j)
+                    a_out[i+j] = iterator_at(find_index(a_keys[i+j], h[j]));
+            }
+        }
+
+        /// Erase all elements for which \a a_pred(value) returns true
+        template <typename Pred>
+        size_t erase_if(Pred a_pred) {
+            size_t n = m_size;
+            for (size_t i = 0, cap = capacity(); i < cap; ++i)
+                while (m_ctrl[i] != s_empty && a_pred(m_slots[i]))
+                    erase_index(i);
+            return n - m_size;
+        }
+    };
+
 } // namespace detail
 } // namespace utxx
\ No newline at end of file
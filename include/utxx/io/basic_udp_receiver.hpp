@@ -31,10 +31,14 @@ at http://www.boost.org/LICENSE_1_0.txt)
 namespace utxx {
 namespace io {
 
-template <typename Derived, size_t BufSize = 16*1024>
+/// UDP packet receiver passing received data to Derived::on_data(Buffer&).
+/// Buffer may be basic_mirrored_io_buffer<BufSize> (mirrored_io_buffer.hpp)
+/// to avoid moving unprocessed data after each read.
+template <typename Derived, size_t BufSize = 16*1024,
+          typename Buffer = basic_io_buffer<BufSize>>
 class basic_udp_receiver : private boost::noncopyable {
 public:
-    typedef basic_io_buffer<BufSize> buffer_type;
+    typedef Buffer buffer_type;
 
     /// Constructor
     basic_udp_receiver(boost::asio::io_service& a_io_service)
@@ -2,6 +2,13 @@
 /// \file  leb128.hpp
 //----------------------------------------------------------------------------
 /// \brief Little Endian Binary integer encoding
+///
+/// Besides the single value codec, the file has bulk encoding/decoding of
+/// integer arrays, delta+zigzag coding of sequences (e.g. time stamps),
+/// and reading/writing of integer streams in an I/O buffer. Bulk decoding
+/// is vectorized with SSE4.1 (when enabled at compile time) using the
+/// table-driven Masked VByte algorithm (J. Plaisance, N. Kurz, D. Lemire,
+/// "Vectorized VByte Decoding").
 /// \see https://en.wikipedia.org/wiki/LEB128
 //----------------------------------------------------------------------------
 // Copyright (c) 2015 Serge Aleynikov <saleyn@gmail.com>
@@ -32,6 +39,19 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 #pragma once
 
+#include <utxx/error.hpp>
+#include <utxx/compiler_hints.hpp>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 namespace utxx {
 
 /// Write an unsigned LEB-encoded integer to \a p
@@ -138,4 +158,331 @@ inline int encoded_sleb128_size(int64_t a_value) {
     return size;
 }
 
-} // namespace utxx
\ No newline at end of file
+//-----------------------------------------------------------------------------
+// Zigzag encoding of signed integers: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+//-----------------------------------------------------------------------------
+inline uint64_t zigzag_encode(int64_t a_value) {
+    return (uint64_t(a_value) << 1) ^ uint64_t(a_value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t a_value) {
+    return int64_t(a_value >> 1) ^ -int64_t(a_value & 1);
+}
+
+//-----------------------------------------------------------------------------
+// Bulk encoding/decoding
+//-----------------------------------------------------------------------------
+
+/// Max size of the ULEB128 encoding of \a a_count 64-bit integers
+inline constexpr size_t max_encoded_uleb128_size(size_t a_count) {
+    return a_count * 10;
+}
+
+/// Encode \a a_count integers from \a a_src to \a a_dst
+/// @param a_dst buffer of at least max_encoded_uleb128_size(a_count) bytes
+/// @return number of bytes written
+inline size_t encode_uleb128(const uint64_t* a_src, size_t a_count, char* a_dst) {
+    auto p = reinterpret_cast<uint8_t*>(a_dst);
+    for (auto e = a_src + a_count; a_src != e; ++a_src) {
+        auto v = *a_src;
+        for (; v >= 0x80; v >>= 7)
+            *p++ = uint8_t(v) | 0x80;
+        *p++ = uint8_t(v);
+    }
+    return p - reinterpret_cast<uint8_t*>(a_dst);
+}
+
+namespace detail {
+    /// Decode a ULEB128 value from [a_p, a_end) advancing \a a_p past it.
+    /// @return false if the value is incomplete (a_p is not advanced)
+    inline bool decode_uleb128_checked(const char*& a_p, const char* a_end,
+                                       uint64_t& a_value) {
+        auto     p = reinterpret_cast<const uint8_t*>(a_p);
+        auto     e = reinterpret_cast<const uint8_t*>(a_end);
+        uint64_t v = 0;
+
+        if (likely(p != e && *p < 0x80)) {
+            a_value = *p;
+            ++a_p;
+            return true;
+        }
+
+        // Values of up to 8 bytes: find the length by the first byte with
+        // a clear high bit, and gather the 7-bit groups without branching
+        if (e - p >= 8) {
+            uint64_t w;
+            memcpy(&w, p, sizeof(w));
+            uint64_t stops = ~w & 0x8080808080808080ull;
+            if (likely(stops)) {
+                int bits = __builtin_ctzll(stops) + 1;
+                w &= bits == 64 ? ~0ull : (1ull << bits) - 1;
+#if defined(__BMI2__)
+                a_value = _pext_u64(w, 0x7f7f7f7f7f7f7f7full);
+#else
+                w = (w & 0x007f007f007f007full) | ((w & 0x7f007f007f007f00ull) >> 1);
+                w = (w & 0x00003fff00003fffull) | ((w & 0x3fff00003fff0000ull) >> 2);
+                a_value = (w & 0x000000000fffffffull) | ((w & 0x0fffffff00000000ull) >> 4);
+#endif
+                a_p += bits >> 3;
+                return true;
+            }
+        }
+
+        for (int shift = 0; p != e; shift += 7) {
+            uint8_t b = *p++;
+            v |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                a_value = v;
+                a_p     = reinterpret_cast<const char*>(p);
+                return true;
+            }
+            if (unlikely(shift == 63))
+                UTXX_THROW_RUNTIME_ERROR("Malformed LEB128 value longer than 10 bytes");
+        }
+        return false;
+    }
+
+#if defined(__SSE4_1__)
+    //-------------------------------------------------------------------------
+    /// Lookup table of the Masked VByte decoder.
+    /// It is indexed by continuation bits of 12 input bytes, and tells how
+    /// to decode the leading values completely contained in these bytes:
+    /// either six values of 1-2 bytes, four values of 1-3 bytes, or two
+    /// values of 1-5 bytes. The bytes of each value are shuffled into a
+    /// 16, 32 or 64-bit lane respectively, where 7-bit groups are joined.
+    //-------------------------------------------------------------------------
+    struct masked_vbyte_table {
+        struct entry {
+            uint8_t shuffle;    // Index in m_shuffles
+            uint8_t count;      // Number of values decoded (0 - use scalar)
+            uint8_t consumed;   // Number of input bytes consumed
+        };
+
+        entry   m_entries[1 << 12];
+        int8_t  m_shuffles[170][16];
+
+        masked_vbyte_table() {
+            int n = 0;
+            for (int mask = 0; mask < (1 << 12); ++mask) {
+                int lens[12], nvals = 0;
+                for (int i = 0, len = 0; i < 12; ++i) {
+                    ++len;
+                    if (!(mask & (1 << i))) { lens[nvals++] = len; len = 0; }
+                }
+                auto fits = [&](int a_count, int a_max) {
+                    if (nvals < a_count) return false;
+                    for (int i = 0; i < a_count; ++i)
+                        if (lens[i] > a_max) return false;
+                    return true;
+                };
+                int count = fits(6, 2) ? 6 : fits(4, 3) ? 4 : fits(2, 5) ? 2 : 0;
+                auto& ent = m_entries[mask];
+                ent.count = count;
+                if (!count) {
+                    ent.shuffle = ent.consumed = 0;
+                    continue;
+                }
+
+                int8_t shuf[16], lane = 16 / count;
+                memset(shuf, -1, sizeof(shuf));
+                int off = 0;
+                for (int i = 0; i < count; off += lens[i++])
+                    for (int j = 0; j < lens[i]; ++j)
+                        shuf[i*lane + j] = off + j;
+                ent.consumed = off;
+
+                // Reuse an identical shuffle (there are 64+81+25 distinct)
+                int k = 0;
+                while (k < n && memcmp(m_shuffles[k], shuf, 16) != 0) ++k;
+                if (k == n) memcpy(m_shuffles[n++], shuf, 16);
+                ent.shuffle = k;
+            }
+        }
+
+        static const masked_vbyte_table& instance() {
+            static const masked_vbyte_table s_table;
+            return s_table;
+        }
+    };
+
+    /// Store \a N 64-bit values widened from the lanes of \a a_v
+    template <int N>
+    inline void masked_vbyte_store(__m128i a_v, uint64_t* a_out);
+
+    template <>
+    inline void masked_vbyte_store<6>(__m128i a_v, uint64_t* a_out) {
+        a_v = _mm_or_si128(_mm_and_si128(a_v, _mm_set1_epi16(0x007f)),
+                           _mm_and_si128(_mm_srli_epi16(a_v, 1), _mm_set1_epi16(0x3f80)));
+        _mm_storeu_si128((__m128i*)a_out,     _mm_cvtepu16_epi64(a_v));
+        _mm_storeu_si128((__m128i*)(a_out+2), _mm_cvtepu16_epi64(_mm_srli_si128(a_v, 4)));
+        _mm_storeu_si128((__m128i*)(a_out+4), _mm_cvtepu16_epi64(_mm_srli_si128(a_v, 8)));
+    }
+
+    template <>
+    inline void masked_vbyte_store<4>(__m128i a_v, uint64_t* a_out) {
+        a_v = _mm_or_si128(
+                _mm_or_si128(_mm_and_si128(a_v, _mm_set1_epi32(0x7f)),
+                             _mm_and_si128(_mm_srli_epi32(a_v, 1), _mm_set1_epi32(0x3f80))),
+                _mm_and_si128(_mm_srli_epi32(a_v, 2), _mm_set1_epi32(0x1fc000)));
+        _mm_storeu_si128((__m128i*)a_out,     _mm_cvtepu32_epi64(a_v));
+        _mm_storeu_si128((__m128i*)(a_out+2), _mm_cvtepu32_epi64(_mm_srli_si128(a_v, 8)));
+    }
+
+    template <>
+    inline void masked_vbyte_store<2>(__m128i a_v, uint64_t* a_out) {
+        auto r = _mm_and_si128(a_v, _mm_set1_epi64x(0x7f));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi64(a_v, 1), _mm_set1_epi64x(0x7fll << 7)));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi64(a_v, 2), _mm_set1_epi64x(0x7fll << 14)));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi64(a_v, 3), _mm_set1_epi64x(0x7fll << 21)));
+        r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi64(a_v, 4), _mm_set1_epi64x(0x7fll << 28)));
+        _mm_storeu_si128((__m128i*)a_out, r);
+    }
+#endif
+} // namespace detail
+
+/// Decode up to \a a_count ULEB128 integers from [a_p, a_end) into \a a_out.
+/// Decoding stops at a value that is not complete in the input, so that
+/// the function can be called again when more input is available.
+/// @param a_p is advanced past the decoded values
+/// @return number of decoded values
+/// @throw runtime_error if a value is longer than 10 bytes
+inline size_t decode_uleb128(const char*& a_p, const char* a_end,
+                             uint64_t* a_out, size_t a_count)
+{
+    size_t n = 0;
+#if defined(__SSE4_1__)
+    auto&  tab = detail::masked_vbyte_table::instance();
+#endif
+
+    while (n < a_count) {
+#if defined(__SSE4_1__)
+        if (a_end - a_p >= 16) {
+            auto  in   = _mm_loadu_si128((const __m128i*)a_p);
+            auto  mask = unsigned(_mm_movemask_epi8(in));
+
+            // Sixteen 1-byte values
+            if (mask == 0 && a_count - n >= 16) {
+                auto o = a_out + n;
+                for (int i = 0; i < 8; ++i, in = _mm_srli_si128(in, 2))
+                    _mm_storeu_si128((__m128i*)(o + 2*i), _mm_cvtepu8_epi64(in));
+                a_p += 16;
+                n   += 16;
+                continue;
+            }
+
+            auto& ent = tab.m_entries[mask & 0xfff];
+            if (ent.count && a_count - n >= ent.count) {
+                auto v = _mm_shuffle_epi8
+                    (in, _mm_loadu_si128((const __m128i*)tab.m_shuffles[ent.shuffle]));
+                switch (ent.count) {
+                    case 6:  detail::masked_vbyte_store<6>(v, a_out + n); break;
+                    case 4:  detail::masked_vbyte_store<4>(v, a_out + n); break;
+                    default: detail::masked_vbyte_store<2>(v, a_out + n); break;
+                }
+                a_p += ent.consumed;
+                n   += ent.count;
+                continue;
+            }
+        }
+#endif
+        if (!detail::decode_uleb128_checked(a_p, a_end, a_out[n]))
+            break;
+        ++n;
+    }
+    return n;
+}
+
+//-----------------------------------------------------------------------------
+// Delta coding of sequences
+//-----------------------------------------------------------------------------
+
+/// Encode \a a_count integers as ULEB128 of zigzag-encoded differences
+/// between adjacent values. Best suited for (nearly) sorted sequences,
+/// such as time stamps or sequence numbers.
+/// @param a_base is the value preceding a_src[0]; on output it is set to
+///               the last encoded value so that a stream can be encoded
+///               in pieces
+/// @return number of bytes written
+template <typename T>
+inline size_t encode_delta_uleb128(const T* a_src, size_t a_count, char* a_dst,
+                                   T& a_base)
+{
+    static_assert(sizeof(T) == sizeof(uint64_t), "64-bit integer type expected");
+    auto p = reinterpret_cast<uint8_t*>(a_dst);
+    auto prev = a_base;
+    for (auto e = a_src + a_count; a_src != e; prev = *a_src++) {
+        auto v = zigzag_encode(int64_t(uint64_t(*a_src) - uint64_t(prev)));
+        for (; v >= 0x80; v >>= 7)
+            *p++ = uint8_t(v) | 0x80;
+        *p++ = uint8_t(v);
+    }
+    a_base = prev;
+    return p - reinterpret_cast<uint8_t*>(a_dst);
+}
+
+/// Decode up to \a a_count integers encoded by encode_delta_uleb128().
+/// @param a_base is the value preceding the first one; on output it is
+///               set to the last decoded value
+/// @see decode_uleb128(const char*&, const char*, uint64_t*, size_t)
+template <typename T>
+inline size_t decode_delta_uleb128(const char*& a_p, const char* a_end,
+                                   T* a_out, size_t a_count, T& a_base)
+{
+    static_assert(sizeof(T) == sizeof(uint64_t), "64-bit integer type expected");
+    auto out = reinterpret_cast<uint64_t*>(a_out);
+    auto n   = decode_uleb128(a_p, a_end, out, a_count);
+    auto v   = uint64_t(a_base);
+    for (size_t i = 0; i < n; ++i)
+        out[i] = v += uint64_t(zigzag_decode(out[i]));
+    a_base = T(v);
+    return n;
+}
+
+//-----------------------------------------------------------------------------
+// Streams of integers in an I/O buffer (e.g. basic_io_buffer)
+//-----------------------------------------------------------------------------
+
+/// Append \a a_count ULEB128-encoded integers to \a a_buf
+template <typename Buffer>
+inline size_t write_uleb128(Buffer& a_buf, const uint64_t* a_src, size_t a_count) {
+    a_buf.reserve(max_encoded_uleb128_size(a_count));
+    auto n = encode_uleb128(a_src, a_count, a_buf.wr_ptr());
+    a_buf.commit(n);
+    return n;
+}
+
+/// Read up to \a a_count ULEB128-encoded integers from \a a_buf.
+/// Only complete values are consumed from the buffer: a partially
+/// received value is left unread until more data is written.
+/// @return number of integers read
+template <typename Buffer>
+inline size_t read_uleb128(Buffer& a_buf, uint64_t* a_out, size_t a_count) {
+    const char* p = a_buf.rd_ptr();
+    auto n = decode_uleb128(p, a_buf.wr_ptr(), a_out, a_count);
+    a_buf.read(p - a_buf.rd_ptr());
+    return n;
+}
+
+/// Append \a a_count delta-encoded integers to \a a_buf
+/// @see encode_delta_uleb128()
+template <typename Buffer, typename T>
+inline size_t write_delta_uleb128(Buffer& a_buf, const T* a_src, size_t a_count,
+                                  T& a_base) {
+    a_buf.reserve(max_encoded_uleb128_size(a_count));
+    auto n = encode_delta_uleb128(a_src, a_count, a_buf.wr_ptr(), a_base);
+    a_buf.commit(n);
+    return n;
+}
+
+/// Read up to \a a_count delta-encoded integers from \a a_buf
+/// @see read_uleb128(), decode_delta_uleb128()
+template <typename Buffer, typename T>
+inline size_t read_delta_uleb128(Buffer& a_buf, T* a_out, size_t a_count,
+                                 T& a_base) {
+    const char* p = a_buf.rd_ptr();
+    auto n = decode_delta_uleb128(p, a_buf.wr_ptr(), a_out, a_count, a_base);
+    a_buf.read(p - a_buf.rd_ptr());
+    return n;
+}
+
+} // namespace utxx
@@ -0,0 +1,311 @@
+//----------------------------------------------------------------------------
+/// \file   line_filter.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Regular expression line filter with a literal substring pre-filter.
+///
+/// std::regex is slow, so running it on every line of a large text is
+/// costly. Most patterns contain a literal string that every match must
+/// include (e.g. "ORDER [0-9]+ FILLED" contains " FILLED"). The filter
+/// extracts such literal from the pattern, scans a whole buffer for it
+/// with a SIMD substring search, and runs the regex only on the lines
+/// containing the literal.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/compiler_hints.hpp>
+#include <string>
+#include <regex>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Find the first occurrence of \a a_needle of \a a_len bytes in
+/// [a_begin, a_end).
+/// Candidate positions are located by comparing the first and the last
+/// character of the needle against 16/32 positions at a time and are
+/// verified with memcmp().
+/// @return pointer to the occurrence or \a a_end if not found
+//-----------------------------------------------------------------------------
+inline const char* find_substr(const char* a_begin, const char* a_end,
+                               const char* a_needle, size_t a_len)
+{
+    if (unlikely(!a_len))
+        return a_begin;
+    if (size_t(a_end - a_begin) < a_len)
+        return a_end;
+    if (a_len == 1) {
+        auto p = (const char*)memchr(a_begin, a_needle[0], a_end - a_begin);
+        return p ? p : a_end;
+    }
+
+    const char* p = a_begin;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+  #if defined(__AVX2__)
+    typedef __m256i vec;
+    static const size_t W = 32;
+    auto splat = [](char c)           { return _mm256_set1_epi8(c); };
+    auto load  = [](const char* a)    { return _mm256_loadu_si256((const __m256i*)a); };
+    auto eqand = [](vec a, vec b, vec c, vec d) {
+        return uint32_t(_mm256_movemask_epi8
+            (_mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(c, d))));
+    };
+  #else
+    typedef __m128i vec;
+    static const size_t W = 16;
+    auto splat = [](char c)           { return _mm_set1_epi8(c); };
+    auto load  = [](const char* a)    { return _mm_loadu_si128((const __m128i*)a); };
+    auto eqand = [](vec a, vec b, vec c, vec d) {
+        return uint32_t(_mm_movemask_epi8
+            (_mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(c, d))));
+    };
+  #endif
+    const vec   first = splat(a_needle[0]);
+    const vec   last  = splat(a_needle[a_len-1]);
+    const char* end   = a_end - (a_len - 1);   // Past the last start position
+
+    for (; p + W <= end; p += W) {
+        uint32_t mask = eqand(first, load(p), last, load(p + a_len - 1));
+        while (mask) {
+            auto i = __builtin_ctz(mask);
+            if (memcmp(p + i + 1, a_needle + 1, a_len - 2) == 0)
+                return p + i;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    auto q = (const char*)memmem(p, a_end - p, a_needle, a_len);
+    return q ? q : a_end;
+}
+
+//-----------------------------------------------------------------------------
+/// Find the longest literal string that must be present in any match of
+/// the ECMAScript or extended POSIX regular expression \a a_pattern.
+/// The analysis is conservative: characters inside groups, character
+/// classes and optional items are not considered, and patterns with
+/// alternatives outside of groups have no required literal.
+/// @return empty string if no literal could be determined
+//-----------------------------------------------------------------------------
+inline std::string regex_required_literal(const std::string& a_pattern)
+{
+    const char* p = a_pattern.c_str();
+    const char* e = p + a_pattern.size();
+
+    // Skip a group or a character class starting at \a a
+    auto skip_nested = [e](const char* a) {
+        int depth = 0;
+        for (; a != e; ++a) {
+            if (*a == '\\' && a+1 != e) { ++a; continue; }
+            if (*a == '[') {
+                // Skip a character class ("[]...]" and "[^]...]" forms too)
+                ++a;
+                if (a != e && *a == '^') ++a;
+                if (a != e && *a == ']') ++a;
+                while (a != e && *a != ']') { if (*a == '\\' && a+1 != e) ++a; ++a; }
+                if (a == e) break;
+                if (!depth) return a+1;
+                continue;
+            }
+            if (*a == '(') ++depth;
+            else if (*a == ')' && --depth == 0)
+                return a+1;
+        }
+        return e;
+    };
+    // Skip an optional quantifier: *, +, ?, {n,m} followed by lazy '?'
+    auto quantifier = [e](const char*& a) {
+        if (a == e) return '\0';
+        char q = *a;
+        if (q == '*' || q == '+' || q == '?')
+            ++a;
+        else if (q == '{') {
+            while (a != e && *a != '}') ++a;
+            if (a != e) ++a;
+        } else
+            return '\0';
+        if (a != e && *a == '?') ++a;
+        return q;
+    };
+
+    // Patterns with alternatives at the top level have no required literal
+    for (auto a = p; a != e; ) {
+        if (*a == '|') return std::string();
+        a = (*a == '(' || *a == '[') ? skip_nested(a)
+          : (*a == '\\' && a+1 != e) ? a + 2 : a + 1;
+    }
+
+    std::string best, cur;
+    auto commit = [&best, &cur]() {
+        if (cur.size() > best.size()) best.swap(cur);
+        cur.clear();
+    };
+
+    while (p != e) {
+        char c = *p;
+        if (c == '(' || c == '[') {
+            commit();
+            p = skip_nested(p);
+            quantifier(p);
+            continue;
+        }
+        if (c == '\\') {
+            if (p+1 == e) break;
+            c = p[1];
+            p += 2;
+            if (isalnum(c)) {   // \d, \w, \s, \b, back references, etc
+                // Skip operands of \xHH, \uHHHH, \cX and multi-digit
+                // back references, so they don't end up in the literal
+                int n = c == 'x' ? 2 : c == 'u' ? 4 : c == 'c' ? 1 : 0;
+                for (; n && p != e && (c == 'c' || isxdigit(*p)); --n) ++p;
+                if (isdigit(c))
+                    while (p != e && isdigit(*p)) ++p;
+                commit();
+                quantifier(p);
+                continue;
+            }
+        } else if (strchr(".^$*+?{})", c)) {
+            commit();
+            ++p;
+            quantifier(p);
+            continue;
+        } else
+            ++p;
+
+        switch (quantifier(p)) {
+            case '\0':                      cur += c; break;
+            case '+':  cur += c; commit();            break;
+            default:             commit();            break;
+        }
+    }
+    commit();
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+/// Filter of lines matching a regular expression
+//-----------------------------------------------------------------------------
+class line_filter {
+    std::string m_pattern;
+    std::string m_literal;
+    std::regex  m_regex;
+    bool        m_match_all;
+public:
+    /// Filter matching all lines
+    line_filter() : m_match_all(true) {}
+
+    /// Filter of lines matching \a a_pattern
+    explicit line_filter(const std::string& a_pattern,
+                         std::regex_constants::syntax_option_type a_opts =
+                            std::regex_constants::ECMAScript)
+        : m_pattern(a_pattern)
+        , m_regex(a_pattern, a_opts)
+        , m_match_all(false)
+    {
+        using namespace std::regex_constants;
+        // In basic POSIX grammars "+", "?", "(", "{" are literals
+        if (a_opts & (basic | grep))
+            return;
+        m_literal = regex_required_literal(a_pattern);
+        if (a_opts & icase)
+            for (auto c : m_literal)
+                if (isalpha(c)) { m_literal.clear(); break; }
+    }
+
+    const std::string& pattern()   const { return m_pattern;   }
+    /// Literal pre-filter (empty if the regex is tried on every line)
+    const std::string& literal()   const { return m_literal;   }
+    bool               match_all() const { return m_match_all; }
+
+    /// Match a single line [a_begin, a_end)
+    bool match(const char* a_begin, const char* a_end, std::cmatch& a_match) const {
+        if (m_match_all) return true;
+        if (!m_literal.empty() &&
+            find_substr(a_begin, a_end, m_literal.c_str(), m_literal.size()) == a_end)
+            return false;
+        return std::regex_search(a_begin, a_end, a_match, m_regex);
+    }
+
+    /// Call \a a_fun for every matching line in a buffer of '\n'-delimited
+    /// lines [a_begin, a_end) that must start at the beginning of a line.
+    /// @param a_fun is void(const char* line, const char* eol, const std::cmatch&)
+    ///              where \a eol excludes the end of line character
+    /// @return number of matching lines
+    template <class Fun>
+    size_t scan(const char* a_begin, const char* a_end, Fun a_fun) const {
+        std::cmatch m;
+        size_t      n = 0;
+        const char* p = a_begin;
+
+        auto eol = [a_end](const char* a) {
+            auto q = (const char*)memchr(a, '\n', a_end - a);
+            return q ? q : a_end;
+        };
+
+        if (m_literal.empty()) {
+            for (const char* q; p < a_end; p = q + 1) {
+                q = eol(p);
+                if (m_match_all || std::regex_search(p, q, m, m_regex)) {
+                    a_fun(p, q, m);
+                    ++n;
+                }
+            }
+            return n;
+        }
+
+        auto lit = m_literal.c_str();
+        auto len = m_literal.size();
+
+        while (p < a_end) {
+            auto q = find_substr(p, a_end, lit, len);
+            if (q == a_end)
+                break;
+            auto b = (const char*)memrchr(p, '\n', q - p);
+            b = b ? b + 1 : p;
+            q = eol(q);
+            if (std::regex_search(b, q, m, m_regex)) {
+                a_fun(b, q, m);
+                ++n;
+            }
+            p = q + 1;
+        }
+        return n;
+    }
+};
+
+} // namespace utxx
@@ -0,0 +1,378 @@
+//----------------------------------------------------------------------------
+/// \file   metrics.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Process-wide registry of counters, gauges and latency histograms.
+///
+/// Counters and histograms keep a cache-line aligned slot per thread
+/// (in the manner of thread_cached_int), so that updating them is a plain
+/// store into memory owned by the calling thread. A collector thread
+/// periodically sweeps the slots and publishes a snapshot into a memory
+/// mapped file that external processes scrape with metrics_reader (see
+/// the metricsdump tool) without locking or pausing the process:
+/// \code
+/// static auto& s_sent = metrics_registry::instance().counter("orders.sent");
+/// static auto& s_rtt  = metrics_registry::instance().histogram("orders.rtt");
+/// ...
+/// s_sent.inc();
+/// s_rtt.add(rtt_nanoseconds);
+/// ...
+/// metrics_registry::instance().start("/dev/shm/myapp.metrics");
+/// \endcode
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/config.h>
+#include <utxx/compiler_hints.hpp>
+#include <utxx/thread_local.hpp>
+#include <utxx/persist_blob.hpp>
+#include <utxx/time_val.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+#include <time.h>
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Aggregated value of a metric
+//-----------------------------------------------------------------------------
+struct metric_sample {
+    enum type_t : uint32_t { COUNTER, GAUGE, HISTOGRAM };
+
+    static const size_t MAX_NAME = 64;
+
+    char     name[MAX_NAME];
+    uint32_t type;
+    uint32_t reserved;
+    int64_t  value;     ///< Counter/gauge value, or number of histogram samples
+    // Histogram statistics (nanoseconds)
+    int64_t  sum;
+    int64_t  min;
+    int64_t  max;
+    int64_t  p50;
+    int64_t  p90;
+    int64_t  p99;
+    int64_t  p999;
+};
+
+//-----------------------------------------------------------------------------
+/// Snapshot of all metrics of a process published in shared memory.
+/// The writer increments \a seq before and after an update, so a reader
+/// retries copying while \a seq is odd or has changed (a seqlock).
+//-----------------------------------------------------------------------------
+struct metrics_snapshot {
+    static const size_t MAX_METRICS = 1024;
+
+    uint64_t      seq;
+    int64_t       time;     ///< Nanoseconds since epoch of the last sweep
+    uint32_t      pid;
+    uint32_t      count;    ///< Number of valid \a items
+    metric_sample items[MAX_METRICS];
+};
+
+namespace detail {
+    struct metrics_tag {};
+
+    class metric_base {
+    protected:
+        std::string          m_name;
+        metric_sample::type_t m_type;
+    public:
+        metric_base(const std::string& a_name, metric_sample::type_t a_type)
+            : m_name(a_name), m_type(a_type)
+        {}
+        virtual ~metric_base() {}
+
+        const std::string&    name() const { return m_name; }
+        metric_sample::type_t type() const { return m_type; }
+
+        /// Sweep per-thread slots into \a a_sample
+        virtual void sample(metric_sample& a_sample) const = 0;
+    };
+
+    /// Allocate a cache-line aligned per-thread slot
+    template <class Slot>
+    Slot* new_slot() {
+        void* p;
+        if (posix_memalign(&p, UTXX_CL_SIZE, sizeof(Slot)) != 0)
+            throw std::bad_alloc();
+        return new (p) Slot();
+    }
+
+    template <class Slot>
+    void delete_slot(Slot* a_slot) {
+        a_slot->~Slot();
+        free(a_slot);
+    }
+} // namespace detail
+
+//-----------------------------------------------------------------------------
+/// Monotonic counter
+//-----------------------------------------------------------------------------
+class metric_counter : public detail::metric_base {
+    struct slot {
+        std::atomic<int64_t> value;
+        slot() : value(0) {}
+    } __attribute__((aligned(UTXX_CL_SIZE)));
+
+    // Sum of the slots of exited threads
+    std::atomic<int64_t>                       m_retired;
+    thr_local_ptr<slot, detail::metrics_tag>   m_slot;
+
+    slot* make_slot();
+public:
+    explicit metric_counter(const std::string& a_name)
+        : metric_base(a_name, metric_sample::COUNTER), m_retired(0)
+    {}
+
+    /// Add \a a_inc to the counter (the calling thread is the only writer
+    /// of its slot, so no atomic read-modify-write is needed)
+    void inc(int64_t a_inc = 1) {
+        slot* s = m_slot.get();
+        if (unlikely(!s))
+            s = make_slot();
+        s->value.store(s->value.load(std::memory_order_relaxed) + a_inc,
+                       std::memory_order_relaxed);
+    }
+
+    metric_counter& operator+=(int64_t a_inc) { inc(a_inc); return *this; }
+    metric_counter& operator++()              { inc(1);     return *this; }
+
+    /// Sum of all threads' slots
+    int64_t value() const;
+
+    void sample(metric_sample& a_sample) const override;
+};
+
+//-----------------------------------------------------------------------------
+/// Gauge holding the last value set by any thread
+//-----------------------------------------------------------------------------
+class metric_gauge : public detail::metric_base {
+    // Padded to avoid false sharing with neighbouring allocations
+    char                 m_pad0[UTXX_CL_SIZE];
+    std::atomic<int64_t> m_value;
+    char                 m_pad1[UTXX_CL_SIZE - sizeof(std::atomic<int64_t>)];
+public:
+    explicit metric_gauge(const std::string& a_name)
+        : metric_base(a_name, metric_sample::GAUGE), m_value(0)
+    {}
+
+    void    set(int64_t a_value) { m_value.store(a_value, std::memory_order_relaxed); }
+    void    add(int64_t a_inc)   { m_value.fetch_add(a_inc, std::memory_order_relaxed); }
+    int64_t value()        const { return m_value.load(std::memory_order_relaxed); }
+
+    void sample(metric_sample& a_sample) const override;
+};
+
+//-----------------------------------------------------------------------------
+/// Latency histogram of nanosecond samples.
+/// Values below 16 have exact buckets, and larger values are grouped in
+/// four buckets per power of two, so that quantiles are reported with
+/// relative error under 25%.
+//-----------------------------------------------------------------------------
+class metric_histogram : public detail::metric_base {
+public:
+    static const int BUCKETS = 256;
+
+    /// Accumulated histogram data
+    struct data {
+        int64_t count;
+        int64_t sum;
+        int64_t min;
+        int64_t max;
+        int64_t buckets[BUCKETS];
+
+        data() { clear(); }
+        void    clear();
+        void    merge(const data& a_rhs);
+        /// Approximate value of quantile \a a_q in [0, 1]
+        int64_t quantile(double a_q) const;
+    };
+
+    /// Measure the duration of a scope
+    class sample_scope {
+        metric_histogram& m_hist;
+        struct timespec   m_start;
+    public:
+        explicit sample_scope(metric_histogram& a_h) : m_hist(a_h) {
+            clock_gettime(CLOCK_MONOTONIC, &m_start);
+        }
+        ~sample_scope() {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            m_hist.add((now.tv_sec - m_start.tv_sec) * 1000000000L
+                     +  now.tv_nsec - m_start.tv_nsec);
+        }
+    };
+
+    explicit metric_histogram(const std::string& a_name)
+        : metric_base(a_name, metric_sample::HISTOGRAM)
+    {}
+
+    static int bucket(uint64_t a_value) {
+        if (a_value < 16)
+            return int(a_value);
+        int b = 63 - __builtin_clzl(a_value);
+        return 16 + (b - 4) * 4 + int((a_value >> (b - 2)) & 3);
+    }
+
+    /// Smallest value of \a a_bucket
+    static int64_t bucket_value(int a_bucket) {
+        if (a_bucket < 16)
+            return a_bucket;
+        int b = (a_bucket - 16) / 4 + 4;
+        return int64_t(4 + (a_bucket - 16) % 4) << (b - 2);
+    }
+
+    /// Add a sample of \a a_nsec nanoseconds
+    void add(int64_t a_nsec) {
+        slot* s = m_slot.get();
+        if (unlikely(!s))
+            s = make_slot();
+        if (a_nsec < 0) a_nsec = 0;
+        auto  r = std::memory_order_relaxed;
+        auto& b = s->buckets[bucket(a_nsec)];
+        b.store(b.load(r) + 1, r);
+        s->count.store(s->count.load(r) + 1, r);
+        s->sum.store(s->sum.load(r) + a_nsec, r);
+        if (a_nsec < s->min.load(r)) s->min.store(a_nsec, r);
+        if (a_nsec > s->max.load(r)) s->max.store(a_nsec, r);
+    }
+
+    void add(time_val a_duration) { add(a_duration.nanoseconds()); }
+
+    /// Merge all threads' slots
+    data value() const;
+
+    void sample(metric_sample& a_sample) const override;
+
+private:
+    struct slot {
+        std::atomic<int64_t> count;
+        std::atomic<int64_t> sum;
+        std::atomic<int64_t> min;
+        std::atomic<int64_t> max;
+        std::atomic<int64_t> buckets[BUCKETS];
+
+        slot()
+            : count(0), sum(0), min(INT64_MAX), max(0)
+        { for (auto& b : buckets) b.store(0, std::memory_order_relaxed); }
+
+        void load(data& a_data) const;
+    } __attribute__((aligned(UTXX_CL_SIZE)));
+
+    // Data of the slots of exited threads
+    mutable std::mutex                         m_mutex;
+    data                                       m_retired;
+    thr_local_ptr<slot, detail::metrics_tag>   m_slot;
+
+    slot* make_slot();
+};
+
+//-----------------------------------------------------------------------------
+/// Registry of named metrics and the collector publishing their snapshots
+//-----------------------------------------------------------------------------
+class metrics_registry {
+    mutable std::mutex                                m_mutex;
+    std::vector<std::unique_ptr<detail::metric_base>> m_metrics;
+
+    // Collector state
+    std::unique_ptr<metrics_snapshot>                 m_snapshot;
+    persist_blob<metrics_snapshot, null_lock>         m_blob;
+    std::mutex                                        m_publish_mutex;
+    std::thread                                       m_thread;
+    std::mutex                                        m_thread_mutex;
+    std::condition_variable                           m_cond;
+    std::atomic<bool>                                 m_running;
+
+    template <class Metric>
+    Metric& get(const std::string& a_name, metric_sample::type_t a_type);
+
+    void run(time_val a_interval);
+public:
+    metrics_registry();
+    ~metrics_registry();
+
+    /// Process-wide registry. It's never destroyed, so that metrics remain
+    /// valid in threads running at exit.
+    static metrics_registry& instance();
+
+    /// Find or create a metric named \a a_name.
+    /// Returned references remain valid for the lifetime of the registry.
+    /// @throw badarg_error if the name is taken by a metric of another type
+    ///        or is longer than metric_sample::MAX_NAME-1
+    /// @throw runtime_error if there are metrics_snapshot::MAX_METRICS metrics
+    metric_counter&   counter  (const std::string& a_name);
+    metric_gauge&     gauge    (const std::string& a_name);
+    metric_histogram& histogram(const std::string& a_name);
+
+    /// Number of registered metrics
+    size_t size() const;
+
+    /// Sweep all metrics into \a a_snapshot (does not touch a_snapshot.seq)
+    void snapshot(metrics_snapshot& a_snapshot) const;
+
+    /// Start the collector thread publishing snapshots to the memory
+    /// mapped file \a a_file every \a a_interval.
+    /// @throw io_error if the file cannot be created
+    void start(const std::string& a_file, time_val a_interval = time_val(1, 0));
+
+    /// Stop the collector thread (the file is left in place)
+    void stop();
+
+    bool running() const { return m_running.load(std::memory_order_acquire); }
+
+    /// Sweep metrics and publish the snapshot to the file given to start().
+    /// Calls are serialized with the ones of the collector thread (the
+    /// snapshot's seqlock allows a single writer).
+    void publish();
+};
+
+//-----------------------------------------------------------------------------
+/// Reader of snapshots published by metrics_registry of another process
+//-----------------------------------------------------------------------------
+class metrics_reader {
+    persist_blob<metrics_snapshot, null_lock> m_blob;
+public:
+    /// @throw io_error or runtime_error if the file cannot be mapped
+    void open(const std::string& a_file) { m_blob.init(a_file.c_str()); }
+    bool is_open() const { return m_blob.is_open(); }
+
+    /// Copy the latest consistent snapshot to \a a_out.
+    /// @return false if no consistent copy was obtained after \a a_tries
+    bool read(metrics_snapshot& a_out, int a_tries = 1000) const;
+};
+
+} // namespace utxx
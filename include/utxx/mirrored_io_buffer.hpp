@@ -0,0 +1,227 @@
+//----------------------------------------------------------------------------
+/// \file   mirrored_io_buffer.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Ring I/O buffer with storage mapped twice in virtual memory.
+///
+/// The buffer's pages are mapped at two adjacent address ranges, so the
+/// byte at offset i is also visible at offset i + max_size(). The unread
+/// data and the free space of the ring are therefore always contiguous
+/// starting at rd_ptr() and wr_ptr(), and, unlike basic_io_buffer, the
+/// buffer never moves unread data to its beginning (crunch() is a no-op).
+/// The interface matches the one of basic_io_buffer, so the buffer can be
+/// used in its place when parsing streams of variable-length messages.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/error.hpp>
+#include <utxx/compiler_hints.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/assert.hpp>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+namespace utxx {
+
+namespace detail {
+    /// Map \a a_size bytes of shared memory twice at adjacent addresses.
+    /// @param a_size must be a multiple of the page size
+    /// @return address of the first mapping
+    inline char* mirrored_map(size_t a_size) {
+        // Anonymous file backing both mappings
+    #ifdef SYS_memfd_create
+        int fd = ::syscall(SYS_memfd_create, "utxx_mirrored_io_buffer", 1 /*MFD_CLOEXEC*/);
+    #else
+        int fd = -1; errno = ENOSYS;
+    #endif
+        if (fd < 0 && errno == ENOSYS) {
+            char name[64];
+            snprintf(name, sizeof(name), "/utxx_mirrored_io_buffer.%d.%p", getpid(), &name);
+            fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+            if (fd >= 0)
+                ::shm_unlink(name);
+        }
+        if (fd < 0)
+            UTXX_THROW_IO_ERROR(errno, "Cannot create a mirrored buffer file");
+
+        if (::ftruncate(fd, a_size) < 0) {
+            int ec = errno;
+            ::close(fd);
+            UTXX_THROW_IO_ERROR(ec, "Cannot size a mirrored buffer file to ", a_size);
+        }
+
+        // Reserve the address range for both mappings, and map the file
+        // over each half of it
+        auto p = (char*)::mmap(nullptr, 2*a_size, PROT_NONE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        bool ok = p != MAP_FAILED
+               && ::mmap(p, a_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+               && ::mmap(p + a_size, a_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+        int ec = errno;
+        ::close(fd);
+        if (!ok) {
+            if (p != MAP_FAILED)
+                ::munmap(p, 2*a_size);
+            UTXX_THROW_IO_ERROR(ec, "Cannot map a mirrored buffer of ", a_size, " bytes");
+        }
+        return p;
+    }
+} // namespace detail
+
+/**
+ * \brief Ring I/O buffer of at least N bytes whose storage is mapped twice
+ *        back to back, so that readable and writable regions are always
+ *        contiguous.
+ * The size is rounded up to the page size. The buffer grows (copying the
+ * unread data) only when reserve() requests more space than is free.
+ */
+template <size_t N = 64*1024>
+class basic_mirrored_io_buffer : boost::noncopyable {
+    char*   m_begin;
+    size_t  m_size;     // Size of one mapping
+    size_t  m_rd;       // Offset of rd_ptr() in [0, m_size)
+    size_t  m_len;      // Number of unread bytes
+
+    static size_t round_up(size_t a_size) {
+        size_t page = ::sysconf(_SC_PAGESIZE);
+        return a_size ? (a_size + page - 1) / page * page : page;
+    }
+
+    void unmap() {
+        if (m_begin)
+            ::munmap(m_begin, 2*m_size);
+    }
+public:
+    /// Construct the buffer of at least \a a_size bytes
+    explicit basic_mirrored_io_buffer(size_t a_size = N)
+        : m_size(round_up(a_size)), m_rd(0), m_len(0)
+    {
+        m_begin = detail::mirrored_map(m_size);
+    }
+
+    basic_mirrored_io_buffer(basic_mirrored_io_buffer&& a_rhs)
+        : m_begin(a_rhs.m_begin), m_size(a_rhs.m_size)
+        , m_rd(a_rhs.m_rd), m_len(a_rhs.m_len)
+    {
+        a_rhs.m_begin = nullptr;
+        a_rhs.m_size  = a_rhs.m_rd = a_rhs.m_len = 0;
+    }
+
+    void operator=(basic_mirrored_io_buffer&& a_rhs) {
+        std::swap(m_begin, a_rhs.m_begin);
+        std::swap(m_size,  a_rhs.m_size);
+        std::swap(m_rd,    a_rhs.m_rd);
+        std::swap(m_len,   a_rhs.m_len);
+    }
+
+    ~basic_mirrored_io_buffer() { unmap(); }
+
+    /// Reset read/write pointers. Any unread content will be lost.
+    void reset() { m_rd = m_len = 0; }
+
+    /// Ensure there's enough free space in the buffer to write \a n bytes.
+    /// If there isn't, the buffer is remapped with a larger size.
+    void reserve(size_t n) {
+        if (n <= capacity())
+            return;
+        basic_mirrored_io_buffer tmp(m_len + n);
+        memcpy(tmp.m_begin, rd_ptr(), m_len);
+        tmp.m_len = m_len;
+        *this = std::move(tmp);
+    }
+
+    /// Address of the internal data buffer
+    const char* address()   const { return m_begin; }
+    /// Max number of bytes the buffer can hold.
+    size_t      max_size()  const { return m_size; }
+    /// Current number of bytes available to read.
+    size_t      size()      const { return m_len; }
+    /// Current number of bytes available to write.
+    size_t      capacity()  const { return m_size - m_len; }
+    /// Returns true if there's no data in the buffer
+    bool        empty()     const { return !m_len; }
+
+    /// Current read pointer.
+    const char* rd_ptr()    const { return m_begin + m_rd; }
+    char*       rd_ptr()          { return m_begin + m_rd; }
+
+    /// Current write pointer (may point to the second mapping).
+    const char* wr_ptr()    const { return m_begin + m_rd + m_len; }
+    char*       wr_ptr()          { return m_begin + m_rd + m_len; }
+
+    /// End of the writable space.
+    const char* end()       const { return rd_ptr() + m_size; }
+
+    /// Read \a n bytes from the buffer and increment the rd_ptr() by \a n.
+    /// @returns NULL if there is not enough data in the buffer
+    ///         to read \a n bytes or else returns the rd_ptr() pointer's
+    ///         value preceeding the increment of its position by \a n.
+    char* read(int n) {
+        if (UNLIKELY((size_t)n > m_len))
+            return NULL;
+        char* p = rd_ptr();
+        m_len  -= n;
+        m_rd   += n;
+        if (m_rd >= m_size)
+            m_rd -= m_size;
+        return p;
+    }
+
+    /// Same as read(n) (the buffer never needs crunching).
+    /// @returns -1 if there is not enough data in the buffer
+    int read_and_crunch(int n) { return read(n) ? n : -1; }
+
+    /// Write \a n bytes to a buffer from a given source \a a_src.
+    /// @return pointer to the next possible buffer write location.
+    char* write(const char* a_src, size_t n) {
+        reserve(n);
+        memcpy(wr_ptr(), a_src, n);
+        commit(n);
+        return wr_ptr();
+    }
+
+    /// Adjust buffer write pointer by \a n bytes.
+    void commit(int n)   { BOOST_ASSERT(size_t(n) <= capacity()); m_len += n; }
+
+    /// No-op: unread data and free space are always contiguous.
+    void crunch() {}
+};
+
+/// Mirrored ring I/O buffer of the default size
+typedef basic_mirrored_io_buffer<> mirrored_io_buffer;
+
+} // namespace utxx
@@ -0,0 +1,321 @@
+//----------------------------------------------------------------------------
+/// \file   perf_counters.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Hardware performance counters attributed to named code scopes.
+///
+/// Counters are opened per thread with perf_event_open(2) as one group
+/// and read in user space with the `rdpmc` instruction when the kernel
+/// permits it (falling back to read(2) otherwise):
+/// \code
+///     static utxx::perf_scope_id s_hot_loop("hot_loop");
+///     while (running) {
+///         utxx::perf_scope scope(s_hot_loop);
+///         ...
+///     }
+///     utxx::perf_registry::instance().dump(std::cout);
+/// \endcode
+/// Per-scope totals are kept in per-thread slots updated by the owning
+/// thread only (no atomic read-modify-write instructions). When counters
+/// are not permitted (e.g. perf_event_paranoid or a VM without PMU) the
+/// scopes still count calls and report zero counter values.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include <utxx/logger/logger_enums.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace utxx {
+
+//----------------------------------------------------------------------------
+/// Counters collected by perf_counters
+//----------------------------------------------------------------------------
+enum class perf_event {
+      CYCLES
+    , INSTRUCTIONS
+    , L1D_MISSES
+    , LLC_MISSES
+    , BRANCH_MISSES
+    , DTLB_MISSES
+    , TASK_CLOCK            ///< Software counter: nanoseconds on CPU
+    , COUNT
+};
+
+/// Name of the counter (e.g. "cycles")
+const char* to_string(perf_event a_event);
+
+/// Snapshot (or difference) of counter values indexed by perf_event
+struct perf_values {
+    uint64_t v[int(perf_event::COUNT)];
+
+    uint64_t  operator[](perf_event e) const { return v[int(e)]; }
+    uint64_t& operator[](perf_event e)       { return v[int(e)]; }
+};
+
+//----------------------------------------------------------------------------
+/// Group of performance counters of the calling thread
+//----------------------------------------------------------------------------
+class perf_counters : boost::noncopyable {
+    struct counter {
+        int     fd;
+        void*   page;       // perf_event_mmap_page for rdpmc reads
+    };
+
+    counter m_ctrs[int(perf_event::COUNT)];
+    int     m_order[int(perf_event::COUNT)];    // Events in the group order
+    int     m_count;                            // Number of opened counters
+    bool    m_rdpmc;
+
+    static bool read_counter(const counter& a_ctr, uint64_t& a_val);
+    bool        read_group(perf_values& a_val) const;
+public:
+    /// Mask of all hardware counters
+    static const unsigned s_hw_events = (1u << int(perf_event::TASK_CLOCK)) - 1;
+
+    /// Bit of \a a_event in the mask passed to the constructor
+    static constexpr unsigned mask(perf_event a_event) { return 1u << int(a_event); }
+
+    /// Open counters in \a a_events mask for the calling thread. The ones
+    /// that can't be opened (not supported or not permitted) read as zeros.
+    /// Note that TASK_CLOCK is a software event that can't be read with
+    /// rdpmc, so it costs a system call per read.
+    explicit perf_counters(unsigned a_events = s_hw_events);
+    ~perf_counters();
+
+    /// True if at least one counter is available
+    bool available() const { return m_count > 0; }
+
+    /// True if \a a_event counter is available
+    bool available(perf_event a_event) const {
+        return m_ctrs[int(a_event)].fd >= 0;
+    }
+
+    /// True if counters are read in user space with rdpmc
+    bool user_rdpmc() const { return m_rdpmc; }
+
+    /// Read current counter values (must be called by the owning thread).
+    /// When a counter is not scheduled on a PMU (e.g. it is multiplexed),
+    /// rdpmc can't read it, and the whole group is read with a system call.
+    /// @return false if the values couldn't be read, in which case the
+    ///         sample must not be used
+    bool read(perf_values& a_val) const {
+        if (!m_rdpmc)
+            return read_group(a_val);
+        for (int i=0; i < int(perf_event::COUNT); ++i)
+            if (m_ctrs[i].fd < 0)
+                a_val.v[i] = 0;
+            else if (!read_counter(m_ctrs[i], a_val.v[i]))
+                return read_group(a_val);
+        return true;
+    }
+};
+
+inline bool perf_counters::read_counter(const counter& a_ctr, uint64_t& a_val) {
+#if defined(__x86_64__) || defined(__i386__)
+    // See the description of perf_event_mmap_page in linux/perf_event.h
+    auto pc = static_cast<volatile perf_event_mmap_page*>(a_ctr.page);
+    if (!pc)
+        return false;
+    uint32_t seq, idx;
+    do {
+        seq = pc->lock;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        idx = pc->index;
+        if (!pc->cap_user_rdpmc || !idx)
+            return false;
+        uint32_t lo, hi;
+        asm volatile("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx-1));
+        int     shift = 64 - pc->pmc_width;
+        int64_t pmc   = int64_t(uint64_t(hi) << 32 | lo) << shift >> shift;
+        a_val = pc->offset + pmc;
+        std::atomic_signal_fence(std::memory_order_acquire);
+    } while (pc->lock != seq);
+    return true;
+#else
+    (void)a_ctr; (void)a_val;
+    return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+/// Identifier of a named scope
+//----------------------------------------------------------------------------
+class perf_scope_id : boost::noncopyable {
+    uint32_t m_id;
+public:
+    /// Register a scope with \a a_name. Scopes are meant to be declared as
+    /// static variables, at most perf_registry::s_max_scopes of them.
+    explicit perf_scope_id(const char* a_name);
+
+    uint32_t id() const { return m_id; }
+};
+
+/// Aggregated statistics of a scope
+struct perf_scope_stats {
+    std::string  name;
+    uint64_t     calls;
+    perf_values  values;
+
+    /// Instructions per cycle
+    double ipc() const {
+        auto c = values[perf_event::CYCLES];
+        return c ? double(values[perf_event::INSTRUCTIONS]) / c : 0.0;
+    }
+    /// Average value of \a a_event per call
+    double per_call(perf_event a_event) const {
+        return calls ? double(values[a_event]) / calls : 0.0;
+    }
+};
+
+//----------------------------------------------------------------------------
+/// Registry of scopes and per-thread counter totals
+//----------------------------------------------------------------------------
+class perf_registry : boost::noncopyable {
+public:
+    static const uint32_t s_max_scopes = 256;
+
+    /// Per-thread storage: counters and totals of each scope. Totals are
+    /// written by the owning thread only, and read by the reporting thread
+    /// with relaxed loads.
+    struct thread_data {
+        struct slot {
+            std::atomic<uint64_t> calls;
+            std::atomic<uint64_t> v[int(perf_event::COUNT)];
+        };
+
+        perf_counters   counters;
+        slot            slots[s_max_scopes];
+
+        explicit thread_data(unsigned a_events);
+
+        void add(uint32_t a_id, const perf_values& a_start, const perf_values& a_end) {
+            auto& s = slots[a_id];
+            s.calls.store(s.calls.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+            for (int i=0; i < int(perf_event::COUNT); ++i)
+                s.v[i].store(s.v[i].load(std::memory_order_relaxed) +
+                             a_end.v[i] - a_start.v[i], std::memory_order_relaxed);
+        }
+    };
+
+    static perf_registry& instance();
+
+    /// Set the mask of counters (see perf_counters::mask()) opened by
+    /// threads that haven't used perf_scope yet
+    void events(unsigned a_mask) { m_events = a_mask; }
+    unsigned events() const      { return m_events;   }
+
+    /// Storage of the calling thread (created on first use). When the
+    /// thread exits, its totals are retained by the registry and its
+    /// counters are closed.
+    thread_data& local() {
+        static thread_local thread_owner s_local;
+        return s_local.data ? *s_local.data : *(s_local.data = add_thread());
+    }
+
+    /// Aggregate totals of scopes across all threads (only the scopes
+    /// that were entered at least once are returned)
+    std::vector<perf_scope_stats> collect() const;
+
+    /// Number of live threads that have storage in the registry
+    size_t threads() const;
+
+    /// Zero all totals. Updates running concurrently may be lost.
+    void reset();
+
+    /// Print a table of scopes with per call counter values and IPC
+    void dump(std::ostream& out) const;
+
+    /// Write CSV with a header line and total counter values per scope
+    void to_csv(std::ostream& out) const;
+
+    /// Print the dump() report through the logger with \a a_level
+    void log(log_level a_level = LEVEL_INFO) const;
+
+private:
+    friend class perf_scope_id;
+
+    /// Releases the thread's storage on thread exit
+    struct thread_owner {
+        thread_data* data = nullptr;
+        ~thread_owner() { if (data) instance().remove_thread(data); }
+    };
+
+    /// Totals of a scope accumulated by the threads that exited
+    struct totals {
+        uint64_t     calls;
+        perf_values  values;
+    };
+
+    mutable std::mutex                          m_mutex;
+    std::atomic<unsigned>                       m_events;
+    std::vector<std::string>                    m_names;
+    std::vector<std::unique_ptr<thread_data>>   m_threads;
+    totals                                      m_retired[s_max_scopes];
+
+    perf_registry();
+
+    uint32_t     add_scope(const char* a_name);
+    thread_data* add_thread();
+    void         remove_thread(thread_data* a_data);
+};
+
+//----------------------------------------------------------------------------
+/// RAII guard attributing counter deltas of its lifetime to a scope
+//----------------------------------------------------------------------------
+class perf_scope : boost::noncopyable {
+    perf_registry::thread_data& m_data;
+    uint32_t                    m_id;
+    bool                        m_valid;
+    perf_values                 m_start;
+public:
+    explicit perf_scope(const perf_scope_id& a_id)
+        : m_data(perf_registry::instance().local())
+        , m_id(a_id.id())
+        , m_valid(m_data.counters.read(m_start))
+    {}
+
+    /// A sample whose counters couldn't be read is not accumulated
+    ~perf_scope() {
+        perf_values end;
+        if (m_valid && m_data.counters.read(end))
+            m_data.add(m_id, m_start, end);
+    }
+};
+
+} // namespace utxx
@@ -26,6 +26,7 @@ at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/assert.hpp>
 #include <utxx/basic_buffer_queue.hpp>
 
 namespace utxx {
@@ -42,11 +43,29 @@ class shared_const_buffer : public boost::asio::const_buffer {
 
     boost::shared_ptr<shadow> m_ptr;
 
+    shared_const_buffer(const boost::asio::const_buffer& a_buf,
+                        const boost::shared_ptr<shadow>& a_ptr)
+        : boost::asio::const_buffer(a_buf)
+        , m_ptr(a_ptr)
+    {}
+
 public:
+    /// Empty buffer not owning any data
+    shared_const_buffer() {}
+
     shared_const_buffer(const boost::asio::const_buffer& a_buf, del_t a_del)
         : boost::asio::const_buffer(a_buf)
         , m_ptr(new shadow(a_del))
     {}
+
+    /// Part of this buffer of \a a_size bytes starting at \a a_offset that
+    /// shares ownership of the data with this buffer.
+    shared_const_buffer slice(size_t a_offset, size_t a_size) const {
+        BOOST_ASSERT(a_offset + a_size <= boost::asio::buffer_size(*this));
+        return shared_const_buffer(boost::asio::const_buffer
+            (boost::asio::buffer_cast<const char*>(*this) + a_offset, a_size),
+            m_ptr);
+    }
 };
 
 template <typename Alloc = std::allocator<char> >
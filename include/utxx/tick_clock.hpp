@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------------
+/// \file   tick_clock.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Clock policies measuring time in integer ticks.
+///
+/// A clock policy provides:
+///   - now()       - current time in ticks;
+///   - ticks(nsec) - convert nanoseconds to ticks;
+///   - nsec(ticks) - convert ticks to nanoseconds.
+/// It's used by components that do arithmetic on raw timestamps in their
+/// fast path (e.g. gcra_throttle, timer_wheel).
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/time_val.hpp>
+#include <utxx/high_res_timer.hpp>
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Real time clock with nanosecond ticks
+//-----------------------------------------------------------------------------
+struct nsec_clock {
+    static long now()                 { return now_utc().nanoseconds(); }
+    static long ticks(long a_nsec)    { return a_nsec;  }
+    static long nsec (long a_ticks)   { return a_ticks; }
+};
+
+//-----------------------------------------------------------------------------
+/// CPU time stamp counter clock.
+/// high_res_timer::calibrate() must be called before converting time.
+//-----------------------------------------------------------------------------
+struct tsc_clock {
+    static long now()                 { return long(high_res_timer::gettime()); }
+    static long ticks(long a_nsec)    {
+        return a_nsec * long(high_res_timer::global_scale_factor()) / 1000;
+    }
+    static long nsec (long a_ticks)   {
+        return a_ticks * 1000 / long(high_res_timer::global_scale_factor());
+    }
+};
+
+} // namespace utxx
@@ -0,0 +1,379 @@
+//----------------------------------------------------------------------------
+/// \file   timer_wheel.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Hashed hierarchical timer wheel.
+///
+/// Timers are kept in LEVELS wheels of 64 slots. Level L holds timers due
+/// in [64^L, 64^(L+1)) ticks, which move to lower levels as time advances
+/// and the slot they are in comes up (see G. Varghese, T. Lauck "Hashed
+/// and Hierarchical Timing Wheels"). Scheduling and cancelling a timer is
+/// O(1), and a bitmap of non-empty slots per level lets expire() skip idle
+/// time without visiting empty slots.
+///
+/// Timers are nodes in a pool addressed by 32-bit indices, so after the
+/// pool reaches the peak number of timers (or after reserve()) no memory
+/// is allocated. A timer_id includes a generation counter of the node, so
+/// cancelling a timer that already fired is a safe no-op.
+///
+/// The wheel is not thread-safe. It's driven either by calling expire()
+/// from a polling loop (next_expiration() tells how long the loop may
+/// sleep), or by asio_timer_wheel (see boost/asio_timer_wheel.hpp).
+/// \code
+/// timer_wheel wheel(usecs(100));
+/// auto id = wheel.schedule_after(msecs(50), order_id);
+/// ...
+/// wheel.cancel(id);   // order was acknowledged
+/// ...
+/// wheel.expire([](timer_wheel::timer_id, uint64_t a_order_id) { ... });
+/// \endcode
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <utxx/tick_clock.hpp>
+#include <utxx/compiler_hints.hpp>
+#include <algorithm>
+#include <vector>
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Timer wheel
+/// @tparam Data  user data of a timer passed to the expiration callback
+/// @tparam Clock clock policy (see tick_clock.hpp)
+//-----------------------------------------------------------------------------
+template <class Data = uint64_t, class Clock = nsec_clock>
+class basic_timer_wheel {
+public:
+    typedef uint64_t timer_id;
+    typedef Data     data_type;
+    typedef Clock    clock_type;
+
+    static const int      BITS       = 6;
+    static const int      SLOTS      = 1 << BITS;
+    static const int      LEVELS     = 8;
+    static const timer_id NULL_TIMER = 0;
+
+    /// Longest delay of a timer in ticks (longer delays are truncated)
+    static const long     MAX_TICKS  = (1L << (BITS * LEVELS)) - 1;
+
+private:
+    static const uint32_t NIL    = ~0u;
+    static const uint32_t FIRING = LEVELS * SLOTS;  // List of timers being fired
+    static const uint32_t FREE   = FIRING + 1;      // Node is on the free list
+
+    struct node {
+        uint32_t next;
+        uint32_t prev;
+        uint32_t list;      // Index of the list in m_heads
+        uint32_t gen;       // Incremented when the node is freed
+        long     expire;    // Expiration tick
+        Data     data;
+    };
+
+    std::vector<node> m_nodes;
+    uint32_t          m_heads[LEVELS * SLOTS + 1];
+    uint64_t          m_occupied[LEVELS];   // Bitmap of non-empty slots
+    uint32_t          m_free;
+    size_t            m_size;
+    long              m_tick;               // Tick length in clock units
+    long              m_origin;             // Clock time of tick 0
+    long              m_now;                // Last processed tick
+
+    static timer_id make_id(uint32_t a_idx, uint32_t a_gen) {
+        return (timer_id(a_gen) << 32) | (a_idx + 1);
+    }
+
+    /// @return node index of \a a_id or NIL if the timer is not active
+    uint32_t find_idx(timer_id a_id) const {
+        uint32_t idx = uint32_t(a_id) - 1;
+        return idx < m_nodes.size() && m_nodes[idx].gen == uint32_t(a_id >> 32)
+            && m_nodes[idx].list != FREE ? idx : NIL;
+    }
+
+    uint32_t alloc() {
+        if (m_free == NIL) {
+            m_nodes.emplace_back();
+            m_nodes.back().gen = 1;
+            return m_nodes.size() - 1;
+        }
+        uint32_t idx = m_free;
+        m_free = m_nodes[idx].next;
+        return idx;
+    }
+
+    void release(uint32_t a_idx) {
+        node& n = m_nodes[a_idx];
+        n.list  = FREE;
+        n.next  = m_free;
+        n.data  = Data();
+        ++n.gen;
+        m_free  = a_idx;
+    }
+
+    void push(uint32_t a_list, uint32_t a_idx) {
+        node& n = m_nodes[a_idx];
+        n.list  = a_list;
+        n.prev  = NIL;
+        n.next  = m_heads[a_list];
+        if (n.next != NIL)
+            m_nodes[n.next].prev = a_idx;
+        m_heads[a_list] = a_idx;
+    }
+
+    void unlink(uint32_t a_idx) {
+        node& n = m_nodes[a_idx];
+        if (n.prev != NIL) m_nodes[n.prev].next = n.next;
+        else               m_heads[n.list]      = n.next;
+        if (n.next != NIL) m_nodes[n.next].prev = n.prev;
+        if (m_heads[n.list] == NIL && n.list < FIRING)
+            m_occupied[n.list / SLOTS] &= ~(1ul << (n.list % SLOTS));
+    }
+
+    /// Put the node in the slot of its expiration tick relative to m_now
+    void link(uint32_t a_idx) {
+        node& n = m_nodes[a_idx];
+        if (n.expire <= m_now)
+            n.expire = m_now + 1;
+        else if (n.expire - m_now > MAX_TICKS)
+            n.expire = m_now + MAX_TICKS;
+        int level = (63 - __builtin_clzl(n.expire - m_now)) / BITS;
+        int slot  = (n.expire >> (BITS * level)) & (SLOTS - 1);
+        push(level * SLOTS + slot, a_idx);
+        m_occupied[level] |= 1ul << slot;
+    }
+
+    /// Tick after m_now at which a slot fires or is cascaded (LONG_MAX if none)
+    long next_event() const {
+        long best = LONG_MAX;
+        for (int level = 0; level < LEVELS; ++level) {
+            uint64_t bits = m_occupied[level];
+            if (!bits)
+                continue;
+            int  shift = BITS * level;
+            int  cur   = (m_now >> shift) & (SLOTS - 1);
+            long base  = (m_now >> (shift + BITS)) << (shift + BITS);
+            // Slots up to the current one were already processed in this
+            // rotation of the level, so they belong to the next rotation
+            uint64_t ahead = cur == SLOTS - 1 ? 0 : bits & (~0ul << (cur + 1));
+            long t = ahead ? base + (long(__builtin_ctzl(ahead)) << shift)
+                           : base + (long(SLOTS + __builtin_ctzl(bits)) << shift);
+            best = std::min(best, t);
+        }
+        return best;
+    }
+
+    /// Move timers of a slot of a higher level to lower levels
+    void cascade(int a_level, int a_slot) {
+        uint32_t list = a_level * SLOTS + a_slot;
+        uint32_t idx  = m_heads[list];
+        m_heads[list] = NIL;
+        m_occupied[a_level] &= ~(1ul << a_slot);
+        while (idx != NIL) {
+            uint32_t next = m_nodes[idx].next;
+            // Timers due at this tick go to the slot that is fired next
+            if (m_nodes[idx].expire == m_now) {
+                int slot = m_now & (SLOTS - 1);
+                push(slot, idx);
+                m_occupied[0] |= 1ul << slot;
+            } else
+                link(idx);
+            idx = next;
+        }
+    }
+
+    /// Call \a a_fun for timers of a slot of level 0
+    template <class Fun>
+    size_t fire(int a_slot, Fun& a_fun) {
+        uint32_t idx = m_heads[a_slot];
+        m_heads[a_slot]  = NIL;
+        m_occupied[0]   &= ~(1ul << a_slot);
+        m_heads[FIRING]  = idx;
+        for (; idx != NIL; idx = m_nodes[idx].next)
+            m_nodes[idx].list = FIRING;
+
+        size_t n = 0;
+        // The callback may cancel other timers in the FIRING list or
+        // schedule new ones, so each timer is removed before it's called
+        while ((idx = m_heads[FIRING]) != NIL) {
+            unlink(idx);
+            node& nd = m_nodes[idx];
+            auto  id = make_id(idx, nd.gen);
+            Data  d  = nd.data;
+            release(idx);
+            --m_size;
+            a_fun(id, d);
+            ++n;
+        }
+        return n;
+    }
+
+    long to_tick(long a_time, bool a_round_up) const {
+        long t = a_time - m_origin;
+        if (t <= 0) return 0;
+        return a_round_up ? (t + m_tick - 1) / m_tick : t / m_tick;
+    }
+
+public:
+    /// @param a_resolution duration of a tick
+    /// @param a_reserve    number of timers to preallocate
+    /// @param a_now        current clock time
+    explicit basic_timer_wheel(time_val a_resolution, size_t a_reserve = 0,
+                               long a_now = Clock::now())
+        : m_free(NIL), m_size(0)
+        , m_tick(std::max(1L, Clock::ticks(a_resolution.nanoseconds())))
+        , m_origin(a_now), m_now(0)
+    {
+        memset(m_heads,    0xFF, sizeof(m_heads));
+        memset(m_occupied, 0,    sizeof(m_occupied));
+        reserve(a_reserve);
+    }
+
+    /// Preallocate nodes for \a a_count timers
+    void reserve(size_t a_count) {
+        if (a_count <= m_nodes.size())
+            return;
+        m_nodes.reserve(a_count);
+        while (m_nodes.size() < a_count) {
+            m_nodes.emplace_back();
+            m_nodes.back().gen = 1;
+            release(m_nodes.size() - 1);
+        }
+    }
+
+    /// Number of active timers
+    size_t size()     const { return m_size;          }
+    bool   empty()    const { return !m_size;         }
+    /// Number of allocated timer nodes
+    size_t capacity() const { return m_nodes.size();  }
+    /// Tick length in clock units
+    long   tick()     const { return m_tick;          }
+    /// Clock time up to which timers were expired
+    long   now()      const { return m_origin + m_now * m_tick; }
+
+    /// Schedule a timer firing at clock time \a a_time
+    timer_id schedule_at(long a_time, const Data& a_data = Data()) {
+        uint32_t idx = alloc();
+        node& n  = m_nodes[idx];
+        n.expire = to_tick(a_time, true);
+        n.data   = a_data;
+        link(idx);
+        ++m_size;
+        return make_id(idx, n.gen);
+    }
+
+    /// Schedule a timer firing after \a a_delay from \a a_now
+    timer_id schedule_after(time_val a_delay, const Data& a_data = Data(),
+                            long a_now = Clock::now()) {
+        return schedule_at(a_now + Clock::ticks(a_delay.nanoseconds()), a_data);
+    }
+
+    /// Cancel a timer
+    /// @return false if the timer already fired or was cancelled
+    bool cancel(timer_id a_id) {
+        uint32_t idx = find_idx(a_id);
+        if (idx == NIL)
+            return false;
+        unlink(idx);
+        release(idx);
+        --m_size;
+        return true;
+    }
+
+    /// Change expiration time of a timer to clock time \a a_time
+    /// @return false if the timer already fired or was cancelled
+    bool reschedule_at(timer_id a_id, long a_time) {
+        uint32_t idx = find_idx(a_id);
+        if (idx == NIL)
+            return false;
+        unlink(idx);
+        m_nodes[idx].expire = to_tick(a_time, true);
+        link(idx);
+        return true;
+    }
+
+    /// @return pointer to the data of a timer, or NULL if it's not active
+    Data* find(timer_id a_id) {
+        uint32_t idx = find_idx(a_id);
+        return idx == NIL ? nullptr : &m_nodes[idx].data;
+    }
+
+    /// Clock time when expire() has timers to process (some of them may
+    /// only move to a lower level), or LONG_MAX if there are no timers
+    long next_expiration() const {
+        long t = next_event();
+        return t == LONG_MAX ? t : m_origin + t * m_tick;
+    }
+
+    /// Fire all timers due at clock time \a a_now in the order of their
+    /// expiration ticks.
+    /// @param a_fun is void(timer_id, Data&)
+    /// @return number of fired timers
+    template <class Fun>
+    size_t expire(long a_now, Fun&& a_fun) {
+        long   target = to_tick(a_now, false);
+        size_t n      = 0;
+
+        for (long t; (t = next_event()) <= target; ) {
+            m_now = t;
+            if ((t & (SLOTS - 1)) == 0)
+                for (int level = 1; level < LEVELS; ++level) {
+                    int slot = (t >> (BITS * level)) & (SLOTS - 1);
+                    cascade(level, slot);
+                    if (slot)
+                        break;
+                }
+            n += fire(t & (SLOTS - 1), a_fun);
+        }
+        if (target > m_now)
+            m_now = target;
+        return n;
+    }
+
+    template <class Fun>
+    size_t expire(Fun&& a_fun) { return expire(Clock::now(), a_fun); }
+
+    /// Cancel all timers
+    void clear() {
+        for (uint32_t i=0; i < m_nodes.size(); ++i)
+            if (m_nodes[i].list != FREE)
+                release(i);
+        memset(m_heads,    0xFF, sizeof(m_heads));
+        memset(m_occupied, 0,    sizeof(m_occupied));
+        m_size = 0;
+    }
+};
+
+/// Timer wheel with nanosecond clock and integer user data
+typedef basic_timer_wheel<> timer_wheel;
+
+} // namespace utxx
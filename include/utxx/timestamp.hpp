@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <utxx/high_res_timer.hpp>
 #include <utxx/time_val.hpp>
+#include <utxx/fast_itoa.hpp>
 #include <boost/thread.hpp>
 #include <time.h>
 
@@ -60,9 +61,9 @@ class timestamp {
 protected:
     static const long DAY_NSEC = 86400L * 1000000000L;
 
-    static boost::mutex             s_mutex;
     static thread_local long        s_next_utc_midnight_nseconds;
     static thread_local long        s_next_local_midnight_nseconds;
+    static thread_local long        s_next_utc_offset_change_nseconds;
     static thread_local long        s_utc_nsec_offset;
     static thread_local char        s_utc_timestamp[16];
     static thread_local char        s_local_timestamp[16];
@@ -83,8 +84,6 @@ protected:
         return time_val::write_date(sec, a_buf, eos_pos, a_sep);
     }
 
-    static void update_slow();
-
     static void check_midnight_seconds() {
         if (likely(s_next_utc_midnight_nseconds)) return;
         timestamp ts; ts.update();
@@ -99,6 +98,14 @@ public:
     static const char* cached_utc_timestamp()   { return s_utc_timestamp;   }
     static const char* cached_local_timestamp() { return s_local_timestamp; }
 
+    /// Narrow the UTC range [a_begin, a_end) containing \a a_utc_sec down to
+    /// the seconds having the same local UTC offset as \a a_utc_sec.
+    /// At most one offset change (e.g. a daylight savings time switch) is
+    /// assumed on either side of \a a_utc_sec within the range.
+    /// @param a_offset if not NULL, is set to the UTC offset in seconds
+    static std::pair<time_t, time_t> utc_offset_range
+        (time_t a_utc_sec, time_t a_begin, time_t a_end, long* a_offset = nullptr);
+
     /// Write local date in format: YYYYMMDD, YYYY-MM-DD. If \a eos_pos > 8
     /// the function appends '-' at the end of the YYYYMMDD string.
     /// The function sets a_buf[eos_pos] = '\0'.
@@ -140,12 +147,12 @@ public:
     }
 
     static void check_day_change(time_val a_now) {
-        // FIXME: the method below will produce incorrect time stamps during
-        // switch to/from daylight savings time because of the unaccounted
-        // utc_offset change.
+        // A switch to/from daylight savings time changes utc_offset, so
+        // the next offset change is tracked in addition to midnights
         auto ns = a_now.nanoseconds();
         if (unlikely((ns >= s_next_utc_midnight_nseconds) ||
-                     (ns + s_utc_nsec_offset >= s_next_local_midnight_nseconds)))
+                     (ns + s_utc_nsec_offset >= s_next_local_midnight_nseconds) ||
+                     (ns >= s_next_utc_offset_change_nseconds)))
             update_midnight_nseconds(a_now);
     }
 
@@ -266,6 +273,86 @@ public:
     static time_val from_string(const char* a_datetime, size_t n, bool a_utc = true);
 };
 
+//---------------------------------------------------------------------------
+/// Formatter of time_val timestamps caching the rendered string
+//---------------------------------------------------------------------------
+/// The string is rendered in full only when the date or the UTC offset
+/// changes, and the "HH:MM:SS" part is re-rendered when the second changes.
+/// Timestamps falling in the last rendered second only have their
+/// fractional digits patched.
+///
+/// The UTC offset is looked up for the whole range where it is constant,
+/// so switches to/from daylight savings time are detected without any
+/// locking. An instance is not thread-safe: use one per thread.
+///
+/// Supported styles:
+///   DEFAULT  - YYYYMMDD-HH:MM:SS[.fff[fff[fff]]] (same as timestamp::format)
+///   FIX      - same as DEFAULT, always in UTC (FIX UTCTimestamp/UTCTimeOnly)
+///   ISO8601  - YYYY-MM-DDTHH:MM:SS[.fff[fff[fff]]]{Z|+HH:MM}
+//---------------------------------------------------------------------------
+class time_formatter {
+public:
+    enum style { DEFAULT, FIX, ISO8601 };
+
+    /// Maximum length of a formatted string (excluding the NULL terminator)
+    static const size_t MAX_SIZE = 35;
+
+    explicit time_formatter(stamp_type a_tp = DATE_TIME_WITH_USEC,
+                            bool a_utc = false, style a_style = DEFAULT);
+
+    stamp_type type()  const { return m_type;  }
+    style      format_style() const { return m_style; }
+    bool       utc()   const { return m_utc;   }
+
+    /// Length of every formatted string (excluding the NULL terminator)
+    size_t     size()  const { return m_size;  }
+
+    /// Write NULL-terminated \a a_tv to \a a_buf of at least size()+1 bytes.
+    /// @return pointer to the NULL terminator
+    char* write(char* a_buf, time_val a_tv) {
+        auto pair = a_tv.split();
+        if (unlikely(pair.first != m_sec))
+            refresh(pair.first);
+        memcpy(a_buf, m_buf, m_size+1);
+        if (m_frac_digits)
+            sse::u32toa_fixed(pair.second / m_frac_div, a_buf + m_frac_pos, m_frac_digits);
+        return a_buf + m_size;
+    }
+
+    /// Write \a a_n timestamps as records of size() characters placed
+    /// \a a_stride bytes apart. If \a a_stride is greater than size(),
+    /// each record is NULL-terminated.
+    /// @return pointer past the last record
+    char* write(const time_val* a_tv, size_t a_n, char* a_buf, size_t a_stride);
+
+    /// Same as write(a_tv, a_n, a_buf, size()), i.e. the records are packed.
+    char* write(const time_val* a_tv, size_t a_n, char* a_buf) {
+        return write(a_tv, a_n, a_buf, m_size);
+    }
+
+    std::string to_string(time_val a_tv) {
+        char buf[MAX_SIZE+1];
+        return std::string(buf, write(buf, a_tv) - buf);
+    }
+
+private:
+    stamp_type  m_type;
+    style       m_style;
+    bool        m_utc;
+    int         m_time_pos;     // Offset of "HH:MM:SS" or -1
+    int         m_frac_pos;     // Offset of the first fractional digit
+    unsigned    m_frac_digits;  // 0, 3, 6, or 9
+    unsigned    m_frac_div;     // Nanoseconds divisor of fractional digits
+    size_t      m_size;
+    time_t      m_sec;          // UTC second rendered in m_buf
+    time_t      m_valid_begin;  // UTC range of seconds sharing the date and
+    time_t      m_valid_end;    // the UTC offset rendered in m_buf
+    long        m_offset;       // UTC offset in seconds
+    char        m_buf[MAX_SIZE+1];
+
+    void refresh(time_t a_utc_sec);
+};
+
 //---------------------------------------------------------------------------
 /// Streaming support for time_val
 //---------------------------------------------------------------------------
@@ -284,7 +371,8 @@ struct test_timestamp : public timestamp {
     /// to times different from now.  Otherwise in production code
     /// always use timestamp::update() instead.
     void update(time_val a_now) {
-        if (unlikely(a_now.nanoseconds() >= s_next_utc_midnight_nseconds))
+        if (unlikely(a_now.nanoseconds() >= s_next_utc_midnight_nseconds ||
+                     a_now.nanoseconds() >= s_next_utc_offset_change_nseconds))
             update_midnight_nseconds(a_now);
     }
 
@@ -294,8 +382,9 @@ struct test_timestamp : public timestamp {
     /// for testing in combination with update(a_now, a_hrnow).
     /// Note: it only resets the midnight seconds in the current thread's TLS
     static void reset() {
-        s_next_local_midnight_nseconds = 0;
-        s_next_utc_midnight_nseconds   = 0;
+        s_next_local_midnight_nseconds    = 0;
+        s_next_utc_midnight_nseconds      = 0;
+        s_next_utc_offset_change_nseconds = 0;
     }
 
     /// Use for testing only.
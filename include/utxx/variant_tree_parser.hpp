@@ -94,6 +94,36 @@ namespace utxx {
             a_tree.validate();
     }
 
+    /**
+     * @brief Read SCON/INI/XML format from a memory buffer
+     * @param a_data     is the buffer holding configuration text (it's not
+     *                   required to be NUL-terminated)
+     * @param a_size     is the size of the buffer in characters
+     * @param a_tree     is the tree
+     * @param a_format   is the format of the buffer
+     * @param a_filename is a filename associated with the buffer in case
+     *                   of exceptions (included files are looked up
+     *                   relative to its directory)
+     * @note Replaces the existing contents. Strong exception guarantee.
+     * @throw file_parser_error If the buffer doesn't contain valid format,
+     *                          or a conversion fails.
+     */
+    template<class Ch>
+    void read_config
+    (
+        const Ch*                    a_data,
+        size_t                       a_size,
+        basic_variant_tree<Ch>&      a_tree,
+        config_format                a_format,
+        const std::basic_string<Ch>& a_filename  = std::basic_string<Ch>(),
+        const boost::function<bool (std::basic_string<Ch>& a_filename)>
+                                     a_resolver = inc_file_resolver<Ch>(),
+        int                          a_flags = 0
+    ) {
+        detail::basic_memory_istream<Ch> stream(a_data, a_size);
+        read_config(stream, a_tree, a_format, a_filename, a_resolver, a_flags);
+    }
+
     /**
      * @brief Read SCON/INI/XML/INFO file format by guessing content type by extension
      * @param a_filename is a filename associated with stream in case of exceptions
@@ -132,7 +162,8 @@ namespace utxx {
                 throw std::runtime_error("Configuration file extension not supported!");
         }
 
-        std::basic_ifstream<Ch> stream(a_filename.c_str());
+        // The file is memory-mapped rather than read through a filebuf
+        typename detail::config_ifstream<Ch>::type stream(a_filename.c_str());
         if (!stream)
             throw variant_tree_parser_error(
                 "cannot open file for reading", a_filename, 0);
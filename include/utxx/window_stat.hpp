@@ -0,0 +1,485 @@
+//----------------------------------------------------------------------------
+/// \file   window_stat.hpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Sliding window statistics with O(1) amortized updates.
+///
+/// This file implements:
+///   - ewma              - exponentially weighted moving average with the
+///                         smoothing factor decaying with elapsed time;
+///   - p2_quantile       - P-square streaming quantile estimator;
+///   - basic_window_stat - mean / variance / min / max / quantiles over a
+///                         window of the last N samples or of the samples
+///                         within a time interval.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#pragma once
+
+#include <math.h>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+#include <assert.h>
+#include <utxx/time_val.hpp>
+#include <utxx/compiler_hints.hpp>
+
+namespace utxx {
+
+//-----------------------------------------------------------------------------
+/// Exponentially weighted moving average with time-decayed smoothing factor.
+//-----------------------------------------------------------------------------
+/// For a sample arriving \a dt after the previous one the smoothing factor
+/// is alpha = 1 - exp(-dt/tau), so irregularly spaced samples are weighted
+/// by the time they have been in effect.
+class ewma {
+    double   m_tau_inv;     ///< 1/tau in nanoseconds^-1
+    double   m_value;
+    time_val m_last_time;
+    bool     m_empty;
+public:
+    explicit ewma(time_val a_tau = secs(1)) { tau(a_tau); clear(); }
+
+    void clear() { m_value = 0.0; m_last_time = time_val(); m_empty = true; }
+
+    /// Set decay time constant
+    void tau(time_val a_tau) {
+        if (a_tau.nanoseconds() <= 0)
+            throw std::out_of_range("utxx::ewma: tau must be > 0!");
+        m_tau_inv = 1.0 / a_tau.nanoseconds();
+    }
+
+    /// Add a sample measured at \a a_now.
+    /// @return updated average
+    double add(time_val a_now, double a_value) {
+        if (unlikely(m_empty)) {
+            m_empty = false;
+            m_value = a_value;
+        } else {
+            auto   dt    = a_now.diff_nsec(m_last_time);
+            double alpha = dt > 0 ? 1.0 - exp(-dt * m_tau_inv) : 0.0;
+            m_value += alpha * (a_value - m_value);
+        }
+        m_last_time = a_now;
+        return m_value;
+    }
+
+    bool     empty()     const { return m_empty;     }
+    double   value()     const { return m_value;     }
+    time_val last_time() const { return m_last_time; }
+};
+
+//-----------------------------------------------------------------------------
+/// P-square streaming quantile estimator.
+//-----------------------------------------------------------------------------
+/// Estimates a quantile using five markers adjusted with piecewise-parabolic
+/// interpolation: O(1) time and space per sample.
+/// \see R. Jain, I. Chlamtac "The P-Square Algorithm for Dynamic Calculation
+///      of Quantiles and Histograms Without Storing Observations", 1985.
+class p2_quantile {
+    double m_p;
+    size_t m_count;
+    double m_q[5];  ///< Marker heights
+    double m_n[5];  ///< Marker positions
+    double m_d[5];  ///< Desired marker positions
+
+    double parabolic(int i, double d) const {
+        return m_q[i] + d / (m_n[i+1] - m_n[i-1])
+             * ((m_n[i] - m_n[i-1] + d) * (m_q[i+1] - m_q[i]) / (m_n[i+1] - m_n[i])
+             +  (m_n[i+1] - m_n[i] - d) * (m_q[i] - m_q[i-1]) / (m_n[i] - m_n[i-1]));
+    }
+
+    double linear(int i, int d) const {
+        return m_q[i] + d * (m_q[i+d] - m_q[i]) / (m_n[i+d] - m_n[i]);
+    }
+public:
+    explicit p2_quantile(double a_p = 0.5) : m_p(a_p) {
+        if (a_p < 0.0 || a_p > 1.0)
+            throw std::out_of_range("utxx::p2_quantile: quantile must be in [0, 1]!");
+        clear();
+    }
+
+    void clear() { m_count = 0; }
+
+    void add(double a_x) {
+        if (unlikely(m_count < 5)) {
+            m_q[m_count++] = a_x;
+            if (m_count == 5) {
+                std::sort(m_q, m_q+5);
+                for (int i=0; i < 5; ++i) m_n[i] = i;
+                m_d[0] = 0; m_d[1] = 2*m_p; m_d[2] = 4*m_p; m_d[3] = 2+2*m_p; m_d[4] = 4;
+            }
+            return;
+        }
+
+        int k;
+        if (a_x < m_q[0])       { m_q[0] = a_x; k = 0; }
+        else if (a_x >= m_q[4]) { m_q[4] = a_x; k = 3; }
+        else for (k = 0; a_x >= m_q[k+1]; ++k);
+
+        for (int i=k+1; i < 5; ++i) m_n[i] += 1;
+        m_d[1] += m_p/2; m_d[2] += m_p; m_d[3] += (1+m_p)/2; m_d[4] += 1;
+        ++m_count;
+
+        for (int i=1; i < 4; ++i) {
+            double d = m_d[i] - m_n[i];
+            if ((d >=  1 && m_n[i+1] - m_n[i] >  1) ||
+                (d <= -1 && m_n[i-1] - m_n[i] < -1)) {
+                int    s = d > 0 ? 1 : -1;
+                double q = parabolic(i, s);
+                m_q[i]   = m_q[i-1] < q && q < m_q[i+1] ? q : linear(i, s);
+                m_n[i]  += s;
+            }
+        }
+    }
+
+    double quantile() const { return m_p;     }
+    size_t count()    const { return m_count; }
+    bool   empty()    const { return !m_count; }
+
+    /// Current estimate (exact while fewer than 5 samples were added)
+    double value() const {
+        if (likely(m_count >= 5))
+            return m_q[2];
+        if (!m_count)
+            return 0.0;
+        double q[5];
+        std::copy(m_q, m_q+m_count, q);
+        std::sort(q, q+m_count);
+        return q[size_t(m_p * (m_count-1) + 0.5)];
+    }
+};
+
+//-----------------------------------------------------------------------------
+/// Statistics over a sliding window of samples.
+//-----------------------------------------------------------------------------
+/// The window either holds the last N samples, or the samples whose
+/// timestamps are within a given duration of the last sample's timestamp.
+///
+/// All updates are O(1) amortized:
+///   - mean and variance are updated with Welford's formula on insertion
+///     and removal of a sample;
+///   - min and max are maintained with monotonic queues;
+///   - EWMA (time-decayed, see ewma) is updated by timestamped samples;
+///   - quantiles are P-square estimates over the most recent 1/2 to 1
+///     window length: for every quantile two staggered estimators are
+///     restarted every window length.
+template <typename T = double>
+class basic_window_stat {
+public:
+    /// Window of the last \a a_count samples
+    /// @param a_quantiles probabilities of estimated quantiles
+    /// @param a_ewma_tau  EWMA decay time constant
+    explicit basic_window_stat(size_t a_count,
+                               std::initializer_list<double> a_quantiles = {},
+                               time_val a_ewma_tau = secs(1))
+        : m_count_limit(a_count), m_ewma(a_ewma_tau)
+    {
+        if (!a_count)
+            throw std::invalid_argument("utxx::basic_window_stat: empty window!");
+        init(a_count, a_quantiles);
+    }
+
+    /// Window of samples within \a a_duration of the last sample
+    /// @param a_quantiles probabilities of estimated quantiles
+    /// @param a_ewma_tau  EWMA decay time constant
+    explicit basic_window_stat(time_val a_duration,
+                               std::initializer_list<double> a_quantiles = {},
+                               time_val a_ewma_tau = secs(1))
+        : m_count_limit(0), m_duration(a_duration), m_ewma(a_ewma_tau)
+    {
+        if (a_duration.nanoseconds() <= 0)
+            throw std::invalid_argument("utxx::basic_window_stat: empty window!");
+        init(16, a_quantiles);
+    }
+
+    /// Add a sample to a count-based window (EWMA is not updated)
+    void add(T a_value) {
+        assert(!time_based());
+        if (size() == m_count_limit)
+            pop_front();
+        push_back(a_value, time_val());
+        add_quantiles(m_end-1, a_value);
+    }
+
+    /// Add a sample measured at \a a_now.
+    /// In a time-based window samples not later than \a a_now - duration()
+    /// are removed.
+    void add(time_val a_now, T a_value) {
+        if (time_based()) {
+            expire(a_now);
+            if (unlikely(size() == capacity()))
+                grow();
+        } else if (size() == m_count_limit)
+            pop_front();
+        push_back(a_value, a_now);
+        m_ewma.add(a_now, a_value);
+        add_quantiles(time_based() ? a_now.nanoseconds() : long(m_end-1), a_value);
+    }
+
+    /// Add \a a_n samples to a count-based window
+    void add(const T* a_values, size_t a_n) {
+        assert(!time_based());
+        // Samples that would be pushed out by the end of the batch only
+        // affect quantile estimators
+        if (a_n > m_count_limit) {
+            for (auto p = a_values, e = a_values + a_n - m_count_limit; p != e; ++p)
+                add_quantiles(m_end++, *p);
+            clear_window();
+            a_values += a_n - m_count_limit;
+            a_n       = m_count_limit;
+        }
+        for (auto e = a_values + a_n; a_values != e; ++a_values)
+            add(*a_values);
+    }
+
+    /// Add \a a_n samples measured at \a a_times (in non-decreasing order)
+    void add(const time_val* a_times, const T* a_values, size_t a_n) {
+        for (size_t i=0; i < a_n; ++i)
+            add(a_times[i], a_values[i]);
+    }
+
+    /// Remove samples not later than \a a_now - duration() from a
+    /// time-based window
+    void expire(time_val a_now) {
+        assert(time_based());
+        auto last = a_now.nanoseconds() - m_duration.nanoseconds();
+        while (m_begin != m_end && m_times[m_begin & m_mask].nanoseconds() <= last)
+            pop_front();
+    }
+
+    /// Reset the internal state
+    void clear() {
+        clear_window();
+        m_end = m_begin = 0;
+        m_ewma.clear();
+        for (auto& q : m_quantiles) q.clear();
+    }
+
+    bool     time_based() const { return !m_count_limit;       }
+    /// Duration of a time-based window
+    time_val duration()   const { return m_duration;           }
+    /// Capacity of a count-based window
+    size_t   limit()      const { return m_count_limit;        }
+
+    bool     empty()      const { return m_begin == m_end;     }
+    /// Number of samples in the window
+    size_t   size()       const { return m_end - m_begin;      }
+    /// Total number of samples added since the last clear()
+    size_t   total()      const { return m_end;                }
+
+    T        last()       const { return empty() ? T(0) : m_values[(m_end-1) & m_mask]; }
+    T        sum()        const { return m_sum;                }
+    double   mean()       const { return likely(size()) ? double(m_sum) / size() : 0.0; }
+    double   variance()   const { return likely(size() > 1) ? m_m2 / size() : 0.0; }
+    double   deviation()  const { return sqrt(variance());     }
+    T        min()        const { return empty() ? T(0) : m_values[m_minq.front() & m_mask]; }
+    T        max()        const { return empty() ? T(0) : m_values[m_maxq.front() & m_mask]; }
+
+    /// Time-decayed exponentially weighted moving average
+    const ewma& average() const { return m_ewma;               }
+
+    /// Number of estimated quantiles
+    size_t   quantiles()  const { return m_quantiles.size();   }
+
+    /// Estimate of the \a a_idx'th quantile given in the constructor
+    double   quantile(size_t a_idx) const {
+        assert(a_idx < m_quantiles.size());
+        return m_quantiles[a_idx].value();
+    }
+
+private:
+    /// Fixed capacity queue of sample sequence numbers
+    class seq_queue {
+        std::vector<size_t> m_data;
+        size_t              m_mask, m_head, m_tail;
+    public:
+        seq_queue() : m_mask(0), m_head(0), m_tail(0) {}
+
+        void   init(size_t a_capacity) { m_data.resize(a_capacity); m_mask = a_capacity-1; }
+        void   clear()              { m_head = m_tail = 0;        }
+        bool   empty()        const { return m_head == m_tail;    }
+        size_t front()        const { return m_data[m_head & m_mask];   }
+        size_t back()         const { return m_data[(m_tail-1) & m_mask]; }
+        void   push_back(size_t a)  { m_data[m_tail++ & m_mask] = a; }
+        void   pop_back()           { --m_tail; }
+        void   pop_front()          { ++m_head; }
+
+        void   grow() {
+            std::vector<size_t> data(m_data.size() * 2);
+            size_t mask = data.size() - 1;
+            for (auto i = m_head; i != m_tail; ++i)
+                data[i & mask] = m_data[i & m_mask];
+            m_data.swap(data);
+            m_mask = mask;
+        }
+    };
+
+    /// Quantile estimated by two staggered P-square estimators
+    class window_quantile {
+        p2_quantile m_est[2];
+        long        m_start[2];
+        bool        m_active[2];
+    public:
+        explicit window_quantile(double a_p) : m_est{p2_quantile(a_p), p2_quantile(a_p)} {
+            clear();
+        }
+
+        void clear() {
+            m_est[0].clear();     m_est[1].clear();
+            m_active[0] = false;  m_active[1] = false;
+        }
+
+        /// @param a_clock sample's sequence number or time in nanoseconds
+        /// @param a_limit window length in units of \a a_clock
+        void add(long a_clock, long a_limit, double a_value) {
+            if (unlikely(!m_active[0])) {
+                m_active[0] = true;
+                m_start[0]  = a_clock;
+            } else if (unlikely(!m_active[1])) {
+                if (a_clock - m_start[0] >= a_limit/2) {
+                    m_active[1] = true;
+                    m_start[1]  = a_clock;
+                }
+            }
+            for (int i=0; i < 2; ++i) {
+                if (!m_active[i])
+                    continue;
+                if (unlikely(a_clock - m_start[i] >= a_limit)) {
+                    m_est[i].clear();
+                    m_start[i] = a_clock;
+                }
+                m_est[i].add(a_value);
+            }
+        }
+
+        double value() const {
+            int i = m_active[1] && m_start[1] < m_start[0] ? 1 : 0;
+            return m_est[i].value();
+        }
+    };
+
+    const size_t                 m_count_limit;
+    const time_val               m_duration;
+    size_t                       m_mask;
+    size_t                       m_begin, m_end;   // Sequence numbers
+    std::vector<T>               m_values;
+    std::vector<time_val>        m_times;
+    seq_queue                    m_minq, m_maxq;
+    T                            m_sum;
+    double                       m_mean, m_m2;
+    ewma                         m_ewma;
+    std::vector<window_quantile> m_quantiles;
+
+    size_t capacity() const { return m_mask+1; }
+
+    void init(size_t a_count, std::initializer_list<double> a_quantiles) {
+        size_t n = 1;
+        while (n < a_count) n <<= 1;
+        m_mask = n-1;
+        m_values.resize(n);
+        if (time_based())
+            m_times.resize(n);
+        m_minq.init(n);
+        m_maxq.init(n);
+        for (auto p : a_quantiles)
+            m_quantiles.emplace_back(p);
+        clear();
+    }
+
+    void clear_window() {
+        m_begin = m_end;
+        m_sum   = 0;
+        m_mean  = m_m2 = 0.0;
+        m_minq.clear();
+        m_maxq.clear();
+    }
+
+    void push_back(T a_value, time_val a_now) {
+        auto idx = m_end & m_mask;
+        m_values[idx] = a_value;
+        if (time_based())
+            m_times[idx] = a_now;
+
+        while (!m_minq.empty() && m_values[m_minq.back() & m_mask] >= a_value)
+            m_minq.pop_back();
+        m_minq.push_back(m_end);
+        while (!m_maxq.empty() && m_values[m_maxq.back() & m_mask] <= a_value)
+            m_maxq.pop_back();
+        m_maxq.push_back(m_end);
+
+        ++m_end;
+        m_sum   += a_value;
+        // See Knuth TAOCP v.2, 3rd ed, p.232
+        double d = a_value - m_mean;
+        m_mean  += d / size();
+        m_m2    += d * (a_value - m_mean);
+    }
+
+    void pop_front() {
+        assert(!empty());
+        T x = m_values[m_begin & m_mask];
+        if (m_minq.front() == m_begin) m_minq.pop_front();
+        if (m_maxq.front() == m_begin) m_maxq.pop_front();
+        ++m_begin;
+        m_sum -= x;
+        if (unlikely(empty())) {
+            m_mean = m_m2 = 0.0;
+            return;
+        }
+        double d = x - m_mean;
+        m_mean  -= d / size();
+        m_m2    -= d * (x - m_mean);
+        if (unlikely(m_m2 < 0.0)) m_m2 = 0.0;
+    }
+
+    void grow() {
+        size_t n    = capacity() * 2;
+        size_t mask = n-1;
+        std::vector<T>        values(n);
+        std::vector<time_val> times(n);
+        for (auto i = m_begin; i != m_end; ++i) {
+            values[i & mask] = m_values[i & m_mask];
+            times [i & mask] = m_times [i & m_mask];
+        }
+        m_values.swap(values);
+        m_times.swap(times);
+        m_minq.grow();
+        m_maxq.grow();
+        m_mask = mask;
+    }
+
+    void add_quantiles(long a_clock, T a_value) {
+        long limit = time_based() ? m_duration.nanoseconds() : long(m_count_limit);
+        for (auto& q : m_quantiles)
+            q.add(a_clock, limit, a_value);
+    }
+};
+
+} // namespace utxx
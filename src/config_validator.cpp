@@ -39,6 +39,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <algorithm>
 #include <regex>
 #include <iomanip>
 
@@ -53,6 +55,13 @@ static std::string value(const variant& v) {
         : v.to_string();
 }
 
+/// Children of \a a_cfg named \a a_name in the order of insertion (looked up
+/// with the ordered index of the tree rather than by a linear scan)
+static boost::iterator_range<variant_tree_base::const_assoc_iterator>
+children(const variant_tree_base& a_cfg, const std::string& a_name) {
+    return boost::make_iterator_range(a_cfg.equal_range(a_name));
+}
+
 const char* type_to_string(option_type_t a_type) {
     switch (a_type) {
         case STRING:    return "string";
@@ -403,6 +412,35 @@ void validator::internal_fill_fallback_defaults
     }
 }
 
+void validator::add_options(const option_def* a_defs, size_t a_count)
+{
+    boost::property_tree::translator_between<variant, std::string> tr;
+    auto val = [&tr](const char* s) { return s ? *tr.put_value(s) : variant(); };
+
+    // Every entry follows its parent, so walking the table backwards
+    // completes the children of an option before it's copied to the parent.
+    // Assignment (rather than insert) preserves the first of duplicate names.
+    std::vector<option_map> children(a_count);
+
+    for (size_t i = a_count; i-- > 0; ) {
+        const option_def& d = a_defs[i];
+        string_set  names;
+        variant_set values;
+        for (auto c = d.names;  c && c->val; ++c)
+            names.insert(c->val, c->desc ? c->desc : "");
+        for (auto c = d.values; c && c->val; ++c)
+            values.insert(d.value_type == STRING ? variant(c->val) : val(c->val),
+                          c->desc ? c->desc : "");
+        option_map& scope = d.parent < 0 ? m_options : children[d.parent];
+        scope[d.name] = option(d.name, d.opt_type, d.value_type, d.desc,
+                               d.unique, d.required, d.validate,
+                               d.def && !*d.def ? variant("") : val(d.def),
+                               val(d.min), val(d.max), names, values,
+                               children[i], d.defaults, d.recursive);
+        children[i].clear();
+    }
+}
+
 void validator::preprocess()
 {
     if (m_preprocessed) return;
@@ -410,10 +448,23 @@ void validator::preprocess()
     stack_t stack;
 
     internal_fill_fallback_defaults(stack, m_options, "");
+    index_options(m_options);
+
+    m_preprocessed = true;
 
     //dump(std::cerr, "  ", 2, m_options, true, true);
 }
 
+void validator::index_options(const option_map& a_opts) const
+{
+    for (auto& ovt : a_opts) {
+        tree_path path;
+        index_options(ovt.second.children);
+        ovt.second.m_has_required_child =
+            has_required_child_options(ovt.second.children, path);
+    }
+}
+
 void validator::recursive_validate
 (
     config_level_list&      a_stack,
@@ -445,9 +496,16 @@ void validator::recursive_validate
     bool single_nested_tree =
         (m_options.size() == 1 && m_options.begin()->second.children.size() > 0);
 
+    // Without anonymous options the option of a config node is found by name
+    // (when single_nested_tree is set only the first option is ever checked)
+    bool by_name = !single_nested_tree && std::none_of(a_opts.begin(), a_opts.end(),
+        [](const option_map::value_type& ovt) { return ovt.second.opt_type == ANONYMOUS; });
+
     for (auto& vt : a_config) {
         bool l_match = false;
-        for (auto& ovt : a_opts) {
+        auto ob = by_name ? a_opts.find(vt.first) : a_opts.begin();
+        auto oe = by_name && ob != a_opts.end() ? std::next(ob) : a_opts.end();
+        for (auto& ovt : boost::make_iterator_range(ob, oe)) {
             const option& opt = ovt.second;
             bool  check = false;
             if (opt.opt_type == ANONYMOUS) {
@@ -506,6 +564,22 @@ void validator::check_required(config_level_list& a_stack)
     std::cout << "check_required(" << root << ", cfg.count=" << cfg.size()
         << ", opts.count=" << a_stack.back().options().size() << ')' << std::endl;
     #endif
+
+    // Leaf options are not allowed to have child nodes (checked in one pass
+    // over the config instead of searching the config for every option)
+    for (auto& vt : cfg) {
+        if (vt.second.empty())
+            continue;
+        auto it = opts.find(vt.first);
+        if (it == opts.end())
+            continue;
+        const option& opt = it->second;
+        if (opt.opt_type != ANONYMOUS && opt.children.empty() && opt.validate)
+            throw missing_required_option_error
+                (format_name(root, opt, vt.first, vt.second.data()),
+                 "Option is not allowed to have child nodes!");
+    }
+
     for (auto& ovt : opts) {
         const option& opt = ovt.second;
         if (opt.required && opt.default_value.data().is_null()) {
@@ -522,31 +596,30 @@ void validator::check_required(config_level_list& a_stack)
                         "Check XML spec. Missing required value of anonymous option!");
             } else {
                 bool found = false;
-                for (auto& vt : cfg)
-                    if (vt.first == opt.name) {
-                        #ifdef TEST_CONFIG_VALIDATOR
-                        std::cout << "    found: "
-                            << format_name(root, opt, vt.first, vt.second.data())
-                            << ", value=" << vt.second.data().to_string()
-                            << ", type=" << type_to_string(opt.opt_type)
-                            << std::endl;
-                        #endif
-
-                        if (opt.opt_type == BRANCH) {
-                            found = true;
-                            break;
-                        }
-
-                        if (vt.second.data().is_null())
-                            throw missing_required_option_error
-                                (format_name(root, opt, vt.first, vt.second.data()),
-                                 "Missing value of the required option "
-                                 "and no default provided!");
+                for (auto& vt : children(cfg, opt.name)) {
+                    #ifdef TEST_CONFIG_VALIDATOR
+                    std::cout << "    found: "
+                        << format_name(root, opt, vt.first, vt.second.data())
+                        << ", value=" << vt.second.data().to_string()
+                        << ", type=" << type_to_string(opt.opt_type)
+                        << std::endl;
+                    #endif
+
+                    if (opt.opt_type == BRANCH) {
                         found = true;
-                        if (opt.unique)
-                            break;
+                        break;
                     }
 
+                    if (vt.second.data().is_null())
+                        throw missing_required_option_error
+                            (format_name(root, opt, vt.first, vt.second.data()),
+                             "Missing value of the required option "
+                             "and no default provided!");
+                    found = true;
+                    if (opt.unique)
+                        break;
+                }
+
                 if (!found && (opt.opt_type != BRANCH || opt.children.empty())) {
                     // If the option points to some other node with a fallback
                     // default, then we check if that path has a value, in which
@@ -598,45 +671,46 @@ void validator::check_required(config_level_list& a_stack)
                 a_stack.pop();
             }
         } else {
-            tree_path l_req_name;
-            bool l_has_req = has_required_child_options(opt.children, l_req_name);
+            bool l_has_req = has_required_child_options(opt);
+            // Path of the required child is only needed for error reporting
+            auto l_req_name = [&]() {
+                tree_path p;
+                has_required_child_options(opt.children, p);
+                return p.dump();
+            };
             bool found   = false;
 
             #ifdef TEST_CONFIG_VALIDATOR
             if (opt.children.size())
                 std::cout << "  Checking children of " << format_name(root, opt)
-                          << " (hasreq=" << (l_has_req ? l_req_name.dump() : "") << ")"
+                          << " (hasreq=" << (l_has_req ? l_req_name() : "") << ")"
                           << std::endl;
             #endif
 
-            for (auto& vt : cfg)
-                if (vt.first == opt.name) {
+            // Options without required children were checked for
+            // disallowed child nodes above
+            if (l_has_req)
+                for (auto& vt : children(cfg, opt.name)) {
                     found = true;
-                    if (l_has_req) {
-                        if (!vt.second.size())
-                            throw missing_required_option_error
-                                (format_name(root, opt, vt.first, vt.second.data()),
-                                 "Option is missing required child option: ",
-                                 l_req_name.dump());
-                        auto path = format_name(root, opt, vt.first, vt.second.data());
-                        try {
-                            a_stack.push(path, vt.second, &opt, opt.children);
-                            check_required(a_stack);
-                            a_stack.pop();
-                        } catch (missing_required_option_error const& e) {
-                            a_stack.pop();
-                            // If this branch option is not required, and the
-                            // exception is due to missing child options, we
-                            // can ignore it
-                            if (!opt.required && opt.opt_type == BRANCH)
-                                continue;
-                            throw;
-                        }
-                    }
-                    if (!opt.children.size() && vt.second.size() && opt.validate)
+                    if (!vt.second.size())
                         throw missing_required_option_error
                             (format_name(root, opt, vt.first, vt.second.data()),
-                             "Option is not allowed to have child nodes!");
+                             "Option is missing required child option: ",
+                             l_req_name());
+                    auto path = format_name(root, opt, vt.first, vt.second.data());
+                    try {
+                        a_stack.push(path, vt.second, &opt, opt.children);
+                        check_required(a_stack);
+                        a_stack.pop();
+                    } catch (missing_required_option_error const& e) {
+                        a_stack.pop();
+                        // If this branch option is not required, and the
+                        // exception is due to missing child options, we
+                        // can ignore it
+                        if (!opt.required && opt.opt_type == BRANCH)
+                            continue;
+                        throw;
+                    }
                 }
 
             if (!found && l_has_req && opt.validate) {
@@ -659,7 +733,7 @@ void validator::check_required(config_level_list& a_stack)
                 if (!found)
                     throw missing_required_option_error
                         (format_name(root, opt), "Missing a required child option: ",
-                        l_req_name.dump());
+                        l_req_name());
             }
         }
     }
@@ -928,20 +1002,17 @@ void validator::check_unique
     const option_map& a_opts
 ) const
 {
-    string_set l_names;
     BOOST_ASSERT(a_opts.size() > 0);
+    // Report the first node (in config order) that repeats the name of a
+    // unique option, i.e. the one that isn't the first of its equal range
     for (auto& vt : a_config) {
-        if (l_names.find(vt.first) == l_names.end())
-            l_names.insert(vt.first);
-        else {
-            for (auto& ovt : a_opts) {
-                const option& o = ovt.second;
-                if (o.name == vt.first && o.unique)
-                    throw variant_tree_error(format_name(a_root, o, vt.first,
-                          vt.second.data()),
-                          "Non-unique config option found!");
-            }
-        }
+        auto it = a_opts.find(vt.first);
+        if (it == a_opts.end() || !it->second.unique)
+            continue;
+        if (&*a_config.find(vt.first) != &vt)
+            throw variant_tree_error(format_name(a_root, it->second, vt.first,
+                  vt.second.data()),
+                  "Non-unique config option found!");
     }
 }
 
@@ -56,6 +56,15 @@ inline int futex_wake(volatile void* futex, int cnt_to_wake,
                         const struct timespec* timeout = NULL) {
     return ::syscall(SYS_futex,(futex),FUTEX_WAKE,(cnt_to_wake),(timeout));
 }
+inline int futex_wait_bits(volatile void* futex, int val, uint32_t mask,
+                           const struct timespec* abs_timeout = NULL) {
+    return ::syscall(SYS_futex,(futex),FUTEX_WAIT_BITSET,(val),(abs_timeout),
+                     NULL,(mask));
+}
+inline int futex_wake_bits(volatile void* futex, int cnt_to_wake, uint32_t mask) {
+    return ::syscall(SYS_futex,(futex),FUTEX_WAKE_BITSET,(cnt_to_wake),NULL,
+                     NULL,(mask));
+}
 #else
 #  error "Missing SYS_futex definition!"
 #endif
@@ -98,6 +107,29 @@ int futex_wake_slow(int* value, int count) {
     return res;
 }
 
+wakeup_result futex_wait_bitset(int* old, int val, uint32_t a_mask,
+                                const struct timespec* abs) {
+    int res;
+    // The timeout is absolute, so it's safe to restart on EINTR
+    while ((res = futex_wait_bits(old, val, a_mask, abs)) < 0
+           && errno == EINTR);
+    if (res == 0)
+        return wakeup_result::SIGNALED;
+    else if (errno == EWOULDBLOCK)
+        return wakeup_result::CHANGED;
+    else if (errno == ETIMEDOUT)
+        return wakeup_result::TIMEDOUT;
+    else
+        return wakeup_result::ERROR;
+}
+
+int futex_wake_bitset(int* value, uint32_t a_mask, int count) {
+    int res;
+    while ((res = futex_wake_bits(value, count, a_mask)) < 0
+           && errno == EINTR);
+    return res;
+}
+
 futex::futex(int initialize) {
     int pagesize = sysconf(_SC_PAGESIZE);
 
@@ -27,15 +27,302 @@
 //==============================================================================
 
 #include <utxx/gzstream.hpp>
+#include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <string.h>  // for memcpy
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace utxx {
 
+namespace detail {
+
+//------------------------------------------------------------------------------
+// Parallel gzip compressor.
+//------------------------------------------------------------------------------
+// The stream fills a block, and the block is deflated by one of the worker
+// threads into a raw deflate stream ending with a sync flush (the last one
+// is finished instead). The deflate stream of a block uses the last 32K of
+// the previous block as the dictionary. Compressed blocks are written by
+// the stream's thread in the submission order, so the file is a single
+// gzip member whose CRC is combined from the CRCs of the blocks.
+//
+// Blocks live in a ring of 2*threads+2 jobs. A job slot is refilled only
+// after the job that follows it was written, so a worker can read the
+// dictionary directly from the input of the previous job.
+//------------------------------------------------------------------------------
+class gzparallel {
+    static const size_t s_dict_size = 32*1024;
+
+    struct job {
+        std::vector<char>          in;
+        std::vector<unsigned char> out;
+        size_t                     len     = 0;
+        size_t                     out_len = 0;
+        uLong                      crc     = 0;
+        bool                       last    = false;
+        bool                       done    = false;
+        bool                       failed  = false;
+    };
+
+    int                      m_fd;
+    int                      m_level;
+    std::vector<job>         m_jobs;
+    std::vector<std::thread> m_threads;
+    std::mutex               m_mutex;
+    std::condition_variable  m_work_cv;     // Signaled when a job is submitted
+    std::condition_variable  m_done_cv;     // Signaled when a job is compressed
+    size_t                   m_head;        // The oldest job not yet written
+    size_t                   m_tail;        // The job being filled by the stream
+    size_t                   m_next;        // The next job to be compressed
+    bool                     m_stop;
+    bool                     m_error;
+    uLong                    m_crc;
+    uLong                    m_size;
+
+    job& at(size_t a_seq) { return m_jobs[a_seq % m_jobs.size()]; }
+
+    void run();
+    bool compress(z_stream& a_zs, size_t a_seq);
+    bool write(const void* a_data, size_t a_len);
+    /// Write compressed jobs in order, waiting while more than
+    /// \a a_max_pending jobs are submitted but not written
+    bool write_done(size_t a_max_pending);
+    void stop();
+public:
+    gzparallel(int a_fd, const gzopts& a_opts);
+    ~gzparallel();
+
+    /// Buffer of the block being filled
+    char*  buffer()           { return at(m_tail).in.data(); }
+    size_t block_size() const { return m_jobs[0].in.size();  }
+    bool   error()      const { return m_error;              }
+
+    /// Submit \a a_len bytes of the current block for compression.
+    /// @return buffer of the next block
+    char*  submit(size_t a_len, bool a_last = false);
+    /// Write the blocks that are already compressed
+    bool   flush() { return write_done(m_jobs.size()); }
+    /// Compress the last block of \a a_len bytes, write the gzip trailer
+    /// and close the file
+    bool   finish(size_t a_len);
+};
+
+const size_t gzparallel::s_dict_size;
+
+gzparallel::gzparallel(int a_fd, const gzopts& a_opts)
+    : m_fd(a_fd), m_level(a_opts.level)
+    , m_jobs(2*std::max(1u, a_opts.threads) + 2)
+    , m_head(0), m_tail(0), m_next(0)
+    , m_stop(false), m_error(false)
+    , m_crc(crc32(0, Z_NULL, 0)), m_size(0)
+{
+    for (auto& j : m_jobs)
+        j.in.resize(std::max<size_t>(a_opts.block_size, 1024));
+
+    // gzip header (RFC 1952): no file name, no time stamp, Unix OS
+    unsigned char hdr[10] = {
+        0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0,
+        (unsigned char)(m_level == 9 ? 2 : m_level == 1 ? 4 : 0), 3
+    };
+    m_error = !write(hdr, sizeof(hdr));
+
+    for (unsigned i=0, n = std::max(1u, a_opts.threads); i < n; ++i)
+        m_threads.emplace_back([this]() { run(); });
+}
+
+gzparallel::~gzparallel()
+{
+    stop();
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+void gzparallel::stop()
+{
+    {
+        std::lock_guard<std::mutex> g(m_mutex);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& t : m_threads)
+        t.join();
+    m_threads.clear();
+}
+
+void gzparallel::run()
+{
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    bool ok = deflateInit2(&zs, m_level, Z_DEFLATED, -MAX_WBITS, 8,
+                           Z_DEFAULT_STRATEGY) == Z_OK;
+
+    std::unique_lock<std::mutex> g(m_mutex);
+    while (true) {
+        m_work_cv.wait(g, [this]() { return m_stop || m_next < m_tail; });
+        if (m_next == m_tail)
+            break;
+        auto seq = m_next++;
+        g.unlock();
+        bool res = ok && compress(zs, seq);
+        g.lock();
+        at(seq).failed = !res;
+        at(seq).done   = true;
+        m_done_cv.notify_one();
+    }
+
+    if (ok)
+        deflateEnd(&zs);
+}
+
+bool gzparallel::compress(z_stream& a_zs, size_t a_seq)
+{
+    auto& j = at(a_seq);
+
+    if (deflateReset(&a_zs) != Z_OK)
+        return false;
+
+    if (a_seq > 0) {
+        auto& prev = at(a_seq-1);
+        auto  n    = std::min(prev.len, s_dict_size);
+        if (n && deflateSetDictionary
+                    (&a_zs, (const Bytef*)prev.in.data() + prev.len - n, n) != Z_OK)
+            return false;
+    }
+
+    j.crc = crc32(0, (const Bytef*)j.in.data(), j.len);
+
+    // Reserve room for the sync flush marker on top of the bound
+    auto sz = deflateBound(&a_zs, j.len) + 16;
+    if (j.out.size() < sz)
+        j.out.resize(sz);
+
+    a_zs.next_in   = (Bytef*)j.in.data();
+    a_zs.avail_in  = j.len;
+    a_zs.next_out  = j.out.data();
+    a_zs.avail_out = j.out.size();
+
+    for (int flush = j.last ? Z_FINISH : Z_SYNC_FLUSH;;) {
+        int rc    = deflate(&a_zs, flush);
+        if (rc == Z_STREAM_ERROR)
+            return false;
+        j.out_len = j.out.size() - a_zs.avail_out;
+        if (j.last ? rc == Z_STREAM_END : a_zs.avail_out != 0)
+            return true;
+        j.out.resize(j.out.size() * 2);
+        a_zs.next_out  = j.out.data() + j.out_len;
+        a_zs.avail_out = j.out.size() - j.out_len;
+    }
+}
+
+bool gzparallel::write(const void* a_data, size_t a_len)
+{
+    for (auto p = (const char*)a_data; a_len;) {
+        auto n = ::write(m_fd, p, a_len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p     += n;
+        a_len -= n;
+    }
+    return true;
+}
+
+bool gzparallel::write_done(size_t a_max_pending)
+{
+    std::unique_lock<std::mutex> g(m_mutex);
+    while (m_head < m_tail) {
+        auto& j = at(m_head);
+        if (!j.done) {
+            if (m_tail - m_head <= a_max_pending)
+                break;
+            m_done_cv.wait(g, [&j]() { return j.done; });
+        }
+        g.unlock();
+        if (j.failed || !write(j.out.data(), j.out_len))
+            m_error = true;
+        m_crc   = crc32_combine(m_crc, j.crc, j.len);
+        m_size += j.len;
+        g.lock();
+        j.done  = false;
+        ++m_head;
+    }
+    return !m_error;
+}
+
+char* gzparallel::submit(size_t a_len, bool a_last)
+{
+    {
+        std::lock_guard<std::mutex> g(m_mutex);
+        auto& j = at(m_tail);
+        j.len   = a_len;
+        j.last  = a_last;
+        ++m_tail;
+    }
+    m_work_cv.notify_one();
+    // Wait until the job in the slot of the next block and the job using
+    // it as the dictionary are written
+    write_done(m_jobs.size()-2);
+    return buffer();
+}
+
+bool gzparallel::finish(size_t a_len)
+{
+    submit(a_len, true);
+    write_done(0);
+
+    // gzip trailer: CRC32 and the size of the input modulo 2^32
+    unsigned char trl[8];
+    for (int i=0; i < 4; ++i) {
+        trl[i]   = (unsigned char)(m_crc  >> (8*i));
+        trl[i+4] = (unsigned char)(m_size >> (8*i));
+    }
+    if (!write(trl, sizeof(trl)))
+        m_error = true;
+
+    stop();
+    if (::close(m_fd) < 0)
+        m_error = true;
+    m_fd = -1;
+    return !m_error;
+}
+
+} // namespace detail
+
 //------------------------------------------------------------------------------
 // class gzstreambuf:
 //------------------------------------------------------------------------------
-gzstreambuf* gzstreambuf::open(const char* name, int open_mode) {
+const int gzstreambuf::defaultBufferSize;
+
+gzstreambuf::gzstreambuf()
+    : file(nullptr), bufferSize(0), opened(0), mode(0)
+{
+    // ASSERT: both input & output capabilities will not be used together
+    init_buffer(defaultBufferSize);
+}
+
+gzstreambuf::~gzstreambuf() { close(); }
+
+void gzstreambuf::init_buffer(int size) {
+    size = std::max(size, defaultBufferSize);
+    if (size != bufferSize) {
+        buffer.reset(new char[size]);
+        bufferSize = size;
+    }
+    setp( buffer.get(), buffer.get() + (bufferSize-1));
+    setg( buffer.get() + 4,     // beginning of putback area
+          buffer.get() + 4,     // read position
+          buffer.get() + 4);    // end position
+}
+
+gzstreambuf* gzstreambuf::open(const char* name, int open_mode,
+                               const gzopts& opts) {
     if (is_open())
         return (gzstreambuf*)0;
     mode = open_mode;
@@ -43,6 +330,18 @@ gzstreambuf* gzstreambuf::open(const char* name, int open_mode) {
     if ((mode & std::ios::ate) || (mode & std::ios::app)
         || ((mode & std::ios::in) && (mode & std::ios::out)))
         return (gzstreambuf*)0;
+
+    if ((mode & std::ios::out) && opts.threads) {
+        int fd = ::open(name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+        if (fd < 0)
+            return (gzstreambuf*)0;
+        par.reset(new detail::gzparallel(fd, opts));
+        // The put area is the whole block handed to the compressor
+        setp(par->buffer(), par->buffer() + par->block_size());
+        opened = 1;
+        return this;
+    }
+
     char  fmode[10];
     char* fmodeptr = fmode;
     if (mode & std::ios::in)
@@ -50,22 +349,38 @@ gzstreambuf* gzstreambuf::open(const char* name, int open_mode) {
     else if (mode & std::ios::out)
         *fmodeptr++ = 'w';
     *fmodeptr++ = 'b';
+    if ((mode & std::ios::out) && opts.level >= 0 && opts.level <= 9)
+        *fmodeptr++ = '0' + opts.level;
     *fmodeptr = '\0';
     file = gzopen(name, fmode);
     if (file == 0)
         return (gzstreambuf*)0;
+    init_buffer(opts.buffer_size);
+    // zlib inflates directly into the caller's memory only when a read asks
+    // for at least twice its buffer size, so on input size its buffer to
+    // half of what underflow() requests
+    gzbuffer(file, (mode & std::ios::in) ? std::max(2, (bufferSize-4)/2) : bufferSize);
     opened = 1;
     return this;
 }
 
 gzstreambuf * gzstreambuf::close() {
-    if (is_open()) {
-        sync();
+    if (!is_open())
+        return (gzstreambuf*)0;
+
+    if (par) {
         opened = 0;
-        if (gzclose(file) == Z_OK)
-            return this;
+        bool ok = par->finish(pptr() - pbase());
+        par.reset();
+        init_buffer(bufferSize);
+        return ok ? this : (gzstreambuf*)0;
     }
-    return (gzstreambuf*)0;
+
+    sync();
+    opened = 0;
+    auto rc = gzclose(file);
+    file    = nullptr;
+    return rc == Z_OK ? this : (gzstreambuf*)0;
 }
 
 int gzstreambuf::underflow() { // used for input buffer only
@@ -78,16 +393,17 @@ int gzstreambuf::underflow() { // used for input buffer only
     int n_putback = gptr() - eback();
     if (n_putback > 4)
         n_putback = 4;
-    memcpy(buffer + (4 - n_putback), gptr() - n_putback, n_putback);
+    char* buf = buffer.get();
+    memcpy(buf + (4 - n_putback), gptr() - n_putback, n_putback);
 
-    int num = gzread(file, buffer+4, bufferSize-4);
+    int num = gzread(file, buf+4, bufferSize-4);
     if (num <= 0) // ERROR or EOF
         return EOF;
 
     // reset buffer pointers
-    setg(buffer + (4 - n_putback),   // beginning of putback area
-          buffer + 4,                 // read position
-          buffer + 4 + num);          // end of buffer
+    setg( buf + (4 - n_putback),   // beginning of putback area
+          buf + 4,                 // read position
+          buf + 4 + num);          // end of buffer
 
     // return next character
     return * reinterpret_cast<unsigned char *>(gptr());
@@ -106,6 +422,18 @@ int gzstreambuf::flush_buffer() {
 int gzstreambuf::overflow(int c) { // used for output buffer only
     if (! (mode & std::ios::out) || ! opened)
         return EOF;
+    if (par) {
+        // Hand the full block to the compressor and continue in a new one
+        auto p = par->submit(pptr() - pbase());
+        setp(p, p + par->block_size());
+        if (par->error())
+            return EOF;
+        if (c != EOF) {
+            *pptr() = c;
+            pbump(1);
+        }
+        return c;
+    }
     if (c != EOF) {
         *pptr() = c;
         pbump(1);
@@ -116,6 +444,10 @@ int gzstreambuf::overflow(int c) { // used for output buffer only
 }
 
 int gzstreambuf::sync() {
+    // A partial block is not compressed until it is full or the stream
+    // is closed (like gzwrite() keeps data in its internal buffer)
+    if (par)
+        return par->flush() ? 0 : -1;
     // Changed to use flush_buffer() instead of overflow(EOF)
     // which caused improper behavior with std::endl and flush(),
     // bug reported by Vincent Ricard.
@@ -131,17 +463,17 @@ int gzstreambuf::sync() {
 //------------------------------------------------------------------------------
 namespace detail {
 
-    gzstreambase::gzstreambase(const char* name, int mode) {
+    gzstreambase::gzstreambase(const char* name, int mode, const gzopts& opts) {
         init(&buf);
-        open(name, mode);
+        open(name, mode, opts);
     }
 
     gzstreambase::~gzstreambase() {
         buf.close();
     }
 
-    void gzstreambase::open(const char* name, int open_mode) {
-        if (! buf.open(name, open_mode))
+    void gzstreambase::open(const char* name, int open_mode, const gzopts& opts) {
+        if (! buf.open(name, open_mode, opts))
             clear(rdstate() | std::ios::badbit);
     }
 
@@ -152,4 +484,4 @@ namespace detail {
     }
 
 } // namespace detail
-} // namespace utxx
\ No newline at end of file
+} // namespace utxx
@@ -417,7 +417,11 @@ format_header(const logger::msg& a_msg, char* a_buf, const char* a_end)
 
     // Write Timestamp
     if (timestamp_type() != stamp_type::NO_TIMESTAMP) {
-        p   += timestamp::format(timestamp_type(), a_msg.m_timestamp, p, a_end - p);
+        static thread_local time_formatter s_formatter(NO_TIMESTAMP);
+        if (unlikely(s_formatter.type() != timestamp_type()))
+            s_formatter = time_formatter(timestamp_type());
+        assert(size_t(a_end - p) > s_formatter.size());
+        p    = s_formatter.write(p, a_msg.m_timestamp);
         *p++ = '|';
     }
     // Write Level
@@ -0,0 +1,349 @@
+//----------------------------------------------------------------------------
+/// \file   metrics.cpp
+/// \author Serge Aleynikov
+//----------------------------------------------------------------------------
+/// \brief Process-wide registry of counters, gauges and latency histograms.
+//----------------------------------------------------------------------------
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <utxx/metrics.hpp>
+#include <utxx/error.hpp>
+#include <algorithm>
+#include <string.h>
+#include <unistd.h>
+
+namespace utxx {
+
+const size_t metric_sample::MAX_NAME;
+const size_t metrics_snapshot::MAX_METRICS;
+const int    metric_histogram::BUCKETS;
+
+//-----------------------------------------------------------------------------
+// metric_counter
+//-----------------------------------------------------------------------------
+metric_counter::slot* metric_counter::make_slot()
+{
+    auto s = detail::new_slot<slot>();
+    // On thread exit fold the slot into m_retired
+    m_slot.reset(s, [this](slot* a_slot, tlp_destruct_mode a_mode) {
+        if (a_mode == tlp_destruct_mode::THIS_THREAD)
+            m_retired.fetch_add(a_slot->value.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+        detail::delete_slot(a_slot);
+    });
+    return s;
+}
+
+int64_t metric_counter::value() const
+{
+    int64_t n = m_retired.load(std::memory_order_relaxed);
+    for (auto& s : m_slot.access_all_threads())
+        n += s.value.load(std::memory_order_relaxed);
+    return n;
+}
+
+void metric_counter::sample(metric_sample& a_sample) const
+{
+    a_sample.value = value();
+}
+
+//-----------------------------------------------------------------------------
+// metric_gauge
+//-----------------------------------------------------------------------------
+void metric_gauge::sample(metric_sample& a_sample) const
+{
+    a_sample.value = value();
+}
+
+//-----------------------------------------------------------------------------
+// metric_histogram
+//-----------------------------------------------------------------------------
+void metric_histogram::data::clear()
+{
+    count = sum = max = 0;
+    min   = INT64_MAX;
+    memset(buckets, 0, sizeof(buckets));
+}
+
+void metric_histogram::data::merge(const data& a_rhs)
+{
+    count += a_rhs.count;
+    sum   += a_rhs.sum;
+    min    = std::min(min, a_rhs.min);
+    max    = std::max(max, a_rhs.max);
+    for (int i=0; i < BUCKETS; ++i)
+        buckets[i] += a_rhs.buckets[i];
+}
+
+int64_t metric_histogram::data::quantile(double a_q) const
+{
+    if (!count)
+        return 0;
+    // Rank of the sample of quantile a_q (counted from 1)
+    auto rank = std::max<int64_t>(1, int64_t(a_q * count + 0.999999));
+    if (rank == 1)     return min;
+    if (rank >= count) return max;
+    int64_t n = 0;
+    for (int i=0; i < BUCKETS; ++i)
+        if ((n += buckets[i]) >= rank) {
+            // Middle of the bucket bounded by the observed range
+            auto lo = bucket_value(i);
+            auto hi = i+1 < BUCKETS ? bucket_value(i+1) : max + 1;
+            return std::min(max, std::max(min, lo + (hi - lo - 1) / 2));
+        }
+    return max;
+}
+
+void metric_histogram::slot::load(data& a_data) const
+{
+    auto r = std::memory_order_relaxed;
+    a_data.count = count.load(r);
+    a_data.sum   = sum.load(r);
+    a_data.min   = min.load(r);
+    a_data.max   = max.load(r);
+    for (int i=0; i < BUCKETS; ++i)
+        a_data.buckets[i] = buckets[i].load(r);
+}
+
+metric_histogram::slot* metric_histogram::make_slot()
+{
+    auto s = detail::new_slot<slot>();
+    m_slot.reset(s, [this](slot* a_slot, tlp_destruct_mode a_mode) {
+        if (a_mode == tlp_destruct_mode::THIS_THREAD) {
+            data d;
+            a_slot->load(d);
+            std::lock_guard<std::mutex> g(m_mutex);
+            m_retired.merge(d);
+        }
+        detail::delete_slot(a_slot);
+    });
+    return s;
+}
+
+metric_histogram::data metric_histogram::value() const
+{
+    data res, d;
+    {
+        std::lock_guard<std::mutex> g(m_mutex);
+        res = m_retired;
+    }
+    for (auto& s : m_slot.access_all_threads()) {
+        s.load(d);
+        res.merge(d);
+    }
+    return res;
+}
+
+void metric_histogram::sample(metric_sample& a_sample) const
+{
+    auto d = value();
+    a_sample.value = d.count;
+    a_sample.sum   = d.sum;
+    a_sample.min   = d.count ? d.min : 0;
+    a_sample.max   = d.max;
+    a_sample.p50   = d.quantile(0.5);
+    a_sample.p90   = d.quantile(0.9);
+    a_sample.p99   = d.quantile(0.99);
+    a_sample.p999  = d.quantile(0.999);
+}
+
+//-----------------------------------------------------------------------------
+// metrics_registry
+//-----------------------------------------------------------------------------
+metrics_registry::metrics_registry()
+    : m_running(false)
+{}
+
+metrics_registry::~metrics_registry()
+{
+    stop();
+}
+
+metrics_registry& metrics_registry::instance()
+{
+    static metrics_registry* s_instance = new metrics_registry();
+    return *s_instance;
+}
+
+template <class Metric>
+Metric& metrics_registry::get(const std::string& a_name, metric_sample::type_t a_type)
+{
+    if (a_name.size() >= metric_sample::MAX_NAME)
+        UTXX_THROW_BADARG_ERROR("Metric name too long: ", a_name);
+
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    for (auto& m : m_metrics)
+        if (m->name() == a_name) {
+            if (m->type() != a_type)
+                UTXX_THROW_BADARG_ERROR("Metric ", a_name,
+                                        " is registered with another type");
+            return static_cast<Metric&>(*m);
+        }
+
+    if (m_metrics.size() == metrics_snapshot::MAX_METRICS)
+        UTXX_THROW_RUNTIME_ERROR("Too many metrics (max ",
+                                 metrics_snapshot::MAX_METRICS, ')');
+
+    m_metrics.emplace_back(new Metric(a_name));
+    return static_cast<Metric&>(*m_metrics.back());
+}
+
+metric_counter& metrics_registry::counter(const std::string& a_name)
+{
+    return get<metric_counter>(a_name, metric_sample::COUNTER);
+}
+
+metric_gauge& metrics_registry::gauge(const std::string& a_name)
+{
+    return get<metric_gauge>(a_name, metric_sample::GAUGE);
+}
+
+metric_histogram& metrics_registry::histogram(const std::string& a_name)
+{
+    return get<metric_histogram>(a_name, metric_sample::HISTOGRAM);
+}
+
+size_t metrics_registry::size() const
+{
+    std::lock_guard<std::mutex> g(m_mutex);
+    return m_metrics.size();
+}
+
+void metrics_registry::snapshot(metrics_snapshot& a_snapshot) const
+{
+    std::lock_guard<std::mutex> g(m_mutex);
+
+    a_snapshot.time  = now_utc().nanoseconds();
+    a_snapshot.pid   = getpid();
+    a_snapshot.count = m_metrics.size();
+
+    for (size_t i=0; i < m_metrics.size(); ++i) {
+        auto& m = *m_metrics[i];
+        auto& s = a_snapshot.items[i];
+        memset(&s, 0, sizeof(s));
+        strncpy(s.name, m.name().c_str(), sizeof(s.name)-1);
+        s.type = m.type();
+        m.sample(s);
+    }
+}
+
+void metrics_registry::publish()
+{
+    std::lock_guard<std::mutex> g(m_publish_mutex);
+    if (!m_blob.is_open())
+        return;
+
+    snapshot(*m_snapshot);
+
+    // Seqlock update: readers retry while the sequence is odd or changes
+    auto&    dst = m_blob.dirty_get();
+    uint64_t seq = __atomic_load_n(&dst.seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&dst.seq, seq + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    dst.time  = m_snapshot->time;
+    dst.pid   = m_snapshot->pid;
+    dst.count = m_snapshot->count;
+    memcpy(dst.items, m_snapshot->items, m_snapshot->count * sizeof(metric_sample));
+
+    __atomic_store_n(&dst.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void metrics_registry::start(const std::string& a_file, time_val a_interval)
+{
+    stop();
+
+    if (!m_snapshot)
+        m_snapshot.reset(new metrics_snapshot());
+
+    {
+        std::lock_guard<std::mutex> g(m_publish_mutex);
+        m_blob.init(a_file.c_str(), nullptr, false);
+        // Make the sequence even in case a previous writer died in an update
+        auto& seq = m_blob.dirty_get().seq;
+        __atomic_store_n(&seq, (seq + 1) & ~1ul, __ATOMIC_RELEASE);
+    }
+    publish();
+
+    m_running = true;
+    m_thread  = std::thread([this, a_interval]() { run(a_interval); });
+}
+
+void metrics_registry::stop()
+{
+    {
+        std::lock_guard<std::mutex> g(m_thread_mutex);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_cond.notify_all();
+    m_thread.join();
+    std::lock_guard<std::mutex> g(m_publish_mutex);
+    m_blob.close();
+}
+
+void metrics_registry::run(time_val a_interval)
+{
+    auto timeout = std::chrono::nanoseconds(a_interval.nanoseconds());
+
+    std::unique_lock<std::mutex> g(m_thread_mutex);
+    while (!m_cond.wait_for(g, timeout, [this]() { return !m_running; }))
+        publish();
+    // Publish the final values
+    publish();
+}
+
+//-----------------------------------------------------------------------------
+// metrics_reader
+//-----------------------------------------------------------------------------
+bool metrics_reader::read(metrics_snapshot& a_out, int a_tries) const
+{
+    auto& src = m_blob.dirty_get();
+
+    for (int i=0; i < a_tries; ++i) {
+        uint64_t seq = __atomic_load_n(&src.seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        a_out.time  = src.time;
+        a_out.pid   = src.pid;
+        a_out.count = std::min<uint32_t>(src.count, metrics_snapshot::MAX_METRICS);
+        memcpy(a_out.items, src.items, a_out.count * sizeof(metric_sample));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (__atomic_load_n(&src.seq, __ATOMIC_RELAXED) == seq) {
+            a_out.seq = seq;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace utxx
@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------
+/// \file  metricsdump.cpp
+//------------------------------------------------------------------------------
+/// \brief Utility for printing metrics published by utxx::metrics_registry
+//------------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//------------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include <utxx/metrics.hpp>
+#include <utxx/path.hpp>
+#include <utxx/get_option.hpp>
+#include <utxx/timestamp.hpp>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+void usage(std::string const& err="")
+{
+    auto prog = utxx::path::basename(
+        utxx::path::program::name().c_str(),
+        utxx::path::program::name().c_str() + utxx::path::program::name().size()
+    );
+
+    if (!err.empty())
+        cerr << "Invalid option: " << err << "\n\n";
+    else {
+        cerr << prog <<
+        " - Tool for printing metrics published by a process\n"
+        "Copyright (c) 2026 Serge Aleynikov\n\n"
+        "Usage: " << prog << " [-h] -f MetricsFile [-i Interval] [-c Count]\n\n"
+        "   -h|--help               - Help screen\n"
+        "   -f MetricsFile          - File given to metrics_registry::start()\n"
+        "   -i|--interval Interval  - Print metrics every Interval seconds\n"
+        "   -c|--count Count        - Stop after printing Count times\n\n";
+    }
+
+    exit(1);
+}
+
+//------------------------------------------------------------------------------
+void unhandled_exception() {
+  auto p = current_exception();
+  try    { rethrow_exception(p); }
+  catch  ( exception& e ) { cerr << e.what() << endl; }
+  catch  ( ... )          { cerr << "Unknown exception" << endl; }
+  exit(1);
+}
+
+//------------------------------------------------------------------------------
+void print_snapshot(const utxx::metrics_snapshot& a_snap)
+{
+    printf("%s pid=%u metrics=%u\n",
+        utxx::timestamp::to_string(utxx::time_val(utxx::nsecs(a_snap.time)),
+                                   utxx::DATE_TIME_WITH_USEC).c_str(),
+        a_snap.pid, a_snap.count);
+
+    for (uint32_t i=0; i < a_snap.count; ++i) {
+        auto& m = a_snap.items[i];
+        switch (m.type) {
+            case utxx::metric_sample::COUNTER:
+                printf("  %-40s counter   %ld\n", m.name, m.value);
+                break;
+            case utxx::metric_sample::GAUGE:
+                printf("  %-40s gauge     %ld\n", m.name, m.value);
+                break;
+            case utxx::metric_sample::HISTOGRAM:
+                printf("  %-40s histogram count=%ld avg=%ld min=%ld p50=%ld"
+                       " p90=%ld p99=%ld p999=%ld max=%ld ns\n",
+                       m.name, m.value, m.value ? m.sum / m.value : 0, m.min,
+                       m.p50, m.p90, m.p99, m.p999, m.max);
+                break;
+        }
+    }
+    fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+//  MAIN
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    string file;
+    double interval = 0;
+    long   count    = 0;
+
+    set_terminate (&unhandled_exception);
+
+    utxx::opts_parser opts(argc, argv);
+
+    while (opts.next()) {
+        if (opts.match("-f", "",           &file))     continue;
+        if (opts.match("-i", "--interval", &interval)) continue;
+        if (opts.match("-c", "--count",    &count))    continue;
+        if (opts.is_help())                            usage();
+
+        usage(opts());
+    }
+
+    if (file.empty())
+        throw std::runtime_error("Must specify -f option!");
+
+    utxx::metrics_reader reader;
+    reader.open(file);
+
+    // The snapshot is large, so keep it off the stack
+    std::unique_ptr<utxx::metrics_snapshot> snap(new utxx::metrics_snapshot());
+
+    for (long i=0; !count || i < count; ++i) {
+        if (i)
+            usleep(long(interval * 1000000));
+        if (!reader.read(*snap))
+            throw std::runtime_error("Cannot read consistent snapshot from " + file);
+        print_snapshot(*snap);
+        if (interval <= 0)
+            break;
+    }
+
+    return 0;
+}
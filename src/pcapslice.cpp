@@ -42,7 +42,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <utxx/string.hpp>
 #include <utxx/path.hpp>
 #include <utxx/get_option.hpp>
-#include <utxx/buffer.hpp>
+#include <utxx/mirrored_io_buffer.hpp>
 #include <utxx/timestamp.hpp>
 #include <utxx/version.hpp>
 
@@ -173,7 +173,7 @@ int main(int argc, char *argv[])
             throw std::runtime_error("Error creating file " + out_file + ": " + strerror(errno));
     }
 
-    utxx::basic_io_buffer<(1024*1024)> buf;
+    utxx::basic_mirrored_io_buffer<(1024*1024)> buf;
 
     if (print || verbose) {
         printf("# Time                   %-20s %-20s %10s %10s",
@@ -0,0 +1,308 @@
+//----------------------------------------------------------------------------
+/// \file  perf_counters.cpp
+//----------------------------------------------------------------------------
+/// \brief Hardware performance counters attributed to named code scopes.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <utxx/perf_counters.hpp>
+#include <utxx/logger/logger.hpp>
+#include <utxx/error.hpp>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <string.h>
+#include <stdio.h>
+#include <sstream>
+
+namespace utxx {
+
+namespace {
+    struct event_info {
+        const char* name;
+        uint32_t    type;
+        uint64_t    config;
+    };
+
+    constexpr uint64_t hw_cache(uint64_t a_cache) {
+        return a_cache
+             | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ)     <<  8)
+             | (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+
+    const event_info s_events[] = {
+        {"cycles",         PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES       },
+        {"instructions",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS     },
+        {"l1d_misses",     PERF_TYPE_HW_CACHE, hw_cache(PERF_COUNT_HW_CACHE_L1D) },
+        {"llc_misses",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES     },
+        {"branch_misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES    },
+        {"dtlb_misses",    PERF_TYPE_HW_CACHE, hw_cache(PERF_COUNT_HW_CACHE_DTLB) },
+        {"task_clock_ns",  PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK       },
+    };
+
+    static_assert(sizeof(s_events)/sizeof(s_events[0]) == int(perf_event::COUNT),
+                  "Invalid size of s_events");
+
+    int perf_event_open(perf_event_attr* a_attr, int a_group_fd) {
+        // Count the calling thread on any CPU
+        return ::syscall(__NR_perf_event_open, a_attr, 0, -1, a_group_fd, 0);
+    }
+}
+
+const char* to_string(perf_event a_event) {
+    return a_event < perf_event::COUNT ? s_events[int(a_event)].name : "undefined";
+}
+
+//----------------------------------------------------------------------------
+// perf_counters
+//----------------------------------------------------------------------------
+perf_counters::perf_counters(unsigned a_events)
+    : m_count(0), m_rdpmc(false)
+{
+    for (auto& c : m_ctrs) { c.fd = -1; c.page = nullptr; }
+
+    // Hardware events are opened first, so that the leader is a hardware
+    // event (software events may join a hardware group, but not vice versa)
+    int leader = -1;
+    for (int i=0; i < int(perf_event::COUNT); ++i) {
+        if (!(a_events & (1u << i)))
+            continue;
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size           = sizeof(attr);
+        attr.type           = s_events[i].type;
+        attr.config         = s_events[i].config;
+        attr.read_format    = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        int fd = perf_event_open(&attr, leader);
+        if (fd < 0)
+            continue;               // Not supported or not permitted
+
+        if (leader < 0)
+            leader = fd;
+        m_ctrs[i].fd       = fd;
+        m_order[m_count++] = i;
+
+        if (attr.type == PERF_TYPE_SOFTWARE)
+            continue;
+
+        void* p = ::mmap(nullptr, ::sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED)
+            m_ctrs[i].page = p;
+    }
+
+    // rdpmc is used only if every opened counter can be read that way
+    m_rdpmc = m_count > 0;
+    for (int i=0; i < m_count; ++i) {
+        auto pc = static_cast<volatile perf_event_mmap_page*>(m_ctrs[m_order[i]].page);
+        if (!pc || !pc->cap_user_rdpmc)
+            m_rdpmc = false;
+    }
+}
+
+perf_counters::~perf_counters() {
+    // Close members before the group leader
+    for (int i = m_count; i-- > 0; ) {
+        auto& c = m_ctrs[m_order[i]];
+        if (c.page)
+            ::munmap(c.page, ::sysconf(_SC_PAGESIZE));
+        ::close(c.fd);
+    }
+}
+
+bool perf_counters::read_group(perf_values& a_val) const {
+    memset(&a_val, 0, sizeof(a_val));
+    if (!m_count)
+        return true;
+
+    // Format of PERF_FORMAT_GROUP: {u64 nr; u64 values[nr];}
+    uint64_t buf[1 + int(perf_event::COUNT)];
+    auto n = ::read(m_ctrs[m_order[0]].fd, buf, sizeof(buf));
+    if (n < long(sizeof(uint64_t)) || buf[0] != uint64_t(m_count) ||
+        n < long((1 + m_count) * sizeof(uint64_t)))
+        return false;
+    for (int i=0; i < m_count; ++i)
+        a_val.v[m_order[i]] = buf[i+1];
+    return true;
+}
+
+//----------------------------------------------------------------------------
+// perf_scope_id
+//----------------------------------------------------------------------------
+perf_scope_id::perf_scope_id(const char* a_name)
+    : m_id(perf_registry::instance().add_scope(a_name))
+{}
+
+//----------------------------------------------------------------------------
+// perf_registry
+//----------------------------------------------------------------------------
+const uint32_t perf_registry::s_max_scopes;
+
+perf_registry::thread_data::thread_data(unsigned a_events)
+    : counters(a_events)
+{
+    for (auto& s : slots) {
+        s.calls.store(0, std::memory_order_relaxed);
+        for (auto& v : s.v) v.store(0, std::memory_order_relaxed);
+    }
+}
+
+perf_registry::perf_registry()
+    : m_events(perf_counters::s_hw_events)
+{
+    memset(m_retired, 0, sizeof(m_retired));
+}
+
+perf_registry& perf_registry::instance() {
+    static perf_registry s_instance;
+    return s_instance;
+}
+
+uint32_t perf_registry::add_scope(const char* a_name) {
+    std::lock_guard<std::mutex> g(m_mutex);
+    for (uint32_t i=0; i < m_names.size(); ++i)
+        if (m_names[i] == a_name)
+            return i;
+    if (m_names.size() == s_max_scopes)
+        UTXX_THROW_RUNTIME_ERROR("Too many perf scopes (max ", s_max_scopes,
+                                 "): ", a_name);
+    m_names.push_back(a_name);
+    return m_names.size()-1;
+}
+
+perf_registry::thread_data* perf_registry::add_thread() {
+    // Counters must be opened by the thread that will be reading them
+    std::unique_ptr<thread_data> p(new thread_data(m_events));
+    std::lock_guard<std::mutex> g(m_mutex);
+    m_threads.push_back(std::move(p));
+    return m_threads.back().get();
+}
+
+void perf_registry::remove_thread(thread_data* a_data) {
+    std::unique_ptr<thread_data> p;
+    {
+        std::lock_guard<std::mutex> g(m_mutex);
+        auto it = std::find_if(m_threads.begin(), m_threads.end(),
+                    [a_data](const std::unique_ptr<thread_data>& t) {
+                        return t.get() == a_data;
+                    });
+        if (it == m_threads.end())
+            return;
+        for (uint32_t i=0; i < s_max_scopes; ++i) {
+            auto& slot = a_data->slots[i];
+            auto& r    = m_retired[i];
+            r.calls += slot.calls.load(std::memory_order_relaxed);
+            for (int j=0; j < int(perf_event::COUNT); ++j)
+                r.values.v[j] += slot.v[j].load(std::memory_order_relaxed);
+        }
+        p = std::move(*it);
+        *it = std::move(m_threads.back());
+        m_threads.pop_back();
+    }
+    // Counters are closed and unmapped outside of the lock
+}
+
+std::vector<perf_scope_stats> perf_registry::collect() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    std::vector<perf_scope_stats> res;
+    for (uint32_t i=0; i < m_names.size(); ++i) {
+        perf_scope_stats s;
+        s.name  = m_names[i];
+        s.calls  = m_retired[i].calls;
+        s.values = m_retired[i].values;
+        for (auto& t : m_threads) {
+            auto& slot = t->slots[i];
+            s.calls += slot.calls.load(std::memory_order_relaxed);
+            for (int j=0; j < int(perf_event::COUNT); ++j)
+                s.values.v[j] += slot.v[j].load(std::memory_order_relaxed);
+        }
+        if (s.calls)
+            res.push_back(std::move(s));
+    }
+    return res;
+}
+
+size_t perf_registry::threads() const {
+    std::lock_guard<std::mutex> g(m_mutex);
+    return m_threads.size();
+}
+
+void perf_registry::reset() {
+    std::lock_guard<std::mutex> g(m_mutex);
+    memset(m_retired, 0, sizeof(m_retired));
+    for (auto& t : m_threads)
+        for (auto& s : t->slots) {
+            s.calls.store(0, std::memory_order_relaxed);
+            for (auto& v : s.v) v.store(0, std::memory_order_relaxed);
+        }
+}
+
+void perf_registry::dump(std::ostream& out) const {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%-24s %12s %6s", "Scope", "Calls", "IPC");
+    out << buf;
+    for (int i=0; i < int(perf_event::COUNT); ++i) {
+        snprintf(buf, sizeof(buf), " %14s", s_events[i].name);
+        out << buf;
+    }
+    out << "  (per call)\n";
+
+    for (auto& s : collect()) {
+        snprintf(buf, sizeof(buf), "%-24s %12lu %6.2f", s.name.c_str(), s.calls, s.ipc());
+        out << buf;
+        for (int i=0; i < int(perf_event::COUNT); ++i) {
+            snprintf(buf, sizeof(buf), " %14.2f", s.per_call(perf_event(i)));
+            out << buf;
+        }
+        out << '\n';
+    }
+}
+
+void perf_registry::to_csv(std::ostream& out) const {
+    out << "scope,calls";
+    for (auto& e : s_events)
+        out << ',' << e.name;
+    out << '\n';
+    for (auto& s : collect()) {
+        out << s.name << ',' << s.calls;
+        for (auto v : s.values.v)
+            out << ',' << v;
+        out << '\n';
+    }
+}
+
+void perf_registry::log(log_level a_level) const {
+    std::stringstream s;
+    dump(s);
+    std::string line;
+    while (std::getline(s, line))
+        UTXX_CLOG(a_level, "perf", "%s", line.c_str());
+}
+
+} // namespace utxx
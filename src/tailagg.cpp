@@ -3,6 +3,12 @@
 /// \file tailagg.cpp
 //----------------------------------------------------------------------------
 /// \brief Tail a file by merging lines beginning with given regex's.
+///
+/// A file is followed using inotify(7): it's read in large chunks when
+/// modified, and reopened when rotated (renamed or deleted and recreated)
+/// or reread from the beginning when truncated. Lines are matched by
+/// utxx::line_filter that runs the regex only on lines containing the
+/// pattern's required literal.
 //----------------------------------------------------------------------------
 // Copyright (c) 2011 Serge Aleynikov <saleyn@gmail.com>
 // Created: 2014-08-28
@@ -31,21 +37,21 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 ***** END LICENSE BLOCK *****
 */
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <unordered_map>
 #include <regex>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/inotify.h>
 #include <fcntl.h>
 #include <string.h>
 #include <utxx/path.hpp>
 #include <utxx/time_val.hpp>
-#include <utxx/buffer.hpp>
-#include <boost/concept_check.hpp>
+#include <utxx/line_filter.hpp>
 
 using namespace std;
 
@@ -64,95 +70,299 @@ void usage(std::string const& a_err = "")
     << "                                for this key. If -k3 is given, this means to use\n"
     << "                                3rd group in the regex pattern)\n"
     << "    -n N                     - start tail from last N lines\n"
-    << "    -s, --sleep-interval=S   - sleep for approximately S seconds (default 1s)\n"
+    << "    -s, --sleep-interval=S   - print changes every S seconds (default 1s)\n"
     << "    -i, --no-case            - ignore case in regex\n"
     << "    --awk                    - use regex awk grammar\n"
     << "    --grep                   - use regex grep grammar\n"
     << "    --egrep                  - use regex egrep grammar\n"
+    << "    --poll                   - poll the file every S seconds instead of\n"
+    << "                               waiting for inotify events\n"
     << "    -h, --help               - help\n"
     << endl;
 
   exit(1);
 }
 
-void print(const vector<string>& a_lines, bool changed[])
-{
-  for (int i=0, e = a_lines.size(); i < e; ++i)
-    if (changed[i]) {
-      changed[i] = false;
-      std::cout << a_lines[i] << endl;
-    }
-  flush(std::cout);
-}
-
-void find_last_line(long a_count, istream* a_file)
-{
-  if (a_count <= 0)
-    return;
+enum class rex {
+  KEY,      // Find a match by regex key
+  SEARCH    // Apply regex to the line without key checking of result
+};
 
-  a_file->seekg(-1, ios_base::end);
+struct key_state {
+  string line;
+  bool   changed = false;
+};
 
-  long count = 0, pos = a_file->tellg();
+struct rex_info {
+  rex               type;
+  int               group;
+  string            str_exp;
+  utxx::line_filter filter;
+  // Last matching line for rex::SEARCH
+  string            line;
+  bool              changed = false;
+  // Last matching line per key for rex::KEY
+  unordered_map<string, key_state> keys;
+  vector<string>    changed_keys;
 
-  while(count < a_count && pos > 0) {
-    long sz = std::min<long>(1024, pos);
-    a_file->seekg(-sz, ios_base::cur);
-    long new_pos = a_file->tellg();
+  rex_info(rex tp, int grp, string val)
+    : type(tp)
+    , group(grp)
+    , str_exp(val)
+  {}
+};
 
-    char  buf[1024];
-    int   n = a_file->readsome(buf, sz);
+class tail_aggregator {
+  vector<rex_info>& m_regex_vals;
+  int               m_change_count;
+public:
+  explicit tail_aggregator(vector<rex_info>& a_regex_vals)
+    : m_regex_vals(a_regex_vals), m_change_count(0)
+  {}
 
-    if (n < 0)
-        exit(1);
+  int change_count() const { return m_change_count; }
 
-    char* p = buf + n;
+  /// Process a buffer of complete lines
+  void process(const char* a_begin, const char* a_end)
+  {
+    for (auto& re : m_regex_vals)
+      re.filter.scan(a_begin, a_end,
+        [this, &re](const char* a_line, const char* a_eol, const std::cmatch& a_match) {
+          if (a_line == a_eol)
+            return;
 
-    for (; p != buf; --p)
-        if (*p == '\n' && ++count == a_count) {
-            a_file->seekg(new_pos + p - buf);
+          if (re.type == rex::SEARCH) {
+            if (!re.changed && re.line.compare(0, string::npos, a_line, a_eol - a_line)) {
+              re.changed = true;
+              m_change_count++;
+            }
+            re.line.assign(a_line, a_eol);
             return;
+          }
+
+          auto& sub = a_match[re.group];
+          auto& key = re.keys[string(sub.first, sub.second)];
+          if (!key.changed && key.line.compare(0, string::npos, a_line, a_eol - a_line)) {
+            key.changed = true;
+            re.changed_keys.emplace_back(sub.first, sub.second);
+            m_change_count++;
+          }
+          key.line.assign(a_line, a_eol);
+        });
+  }
+
+  void print()
+  {
+    for (auto& re : m_regex_vals) {
+      if (re.changed) {
+        re.changed = false;
+        std::cout << re.line << '\n';
+      }
+      for (auto& k : re.changed_keys) {
+        auto& key = re.keys[k];
+        key.changed = false;
+        std::cout << key.line << '\n';
+      }
+      re.changed_keys.clear();
+    }
+    m_change_count = 0;
+    flush(std::cout);
+  }
+};
+
+/// Reads a file in large chunks passing complete lines to the aggregator
+class chunk_reader {
+  int           m_fd;
+  off_t         m_offset;
+  vector<char>  m_buf;
+  size_t        m_len;      // Length of incomplete last line in m_buf
+public:
+  chunk_reader() : m_fd(-1), m_offset(0), m_buf(1 << 20), m_len(0) {}
+  ~chunk_reader() { close(); }
+
+  int   fd()     const { return m_fd;     }
+  off_t offset() const { return m_offset; }
+
+  bool open(const string& a_file) {
+    close();
+    m_fd = ::open(a_file.c_str(), O_RDONLY | O_CLOEXEC);
+    return m_fd >= 0;
+  }
+
+  void attach(int a_fd) { close(); m_fd = a_fd; }
+
+  void close() {
+    if (m_fd > 0) ::close(m_fd);
+    m_fd = -1; m_offset = 0; m_len = 0;
+  }
+
+  void seek(off_t a_offset) {
+    m_offset = ::lseek(m_fd, a_offset, SEEK_SET);
+    m_len    = 0;
+  }
+
+  /// Position the file at the beginning of the last \a a_count lines
+  void seek_last_lines(long a_count) {
+    struct stat st;
+    if (a_count <= 0 || ::fstat(m_fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+      if (a_count <= 0 && ::fstat(m_fd, &st) == 0 && S_ISREG(st.st_mode))
+        seek(st.st_size);
+      return;
+    }
+    // The last line's end of line character is not counted
+    off_t pos = st.st_size - 1;
+    long  n   = 0;
+    char  buf[4096];
+    while (pos > 0) {
+      off_t sz = std::min<off_t>(sizeof(buf), pos);
+      if (::pread(m_fd, buf, sz, pos - sz) != sz)
+        break;
+      for (char* p = buf + sz; p != buf; )
+        if (*--p == '\n' && ++n == a_count) {
+          seek(pos - sz + (p - buf) + 1);
+          return;
         }
+      pos -= sz;
+    }
+    seek(0);
+  }
 
-    pos = new_pos;
+  /// Check if the file was truncated, and if so, read it from the start
+  bool check_truncated() {
+    struct stat st;
+    if (::fstat(m_fd, &st) < 0 || !S_ISREG(st.st_mode) || st.st_size >= m_offset)
+      return false;
+    seek(0);
+    return true;
   }
 
-  a_file->clear();
-}
+  /// Read the available data.
+  /// @return false on end of file
+  bool read(tail_aggregator& a_agg) {
+    ssize_t n = ::read(m_fd, &m_buf[m_len], m_buf.size() - m_len);
+    if (n <= 0) {
+      if (n < 0 && errno != EAGAIN && errno != EINTR) {
+        cerr << "Error reading file: " << strerror(errno) << endl;
+        exit(1);
+      }
+      return false;
+    }
+    m_offset += n;
 
-enum class rex {
-  KEY,      // Find a match by regex key
-  SEARCH    // Apply regex to the line without key checking of result
-};
+    const char* begin = &m_buf[0];
+    const char* end   = begin + m_len + n;
+    auto last = (const char*)memrchr(begin, '\n', end - begin);
 
-struct rex_info {
-  rex      type;
-  int      group;
-  unique_ptr<regex> exp;
-  string   last_key;
-  string   str_exp;
+    if (!last) {
+      if (end - begin < long(m_buf.size())) {
+        m_len += n;
+        return true;
+      }
+      last = end;   // A line longer than the buffer is processed as is
+    }
+    a_agg.process(begin, last);
 
-  rex_info(rex tp, int grp, string val)
-    : type(tp)
-    , group(grp)
-    , str_exp(val)
-  {}
+    m_len = last == end ? 0 : end - last - 1;
+    memmove(&m_buf[0], last + 1 - (last == end), m_len);
+    return true;
+  }
+
+  /// Read until the end of file
+  void drain(tail_aggregator& a_agg) { while (read(a_agg)); }
 };
 
+/// Follow the file by waiting for inotify events
+void follow(const string& a_file, chunk_reader& a_reader, tail_aggregator& a_agg,
+            int a_interval, utxx::time_val a_deadline)
+{
+  int ifd = inotify_init1(IN_CLOEXEC);
+  if (ifd < 0) {
+    cerr << "Failed to initialize inotify: " << strerror(errno) << endl;
+    exit(1);
+  }
+
+  auto slash = a_file.rfind('/');
+  auto dir   = slash == string::npos ? string(".") : a_file.substr(0, slash+1);
+  auto name  = utxx::path::basename(a_file);
+
+  const uint32_t file_events = IN_MODIFY;
+  int wfile = inotify_add_watch(ifd, a_file.c_str(), file_events);
+  int wdir  = inotify_add_watch(ifd, dir.c_str(),    IN_CREATE  | IN_MOVED_TO);
+
+  if (wfile < 0 || wdir < 0) {
+    cerr << "Failed to watch file " << a_file << ": " << strerror(errno) << endl;
+    exit(1);
+  }
+
+  char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  while (true) {
+    auto now = utxx::now_utc();
+
+    if (a_agg.change_count() && now >= a_deadline) {
+      a_agg.print();
+      a_deadline = now + utxx::time_val(a_interval, 0);
+    }
+
+    // Wait for file events or for the time to print the pending changes
+    pollfd pfd = { ifd, POLLIN, 0 };
+    int timeout = a_agg.change_count()
+                ? std::max<long>(0, a_deadline.diff_nsec(now) / 1000000 + 1) : -1;
+    int rc = ::poll(&pfd, 1, timeout);
+    if (rc <= 0) {
+      if (rc < 0 && errno != EINTR) {
+        cerr << "Failed to poll inotify events: " << strerror(errno) << endl;
+        exit(1);
+      }
+      continue;
+    }
+
+    ssize_t len = ::read(ifd, buf, sizeof(buf));
+    if (len <= 0)
+      continue;
+
+    bool modified = false, created = false;
+
+    for (char* p = buf; p < buf + len; ) {
+      auto ev = reinterpret_cast<const inotify_event*>(p);
+      if (ev->wd == wfile)
+        modified |= (ev->mask & IN_MODIFY) != 0;
+      else if (ev->wd == wdir && ev->len && name == ev->name)
+        created = true;
+      p += sizeof(inotify_event) + ev->len;
+    }
+
+    if (modified) {
+      a_reader.check_truncated();
+      a_reader.drain(a_agg);
+    }
+
+    if (created) {
+      // The file was rotated: finish reading the old file, and
+      // switch to the new one
+      a_reader.drain(a_agg);
+      inotify_rm_watch(ifd, wfile);
+      if (!a_reader.open(a_file)) {
+        cerr << "Failed to open file " << a_file << ": " << strerror(errno) << endl;
+        exit(1);
+      }
+      wfile = inotify_add_watch(ifd, a_file.c_str(), file_events);
+      a_reader.drain(a_agg);
+    }
+  }
+}
+
 int main(int argc, char* argv[])
 {
   int    interval = 1;
   string filename;
   long   last = 0;
+  bool   poll_file = false;
   regex_constants::syntax_option_type regex_opts =
     regex_constants::syntax_option_type(0);
   vector<rex_info> regex_vals;
-  vector<string>   lines;
-
-  ifstream input;
-  istream* file = &std::cin;
 
   auto matchopt = [&](int i, const char* sv, const char* lv)
-                  { return !strcmp(argv[i], sv) || !lv || !strcmp(argv[i], lv); };
+                  { return !strcmp(argv[i], sv) || (lv && !strcmp(argv[i], lv)); };
   auto matchopt_n = [&](int i, int len, const char* sv)
                   { return !strncmp(argv[i], sv, len); };
   auto hasarg   = [&](int i)
@@ -166,8 +376,8 @@ int main(int argc, char* argv[])
     else if (matchopt_n(i, 2, "-k") && hasarg(i)) {
       regex_vals.push_back(rex_info(
           rex::KEY,
-          argv[i][2] != ' ' ? argv[i][2] - '0' : 1,
-          argv[i]));
+          argv[i][2] ? argv[i][2] - '0' : 1,
+          argv[i+1]));
       i++;
     }
     else if (matchopt(i, "-h", "--help"))
@@ -182,85 +392,62 @@ int main(int argc, char* argv[])
       regex_opts |= regex_constants::grep;
     else if (matchopt(i, "--egrep", nullptr))
       regex_opts |= regex_constants::egrep;
+    else if (matchopt(i, "--poll", nullptr))
+      poll_file = true;
     else if (argv[i][0] != '-')
-    {
       filename = argv[i];
-      input.open(filename.c_str(), ifstream::in);
-      if (input.fail())
-      {
-        cerr << "Failed to open file: " << filename << endl;
-        exit(1);
-      }
-      file = &input;
-    }
     else
       usage(string("Invalid option: ") + argv[i]);
   }
 
-  for (auto& e : regex_vals)
-    e.exp.reset(new regex(e.str_exp, regex_opts));
+  if (regex_vals.empty())
+    regex_vals.push_back(rex_info(rex::SEARCH, 0, ""));
+  else
+    for (auto& e : regex_vals)
+      e.filter = utxx::line_filter(e.str_exp, regex_opts);
 
-  size_t sz = std::max<size_t>(1, regex_vals.size());
+  tail_aggregator agg(regex_vals);
+  chunk_reader    reader;
 
-  bool changed[sz];
-  memset(changed, 0, sizeof(bool)*sz);
-
-  lines.resize(sz);
+  if (filename.empty())
+    reader.attach(STDIN_FILENO);
+  else if (!reader.open(filename)) {
+    cerr << "Failed to open file: " << filename << endl;
+    exit(1);
+  }
 
-  utxx::time_val deadline = utxx::now_utc() + 1.0, last_time;
-  int change_count = 0;
+  reader.seek_last_lines(last);
 
-  find_last_line(last, file);
+  utxx::time_val deadline = utxx::now_utc() + 1.0;
 
-  auto now = utxx::now_utc();
+  if (!filename.empty() && !poll_file) {
+    reader.drain(agg);
+    follow(filename, reader, agg, interval, deadline);
+    return 0;
+  }
 
   while(true) {
+    auto now = utxx::now_utc();
     if (now < deadline)
       usleep(long(deadline.diff(now) * 1000000));
 
-    string s;
-    while (getline(*file, s)) {
-      if (s.empty())
-        continue;
-
-      for (size_t i = 0, e = sz; i < e; ++i) {
-        auto& re = regex_vals[i];
-        std::smatch rmatch;
-        if (regex_vals.empty() || regex_search(s, rmatch, *re.exp))
-        {
-          bool&   line_changed = changed[i];
-          string& last_key     = re.last_key;
-
-          if (!line_changed) {
-            line_changed |= ((re.type == rex::KEY)
-                          ? last_key != rmatch[re.group]
-                          : lines[i] != s);
-
-            if (line_changed)
-              change_count++;
-          }
-
-          if (re.type == rex::KEY)
-            last_key = rmatch[re.group];
-          lines[i] = s;
-        }
-      }
-
-      now = utxx::now_utc();
-
-      if (now >= deadline && change_count) {
-        print(lines, changed);
-        change_count = 0;
-        deadline = now + utxx::time_val(interval, 0);
-      }
-    }
+    if (!filename.empty())
+      reader.check_truncated();
 
-    if (!file->eof())
-       exit(1);
+    // Reading a pipe blocks until data is available
+    bool eof = !reader.read(agg);
+    if (!eof && filename.empty())
+      while (agg.change_count() == 0 && reader.read(agg));
+    else
+      reader.drain(agg);
 
-    file->clear();
+    now = utxx::now_utc();
 
-    deadline = now + utxx::time_val(interval, 0);
+    if (agg.change_count()) {
+      agg.print();
+      deadline = now + utxx::time_val(interval, 0);
+    } else if (eof && filename.empty())
+      break;
   }
 
   return 0;
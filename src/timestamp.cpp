@@ -40,9 +40,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 namespace utxx {
 
-boost::mutex            timestamp::s_mutex;
-thread_local long       timestamp::s_next_local_midnight_nseconds = 0;
-thread_local long       timestamp::s_next_utc_midnight_nseconds   = 0;
+thread_local long       timestamp::s_next_local_midnight_nseconds    = 0;
+thread_local long       timestamp::s_next_utc_midnight_nseconds      = 0;
+thread_local long       timestamp::s_next_utc_offset_change_nseconds = 0;
 thread_local time_t     timestamp::s_utc_nsec_offset              = 0;
 thread_local char       timestamp::s_local_timestamp[16];
 thread_local char       timestamp::s_utc_timestamp[16];
@@ -59,6 +59,12 @@ namespace {
         "date-time-msec", "date-time-usec", "date-time-nsec",
         "time", "time-msec", "time-usec",   "time-nsec"
     };
+
+    long local_utc_offset(time_t a_utc_sec) {
+        struct tm tm;
+        localtime_r(&a_utc_sec, &tm);
+        return tm.tm_gmtoff;
+    }
 }
 
 stamp_type parse_stamp_type(const std::string& a_line) {
@@ -113,6 +119,9 @@ void timestamp::update_midnight_nseconds(time_val a_now)
                                    ? (s_next_utc_midnight_nseconds - s_utc_nsec_offset)
                                    : local_midnight_nsecs;
 
+    auto next_change = utc_offset_range(s, s, s + 86400).second;
+    s_next_utc_offset_change_nseconds = next_change * 1000000000L;
+
     strncpy(s_local_timezone, tm.tm_zone, sizeof(s_local_timezone)-1);
     s_local_timezone[sizeof(s_local_timezone)-1] = '\0';
 
@@ -121,6 +130,35 @@ void timestamp::update_midnight_nseconds(time_val a_now)
     internal_write_date(s_utc_timestamp,   s, true,  9, '\0');
 }
 
+std::pair<time_t, time_t> timestamp::
+utc_offset_range(time_t a_utc_sec, time_t a_begin, time_t a_end, long* a_offset)
+{
+    assert(a_begin <= a_utc_sec && a_utc_sec < a_end);
+
+    auto off = local_utc_offset(a_utc_sec);
+    if (a_offset) *a_offset = off;
+
+    // Bisect for the first second having a different offset after a_utc_sec
+    if (local_utc_offset(a_end-1) != off) {
+        time_t lo = a_utc_sec, hi = a_end-1;
+        while (hi - lo > 1) {
+            auto mid = lo + (hi - lo) / 2;
+            (local_utc_offset(mid) == off ? lo : hi) = mid;
+        }
+        a_end = hi;
+    }
+    // Bisect for the first second having the same offset before a_utc_sec
+    if (local_utc_offset(a_begin) != off) {
+        time_t lo = a_begin, hi = a_utc_sec;
+        while (hi - lo > 1) {
+            auto mid = lo + (hi - lo) / 2;
+            (local_utc_offset(mid) == off ? hi : lo) = mid;
+        }
+        a_begin = hi;
+    }
+    return std::make_pair(a_begin, a_end);
+}
+
 size_t timestamp::format_size(stamp_type a_tp)
 {
     switch (a_tp) {
@@ -188,6 +226,127 @@ int timestamp::format(stamp_type a_tp, time_val tv, char* a_buf, size_t a_sz,
     }
 }
 
+//---------------------------------------------------------------------------
+// time_formatter
+//---------------------------------------------------------------------------
+time_formatter::time_formatter(stamp_type a_tp, bool a_utc, style a_style)
+    : m_type(a_tp), m_style(a_style), m_utc(a_utc || a_style == FIX)
+    , m_time_pos(-1), m_frac_pos(0), m_frac_digits(0), m_frac_div(1)
+    , m_sec(-1), m_valid_begin(0), m_valid_end(0), m_offset(0)
+{
+    bool iso = a_style == ISO8601;
+    int  pos = 0;
+
+    switch (a_tp) {
+        case NO_TIMESTAMP:
+            break;
+        case DATE:
+            pos = iso ? 10 : 8;
+            break;
+        case DATE_TIME:
+        case DATE_TIME_WITH_MSEC:
+        case DATE_TIME_WITH_USEC:
+        case DATE_TIME_WITH_NSEC:
+            pos = iso ? 11 : 9;
+            // fallthrough
+        case TIME:
+        case TIME_WITH_MSEC:
+        case TIME_WITH_USEC:
+        case TIME_WITH_NSEC: {
+            m_time_pos = pos;
+            pos += 8;
+            auto tp = a_tp < TIME ? stamp_type(a_tp+4) : a_tp;
+            m_frac_digits = tp == TIME_WITH_MSEC ? 3
+                          : tp == TIME_WITH_USEC ? 6
+                          : tp == TIME_WITH_NSEC ? 9 : 0;
+            m_frac_div    = tp == TIME_WITH_MSEC ? 1000000
+                          : tp == TIME_WITH_USEC ? 1000 : 1;
+            if (m_frac_digits) {
+                m_buf[pos]  = '.';
+                m_frac_pos  = ++pos;
+                pos        += m_frac_digits;
+                memset(m_buf + m_frac_pos, '0', m_frac_digits);
+            }
+            if (iso)
+                pos += m_utc ? 1 : 6;
+            break;
+        }
+        default:
+            throw badarg_error("time_formatter: invalid timestamp type: ", int(a_tp));
+    }
+    m_size      = pos;
+    m_buf[pos]  = '\0';
+}
+
+void time_formatter::refresh(time_t a_sec)
+{
+    if (unlikely(a_sec < m_valid_begin || a_sec >= m_valid_end)) {
+        // Find the range of seconds sharing the date and the UTC offset
+        if (m_utc) {
+            m_offset      = 0;
+            m_valid_begin = a_sec - a_sec % 86400;
+            m_valid_end   = m_valid_begin + 86400;
+        } else {
+            m_offset      = local_utc_offset(a_sec);
+            auto local    = a_sec + m_offset;
+            auto begin    = local - local % 86400 - m_offset;
+            std::tie(m_valid_begin, m_valid_end) =
+                timestamp::utc_offset_range(a_sec, begin, begin + 86400, &m_offset);
+        }
+
+        auto local = a_sec + m_offset;
+        bool iso   = m_style == ISO8601;
+
+        if (m_type < TIME && m_type != NO_TIMESTAMP) {
+            time_val::write_date(local, m_buf, 0, iso ? '-' : '\0');
+            if (iso && m_time_pos > 0)
+                m_buf[m_time_pos-1] = 'T';
+        }
+
+        if (iso && m_time_pos >= 0) {
+            char* p = m_buf + m_size - (m_utc ? 1 : 6);
+            if (m_utc)
+                *p = 'Z';
+            else {
+                auto off = m_offset < 0 ? -m_offset : m_offset;
+                auto h   = off / 3600, m = off / 60 % 60;
+                *p++ = m_offset < 0 ? '-' : '+';
+                *p++ = '0' + h / 10; *p++ = '0' + h % 10; *p++ = ':';
+                *p++ = '0' + m / 10; *p   = '0' + m % 10;
+            }
+        }
+        m_buf[m_size] = '\0';
+    }
+
+    if (m_time_pos >= 0) {
+        unsigned h, m, s;
+        std::tie(h, m, s) = time_val::to_hms(a_sec + m_offset);
+        char* p = m_buf + m_time_pos;
+        *p++ = '0' + h / 10; *p++ = '0' + h % 10; *p++ = ':';
+        *p++ = '0' + m / 10; *p++ = '0' + m % 10; *p++ = ':';
+        *p++ = '0' + s / 10; *p   = '0' + s % 10;
+    }
+    m_sec = a_sec;
+}
+
+char* time_formatter::write(const time_val* a_tv, size_t a_n, char* a_buf, size_t a_stride)
+{
+    assert(a_stride >= m_size);
+    char* p = a_buf;
+
+    for (auto e = a_tv + a_n; a_tv != e; ++a_tv, p += a_stride) {
+        auto pair = a_tv->split();
+        if (unlikely(pair.first != m_sec))
+            refresh(pair.first);
+        memcpy(p, m_buf, m_size);
+        if (m_frac_digits)
+            sse::u32toa_fixed(pair.second / m_frac_div, p + m_frac_pos, m_frac_digits);
+        if (a_stride > m_size)
+            p[m_size] = '\0';
+    }
+    return p;
+}
+
 time_val timestamp::from_string(const char* a_datetime, size_t n, bool a_utc) {
     if (unlikely(n < 8 ||
                 (n > 8 && (n < 17 || a_datetime[8]  != '-' ||
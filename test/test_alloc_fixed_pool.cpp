@@ -0,0 +1,213 @@
+//----------------------------------------------------------------------------
+/// \file  test_alloc_fixed_pool.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for the fixed size object pool and its thread cache.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file may be included in different open-source projects
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/alloc_fixed_pool.hpp>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+#include <set>
+
+using namespace utxx;
+using namespace utxx::memory;
+
+namespace {
+    struct order { long id; double px; long qty; char sym[8]; };
+
+    template <class Pool>
+    struct pool_storage {
+        enum { SIZE = Pool::template storage_size<sizeof(order), 4096>::value };
+        std::vector<char> mem;
+        Pool&             pool;
+
+        pool_storage()
+            : mem(SIZE)
+            , pool(Pool::create(&mem[0], mem.size(), sizeof(order)))
+        {}
+    };
+
+    static long iterations() {
+        return getenv("ITERATIONS") ? atol(getenv("ITERATIONS")) : 1000000;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_alloc_fixed_pool )
+{
+    pool_storage<heap_fixed_size_object_pool> s;
+    auto& pool = s.pool;
+
+    BOOST_REQUIRE_EQUAL(4096u, pool.capacity());
+    BOOST_REQUIRE_EQUAL(sizeof(order), pool.object_size());
+
+    std::set<void*> all;
+    for (size_t i=0; i < pool.capacity(); ++i) {
+        void* p = pool.allocate();
+        BOOST_REQUIRE(p);
+        BOOST_REQUIRE(all.insert(p).second);
+    }
+    BOOST_REQUIRE(!pool.allocate());
+
+    for (auto p : all)
+        pool.free(p);
+
+    auto& pool2 = heap_fixed_size_object_pool::attach(&s.mem[0], s.mem.size(), sizeof(order));
+    BOOST_REQUIRE_EQUAL(&pool, &pool2);
+}
+
+BOOST_AUTO_TEST_CASE( test_alloc_fixed_pool_thread_cache )
+{
+    typedef heap_fixed_size_object_pool pool_t;
+    pool_storage<pool_t> s;
+    auto& pool = s.pool;
+
+    std::set<void*> all;
+    {
+        pool_t::thread_cache cache(pool, 16);
+        BOOST_CHECK_EQUAL(16u, cache.batch());
+
+        void* p = cache.allocate();
+        BOOST_REQUIRE(p);
+        BOOST_CHECK_EQUAL(15u, cache.cached());
+        cache.free(p);
+        BOOST_CHECK_EQUAL(16u, cache.cached());
+        BOOST_CHECK_EQUAL(p, cache.allocate());
+        cache.free(p);
+
+        // Drain the pool through the cache
+        for (size_t i=0; i < pool.capacity(); ++i) {
+            void* q = cache.allocate();
+            BOOST_REQUIRE(q);
+            BOOST_REQUIRE(all.insert(q).second);
+        }
+        BOOST_REQUIRE(!cache.allocate());
+        BOOST_REQUIRE(!pool.allocate());
+
+        // Overflowing the local free list returns a chain to the pool
+        auto it = all.begin();
+        for (int i=0; i < 31; ++i)
+            cache.free(*it++);
+        BOOST_CHECK_EQUAL(31u, cache.cached());
+        cache.free(*it++);
+        BOOST_CHECK_EQUAL(16u, cache.cached());
+
+        void* q = pool.allocate();
+        BOOST_CHECK(q);
+        pool.free(q);
+
+        // Objects from the cache can be freed to the pool and vice versa
+        for (; it != all.end(); ++it)
+            pool.free(*it);
+        void* r = pool.allocate();
+        cache.free(r);
+    }
+
+    // All objects are back in the pool when the cache is destroyed
+    std::set<void*> again;
+    void* p;
+    while ((p = pool.allocate()) != NULL)
+        again.insert(p);
+    BOOST_CHECK(all == again);
+}
+
+BOOST_AUTO_TEST_CASE( test_alloc_fixed_pool_threads )
+{
+    typedef heap_fixed_size_object_pool pool_t;
+    pool_storage<pool_t> s;
+    auto& pool = s.pool;
+    const long iters = std::min(iterations(), 200000l);
+    volatile long errors = 0;
+
+    auto worker = [&](long id) {
+        pool_t::thread_cache cache(pool, 8);
+        std::vector<order*> held;
+        unsigned seed = id;
+        for (long i=0; i < iters; ++i) {
+            if (held.size() < 64 && (held.empty() || rand_r(&seed) & 1)) {
+                // Alternate between the cache and the pool
+                order* o = static_cast<order*>(i & 4 ? cache.allocate() : pool.allocate());
+                if (!o) { atomic::inc(&errors); break; }
+                o->id = id;
+                held.push_back(o);
+            } else {
+                order* o = held.back();
+                held.pop_back();
+                if (o->id != id) atomic::inc(&errors);
+                if (i & 8) cache.free(o); else pool.free(o);
+            }
+        }
+        for (auto o : held)
+            cache.free(o);
+    };
+
+    std::vector<std::thread> thr;
+    for (int i=0; i < 8; ++i)
+        thr.emplace_back(worker, i+1);
+    for (auto& t : thr)
+        t.join();
+
+    BOOST_CHECK_EQUAL(0, errors);
+
+    size_t n = 0;
+    while (pool.allocate()) ++n;
+    BOOST_CHECK_EQUAL(pool.capacity(), n);
+}
+
+#ifdef USE_PID_RECOVERY
+BOOST_AUTO_TEST_CASE( test_alloc_fixed_pool_reclaim )
+{
+    typedef shmem_fixed_size_object_pool pool_t;
+    const size_t sz = pool_t::storage_size<sizeof(order), 1024>::value;
+    void* mem = ::mmap(NULL, sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    BOOST_REQUIRE(mem != MAP_FAILED);
+    auto& pool = pool_t::create(mem, sz, sizeof(order));
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        // Leave allocated objects and objects cached by a thread cache
+        auto* cache = new pool_t::thread_cache(pool, 16);
+        for (int i=0; i < 10; ++i) pool.allocate();
+        for (int i=0; i < 10; ++i) cache->allocate();
+        ::_exit(0);
+    }
+    BOOST_REQUIRE(pid > 0);
+    int status;
+    ::waitpid(pid, &status, 0);
+
+    pool.reclaim_objects(pid);
+
+    size_t n = 0;
+    while (pool.allocate()) ++n;
+    BOOST_CHECK_EQUAL(pool.capacity(), n);
+    ::munmap(mem, sz);
+}
+#endif
@@ -0,0 +1,296 @@
+//----------------------------------------------------------------------------
+/// \file  test_allocator.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for the shared memory pow2_allocator.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file may be included in different open-source projects
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/allocator.hpp>
+#include <sys/wait.h>
+#include <thread>
+#include <vector>
+
+using namespace utxx;
+
+namespace {
+    typedef memory::pow2_allocator<>              cached_alloc;
+    typedef memory::pow2_allocator<8, 32, 32, 0>  shared_alloc;
+    typedef memory::pow2_allocator<8, 32, 32, 2>  small_alloc;
+
+    struct shm_region {
+        void*  addr;
+        size_t size;
+
+        shm_region(size_t sz) : size(sz) {
+            addr = ::mmap(NULL, sz, PROT_READ|PROT_WRITE,
+                          MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+            BOOST_REQUIRE(addr != MAP_FAILED);
+        }
+        ~shm_region() { ::munmap(addr, size); }
+    };
+
+    static long iterations() {
+        return getenv("ITERATIONS") ? atol(getenv("ITERATIONS")) : 1000000;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_simple )
+{
+    shm_region   shm(1 << 20);
+    cached_alloc alloc(shm.addr, shm.size, true);
+
+    BOOST_CHECK_EQUAL(0u, alloc.used_memory());
+
+    void* p1 = alloc.allocate(10);
+    void* p2 = alloc.allocate(100);
+    BOOST_REQUIRE(p1);
+    BOOST_REQUIRE(p2);
+    BOOST_CHECK_EQUAL(32u,  cached_alloc::size_of(p1));
+    BOOST_CHECK_EQUAL(128u, cached_alloc::size_of(p2));
+    BOOST_CHECK_EQUAL(160u, alloc.used_memory());
+    BOOST_CHECK_EQUAL(1,    alloc.magazines_in_use());
+
+    // Released blocks are cached in the thread's magazine
+    alloc.release(p1);
+    alloc.release(p2);
+    BOOST_CHECK_EQUAL(1, alloc.cached_size(5));
+    BOOST_CHECK_EQUAL(1, alloc.cached_size(7));
+    BOOST_CHECK_EQUAL(0, alloc.freelist_size(5));
+
+    BOOST_CHECK_EQUAL(p1, alloc.allocate(12));
+    BOOST_CHECK_EQUAL(0,  alloc.cached_size(5));
+
+    // Overflowing the magazine moves a batch to the shared free list
+    const int n = 2*cached_alloc::batch_size;
+    std::vector<void*> v;
+    for (int i=0; i < n; ++i)
+        v.push_back(alloc.allocate(12));
+    for (int i=0; i < n; ++i)
+        alloc.release(v[i]);
+    BOOST_CHECK_EQUAL(cached_alloc::batch_size, alloc.freelist_size(5));
+    BOOST_CHECK_EQUAL(cached_alloc::batch_size, alloc.cached_size(5));
+
+    // Detaching returns all cached blocks to the shared free lists
+    alloc.detach_thread();
+    BOOST_CHECK_EQUAL(0,   alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(n,   alloc.freelist_size(5));
+    BOOST_CHECK_EQUAL(1,   alloc.freelist_size(7));
+
+    // A batch is fetched from the shared free list with one CAS
+    size_t used = alloc.used_memory();
+    void*  p    = alloc.allocate(12);
+    BOOST_CHECK(p);
+    BOOST_CHECK_EQUAL(used, alloc.used_memory());
+    BOOST_CHECK_EQUAL(n-cached_alloc::batch_size,   alloc.freelist_size(5));
+    BOOST_CHECK_EQUAL(cached_alloc::batch_size - 1, alloc.cached_size(5));
+    alloc.release(p);
+    alloc.detach_thread();
+
+    BOOST_CHECK(!alloc.allocate(1ul << 32));
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_uncached )
+{
+    shm_region   shm(1 << 16);
+    shared_alloc alloc(shm.addr, shm.size, true);
+
+    void* p1 = alloc.allocate(10);
+    void* p2 = alloc.allocate(10);
+    alloc.release(p1);
+    alloc.release(p2);
+    BOOST_CHECK_EQUAL(0, alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(2, alloc.freelist_size(5));
+    BOOST_CHECK_EQUAL(p2, alloc.allocate(10));
+    BOOST_CHECK_EQUAL(p1, alloc.allocate(10));
+    BOOST_CHECK_EQUAL(0, alloc.freelist_size(5));
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_threads )
+{
+    const int    threads = 4;
+    const long   iters   = std::min(iterations(), 200000l);
+    shm_region   shm(64 << 20);
+    cached_alloc alloc(shm.addr, shm.size, true);
+    volatile long errors = 0;
+
+    auto worker = [&](int id) {
+        std::vector<std::pair<char*, size_t>> held;
+        unsigned seed = id;
+        for (long i=0; i < iters; ++i) {
+            if (held.size() < 128 && (held.empty() || rand_r(&seed) % 3)) {
+                size_t sz = 1 + rand_r(&seed) % 200;
+                char*  p  = static_cast<char*>(alloc.allocate(sz));
+                if (!p) { atomic::inc(&errors); break; }
+                memset(p, id, sz);
+                held.push_back(std::make_pair(p, sz));
+            } else {
+                size_t k  = rand_r(&seed) % held.size();
+                auto   e  = held[k];
+                for (size_t j=0; j < e.second; ++j)
+                    if (e.first[j] != id) { atomic::inc(&errors); break; }
+                alloc.release(e.first);
+                held[k] = held.back();
+                held.pop_back();
+            }
+        }
+        for (auto& e : held)
+            alloc.release(e.first);
+        alloc.detach_thread();
+    };
+
+    std::vector<std::thread> thr;
+    for (int i=0; i < threads; ++i)
+        thr.emplace_back(worker, i+1);
+    for (auto& t : thr)
+        t.join();
+
+    BOOST_CHECK_EQUAL(0, errors);
+    BOOST_CHECK_EQUAL(0, alloc.magazines_in_use());
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_dead_thread )
+{
+    shm_region  shm(1 << 20);
+    small_alloc alloc(shm.addr, shm.size, true);
+
+    // Two threads exit without detaching, each leaving 10 blocks cached
+    for (int k=0; k < 2; ++k)
+        std::thread([&] {
+            void* p[10];
+            for (int i=0; i < 10; ++i)
+                p[i] = alloc.allocate(40);
+            for (int i=0; i < 10; ++i)
+                alloc.release(p[i]);
+        }).join();
+
+    BOOST_CHECK_EQUAL(2,  alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(20, alloc.cached_size(6));
+    BOOST_CHECK_EQUAL(0,  alloc.freelist_size(6));
+
+    // A new thread takes over one of the magazines after draining it
+    std::thread([&] {
+        alloc.release(alloc.allocate(40));
+        BOOST_CHECK_EQUAL(2,  alloc.magazines_in_use());
+        BOOST_CHECK_EQUAL(20, alloc.cached_size(6));
+        BOOST_CHECK_EQUAL(0,  alloc.freelist_size(6));
+        alloc.detach_thread();
+    }).join();
+
+    BOOST_CHECK_EQUAL(1,  alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(10, alloc.cached_size(6));
+    BOOST_CHECK_EQUAL(10, alloc.freelist_size(6));
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_reclaim )
+{
+    shm_region   shm(1 << 20);
+    cached_alloc alloc(shm.addr, shm.size, true);
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        // Leave 10 blocks allocated and 5 cached in the magazine
+        void* p[15];
+        for (int i=0; i < 15; ++i)
+            p[i] = alloc.allocate(40);
+        for (int i=10; i < 15; ++i)
+            alloc.release(p[i]);
+        ::_exit(0);
+    }
+
+    BOOST_REQUIRE(pid > 0);
+    int status;
+    BOOST_REQUIRE_EQUAL(pid, ::waitpid(pid, &status, 0));
+
+    BOOST_CHECK_EQUAL(1,  alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(5,  alloc.cached_size(6));
+    BOOST_CHECK_EQUAL(0,  alloc.freelist_size(6));
+
+    // A pid equal to the child's one in the lower 16 bits owns nothing
+    alloc.reclaim_resources(pid + 0x10000);
+    BOOST_CHECK_EQUAL(5,  alloc.cached_size(6));
+    BOOST_CHECK_EQUAL(0,  alloc.freelist_size(6));
+
+    alloc.reclaim_resources(pid);
+
+    BOOST_CHECK_EQUAL(0,  alloc.magazines_in_use());
+    BOOST_CHECK_EQUAL(15, alloc.freelist_size(6));
+
+    // Reclaiming twice is harmless
+    alloc.reclaim_resources(pid);
+    BOOST_CHECK_EQUAL(15, alloc.freelist_size(6));
+}
+
+BOOST_AUTO_TEST_CASE( test_pow2_allocator_reclaim_takeover )
+{
+    shm_region  shm(1 << 20);
+    small_alloc alloc(shm.addr, shm.size, true);
+
+    for (int k=0; k < 20; ++k) {
+        // Both magazines are left with cached blocks by threads of a
+        // process that exits without detaching them
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            for (int t=0; t < 2; ++t)
+                std::thread([&] {
+                    void* p[10];
+                    for (int i=0; i < 10; ++i)
+                        p[i] = alloc.allocate(40);
+                    for (int i=0; i < 10; ++i)
+                        alloc.release(p[i]);
+                }).join();
+            ::_exit(0);
+        }
+
+        BOOST_REQUIRE(pid > 0);
+        int status;
+        BOOST_REQUIRE_EQUAL(pid, ::waitpid(pid, &status, 0));
+        BOOST_REQUIRE_EQUAL(2, alloc.magazines_in_use());
+
+        int free_blocks = alloc.cached_size(6) + alloc.freelist_size(6);
+
+        // Reclaiming the dead process races with a thread taking over
+        // one of its magazines.  Each cached block must be returned once
+        volatile bool go = false;
+        std::thread reclaimer([&] {
+            while (!go);
+            alloc.reclaim_resources(pid);
+        });
+        std::thread taker([&] {
+            while (!go);
+            alloc.release(alloc.allocate(40));
+            alloc.detach_thread();
+        });
+        go = true;
+        reclaimer.join();
+        taker.join();
+
+        BOOST_REQUIRE_EQUAL(0,           alloc.magazines_in_use());
+        BOOST_REQUIRE_EQUAL(free_blocks, alloc.freelist_size(6));
+    }
+}
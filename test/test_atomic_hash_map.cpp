@@ -24,6 +24,7 @@
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <random>
 
 using std::vector;
 using std::string;
@@ -593,3 +594,111 @@ BOOST_AUTO_TEST_CASE( test_atomic_hash_map_atomic_hash_array_insert_race) {
             BOOST_CHECK_EQUAL(arr->size(), uintptr_t(statuses[j]));
     }
 }
+
+BOOST_AUTO_TEST_CASE( test_atomic_hash_map_batch) {
+    const int numEntries = 1000;
+    // Small size hint to spill into secondary sub maps
+    AHMapT m(int(numEntries * 0.46), config);
+
+    vector<RecordT> recs;
+    for (int i = 0; i < numEntries; i++)
+        recs.push_back(RecordT(i, genVal(i)));
+
+    vector<std::pair<AHMapT::iterator,bool>> ins(numEntries);
+    vector<uint32_t>                         probes(numEntries);
+    m.insert_batch(&recs[0], numEntries, &ins[0], &probes[0]);
+    BOOST_CHECK(m.num_submaps() > 1);
+    BOOST_CHECK_EQUAL(size_t(numEntries), m.size());
+    for (int i = 0; i < numEntries; i++) {
+        BOOST_REQUIRE(ins[i].second);
+        BOOST_REQUIRE_EQUAL(i, ins[i].first->first);
+        BOOST_REQUIRE(probes[i] >= 1);
+    }
+
+    // Inserting again fails and returns the existing entries
+    for (auto& r : recs) r.second = -1;
+    m.insert_batch(&recs[0], numEntries, &ins[0]);
+    for (int i = 0; i < numEntries; i++) {
+        BOOST_REQUIRE(!ins[i].second);
+        BOOST_REQUIRE_EQUAL(genVal(i), ins[i].first->second);
+    }
+
+    // Look up existing and missing keys
+    vector<KeyT> keys;
+    for (int i = 0; i < 2 * numEntries; i += 3)
+        keys.push_back(i);
+    vector<AHMapT::iterator> found(keys.size());
+    m.find_batch(&keys[0], keys.size(), &found[0], &probes[0]);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < keys.size(); i++) {
+        BOOST_REQUIRE(found[i] == m.find(keys[i]));
+        if (keys[i] < numEntries)
+            BOOST_REQUIRE_EQUAL(genVal(keys[i]), found[i]->second);
+        BOOST_REQUIRE(probes[i] >= 1);
+        sum += probes[i];
+    }
+    BOOST_TEST_MESSAGE("Average probes per key: " << double(sum) / keys.size());
+
+    const AHMapT& cm = m;
+    vector<AHMapT::const_iterator> cfound(keys.size());
+    cm.find_batch(&keys[0], keys.size(), &cfound[0]);
+    for (size_t i = 0; i < keys.size(); i++)
+        BOOST_REQUIRE(cfound[i] == cm.find(keys[i]));
+}
+
+BOOST_AUTO_TEST_CASE( test_atomic_hash_map_batch_perf) {
+    using Map = atomic_hash_map<int64_t, int64_t, std::hash<int64_t>,
+                                std::equal_to<int64_t>, std::allocator<char>>;
+    const int numEntries = get_opt<int>("batch-entries", 4000000);
+    const int numLookups = get_opt<int>("batch-lookups", 4000000);
+
+    // Random order ids so that lookups miss the cache
+    std::mt19937_64 rnd(1);
+    vector<int64_t> ids(numEntries);
+    for (auto& id : ids) id = rnd() >> 2;
+
+    Map::config cfg;
+    Map m(numEntries, cfg);
+    vector<Map::value_type> recs;
+    recs.reserve(numEntries);
+    for (auto id : ids) recs.push_back(Map::value_type(id, id));
+
+    int64_t start = nowInUsec();
+    for (auto& r : recs) m.insert(r);
+    double ins1 = nowInUsec() - start;
+
+    Map m2(numEntries, cfg);
+    start = nowInUsec();
+    m2.insert_batch(&recs[0], recs.size());
+    double ins2 = nowInUsec() - start;
+
+    vector<int64_t> keys(numLookups);
+    for (auto& k : keys) k = ids[rnd() % numEntries];
+
+    int64_t sum1 = 0, sum2 = 0;
+    start = nowInUsec();
+    for (auto k : keys) sum1 += m.find(k)->second;
+    double find1 = nowInUsec() - start;
+
+    vector<Map::iterator> out(numLookups);
+    vector<uint32_t>      probes(numLookups);
+    start = nowInUsec();
+    m.find_batch(&keys[0], numLookups, &out[0], &probes[0]);
+    for (auto& it : out) sum2 += it->second;
+    double find2 = nowInUsec() - start;
+    BOOST_CHECK_EQUAL(sum1, sum2);
+
+    uint64_t total = 0;
+    uint32_t worst = 0;
+    for (auto p : probes) { total += p; worst = std::max(worst, p); }
+
+    BOOST_TEST_MESSAGE(utxx::to_string(
+        "atomic_hash_map ", numEntries, " entries: insert ",
+        utxx::fixed(1000 * ins1 / numEntries, 1), " ns/key, insert_batch ",
+        utxx::fixed(1000 * ins2 / numEntries, 1), " ns/key (x",
+        utxx::fixed(ins1 / ins2, 2), "); find ",
+        utxx::fixed(1000 * find1 / numLookups, 1), " ns/key, find_batch ",
+        utxx::fixed(1000 * find2 / numLookups, 1), " ns/key (x",
+        utxx::fixed(find1 / find2, 2), "); probes avg ",
+        utxx::fixed(double(total) / numLookups, 2), " max ", worst));
+}
@@ -33,6 +33,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <utxx/base64.hpp>
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <random>
 
 using namespace utxx;
 
@@ -89,3 +90,106 @@ BOOST_AUTO_TEST_CASE( test_base64 )
     }
 }
 
+
+// Bit-by-bit reference encoder
+static std::string ref_encode(const std::string& a_src, bool a_url, bool a_pad) {
+    const char* tab = a_url
+        ? "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+        : "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string res;
+    size_t nbits = a_src.size() * 8;
+    for (size_t bit = 0; bit < nbits; bit += 6) {
+        int v = 0;
+        for (size_t i = bit; i < bit + 6; ++i)
+            v = v << 1 | (i < nbits ? (uint8_t(a_src[i / 8]) >> (7 - i % 8)) & 1 : 0);
+        res += tab[v];
+    }
+    while (a_pad && (res.size() & 3))
+        res += '=';
+    return res;
+}
+
+BOOST_AUTO_TEST_CASE( test_base64_span )
+{
+    std::mt19937 rng(1);
+    char enc[512], dec[512];
+
+    for (auto e : {base64::STANDARD, base64::URL})
+        for (size_t len = 0; len < 300; ++len) {
+            std::string src(len, '\0');
+            for (auto& c : src) c = char(rng());
+
+            for (bool pad : {true, false}) {
+                auto ref = ref_encode(src, e == base64::URL, pad);
+                auto n   = base64::encode_to(enc, src.data(), len, e, pad);
+                BOOST_REQUIRE_EQUAL(base64::encoded_size(len, pad), n);
+                BOOST_REQUIRE_EQUAL(ref, std::string(enc, n));
+
+                auto m = base64::decode_to(dec, enc, n, e);
+                BOOST_REQUIRE_EQUAL(long(len), m);
+                BOOST_REQUIRE(src == std::string(dec, m));
+                BOOST_REQUIRE(base64::decoded_size(n) >= size_t(m));
+            }
+
+            // Line breaks every 76 characters and at random positions
+            auto s = base64::encode(src, e);
+            std::string wrapped;
+            for (size_t i = 0; i < s.size(); ++i) {
+                if ((i && i % 76 == 0) || rng() % 50 == 0)
+                    wrapped += "\r\n";
+                wrapped += s[i];
+            }
+            if (wrapped != s)
+                BOOST_REQUIRE_EQUAL(-1, base64::decode_to(dec, wrapped.data(), wrapped.size(),
+                                                          e, base64::STRICT));
+            auto m = base64::decode_to(dec, wrapped.data(), wrapped.size(),
+                                       e, base64::RELAXED);
+            BOOST_REQUIRE_EQUAL(long(len), m);
+            BOOST_REQUIRE(src == std::string(dec, m));
+        }
+
+    // Every byte value at every position of vectorized blocks
+    for (auto e : {base64::STANDARD, base64::URL}) {
+        std::string alphabet = ref_encode(std::string("\x00\x10\x83\x10\x51\x87\x20\x92"
+            "\x8b\x30\xd3\x8f\x41\x14\x93\x51\x55\x97\x61\x96\x9b\x71\xd7\x9f"
+            "\x82\x18\xa3\x92\x59\xa7\xa2\x9a\xab\xb2\xdb\xaf\xc3\x1c\xb3\xd3"
+            "\x5d\xb7\xe3\x9e\xbb\xf3\xdf\xbf", 48), e == base64::URL, false);
+        BOOST_REQUIRE_EQUAL(64u, alphabet.size());
+        for (int c = 0; c < 256; ++c) {
+            bool valid = alphabet.find(char(c)) != std::string::npos;
+            for (size_t i = 0; i < alphabet.size(); ++i) {
+                auto s = alphabet;
+                s[i]   = char(c);
+                auto n = base64::decode_to(dec, s.data(), s.size(), e, base64::STRICT);
+                BOOST_REQUIRE_EQUAL(valid ? 48 : -1, n);
+            }
+        }
+    }
+
+    auto strict = [&dec](const std::string& s, base64::encoding e = base64::STANDARD) {
+        return base64::decode_to(dec, s.data(), s.size(), e, base64::STRICT);
+    };
+    auto relaxed = [&dec](const std::string& s) {
+        auto n = base64::decode_to(dec, s.data(), s.size(),
+                                   base64::STANDARD, base64::RELAXED);
+        return std::string(dec, std::max(0l, n));
+    };
+
+    BOOST_CHECK_EQUAL( 3, strict("QmFz"));
+    BOOST_CHECK_EQUAL( 1, strict("Qg=="));
+    BOOST_CHECK_EQUAL( 1, strict("Qg"));
+    BOOST_CHECK_EQUAL(-1, strict("Qg="));                   // Bad padding
+    BOOST_CHECK_EQUAL(-1, strict("Q==="));
+    BOOST_CHECK_EQUAL(-1, strict("QmFzQ"));                 // Partial character
+    BOOST_CHECK_EQUAL(-1, strict("Qh=="));                  // Non-zero unused bits
+    BOOST_CHECK_EQUAL( 3, strict("QmE/"));
+    BOOST_CHECK_EQUAL(-1, strict("QmE_"));                  // Not in STANDARD
+    BOOST_CHECK_EQUAL( 3, strict("QmE_", base64::URL));
+    BOOST_CHECK_EQUAL(-1, strict("QmE/", base64::URL));     // Not in URL
+    BOOST_CHECK_EQUAL(-1, strict("QmFz\xc3\xa9QmFzQmFzQmFzQmFzQmFzQmFzQmFzQmFz"));
+    BOOST_CHECK_EQUAL(-1, strict("QmFzQmFzQmFzQmFzQmFzQmFzQmFzQmFzQmFzQmFz QmFz"));
+
+    BOOST_CHECK_EQUAL("Bas",   relaxed(" Qm\nFz "));
+    BOOST_CHECK_EQUAL("Ba",    relaxed("QmE=QmFz"));        // Stops at padding
+    BOOST_CHECK_EQUAL("BasBa", relaxed("QmFz\xc3QmE"));
+}
@@ -192,3 +192,197 @@ BOOST_AUTO_TEST_CASE( test_clustered_map ) {
 }
 
 
+
+#ifndef UTXX_STANDALONE
+
+#include <utxx/container/flat_clustered_map.hpp>
+#include <map>
+
+template <class Map>
+static void check_against_std_map(Map& m, int seed) {
+    std::map<long, int> ref;
+    srand(seed);
+    for (int i = 0; i < 20000; i++) {
+        long k = (rand() % 4096) - 1024;
+        if (rand() % 3) {
+            m.insert(k) += i;
+            ref[k]      += i;
+        } else {
+            BOOST_REQUIRE_EQUAL(ref.erase(k) > 0, m.erase(k));
+        }
+    }
+    size_t n = 0;
+    for (auto& r : ref) {
+        int* p = m.at(r.first);
+        BOOST_REQUIRE(p);
+        BOOST_REQUIRE_EQUAL(r.second, *p);
+        n++;
+    }
+    size_t cnt = 0;
+    for (auto it = m.begin(), e = m.end(); it != e; ++it, ++cnt) {
+        auto r = ref.find(it.key());
+        BOOST_REQUIRE(r != ref.end());
+        BOOST_REQUIRE_EQUAL(r->second, it.data());
+    }
+    BOOST_REQUIRE_EQUAL(n, cnt);
+}
+
+BOOST_AUTO_TEST_CASE( test_flat_clustered_map )
+{
+    typedef utxx::flat_clustered_map<size_t, int> fmap;
+    fmap m;
+    static const int s_data[][2] = {
+        {1, 10}, {2, 20}, {3, 30},
+        {65,40}, {66,50}, {67,60},
+        {129,70}
+    };
+
+    // Insert out of order to exercise the sorted index
+    for (int i = sizeof(s_data)/sizeof(s_data[0]) - 1; i >= 0; i--)
+        m.insert(s_data[i][0], s_data[i][1]);
+
+    BOOST_REQUIRE_EQUAL(3u, m.group_count());
+    BOOST_REQUIRE_EQUAL(3u, m.item_count(1));
+    BOOST_REQUIRE_EQUAL(3u, m.item_count(65));
+    BOOST_REQUIRE_EQUAL(1u, m.item_count(129));
+    BOOST_REQUIRE_EQUAL(0u, m.item_count(1000));
+
+    for (size_t i = 0; i < sizeof(s_data)/sizeof(s_data[0]); i++) {
+        int* p = m.at(s_data[i][0]);
+        BOOST_REQUIRE(p);
+        BOOST_REQUIRE_EQUAL(s_data[i][1], *p);
+    }
+    BOOST_REQUIRE(!m.at(4));
+    BOOST_REQUIRE(!m.at(1000));
+    BOOST_REQUIRE(m.find(4) == m.end());
+    BOOST_REQUIRE_EQUAL(50, *m.find(66));
+
+    int n = 0;
+    for (fmap::iterator it = m.begin(), e = m.end(); it != e; ++it, ++n) {
+        BOOST_REQUIRE_EQUAL(s_data[n][0], (int)it.key());
+        BOOST_REQUIRE_EQUAL(s_data[n][1], it.data());
+    }
+    BOOST_REQUIRE_EQUAL(7, n);
+
+    int j = 0;
+    m.for_each(visitor, j);
+    BOOST_REQUIRE_EQUAL(333, j);
+
+    // Data pointers are stable when clusters are added
+    int* p66 = m.at(66);
+    for (size_t k = 1000; k < 100000; k += 64)
+        m.insert(k, 1);
+    BOOST_REQUIRE_EQUAL(p66, m.at(66));
+    for (size_t k = 1000; k < 100000; k += 64)
+        BOOST_REQUIRE(m.erase(k));
+
+    BOOST_REQUIRE(m.erase(2));
+    BOOST_REQUIRE(!m.erase(2));
+    BOOST_REQUIRE_EQUAL(2u, m.item_count(1));
+    BOOST_REQUIRE(m.erase(3));
+    BOOST_REQUIRE_EQUAL(3u, m.group_count());
+    BOOST_REQUIRE(m.erase(129));
+    BOOST_REQUIRE_EQUAL(2u, m.group_count());
+    BOOST_REQUIRE_EQUAL(0u, m.item_count(129));
+    BOOST_REQUIRE(m.erase(m.find(1)));
+    BOOST_REQUIRE_EQUAL(65u, m.begin().key());
+
+    m.clear();
+    BOOST_REQUIRE(m.empty());
+    BOOST_REQUIRE(m.begin() == m.end());
+
+    // Descending order and signed keys
+    utxx::flat_clustered_map<long, int, 6, utxx::desending> d;
+    static const long s_keys[] = { -200, -1, 0, 5, 63, 64, 300 };
+    for (auto k : s_keys)
+        d[k] = int(k);
+    n = sizeof(s_keys)/sizeof(s_keys[0]);
+    for (auto it = d.begin(), e = d.end(); it != e; ++it) {
+        BOOST_REQUIRE(n > 0);
+        BOOST_REQUIRE_EQUAL(s_keys[--n], it.key());
+        BOOST_REQUIRE_EQUAL(s_keys[n],   *it);
+    }
+    BOOST_REQUIRE_EQUAL(0, n);
+
+    utxx::flat_clustered_map<long, int>             fa;
+    utxx::flat_clustered_map<long, int, 3>          fb;
+    utxx::flat_clustered_map<long, int, 6, utxx::desending> fc;
+    check_against_std_map(fa, 1);
+    check_against_std_map(fb, 2);
+    check_against_std_map(fc, 3);
+}
+
+namespace {
+    // Order-book-like workload: price levels (in ticks) random walk around
+    // the mid price, levels are updated, removed when their quantity drops
+    // to zero, and the best level is queried after each update.
+    std::vector<long> book_prices(long a_count, double a_sigma) {
+        std::vector<long> v(a_count);
+        long mid = 100000;
+        std::default_random_engine gen(1);
+        std::normal_distribution<double> dist(0, a_sigma);
+        for (long i = 0; i < a_count; i++) {
+            if ((i & 255) == 0)
+                mid += (gen() & 1) ? 1 : -1;
+            v[i] = mid + long(dist(gen));
+        }
+        return v;
+    }
+
+    template <class Map>
+    double book_updates(Map& a_book, const std::vector<long>& a_prices, long& a_checksum) {
+        boost::timer t;
+        long i = 0;
+        for (auto px : a_prices) {
+            int& qty = a_book[px];
+            qty += (i++ & 3) ? 1 : -2;
+            if (qty <= 0)
+                a_book.erase(px);
+            auto it = a_book.begin();
+            if (it != a_book.end())
+                a_checksum += it.key();
+        }
+        return t.elapsed();
+    }
+
+    struct std_book : public std::map<long, int> {
+        struct iter : public std::map<long, int>::iterator {
+            iter(std::map<long, int>::iterator it) : std::map<long, int>::iterator(it) {}
+            long key() const { return (*this)->first; }
+        };
+        iter begin() { return iter(std::map<long, int>::begin()); }
+        iter end()   { return iter(std::map<long, int>::end());   }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( test_flat_clustered_map_perf )
+{
+    const long ITERATIONS = getenv("ITERATIONS") ? atoi(getenv("ITERATIONS")) : 1000000;
+
+    for (double sigma : {20.0, 1000.0}) {
+        auto prices = book_prices(ITERATIONS, sigma);
+
+        utxx::clustered_map<long, int>      m1;
+        utxx::flat_clustered_map<long, int> m2;
+        std_book                            m3;
+        long c1 = 0, c2 = 0, c3 = 0;
+
+        double e1 = book_updates(m1, prices, c1);
+        double e2 = book_updates(m2, prices, c2);
+        double e3 = book_updates(m3, prices, c3);
+
+        BOOST_REQUIRE_EQUAL(c1, c3);
+        BOOST_REQUIRE_EQUAL(c2, c3);
+
+        char buf[160];
+        sprintf(buf, "Price ladder (sigma=%4.0f ticks, %3lu clusters): clustered_map=%.3fus, "
+                     "flat_clustered_map=%.3fus, std::map=%.3fus per update",
+                sigma, m2.group_count(),
+                e1 * 1000000 / ITERATIONS, e2 * 1000000 / ITERATIONS,
+                e3 * 1000000 / ITERATIONS);
+        BOOST_TEST_MESSAGE(buf);
+        BOOST_TEST_MESSAGE("Time(flat_clustered_map / clustered_map) = " << e2 / e1);
+    }
+}
+
+#endif
@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------
+/// \file  test_concurrent_priority_queue.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for concurrent priority queue
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <boost/test/unit_test.hpp>
+#include <utxx/container/concurrent_priority_queue.hpp>
+#include <thread>
+#include <vector>
+
+using namespace utxx;
+using namespace utxx::container;
+
+BOOST_AUTO_TEST_CASE( test_concurrent_priority_queue_mpmc_fifo )
+{
+    bound_mpmc_queue<int, 4> q;
+    int v;
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.dequeue(v));
+    for (int i=0; i < 4; ++i)
+        BOOST_CHECK(q.enqueue(i));
+    BOOST_CHECK(!q.enqueue(4));
+    BOOST_CHECK_EQUAL(4u, q.size());
+    for (int i=0; i < 4; ++i) {
+        BOOST_REQUIRE(q.dequeue(v));
+        BOOST_CHECK_EQUAL(i, v);
+    }
+    BOOST_CHECK(q.empty());
+    // Wrap around the ring
+    for (int i=0; i < 10; ++i) {
+        BOOST_CHECK(q.enqueue(i));
+        BOOST_CHECK(q.dequeue(v));
+        BOOST_CHECK_EQUAL(i, v);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent_priority_queue_order )
+{
+    concurrent_priority_queue<int, 3, bound_mpmc_queue<int, 4>> q;
+    int v, pri;
+
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK(!q.get(v));
+
+    BOOST_CHECK(q.put(2, 20));
+    BOOST_CHECK(q.put(1, 10));
+    BOOST_CHECK(q.put(2, 21));
+    BOOST_CHECK(q.put(0, 1));
+    BOOST_CHECK(q.put(1, 11));
+    BOOST_CHECK_EQUAL(7u, q.levels().value());
+
+    for (auto exp : {1, 10, 11, 20, 21}) {
+        BOOST_REQUIRE(q.get(v, &pri));
+        BOOST_CHECK_EQUAL(exp, v);
+        BOOST_CHECK_EQUAL(exp / 10, pri);
+    }
+    BOOST_CHECK(q.empty());
+    BOOST_CHECK_EQUAL(0u, q.levels().value());
+
+    // A full level doesn't affect other levels
+    for (int i=0; i < 4; ++i)
+        BOOST_CHECK(q.put(1, i));
+    BOOST_CHECK(!q.put(1, 4));
+    BOOST_CHECK(q.put(0, 100));
+    BOOST_REQUIRE(q.get(v));
+    BOOST_CHECK_EQUAL(100, v);
+
+    timespec ts = {0, 1000000};
+    for (int i=0; i < 4; ++i)
+        BOOST_CHECK_EQUAL(0, q.dequeue(v, &ts));
+    BOOST_CHECK_EQUAL(-1, q.dequeue(v, &ts));
+    q.terminate();
+    BOOST_CHECK_EQUAL(-2, q.dequeue(v));
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent_priority_queue_pluggable )
+{
+    concurrent_priority_queue<unsigned long, 2, bound_lock_free_queue<unsigned long, 8>> q;
+    unsigned long v;
+    BOOST_CHECK(q.put(1, 5));
+    BOOST_CHECK(q.put(0, 7));
+    BOOST_REQUIRE(q.get(v));
+    BOOST_CHECK_EQUAL(7u, v);
+    BOOST_REQUIRE(q.get(v));
+    BOOST_CHECK_EQUAL(5u, v);
+    BOOST_CHECK(!q.get(v));
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent_priority_queue_concurrent )
+{
+    static const int s_producers = 4, s_consumers = 4, s_iters = 100000;
+    static const int s_levels    = 8;
+
+    concurrent_priority_queue<long, s_levels> q;
+    std::atomic<long> sum(0), count(0);
+    std::vector<std::thread> threads;
+
+    for (int c=0; c < s_consumers; ++c)
+        threads.emplace_back([&]() {
+            long v;
+            while (q.dequeue(v) == 0) {
+                sum   += v;
+                count += 1;
+            }
+        });
+
+    std::vector<std::thread> producers;
+    for (int p=0; p < s_producers; ++p)
+        producers.emplace_back([&q, p]() {
+            for (long i=1; i <= s_iters; ++i)
+                while (!q.put((i + p) % s_levels, i))
+                    std::this_thread::yield();
+        });
+
+    for (auto& t : producers)
+        t.join();
+    // Let consumers drain the queue
+    while (!q.empty())
+        std::this_thread::yield();
+    q.terminate();
+    for (auto& t : threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(long(s_producers) * s_iters, count.load());
+    BOOST_CHECK_EQUAL(long(s_producers) * s_iters * (s_iters + 1) / 2, sum.load());
+}
@@ -0,0 +1,168 @@
+//----------------------------------------------------------------------------
+/// \file  test_config_snapshot.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for the flat config snapshot.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/config_snapshot.hpp>
+#include <utxx/time_val.hpp>
+#include <utxx/verbosity.hpp>
+#include <thread>
+
+using namespace utxx;
+
+namespace {
+    variant_tree make_tree(long a_qty) {
+        variant_tree pt;
+        pt.put("strategy.name",        variant("arb"));
+        pt.put("strategy.max-qty",     variant(a_qty));
+        pt.put("strategy.px-offset",   variant(0.25));
+        pt.put("strategy.enabled",     variant(true));
+        pt.put("strategy.venue.id",    variant(7));
+        pt.put("strategy.venue.host",  variant("10.0.0.1"));
+        return pt;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_config_snapshot )
+{
+    config_publisher pub;
+    auto qty  = pub.key("strategy.max-qty");
+    auto miss = pub.key("strategy.missing");
+
+    BOOST_CHECK(!pub.snapshot());
+    BOOST_CHECK_EQUAL(0u, pub.generation());
+
+    auto s = pub.publish(make_tree(100));
+    BOOST_CHECK_EQUAL(1u, s->generation());
+    BOOST_CHECK_EQUAL(6u, s->size());
+
+    // Keys interned before and after publishing
+    auto name = pub.key("strategy.name");
+    BOOST_CHECK_EQUAL(100,        s->get<long>(qty));
+    BOOST_CHECK_EQUAL(100,        s->get<int>(qty));
+    BOOST_CHECK_EQUAL(100.0,      s->get<double>(qty));
+    BOOST_CHECK_EQUAL("arb",      s->get<std::string>(name));
+    BOOST_CHECK_EQUAL("arb",      std::string(s->get<const char*>(name)));
+    BOOST_CHECK_EQUAL(0.25,       s->get<double>(s->find("strategy.px-offset")));
+    BOOST_CHECK_EQUAL(true,       s->get<bool>(s->find("strategy.enabled")));
+    BOOST_CHECK_EQUAL(7,          s->get<int>(s->find("strategy.venue.id")));
+    BOOST_CHECK_EQUAL("10.0.0.1", s->get<std::string>(s->find("strategy.venue.host")));
+    BOOST_CHECK_EQUAL("strategy.max-qty", s->path(qty));
+    BOOST_CHECK(s->to_variant(qty) == variant(100));
+
+    // Missing values and type mismatches
+    BOOST_CHECK(!s->has(miss));
+    BOOST_CHECK(!s->has(pub.key("strategy.later")));
+    BOOST_CHECK(!s->has(config_key()));
+    BOOST_CHECK(!s->find("strategy.missing").valid());
+    BOOST_CHECK(!s->find("strategy").valid());
+    BOOST_CHECK_EQUAL(5,          s->get<int>(miss, 5));
+    BOOST_CHECK_THROW(s->get<long>(miss),        variant_tree_error);
+    BOOST_CHECK_THROW(s->get<long>(name),        variant_tree_error);
+    BOOST_CHECK_THROW(s->get<bool>(qty),         variant_tree_error);
+
+    // Reload: keys remain valid, old snapshot is unchanged
+    auto tree = make_tree(200);
+    tree.put("strategy.missing", variant(3));
+    auto s2 = pub.publish(tree);
+    BOOST_CHECK_EQUAL(2u,   s2->generation());
+    BOOST_CHECK_EQUAL(2u,   pub.generation());
+    BOOST_CHECK_EQUAL(200,  s2->get<long>(qty));
+    BOOST_CHECK_EQUAL(3,    s2->get<long>(miss));
+    BOOST_CHECK_EQUAL(100,  s->get<long>(qty));
+    BOOST_CHECK(!s->has(miss));
+}
+
+BOOST_AUTO_TEST_CASE( test_config_snapshot_reader )
+{
+    config_publisher pub;
+    auto qty = pub.key("strategy.max-qty");
+    config_reader cfg(pub);
+
+    BOOST_CHECK_THROW(cfg.get(), std::runtime_error);
+
+    pub.publish(make_tree(1));
+    BOOST_CHECK_EQUAL(1, cfg->get<long>(qty));
+    BOOST_CHECK(!cfg.refresh());
+
+    // Readers observe monotonically increasing values while reloading
+    std::atomic<bool> done(false);
+    long errors = 0;
+    std::thread reader([&] {
+        config_reader r(pub);
+        long last = 0;
+        while (!done) {
+            long v = r->get<long>(qty);
+            if (v < last) ++errors;
+            last = v;
+        }
+    });
+    for (long i=2; i <= 1000; ++i)
+        pub.publish(make_tree(i));
+    done = true;
+    reader.join();
+
+    BOOST_CHECK_EQUAL(0, errors);
+    BOOST_CHECK_EQUAL(1000, cfg->get<long>(qty));
+}
+
+BOOST_AUTO_TEST_CASE( test_config_snapshot_perf )
+{
+    const long iters = getenv("ITERATIONS") ? atol(getenv("ITERATIONS")) : 1000000;
+    auto tree = make_tree(100);
+    for (int i=0; i < 50; ++i)
+        tree.put("strategy.param" + std::to_string(i), variant(i));
+
+    config_publisher pub;
+    auto qty = pub.key("strategy.venue.id");
+    pub.publish(tree);
+    config_reader cfg(pub);
+
+    long sum1 = 0, sum2 = 0;
+    auto t1 = now_utc();
+    for (long i=0; i < iters; ++i)
+        sum1 += tree.get<long>("strategy.venue.id");
+    auto t2 = now_utc();
+    for (long i=0; i < iters; ++i)
+        sum2 += cfg->get<long>(qty);
+    auto t3 = now_utc();
+
+    BOOST_CHECK_EQUAL(sum1, sum2);
+    double tree_ns = (t2 - t1).nanoseconds() / double(iters);
+    double snap_ns = (t3 - t2).nanoseconds() / double(iters);
+    if (verbosity::level() > VERBOSE_NONE) {
+        char buf[128];
+        snprintf(buf, sizeof(buf),
+                 "variant_tree::get %.1f ns, config_snapshot::get %.1f ns (x%.0f)",
+                 tree_ns, snap_ns, tree_ns / snap_ns);
+        BOOST_TEST_MESSAGE(buf);
+    }
+}
@@ -34,6 +34,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <boost/test/unit_test.hpp>
 #include <utxx/decimal.hpp>
+#include <utxx/decimal_batch.hpp>
+#include <random>
+#include <string.h>
 
 using namespace utxx;
 
@@ -102,4 +105,121 @@ BOOST_AUTO_TEST_CASE( test_decimal )
                                   BOOST_CHECK_EQUAL("1.256789012345678",d.to_string());}
 }
 
+BOOST_AUTO_TEST_CASE( test_decimal_parse )
+{
+    auto parse = [](const char* s, decimal& d) {
+        auto e = d.parse(s, s + strlen(s));
+        return e ? std::string(e) : std::string("ERROR");
+    };
+
+    decimal d;
+    BOOST_CHECK_EQUAL("", parse("1.25", d));    BOOST_CHECK_EQUAL(decimal(-2, 125), d);
+    BOOST_CHECK_EQUAL("", parse("-0.001", d));  BOOST_CHECK_EQUAL(decimal(-3, -1), d);
+    BOOST_CHECK_EQUAL("", parse("+100", d));    BOOST_CHECK_EQUAL(decimal(2, 1), d);
+    BOOST_CHECK_EQUAL("", parse("-0.0", d));    BOOST_CHECK_EQUAL(decimal(0, 0), d);
+    BOOST_CHECK_EQUAL("", parse(".5", d));      BOOST_CHECK_EQUAL(decimal(-1, 5), d);
+    BOOST_CHECK_EQUAL("", parse("7.", d));      BOOST_CHECK_EQUAL(decimal(0, 7), d);
+    BOOST_CHECK_EQUAL("", parse("001.2300", d));BOOST_CHECK_EQUAL(decimal(-2, 123), d);
+    BOOST_CHECK_EQUAL(",1", parse("1.5,1", d)); BOOST_CHECK_EQUAL(decimal(-1, 15), d);
+    BOOST_CHECK_EQUAL("", parse("1.00000000000000000000000000", d));
+    BOOST_CHECK_EQUAL(decimal(0, 1), d);
+    BOOST_CHECK_EQUAL("", parse("-36028797018963968", d));
+    BOOST_CHECK_EQUAL(-36028797018963968l, d.mantissa());
+    BOOST_CHECK_EQUAL("-36028797018963968", d.to_string());
+    // Exact, unlike decimal(double, precision)
+    BOOST_CHECK_EQUAL("", parse("-1.34567", d));BOOST_CHECK_EQUAL(decimal(-5, -134567), d);
+    BOOST_CHECK_EQUAL("", parse("0.1234567890123456", d));
+    BOOST_CHECK_EQUAL(decimal(-16, 1234567890123456l), d);
+
+    BOOST_CHECK_EQUAL("ERROR", parse("", d));
+    BOOST_CHECK_EQUAL("ERROR", parse("-", d));
+    BOOST_CHECK_EQUAL("ERROR", parse(".", d));
+    BOOST_CHECK_EQUAL("ERROR", parse("abc", d));
+    BOOST_CHECK_EQUAL("ERROR", parse("36028797018963968", d));        // > 2^55-1
+    BOOST_CHECK_EQUAL("ERROR", parse("1.000000000000000001", d));     // 19 digits
+
+    // Formatting is exact and round-trips
+    BOOST_CHECK_EQUAL("0",      decimal(-1, 0).to_string());
+    BOOST_CHECK_EQUAL("0",      decimal(-3, 0).to_string());
+    BOOST_CHECK_EQUAL("0",      decimal(2, 0).to_string());
+    BOOST_CHECK_EQUAL("1.0",    decimal(-2, 100).to_string());
+    BOOST_CHECK_EQUAL("-0.05",  decimal(-2, -5).to_string());
+    BOOST_CHECK_EQUAL("-300",   decimal(2, -3).to_string());
+    BOOST_CHECK_EQUAL("nan",    decimal(nullptr).to_string());
+    BOOST_CHECK_EQUAL("0.36028797018963967", decimal(-17, 36028797018963967l).to_string());
+
+    std::mt19937_64 rng(1);
+    char buf[decimal::max_width()];
+    for (int i=0; i < 10000; ++i) {
+        decimal a(-int(rng() % 19), long(rng() % (1l << 55)) * (i & 1 ? 1 : -1));
+        auto    e = a.write(buf);
+        decimal b;
+        BOOST_REQUIRE(b.parse(buf, e) == e);
+        BOOST_REQUIRE_EQUAL(decimal(a).normalize(), b);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_decimal_batch )
+{
+    // Mix of values needing the scalar path (null, finer than the
+    // target exponent) with ones rescaled by the vector path
+    std::mt19937_64 rng(2);
+    const size_t n = 1003;
+    const int    e = -6;
+    std::vector<decimal> a(n), b(n), out(n);
+    std::vector<long>    qty(n);
+    for (size_t i=0; i < n; ++i) {
+        int ea = e + int(rng() % 4);
+        a[i]   = i % 97 == 0 ? decimal(nullptr)
+               : i % 89 == 0 ? decimal(-8, long(rng() % 100000000))
+               : decimal(ea, long(rng() % 10000000) - 5000000);
+        b[i]   = i % 5  == 0 ? decimal(a[i]).normalize(a[i].exp()-2)
+               : decimal(e + int(rng() % 4), long(rng() % 10000000) - 5000000);
+        qty[i] = long(rng() % 2000) - 1000;
+    }
+
+    auto ref = [e](decimal d) {
+        return d.is_null() ? 0 : long(std::trunc(d.mantissa() * decimal::pow10(d.exp() - e)));
+    };
+
+    decimal_batch::rescale(a.data(), n, e, out.data());
+    long s = 0, p = 0;
+    for (size_t i=0; i < n; ++i) {
+        BOOST_REQUIRE_EQUAL(e,         out[i].exp());
+        BOOST_REQUIRE_EQUAL(ref(a[i]), out[i].mantissa());
+        s += ref(a[i]);
+        p += ref(a[i]) * qty[i];
+    }
+
+    BOOST_CHECK_EQUAL(decimal(e, s), decimal_batch::sum(a.data(), n, e));
+    BOOST_CHECK_EQUAL(decimal(e, p), decimal_batch::dot(a.data(), qty.data(), n, e));
+
+    decimal_batch::multiply(a.data(), qty.data(), n, e, out.data());
+    for (size_t i=0; i < n; ++i)
+        BOOST_REQUIRE_EQUAL(decimal(e, ref(a[i]) * qty[i]), out[i]);
+
+    std::vector<int8_t> cmp(n);
+    decimal_batch::compare(a.data(), b.data(), n, cmp.data());
+    for (size_t i=0; i < n; ++i) {
+        // All exponents are >= e-2, so values are exact at this exponent
+        auto x = detail::decimal_rescale(a[i], e-2);
+        auto y = detail::decimal_rescale(b[i], e-2);
+        BOOST_REQUIRE_EQUAL(int(x < y ? -1 : x > y), int(cmp[i]));
+    }
+
+    // Equal values with different exponents and values beyond double precision
+    decimal l[] = { decimal(0, 5), decimal(-3, 5000), decimal(-16, 10000000000000001l),
+                    decimal(nullptr), decimal(2, 1), decimal(-2, -1) };
+    decimal r[] = { decimal(-1, 50), decimal(0, 5),   decimal(0, 1),
+                    decimal(-5, 0),  decimal(0, 99),  decimal(-30, -1) };
+    int8_t  c[6];
+    decimal_batch::compare(l, r, 6, c);
+    BOOST_CHECK_EQUAL( 0, int(c[0]));
+    BOOST_CHECK_EQUAL( 0, int(c[1]));
+    BOOST_CHECK_EQUAL( 1, int(c[2]));
+    BOOST_CHECK_EQUAL( 0, int(c[3]));
+    BOOST_CHECK_EQUAL( 1, int(c[4]));
+    BOOST_CHECK_EQUAL(-1, int(c[5]));
+}
+
 #endif
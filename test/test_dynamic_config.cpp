@@ -33,6 +33,8 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/test/unit_test.hpp>
 #include <utxx/dynamic_config.hpp>
 #include <utxx/path.hpp>
+#include <atomic>
+#include <thread>
 
 using namespace utxx;
 
@@ -88,4 +90,74 @@ BOOST_AUTO_TEST_CASE( test_dynamic_config )
     }
 
     path::file_unlink(s_file);
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE( test_dynamic_config_versioned )
+{
+    static const char* s_file = "/tmp/dynconfig2.bin";
+
+    path::file_unlink(s_file);
+
+    dynamic_config<64> dc(s_file);
+
+    dc.bind<long>("param1");
+    dc.bind<double>("param2");
+    dc.bind<dparam_str_t>("param3");
+
+    int i1 = dc.find("param1");
+    int i2 = dc.find("param2");
+    int i3 = dc.find("param3");
+
+    BOOST_CHECK_EQUAL(0,  i1);
+    BOOST_CHECK_EQUAL(1,  i2);
+    BOOST_CHECK_EQUAL(2,  i3);
+    BOOST_CHECK_EQUAL(-1, dc.find("param4"));
+
+    BOOST_CHECK_EQUAL(0u, dc.generation());
+    BOOST_CHECK_EQUAL(0u, dc.version(i1));
+
+    dc.set(i1, 10l);
+    dc.set(i2, 1.5);
+    dc.set(i3, "abc");
+
+    BOOST_CHECK_EQUAL(10,    dc.get<long>(i1));
+    BOOST_CHECK_EQUAL(1.5,   dc.get<double>(i2));
+    BOOST_CHECK_EQUAL("abc", dc.get<dparam_str_t>(i3).data());
+    BOOST_CHECK_EQUAL(3u,    dc.generation());
+    BOOST_CHECK_EQUAL(1u,    dc.version(i1));
+    BOOST_CHECK_EQUAL(1u,    dc.version(i3));
+
+    BOOST_CHECK_THROW(dc.set(i1, 1.0),      badarg_error);
+    BOOST_CHECK_THROW(dc.get<long>(10),     badarg_error);
+
+    // Another mapping of the same file sees the changes
+    dynamic_config<64> dc2(s_file);
+    BOOST_CHECK_EQUAL(10, dc2.get<long>(dc2.find("param1")));
+    BOOST_CHECK_EQUAL(3u, dc2.generation());
+
+    // No change: time out
+    auto gen = dc2.generation();
+    BOOST_CHECK(wakeup_result::TIMEDOUT == dc2.wait(dc2.watch_mask(i1), gen, 10));
+    // Generation changed before the wait
+    BOOST_CHECK(wakeup_result::CHANGED  == dc2.wait(dc2.watch_mask(i1), gen-1, 10));
+
+    // A waiter watching param1 is woken up by its change only
+    wakeup_result     res = wakeup_result::ERROR;
+    std::atomic<bool> woken(false);
+    std::thread th([&]() {
+        res = dc2.wait(dc2.watch_mask(i1), gen, 5000);
+        woken = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    dc.set(i2, 2.5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK(!woken);    // Still waiting after a change of param2
+    dc.set(i1, 20l);
+    th.join();
+
+    BOOST_CHECK(wakeup_result::SIGNALED == res);
+    BOOST_CHECK_EQUAL(20, dc2.get<long>(i1));
+    BOOST_CHECK_EQUAL(2u, dc2.version(i1));
+    BOOST_CHECK_EQUAL(5u, dc2.generation());
+
+    path::file_unlink(s_file);
+}
@@ -65,4 +65,24 @@ BOOST_AUTO_TEST_CASE( test_fast_itoa )
     BOOST_CHECK_EQUAL(16, p - buf);
 }
 
+BOOST_AUTO_TEST_CASE( test_fast_itoa_fixed )
+{
+    char buf[16] = "xxxxxxxxxxxxxxx";
+    auto p = sse::u32toa_fixed(42, buf, 3);
+    BOOST_CHECK_EQUAL("042xxxxxxxxxxxx", buf);
+    BOOST_CHECK_EQUAL(3, p - buf);
+
+    p = sse::u32toa_fixed(0, buf, 6);
+    BOOST_CHECK_EQUAL("000000xxxxxxxxx", buf);
+    BOOST_CHECK_EQUAL(6, p - buf);
+
+    p = sse::u32toa_fixed(12345678, buf, 8);
+    BOOST_CHECK_EQUAL("12345678xxxxxxx", buf);
 
+    p = sse::u32toa_fixed(987654321, buf, 9);
+    BOOST_CHECK_EQUAL("987654321xxxxxx", buf);
+    BOOST_CHECK_EQUAL(9, p - buf);
+
+    p = sse::u32toa_fixed(1, buf, 9);
+    BOOST_CHECK_EQUAL("000000001xxxxxx", buf);
+}
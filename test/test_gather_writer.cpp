@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------
+/// \file  test_gather_writer.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for the gather_writer.hpp file.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/gather_writer.hpp>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace utxx;
+
+namespace {
+    struct deleter {
+        int& cnt;
+        deleter(int& n) : cnt(n) {}
+        void operator()() { cnt++; }
+    };
+
+    std::string read_all(int a_fd) {
+        std::string s;
+        char buf[4096];
+        for (ssize_t n; (n = ::read(a_fd, buf, sizeof(buf))) > 0; )
+            s.append(buf, n);
+        return s;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_gather_writer_build )
+{
+    basic_gather_writer<4, 16> w;
+    std::string payload("PAYLOAD");
+
+    BOOST_CHECK(w.empty());
+    BOOST_CHECK(w.append("ab", 2));
+    BOOST_CHECK(w.append("cd", 2));     // Coalesced with the previous piece
+    BOOST_CHECK_EQUAL(1u, w.iovcnt());
+    BOOST_CHECK(w.append(boost::asio::buffer(payload)));
+    char* p = w.alloc(3);
+    BOOST_REQUIRE(p);
+    memcpy(p, "efg", 3);
+    BOOST_CHECK_EQUAL(3u, w.iovcnt());
+    BOOST_CHECK_EQUAL(14u, w.pending());
+    BOOST_CHECK_EQUAL(9u, w.arena_capacity());
+
+    BOOST_CHECK(!w.append("0123456789", 10));   // Arena is full
+    BOOST_CHECK(w.append(boost::asio::buffer(payload)));
+    BOOST_CHECK(!w.append(boost::asio::buffer(payload))); // No iovecs left
+    BOOST_CHECK(w.append(boost::asio::const_buffer()));   // Nothing to add
+    BOOST_CHECK(w.append(shared_const_buffer()));
+    BOOST_CHECK_EQUAL(4u, w.iovcnt());
+
+    std::string s;
+    for (size_t i=0; i < w.iovcnt(); ++i)
+        s.append((const char*)w.iov()[i].iov_base, w.iov()[i].iov_len);
+    BOOST_CHECK_EQUAL("abcdPAYLOADefgPAYLOAD", s);
+
+    // Partial consumption resumes in the middle of an entry
+    w.consume(6);
+    BOOST_CHECK_EQUAL(3u, w.iovcnt());
+    BOOST_CHECK_EQUAL("YLOAD", std::string((const char*)w.iov()->iov_base,
+                                           w.iov()->iov_len));
+    // Written entries are reused
+    BOOST_CHECK(w.append(boost::asio::buffer(payload)));
+    BOOST_CHECK_EQUAL(4u, w.iovcnt());
+    BOOST_CHECK_EQUAL(22u, w.pending());
+
+    w.clear();
+    BOOST_CHECK(w.empty());
+    BOOST_CHECK_EQUAL(0u, w.iovcnt());
+    BOOST_CHECK_EQUAL(16u, w.arena_capacity());
+}
+
+BOOST_AUTO_TEST_CASE( test_gather_writer_shared )
+{
+    static const char s_data[] = "0123456789";
+    int cnt = 0;
+    {
+        gather_writer w1, w2;
+        {
+            shared_const_buffer buf(boost::asio::buffer(s_data, 10), deleter(cnt));
+            w1.append(buf.slice(2, 3));
+            w2.append(buf);
+            w2.append(buf.slice(9, 1));
+        }
+        BOOST_CHECK_EQUAL(0, cnt);
+        w1.consume(1);
+        BOOST_CHECK_EQUAL(0, cnt);
+        w1.consume(2);
+        w2.consume(10);
+        BOOST_CHECK_EQUAL(0, cnt);
+        w2.consume(1);
+        BOOST_CHECK_EQUAL(1, cnt);      // Released once written by all
+    }
+    BOOST_CHECK_EQUAL(1, cnt);
+}
+
+BOOST_AUTO_TEST_CASE( test_gather_writer_flush )
+{
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    int sz = 4096;
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sz, sizeof(sz));
+    ::setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &sz, sizeof(sz));
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+    std::string snap(256*1024, 'x');
+    for (size_t i=0; i < snap.size(); ++i)
+        snap[i] = char('a' + i % 26);
+
+    int cnt = 0;
+    std::string expect, got;
+    {
+        gather_writer w;
+        shared_const_buffer buf(boost::asio::buffer(snap), deleter(cnt));
+        for (int i=0; i < 4; ++i) {
+            char hdr[16];
+            int  n = snprintf(hdr, sizeof(hdr), "HDR%d|", i);
+            BOOST_REQUIRE(w.append(hdr, n));
+            BOOST_REQUIRE(w.append(buf.slice(i * 1000, 64*1024)));
+            expect.append(hdr, n).append(snap, i * 1000, 64*1024);
+        }
+
+        int  partial = 0;
+        while (!w.empty()) {
+            auto n = (partial & 1) ? w.flush(fds[0]) : w.send(fds[0]);
+            BOOST_REQUIRE(n >= 0);
+            if (!w.empty())
+                ++partial;
+            got += read_all(fds[1]);
+        }
+        BOOST_CHECK(partial > 0);
+        BOOST_CHECK_EQUAL(0, w.flush(fds[0]));
+    }
+    BOOST_CHECK_EQUAL(1, cnt);
+    got += read_all(fds[1]);
+    BOOST_CHECK_EQUAL(expect.size(), got.size());
+    BOOST_CHECK(expect == got);
+
+    // Errors are reported through errno
+    gather_writer w;
+    w.append("abc", 3);
+    ::close(fds[1]);
+    BOOST_CHECK_EQUAL(-1, w.send(fds[0]));
+    BOOST_CHECK_EQUAL(EPIPE, errno);
+    BOOST_CHECK_EQUAL(3u, w.pending());
+    ::close(fds[0]);
+}
@@ -38,6 +38,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <utxx/string.hpp>
 #include <iostream>
 #include <fstream>
+#include <string.h>
 
 using namespace utxx;
 
@@ -109,4 +110,68 @@ BOOST_AUTO_TEST_CASE( test_gzstream_gzip )
     }
 }
 
+BOOST_AUTO_TEST_CASE( test_gzstream_parallel )
+{
+    auto dd = temp_path("xxxx-par.gz");
+    UTXX_SCOPE_EXIT([&]() { path::file_unlink(dd); });
+
+    // Inflate a whole file checking that it is a single gzip member
+    // with valid CRC and size
+    auto gunzip = [&dd](size_t a_size) {
+        auto data = path::read_file(dd);
+        std::string res(a_size + 1, '\0');
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        BOOST_REQUIRE_EQUAL(Z_OK, inflateInit2(&zs, 16 + MAX_WBITS));
+        zs.next_in   = (Bytef*)&data[0];
+        zs.avail_in  = data.size();
+        zs.next_out  = (Bytef*)&res[0];
+        zs.avail_out = res.size();
+        BOOST_CHECK_EQUAL(Z_STREAM_END, inflate(&zs, Z_FINISH));
+        BOOST_CHECK_EQUAL(0u, zs.avail_in);
+        res.resize(zs.total_out);
+        inflateEnd(&zs);
+        return res;
+    };
+
+    // Empty stream
+    {
+        ogzstream out(dd, std::ios::out, gzopts(6, 2));
+        BOOST_REQUIRE(out.good());
+        BOOST_CHECK(!out.rdbuf()->native_handle());
+        out.close();
+        BOOST_REQUIRE(out.good());
+        BOOST_CHECK_EQUAL("", gunzip(0));
+    }
+
+    std::string text;
+    for (int i=0; text.size() < 3*1024*1024; ++i)
+        text += utxx::to_string("line ", i, " value=", i * 7919 % 100003, '\n');
+
+    for (unsigned threads : {1, 3}) {
+        {
+            ogzstream out(dd, std::ios::out, gzopts(6, threads, 64*1024));
+            BOOST_REQUIRE(out.good());
+            // Mix of character and bulk output crossing block boundaries
+            size_t i = 0;
+            for (; i < 100000; ++i)
+                out << text[i];
+            out.flush();
+            out.write(text.data() + i, text.size() - i);
+            out.close();
+            BOOST_REQUIRE(out.good());
+        }
+        BOOST_CHECK(utxx::path::file_size(dd) < long(text.size() / 2));
+        BOOST_CHECK(gunzip(text.size()) == text);
+
+        // Read back with a large decompression buffer
+        igzstream in(dd, std::ios::in, gzopts(0, 0, 0, 1024*1024));
+        BOOST_REQUIRE(in.good());
+        std::string s, res;
+        while (std::getline(in, s))
+            (res += s) += '\n';
+        BOOST_CHECK(res == text);
+    }
+}
+
 #endif // UTXX_HAVE_LIBZ
@@ -31,11 +31,14 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/test/unit_test.hpp>
 #include <boost/format.hpp>
 #include <utxx/hashmap.hpp>
+#include <utxx/name.hpp>
 #include <utxx/time_val.hpp>
 #include <utxx/verbosity.hpp>
 #if defined(__GNUC__) && __cplusplus >= 201103L
 #include <bits/functional_hash.h>
 #endif
+#include <unordered_map>
+#include <random>
 
 using namespace utxx;
 
@@ -147,3 +150,347 @@ BOOST_AUTO_TEST_CASE( test_hashmap )
 
     BOOST_TEST_MESSAGE((boost::format("Ratio: %.3f") % (elapsed4 / elapsed2)).str());
 }
+
+BOOST_AUTO_TEST_CASE( test_flat_hash_map )
+{
+    typedef detail::flat_hash_map<long, int> map_t;
+    map_t m;
+
+    BOOST_CHECK(m.empty());
+    BOOST_CHECK(m.begin() == m.end());
+    BOOST_CHECK(m.find(1) == m.end());
+    BOOST_CHECK_EQUAL(0u, m.erase(1));
+
+    m[1] = 10;
+    m[2] = 20;
+    BOOST_CHECK(m.try_emplace(3, 30).second);
+    BOOST_CHECK(!m.try_emplace(3, 31).second);
+    BOOST_CHECK_EQUAL(3u, m.size());
+    BOOST_CHECK_EQUAL(30, m.at(3));
+    BOOST_CHECK_THROW(m.at(4), std::out_of_range);
+
+    int sum = 0;
+    for (auto& v : m) sum += v.second;
+    BOOST_CHECK_EQUAL(60, sum);
+
+    BOOST_CHECK_EQUAL(1u, m.erase(2));
+    BOOST_CHECK(m.find(2) == m.end());
+    m.erase(m.find(1));
+    BOOST_CHECK_EQUAL(1u, m.size());
+
+    map_t m2(m);
+    map_t m3(std::move(m));
+    BOOST_CHECK_EQUAL(30, m2[3]);
+    BOOST_CHECK_EQUAL(30, m3[3]);
+
+    m3.reserve(1000);
+    BOOST_CHECK(m3.capacity() >= 1000);
+    BOOST_CHECK_EQUAL(30, m3[3]);
+    m3.clear();
+    BOOST_CHECK(m3.empty());
+    BOOST_CHECK(m3.begin() == m3.end());
+
+    // Heterogeneous lookup of string keys
+    typedef detail::flat_hash_map<
+        std::string, int,
+        detail::hash_fun<std::string>, detail::equal_fun<std::string> > str_map;
+    str_map s;
+    s["IBM"]     = 1;
+    s["MSFT.O"]  = 2;
+    s["EUR/USD"] = 3;
+
+    const char* k = "MSFT.O";
+    BOOST_CHECK_EQUAL(2, s.find(k)->second);
+    BOOST_CHECK_EQUAL(1u, s.count("EUR/USD"));
+    BOOST_CHECK_EQUAL(1, s.find(name_t("IBM"))->second);
+    BOOST_CHECK(s.find(name_t("IBMX")) == s.end());
+    BOOST_CHECK_EQUAL(1u, s.erase("IBM"));
+    BOOST_CHECK_EQUAL(2u, s.size());
+}
+
+BOOST_AUTO_TEST_CASE( test_flat_hash_map_random )
+{
+    // Small key range forces long clusters and many backward shifts
+    detail::flat_hash_map<int, int>      m;
+    std::unordered_map<int, int>         ref;
+    std::default_random_engine           gen(1);
+
+    for (int i=0; i < 200000; ++i) {
+        int k = gen() % 5000;
+        switch (gen() % 3) {
+            case 0:
+            case 1:
+                m[k] = i; ref[k] = i;
+                break;
+            default:
+                BOOST_REQUIRE_EQUAL(ref.erase(k), m.erase(k));
+        }
+        if ((i & 1023) == 0) {
+            BOOST_REQUIRE_EQUAL(ref.size(), m.size());
+            for (auto& v : ref) {
+                auto it = m.find(v.first);
+                BOOST_REQUIRE(it != m.end());
+                BOOST_REQUIRE_EQUAL(v.second, it->second);
+            }
+        }
+    }
+
+    size_t n = 0;
+    for (auto& v : m) {
+        BOOST_REQUIRE_EQUAL(ref[v.first], v.second);
+        ++n;
+    }
+    BOOST_REQUIRE_EQUAL(ref.size(), n);
+
+    size_t odd = 0;
+    for (auto& v : ref) odd += v.first & 1;
+    BOOST_CHECK_EQUAL(odd, m.erase_if([](const std::pair<const int, int>& v) {
+        return v.first & 1;
+    }));
+    for (auto& v : ref)
+        BOOST_REQUIRE_EQUAL(!(v.first & 1), m.count(v.first) == 1);
+}
+
+namespace {
+    template <class Map, class Keys, class Lookup>
+    double hash_map_run(Map& a_map, const Keys& a_keys, const Lookup& a_lookup,
+                        int a_rounds, long& a_sum)
+    {
+        timer t;
+        for (size_t i=0; i < a_keys.size(); ++i)
+            a_map[a_keys[i]] = i;
+        for (int r=0; r < a_rounds; ++r)
+            for (auto& k : a_lookup) {
+                auto it = a_map.find(k);
+                if (it != a_map.end()) a_sum += it->second;
+            }
+        for (size_t i=0; i < a_keys.size(); i += 2)
+            a_map.erase(a_keys[i]);
+        return t.elapsed();
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_flat_hash_map_perf )
+{
+    const int ITERATIONS = getenv("ITERATIONS") ? atoi(getenv("ITERATIONS")) : 10;
+    const int COUNT      = 100000;
+    std::default_random_engine gen(1);
+
+    // Order id table
+    {
+        std::vector<long> ids(COUNT), lookup(COUNT);
+        for (auto& id : ids)    id = (long(gen()) << 20) + gen() % 1000000;
+        for (auto& id : lookup) id = ids[gen() % COUNT];
+
+        detail::basic_hash_map<long, long> m1;
+        detail::flat_hash_map <long, long> m2;
+        long s1 = 0, s2 = 0;
+        double e1 = hash_map_run(m1, ids, lookup, ITERATIONS, s1);
+        double e2 = hash_map_run(m2, ids, lookup, ITERATIONS, s2);
+        BOOST_REQUIRE_EQUAL(s1, s2);
+        BOOST_REQUIRE_EQUAL(m1.size(), m2.size());
+
+        BOOST_TEST_MESSAGE(
+            (boost::format("Order ids: basic_hash_map %.3f us/op, flat_hash_map %.3f us/op "
+                           "(x%.2f)")
+             % (1e6 * e1 / (COUNT * (ITERATIONS + 2)))
+             % (1e6 * e2 / (COUNT * (ITERATIONS + 2))) % (e1 / e2)).str());
+    }
+
+    // Symbol table with std::string keys looked up by C string
+    {
+        std::vector<std::string> syms(COUNT);
+        std::vector<const char*> lookup(COUNT);
+        for (auto& s : syms)   s = srandom(12) + std::to_string(gen() % 1000);
+        for (auto& s : lookup) s = syms[gen() % COUNT].c_str();
+
+        typedef detail::hash_fun<std::string>  hash;
+        typedef detail::equal_fun<std::string> eq;
+        detail::basic_hash_map<std::string, long, hash>     m1;
+        detail::flat_hash_map <std::string, long, hash, eq> m2, m3;
+        detail::flat_hash_map <std::string, long, detail::fast_str_hash, eq> m4;
+        std::vector<std::string> lookup_str(lookup.begin(), lookup.end());
+        long s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+        double e1 = hash_map_run(m1, syms, lookup_str, ITERATIONS, s1);
+        double e2 = hash_map_run(m2, syms, lookup_str, ITERATIONS, s2);
+        double e3 = hash_map_run(m3, syms, lookup,     ITERATIONS, s3);
+        double e4 = hash_map_run(m4, syms, lookup,     ITERATIONS, s4);
+        BOOST_REQUIRE_EQUAL(s1, s2);
+        BOOST_REQUIRE_EQUAL(s1, s3);
+        BOOST_REQUIRE_EQUAL(s1, s4);
+        BOOST_REQUIRE_EQUAL(m1.size(), m2.size());
+
+        const double ops = COUNT * (ITERATIONS + 2) / 1e6;
+        BOOST_TEST_MESSAGE(
+            (boost::format("Symbols:   basic_hash_map %.3f us/op, flat_hash_map %.3f us/op "
+                           "(x%.2f), by const char* %.3f us/op, with fast_str_hash %.3f us/op")
+             % (e1 / ops) % (e2 / ops) % (e1 / e2) % (e3 / ops) % (e4 / ops)).str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_fast_hashes )
+{
+    // Standard CRC-32C check value
+    BOOST_CHECK_EQUAL(0xE3069283u, detail::crc32c_hash("123456789", 9));
+    BOOST_CHECK_EQUAL(0u,          detail::crc32c_hash("", 0));
+
+    const char* s = "The quick brown fox jumps over the lazy dog, twice over";
+    for (size_t n = 0; n < strlen(s); ++n) {
+        std::string str(s, n);
+        BOOST_REQUIRE_EQUAL(detail::wy_hash(s, n), detail::wy_hash(str.c_str(), n));
+        BOOST_REQUIRE_NE   (detail::wy_hash(s, n), detail::wy_hash(s, n, 1));
+        if (n)
+            BOOST_REQUIRE_NE(detail::wy_hash(s, n), detail::wy_hash(s, n-1));
+    }
+
+    // Transparent string hashing
+    detail::fast_str_hash h;
+    BOOST_CHECK_EQUAL(h(std::string("IBM")), h("IBM"));
+    BOOST_CHECK_EQUAL(h(std::string("IBM")), h(name_t("IBM")));
+
+    // Integer mixer for names
+    name_t n1("IBM"), n2("IBN");
+    BOOST_CHECK_EQUAL(detail::hash_int64(n1.to_int()), detail::hash_fun<name_t>()(n1));
+    BOOST_CHECK_NE(detail::hash_fun<name_t>()(n1), detail::hash_fun<name_t>()(n2));
+
+    // Batch hashing matches hashing one key at a time
+    std::vector<std::string> keys;
+    for (int i=0; i < 37; ++i) keys.push_back("SYM" + std::to_string(i));
+    std::vector<size_t> out(keys.size());
+    detail::hash_batch(h, &keys[0], keys.size(), &out[0]);
+    for (size_t i=0; i < keys.size(); ++i)
+        BOOST_REQUIRE_EQUAL(h(keys[i]), out[i]);
+
+    // Batch lookup
+    detail::flat_hash_map<std::string, int, detail::fast_str_hash,
+                          detail::equal_fun<std::string>> m;
+    for (size_t i=0; i < keys.size(); i += 2)
+        m[keys[i]] = i;
+    std::vector<const char*> q;
+    for (auto& k : keys) q.push_back(k.c_str());
+    std::vector<decltype(m)::iterator> res(q.size());
+    m.find_batch(&q[0], q.size(), &res[0]);
+    for (size_t i=0; i < q.size(); ++i)
+        if (i & 1) BOOST_REQUIRE(res[i] == m.end());
+        else       BOOST_REQUIRE_EQUAL(int(i), res[i]->second);
+}
+
+BOOST_AUTO_TEST_CASE( test_jump_consistent_hash )
+{
+    std::default_random_engine gen(1);
+    const int  N = 10, KEYS = 100000;
+    std::vector<int> count(N+1);
+
+    for (int i=0; i < KEYS; ++i) {
+        uint64_t key = (uint64_t(gen()) << 32) | gen();
+        int b  = detail::jump_consistent_hash(key, N);
+        int b1 = detail::jump_consistent_hash(key, N+1);
+        BOOST_REQUIRE(b >= 0 && b < N);
+        // Growing the number of buckets only moves keys to the new bucket
+        BOOST_REQUIRE(b1 == b || b1 == N);
+        ++count[b];
+        count[N] += b1 == N;
+    }
+    for (int i=0; i < N; ++i)
+        BOOST_CHECK_CLOSE(double(KEYS) / N, count[i], 5.0);
+    BOOST_CHECK_CLOSE(double(KEYS) / (N+1), count[N], 5.0);
+
+    BOOST_CHECK_EQUAL(0, detail::jump_consistent_hash(12345, 1));
+}
+
+namespace {
+    /// Normalized chi-square (expected ~1.0) of hashes over 2^Bits buckets
+    /// using the low or the high bits
+    template <int Bits>
+    double chi_square(const std::vector<uint64_t>& a_hashes, bool a_high) {
+        std::vector<long> buckets(1 << Bits);
+        for (auto h : a_hashes)
+            ++buckets[a_high ? h >> (64 - Bits) : h & ((1 << Bits) - 1)];
+        double expected = double(a_hashes.size()) / buckets.size(), chi = 0;
+        for (auto n : buckets)
+            chi += (n - expected) * (n - expected) / expected;
+        return chi / (buckets.size() - 1);
+    }
+
+    template <class Keys, class Fun>
+    void hash_quality(const char* a_name, const Keys& a_keys, int a_rounds, Fun a_fun,
+                      bool a_check, bool a_has_high = true)
+    {
+        std::vector<uint64_t> hashes(a_keys.size());
+        timer t;
+        uint64_t sum = 0;
+        for (int r=0; r < a_rounds; ++r)
+            for (size_t i=0; i < a_keys.size(); ++i)
+                sum += a_fun(a_keys[i]);
+        double elapsed = t.elapsed();
+        for (size_t i=0; i < a_keys.size(); ++i)
+            hashes[i] = a_fun(a_keys[i]);
+
+        double lo = chi_square<12>(hashes, false);
+        double hi = a_has_high ? chi_square<12>(hashes, true) : 0;
+        BOOST_TEST_MESSAGE(
+            (boost::format("  %-16s %6.2f ns/key  chi2(low)=%6.3f chi2(high)=%6.3f%s")
+             % a_name % (1e9 * elapsed / (a_rounds * a_keys.size())) % lo % hi
+             % (sum ? "" : " ")).str());
+        if (a_check) {
+            BOOST_CHECK_LT(lo, 1.2);
+            if (a_has_high) BOOST_CHECK_LT(hi, 1.2);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_hash_perf )
+{
+    const int ITERATIONS = getenv("ITERATIONS") ? atoi(getenv("ITERATIONS")) : 10;
+    const int COUNT      = 1 << 18;
+
+    std::vector<std::string> syms(COUNT);
+    for (int i=0; i < COUNT; ++i)
+        syms[i] = srandom(4) + std::to_string(i);
+
+    BOOST_TEST_MESSAGE("Symbols (2-10 chars):");
+    typedef const std::string& str;
+    hash_quality("hsieh_hash",    syms, ITERATIONS, [](str s) -> uint64_t {
+        return detail::hsieh_hash(s.c_str(), s.size()); }, false, false);
+    hash_quality("murmur_hash64", syms, ITERATIONS, [](str s) -> uint64_t {
+        return detail::murmur_hash64(s.c_str(), s.size(), 0); }, false);
+    hash_quality("crapwow",       syms, ITERATIONS, [](str s) -> uint64_t {
+        return detail::crapwow(s.c_str(), s.size()); }, false, false);
+    hash_quality("std::hash",     syms, ITERATIONS, [](str s) -> uint64_t {
+        return std::hash<std::string>()(s); }, false);
+    hash_quality("crc32c_hash",   syms, ITERATIONS, [](str s) -> uint64_t {
+        return detail::crc32c_hash(s.c_str(), s.size()); }, true, false);
+    hash_quality("wy_hash",       syms, ITERATIONS, [](str s) -> uint64_t {
+        return detail::wy_hash(s.c_str(), s.size()); }, true);
+
+    // Sequential 8-byte keys (order ids, name_t values)
+    std::vector<uint64_t> ids(COUNT);
+    for (int i=0; i < COUNT; ++i)
+        ids[i] = 1000000 + i * 16;
+
+    BOOST_TEST_MESSAGE("Sequential 8-byte keys:");
+    hash_quality("std::hash",     ids, ITERATIONS, [](uint64_t k) -> uint64_t {
+        return std::hash<uint64_t>()(k); }, false);
+    hash_quality("murmur_hash64", ids, ITERATIONS, [](uint64_t k) -> uint64_t {
+        return detail::murmur_hash64(&k, 8, 0); }, false);
+    hash_quality("crc32c_hash",   ids, ITERATIONS, [](uint64_t k) -> uint64_t {
+        return detail::crc32c_hash(&k, 8); }, false, false);
+    hash_quality("hash_int64",    ids, ITERATIONS, [](uint64_t k) -> uint64_t {
+        return detail::hash_int64(k); }, true);
+
+    // Batch vs one key at a time
+    std::vector<size_t> out(COUNT);
+    auto fun = [](uint64_t k) { return detail::hash_int64(k); };
+    timer t;
+    for (int r=0; r < ITERATIONS; ++r)
+        detail::hash_batch(fun, &ids[0], COUNT, &out[0]);
+    double batch = t.elapsed();
+    t.reset();
+    for (int r=0; r < ITERATIONS; ++r)
+        for (int i=0; i < COUNT; ++i)
+            out[i] = fun(ids[i]);
+    double single = t.elapsed();
+    BOOST_TEST_MESSAGE(
+        (boost::format("hash_batch(hash_int64): %.2f ns/key, single: %.2f ns/key")
+         % (1e9 * batch / (ITERATIONS * COUNT)) % (1e9 * single / (ITERATIONS * COUNT))).str());
+}
@@ -33,6 +33,9 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 #include <boost/test/unit_test.hpp>
 #include <utxx/leb128.hpp>
+#include <utxx/buffer.hpp>
+#include <random>
+#include <vector>
 
 using namespace utxx;
 
@@ -361,3 +364,126 @@ BOOST_AUTO_TEST_CASE( test_leb128_encode_size_unsigned )
 
     BOOST_CHECK_EQUAL(10, encoded_uleb128_size(UINT64_MAX));
 }
+
+BOOST_AUTO_TEST_CASE( test_leb128_bulk )
+{
+    std::mt19937_64 rng(1);
+
+    // Values of 1..10 bytes mixed in runs of different lengths, so that
+    // all vectorized decoding patterns are exercised
+    for (int bits : {7, 14, 21, 35, 64, 0}) {
+        std::vector<uint64_t> src(5000);
+        for (auto& v : src) {
+            int b = bits ? bits : 1 + rng() % 64;
+            v = rng() >> (64 - (rng() % b + 1));
+        }
+
+        std::vector<char> buf(max_encoded_uleb128_size(src.size()));
+        auto len = encode_uleb128(src.data(), src.size(), buf.data());
+
+        // Compare with the single value codec
+        const char* q = buf.data();
+        for (auto v : src) {
+            char tmp[16];
+            int  n = encode_uleb128(v, tmp);
+            BOOST_REQUIRE(memcmp(tmp, q, n) == 0);
+            BOOST_REQUIRE_EQUAL(v, decode_uleb128(q));
+        }
+        BOOST_REQUIRE_EQUAL(len, size_t(q - buf.data()));
+
+        std::vector<uint64_t> dst(src.size() + 1);
+        const char* p = buf.data();
+        auto n = decode_uleb128(p, buf.data() + len, dst.data(), dst.size());
+        BOOST_REQUIRE_EQUAL(src.size(), n);
+        BOOST_REQUIRE_EQUAL(len, size_t(p - buf.data()));
+        BOOST_REQUIRE(std::equal(src.begin(), src.end(), dst.begin()));
+
+        // Decoding in small pieces does not write past the requested count
+        p = buf.data();
+        for (size_t i = 0, k; i < src.size(); i += k) {
+            dst[i + 1] = 12345;
+            k = decode_uleb128(p, buf.data() + len, &dst[i], 1);
+            BOOST_REQUIRE_EQUAL(1u, k);
+            BOOST_REQUIRE_EQUAL(src[i], dst[i]);
+            BOOST_REQUIRE_EQUAL(12345u, dst[i + 1]);
+        }
+    }
+
+    // Truncated input stops before the incomplete value
+    char buf[32];
+    uint64_t vals[] = {1, 300, 1ull << 40}, out[3];
+    auto len = encode_uleb128(vals, 3, buf);
+    const char* p = buf;
+    BOOST_CHECK_EQUAL(2u, decode_uleb128(p, buf + len - 1, out, 3));
+    BOOST_CHECK_EQUAL(3,  p - buf);
+    BOOST_CHECK_EQUAL(1u, decode_uleb128(p, buf + len, out + 2, 3));
+    BOOST_CHECK_EQUAL(1ull << 40, out[2]);
+
+    // Malformed value longer than 10 bytes
+    memset(buf, 0x80, sizeof(buf));
+    p = buf;
+    BOOST_CHECK_THROW(decode_uleb128(p, buf + sizeof(buf), out, 3), utxx::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_leb128_delta )
+{
+    BOOST_CHECK_EQUAL(0u, zigzag_encode(0));
+    BOOST_CHECK_EQUAL(1u, zigzag_encode(-1));
+    BOOST_CHECK_EQUAL(2u, zigzag_encode(1));
+    BOOST_CHECK_EQUAL(~0ull, zigzag_encode(INT64_MIN));
+    BOOST_CHECK_EQUAL(INT64_MIN, zigzag_decode(~0ull));
+    BOOST_CHECK_EQUAL(INT64_MAX, zigzag_decode(zigzag_encode(INT64_MAX)));
+
+    // Nanosecond time stamps with occasional out-of-order values
+    std::mt19937_64 rng(2);
+    std::vector<int64_t> src(10000);
+    int64_t ts = 1475000000000000000;
+    for (auto& v : src)
+        v = (ts += rng() % 5000) - (rng() % 100 == 0 ? 10000 : 0);
+
+    std::vector<char> buf(max_encoded_uleb128_size(src.size()));
+    int64_t base = 0;
+    auto len = encode_delta_uleb128(src.data(), src.size(), buf.data(), base);
+    BOOST_CHECK_EQUAL(src.back(), base);
+    BOOST_CHECK(len < src.size() * 3);
+
+    std::vector<int64_t> dst(src.size());
+    const char* p = buf.data();
+    base = 0;
+    BOOST_REQUIRE_EQUAL(src.size(),
+        decode_delta_uleb128(p, buf.data() + len, dst.data(), dst.size(), base));
+    BOOST_CHECK(src == dst);
+    BOOST_CHECK_EQUAL(src.back(), base);
+}
+
+BOOST_AUTO_TEST_CASE( test_leb128_stream )
+{
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> src(3000);
+    for (auto& v : src)
+        v = rng() >> (rng() % 64);
+
+    basic_io_buffer<64> wbuf;
+    uint64_t base = 0;
+    for (size_t i = 0; i < src.size(); i += 100)
+        write_delta_uleb128(wbuf, &src[i], 100, base);
+
+    // Feed the encoded data to the reader in chunks of random size
+    basic_io_buffer<64> rbuf;
+    std::vector<uint64_t> dst(src.size());
+    size_t n = 0;
+    base     = 0;
+    while (n < src.size()) {
+        auto k = std::min<size_t>(wbuf.size(), rng() % 50);
+        rbuf.write(wbuf.read(k), k);
+        n += read_delta_uleb128(rbuf, &dst[n], dst.size() - n, base);
+        rbuf.crunch();
+    }
+    BOOST_CHECK(src == dst);
+    BOOST_CHECK(rbuf.empty());
+    BOOST_CHECK(wbuf.empty());
+
+    write_uleb128(wbuf, src.data(), src.size());
+    BOOST_CHECK_EQUAL(src.size(), read_uleb128(wbuf, dst.data(), dst.size()));
+    BOOST_CHECK(src == dst);
+}
@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------
+/// \file  test_line_filter.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for regex line filter
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <boost/test/unit_test.hpp>
+#include <utxx/line_filter.hpp>
+#include <vector>
+
+using namespace utxx;
+
+BOOST_AUTO_TEST_CASE( test_line_filter_find_substr )
+{
+    std::string s(200, 'a');
+    s.replace(150, 3, "abc");
+    s.replace( 90, 3, "abd");
+
+    auto b = s.c_str(), e = b + s.size();
+
+    BOOST_CHECK_EQUAL(150, find_substr(b, e, "abc", 3) - b);
+    BOOST_CHECK_EQUAL( 90, find_substr(b, e, "abd", 3) - b);
+    BOOST_CHECK_EQUAL( 91, find_substr(b, e, "b",   1) - b);
+    BOOST_CHECK(e == find_substr(b, e, "abe", 3));
+    BOOST_CHECK(b == find_substr(b, e, "",    0));
+    BOOST_CHECK(b+2 == find_substr(b, b+2, "aaa", 3));
+    // Matches at the very end of the buffer and in the scalar tail
+    s.replace(197, 3, "xyz");
+    b = s.c_str(); e = b + s.size();
+    BOOST_CHECK_EQUAL(197, find_substr(b, e, "xyz", 3) - b);
+    BOOST_CHECK_EQUAL(198, find_substr(b, e, "yz",  2) - b);
+
+    // Every offset and needle length
+    for (size_t len = 2; len < 40; ++len)
+        for (size_t i = 0; i + len <= s.size(); i += 7) {
+            std::string t(s.size(), '.');
+            std::string needle(len, 'n');
+            needle[0] = 'x'; needle[len-1] = 'y';
+            t.replace(i, len, needle);
+            BOOST_CHECK_EQUAL(i, size_t(find_substr(t.c_str(), t.c_str()+t.size(),
+                                                    needle.c_str(), len) - t.c_str()));
+        }
+}
+
+BOOST_AUTO_TEST_CASE( test_line_filter_required_literal )
+{
+    BOOST_CHECK_EQUAL(" FILLED",  regex_required_literal("ORDER [0-9]+ FILLED"));
+    BOOST_CHECK_EQUAL("ORDER ",   regex_required_literal("ORDER (\\d+) DONE"));
+    BOOST_CHECK_EQUAL("abcd",     regex_required_literal("^abcd$"));
+    BOOST_CHECK_EQUAL("abc",      regex_required_literal("abc+"));
+    BOOST_CHECK_EQUAL("ab",       regex_required_literal("abc*"));
+    BOOST_CHECK_EQUAL("ab",       regex_required_literal("abc?"));
+    BOOST_CHECK_EQUAL("ab",       regex_required_literal("abc{0,2}"));
+    BOOST_CHECK_EQUAL("a.b",      regex_required_literal("x*a\\.b"));
+    BOOST_CHECK_EQUAL("key=",     regex_required_literal("(a|b)key=[^|]+"));
+    BOOST_CHECK_EQUAL("",         regex_required_literal("abc|def"));
+    BOOST_CHECK_EQUAL("",         regex_required_literal("\\d+\\s\\w"));
+    BOOST_CHECK_EQUAL("",         regex_required_literal(""));
+    // Operands of \xHH, \uHHHH, \cX and back references are not literals
+    BOOST_CHECK_EQUAL("BC",       regex_required_literal("\\x41BC"));
+    BOOST_CHECK_EQUAL("ghi",      regex_required_literal("\\u0041ghi"));
+    BOOST_CHECK_EQUAL("xy",       regex_required_literal("\\cJxy"));
+    BOOST_CHECK_EQUAL("b",        regex_required_literal("(a)\\12b"));
+
+    // The pre-filter doesn't reject lines matching escaped characters
+    const std::string text = "id=ABC\nid=41BC\nx\ny";
+    line_filter f("id=\\x41BC");
+    BOOST_CHECK_EQUAL("id=", f.literal());
+    std::vector<std::string> lines;
+    f.scan(text.c_str(), text.c_str() + text.size(),
+           [&](const char* a, const char* z, const std::cmatch&) { lines.emplace_back(a, z); });
+    BOOST_REQUIRE_EQUAL(1u, lines.size());
+    BOOST_CHECK_EQUAL("id=ABC", lines[0]);
+    line_filter g("\\cJ?y$");
+    BOOST_CHECK_EQUAL("y", g.literal());
+}
+
+BOOST_AUTO_TEST_CASE( test_line_filter_scan )
+{
+    const std::string text =
+        "a=1 ORDER 10 FILLED\n"
+        "b=2 ORDER 11 NEW\n"
+        "FILLED ORDER\n"
+        "c=3 ORDER 12 FILLED";
+
+    auto b = text.c_str(), e = b + text.size();
+
+    for (auto opts : {std::regex_constants::ECMAScript, std::regex_constants::grep}) {
+        line_filter f("ORDER ([0-9]+) FILLED", opts);
+        if (opts == std::regex_constants::grep)
+            f = line_filter("ORDER \\([0-9]*\\) FILLED", opts);
+
+        BOOST_CHECK_EQUAL(opts == std::regex_constants::grep ? "" : " FILLED",
+                          f.literal());
+
+        std::vector<std::string> lines, ids;
+        auto n = f.scan(b, e, [&](const char* a, const char* z, const std::cmatch& m) {
+            lines.emplace_back(a, z);
+            ids.emplace_back(m[1].first, m[1].second);
+        });
+        BOOST_REQUIRE_EQUAL(2u, n);
+        BOOST_CHECK_EQUAL("a=1 ORDER 10 FILLED", lines[0]);
+        BOOST_CHECK_EQUAL("c=3 ORDER 12 FILLED", lines[1]);
+        BOOST_CHECK_EQUAL("10", ids[0]);
+        BOOST_CHECK_EQUAL("12", ids[1]);
+
+        std::cmatch m;
+        BOOST_CHECK( f.match(b, b+19, m));
+        BOOST_CHECK(!f.match(b+20, b+36, m));
+    }
+
+    // Default filter matches all lines
+    line_filter all;
+    BOOST_CHECK(all.match_all());
+    BOOST_CHECK_EQUAL(4u, all.scan(b, e, [](const char*, const char*, const std::cmatch&){}));
+
+    // Literals with letters are not used for case insensitive patterns
+    line_filter ic("ORDER [0-9]+ FILLED", std::regex_constants::icase);
+    BOOST_CHECK_EQUAL("", ic.literal());
+    BOOST_CHECK_EQUAL(2u, ic.scan(b, e, [](const char*, const char*, const std::cmatch&){}));
+}
@@ -0,0 +1,160 @@
+//----------------------------------------------------------------------------
+/// \file  test_metrics.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for metrics registry
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <boost/test/unit_test.hpp>
+#include <utxx/metrics.hpp>
+#include <utxx/path.hpp>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+using namespace utxx;
+
+BOOST_AUTO_TEST_CASE( test_metrics_counter )
+{
+    metrics_registry reg;
+    auto& c = reg.counter("test.count");
+
+    BOOST_CHECK(&c == &reg.counter("test.count"));
+    BOOST_CHECK_EQUAL(1u, reg.size());
+    BOOST_CHECK_THROW(reg.gauge("test.count"), badarg_error);
+    BOOST_CHECK_THROW(reg.counter(std::string(metric_sample::MAX_NAME, 'x')),
+                      badarg_error);
+
+    c.inc();
+    c += 4;
+    ++c;
+    BOOST_CHECK_EQUAL(6, c.value());
+
+    // Counts of exited threads are retained
+    static const int s_threads = 4, s_iters = 100000;
+    std::vector<std::thread> threads;
+    for (int i=0; i < s_threads; ++i)
+        threads.emplace_back([&c]() { for (int j=0; j < s_iters; ++j) c.inc(); });
+    for (auto& t : threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(6 + s_threads * s_iters, c.value());
+}
+
+BOOST_AUTO_TEST_CASE( test_metrics_gauge )
+{
+    metrics_registry reg;
+    auto& g = reg.gauge("test.gauge");
+    g.set(10);
+    g.add(-3);
+    BOOST_CHECK_EQUAL(7, g.value());
+}
+
+BOOST_AUTO_TEST_CASE( test_metrics_histogram )
+{
+    for (int i=0; i < metric_histogram::BUCKETS; ++i)
+        BOOST_CHECK_EQUAL(i, metric_histogram::bucket(metric_histogram::bucket_value(i)));
+    for (uint64_t v : {0ul, 15ul, 16ul, 19ul, 20ul, 1000ul, 123456789ul, ~0ul >> 1}) {
+        int b = metric_histogram::bucket(v);
+        BOOST_CHECK(uint64_t(metric_histogram::bucket_value(b)) <= v);
+        BOOST_CHECK(b+1 == metric_histogram::BUCKETS ||
+                    uint64_t(metric_histogram::bucket_value(b+1)) > v);
+    }
+
+    metrics_registry reg;
+    auto& h = reg.histogram("test.latency");
+
+    std::thread t([&h]() { for (int i=1; i <= 5000; ++i) h.add(i); });
+    t.join();
+    for (int i=5001; i <= 10000; ++i)
+        h.add(i);
+
+    auto d = h.value();
+    BOOST_CHECK_EQUAL(10000, d.count);
+    BOOST_CHECK_EQUAL(50005000, d.sum);
+    BOOST_CHECK_EQUAL(1, d.min);
+    BOOST_CHECK_EQUAL(10000, d.max);
+
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        double exp = q * 10000;
+        BOOST_CHECK_CLOSE(exp, double(d.quantile(q)), 25.0);
+    }
+    BOOST_CHECK_EQUAL(10000, d.quantile(1.0));
+
+    {
+        metric_histogram::sample_scope s(h);
+    }
+    BOOST_CHECK_EQUAL(10001, h.value().count);
+}
+
+BOOST_AUTO_TEST_CASE( test_metrics_publish )
+{
+    const std::string file = path::temp_path("utxx_test_metrics.bin");
+    path::file_unlink(file);
+
+    metrics_registry reg;
+    reg.counter("orders.sent").inc(5);
+    reg.gauge("orders.open").set(3);
+    reg.histogram("orders.rtt").add(1000);
+
+    reg.start(file, time_val(0, 10000));
+    BOOST_CHECK(reg.running());
+
+    metrics_reader reader;
+    reader.open(file);
+
+    std::unique_ptr<metrics_snapshot> snap(new metrics_snapshot());
+    BOOST_REQUIRE(reader.read(*snap));
+    BOOST_CHECK_EQUAL(0u, snap->seq & 1);
+    BOOST_CHECK_EQUAL(uint32_t(getpid()), snap->pid);
+    BOOST_REQUIRE_EQUAL(3u, snap->count);
+    BOOST_CHECK_EQUAL("orders.sent", snap->items[0].name);
+    BOOST_CHECK_EQUAL(metric_sample::COUNTER, snap->items[0].type);
+    BOOST_CHECK_EQUAL(5, snap->items[0].value);
+    BOOST_CHECK_EQUAL(3, snap->items[1].value);
+    BOOST_CHECK_EQUAL(1, snap->items[2].value);
+    BOOST_CHECK_EQUAL(1000, snap->items[2].max);
+
+    // Updates are published by the collector thread
+    reg.counter("orders.sent").inc(5);
+    for (int i=0; i < 1000 && snap->items[0].value != 10; ++i) {
+        usleep(1000);
+        BOOST_REQUIRE(reader.read(*snap));
+    }
+    BOOST_CHECK_EQUAL(10, snap->items[0].value);
+
+    // Explicit publishing is serialized with the collector thread
+    for (int i=0; i < 1000; ++i)
+        reg.publish();
+    BOOST_REQUIRE(reader.read(*snap));
+    BOOST_CHECK_EQUAL(0u, snap->seq & 1);
+    BOOST_CHECK_EQUAL(10, snap->items[0].value);
+
+    reg.stop();
+    BOOST_CHECK(!reg.running());
+    path::file_unlink(file);
+}
@@ -0,0 +1,100 @@
+//----------------------------------------------------------------------------
+/// \file  test_mirrored_io_buffer.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for the mirrored_io_buffer.hpp file.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/mirrored_io_buffer.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace utxx;
+
+BOOST_AUTO_TEST_CASE( test_mirrored_io_buffer )
+{
+    mirrored_io_buffer b(100);
+    size_t sz = b.max_size();
+    BOOST_REQUIRE_EQUAL(0u, sz % ::sysconf(_SC_PAGESIZE));
+    BOOST_CHECK_EQUAL(sz, b.capacity());
+    BOOST_CHECK(b.empty());
+
+    // The second half of the address range aliases the first one
+    b.commit(sz - 2);
+    b.read(sz - 2);
+    b.write("abcd", 4);
+    BOOST_CHECK_EQUAL("abcd", std::string(b.rd_ptr(), 4));
+    BOOST_CHECK_EQUAL("cd",   std::string(b.address(), 2));
+    BOOST_CHECK_EQUAL(sz - 4, b.capacity());
+    BOOST_CHECK_EQUAL(b.rd_ptr() + sz, b.end());
+
+    BOOST_CHECK(!b.read(5));
+    BOOST_CHECK_EQUAL(b.address() + sz - 2, b.read(3));
+    BOOST_CHECK_EQUAL(b.address() + 1, b.rd_ptr());
+    BOOST_CHECK_EQUAL("d", std::string(b.rd_ptr(), b.size()));
+
+    // Growing keeps unread data
+    b.reserve(sz);
+    BOOST_CHECK_EQUAL(2*sz, b.max_size());
+    BOOST_CHECK_EQUAL("d", std::string(b.rd_ptr(), b.size()));
+
+    mirrored_io_buffer c(std::move(b));
+    BOOST_CHECK_EQUAL("d", std::string(c.rd_ptr(), c.size()));
+    BOOST_CHECK(!b.address());
+
+    // Parse a stream of length-prefixed messages written in chunks that
+    // don't align with message boundaries
+    std::mt19937 rng(1);
+    std::string  stream;
+    std::vector<std::string> msgs;
+    for (int i = 0; stream.size() < 20*sz; ++i) {
+        std::string m(1 + rng() % 200, char('a' + i % 26));
+        stream += char(m.size());
+        stream += m;
+        msgs.push_back(m);
+    }
+
+    basic_mirrored_io_buffer<> r(4096);
+    size_t pos = 0, n = 0;
+    while (n < msgs.size()) {
+        size_t k = std::min<size_t>(stream.size() - pos,
+                                    std::min<size_t>(r.capacity(), rng() % 1500));
+        memcpy(r.wr_ptr(), stream.data() + pos, k);
+        r.commit(k);
+        pos += k;
+        while (r.size() && r.size() > size_t(uint8_t(*r.rd_ptr()))) {
+            size_t len = uint8_t(*r.read(1));
+            BOOST_REQUIRE_EQUAL(msgs[n++], std::string(r.read(len), len));
+        }
+        r.crunch();
+    }
+    BOOST_CHECK(r.empty());
+    BOOST_CHECK_EQUAL(stream.size(), pos);
+}
@@ -0,0 +1,171 @@
+//----------------------------------------------------------------------------
+/// \file  test_perf_counters.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for hardware performance counters.
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+
+#include <boost/test/unit_test.hpp>
+#include <utxx/perf_counters.hpp>
+#include <utxx/verbosity.hpp>
+#include <sstream>
+#include <thread>
+#include <dirent.h>
+
+using namespace utxx;
+
+namespace {
+    static perf_scope_id s_loop ("test_loop");
+    static perf_scope_id s_inner("test_inner");
+
+    int open_fds() {
+        int  n = 0;
+        auto d = ::opendir("/proc/self/fd");
+        while (::readdir(d)) ++n;
+        ::closedir(d);
+        return n;
+    }
+
+    long work(long n) {
+        volatile long sum = 0;
+        for (long i=0; i < n; ++i) sum += i * i;
+        return sum;
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_perf_counters )
+{
+    perf_counters ctrs(perf_counters::s_hw_events | perf_counters::mask(perf_event::TASK_CLOCK));
+
+    BOOST_TEST_MESSAGE("perf counters available: " << ctrs.available()
+                       << ", rdpmc: " << ctrs.user_rdpmc());
+
+    perf_values v1, v2;
+    BOOST_REQUIRE(ctrs.read(v1));
+    work(1000000);
+    BOOST_REQUIRE(ctrs.read(v2));
+
+    // Counters that can't be opened read as zeros
+    for (int i=0; i < int(perf_event::COUNT); ++i) {
+        auto e = perf_event(i);
+        if (!ctrs.available(e)) {
+            BOOST_CHECK_EQUAL(0u, v1[e]);
+            BOOST_CHECK_EQUAL(0u, v2[e]);
+        } else
+            BOOST_CHECK(v2[e] >= v1[e]);
+    }
+
+    if (ctrs.available(perf_event::TASK_CLOCK))
+        BOOST_CHECK(v2[perf_event::TASK_CLOCK] > v1[perf_event::TASK_CLOCK]);
+    if (ctrs.available(perf_event::INSTRUCTIONS))
+        BOOST_CHECK(v2[perf_event::INSTRUCTIONS] - v1[perf_event::INSTRUCTIONS] > 1000000);
+
+    BOOST_CHECK_EQUAL("cycles",        to_string(perf_event::CYCLES));
+    BOOST_CHECK_EQUAL("task_clock_ns", to_string(perf_event::TASK_CLOCK));
+}
+
+BOOST_AUTO_TEST_CASE( test_perf_scope )
+{
+    auto& reg = perf_registry::instance();
+    reg.events(reg.events() | perf_counters::mask(perf_event::TASK_CLOCK));
+    reg.reset();
+
+    BOOST_CHECK_EQUAL(s_loop.id(), perf_scope_id("test_loop").id());
+    BOOST_CHECK(s_loop.id() != s_inner.id());
+
+    auto worker = [] {
+        for (int i=0; i < 10; ++i) {
+            perf_scope scope(s_loop);
+            work(10000);
+            for (int j=0; j < 3; ++j) {
+                perf_scope inner(s_inner);
+                work(1000);
+            }
+        }
+    };
+
+    std::thread t1(worker), t2(worker);
+    t1.join();
+    t2.join();
+    worker();
+
+    auto stats = reg.collect();
+    BOOST_REQUIRE_EQUAL(2u, stats.size());
+    BOOST_CHECK_EQUAL("test_loop",  stats[0].name);
+    BOOST_CHECK_EQUAL(30u,          stats[0].calls);
+    BOOST_CHECK_EQUAL("test_inner", stats[1].name);
+    BOOST_CHECK_EQUAL(90u,          stats[1].calls);
+
+    // Inner scopes are nested in the outer ones
+    for (int i=0; i < int(perf_event::COUNT); ++i)
+        BOOST_CHECK(stats[0].values.v[i] >= stats[1].values.v[i]);
+
+    std::stringstream csv;
+    reg.to_csv(csv);
+    std::string line;
+    std::getline(csv, line);
+    BOOST_CHECK_EQUAL("scope,calls,cycles,instructions,l1d_misses,llc_misses,"
+                      "branch_misses,dtlb_misses,task_clock_ns", line);
+    std::getline(csv, line);
+    BOOST_CHECK_EQUAL(0u, line.find("test_loop,30,"));
+
+    if (verbosity::level() > VERBOSE_NONE) {
+        std::stringstream s;
+        reg.dump(s);
+        BOOST_TEST_MESSAGE(s.str());
+    }
+
+    reg.reset();
+    BOOST_CHECK(reg.collect().empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_perf_scope_thread_exit )
+{
+    auto& reg = perf_registry::instance();
+    reg.reset();
+
+    // Make sure the main thread's storage is allocated
+    { perf_scope scope(s_loop); }
+
+    size_t threads = reg.threads();
+    int    fds     = open_fds();
+
+    // Counters of exited threads are released, and their totals are kept
+    for (int i=0; i < 50; ++i)
+        std::thread([] { perf_scope scope(s_loop); work(100); }).join();
+
+    BOOST_CHECK_EQUAL(threads, reg.threads());
+    BOOST_CHECK_EQUAL(fds,     open_fds());
+
+    auto stats = reg.collect();
+    BOOST_REQUIRE_EQUAL(1u, stats.size());
+    BOOST_CHECK_EQUAL(51u,  stats[0].calls);
+
+    reg.reset();
+    BOOST_CHECK(reg.collect().empty());
+}
@@ -34,7 +34,10 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 
 #include <utxx/test_helper.hpp>
 #include <utxx/rate_throttler.hpp>
+#include <utxx/gcra_throttle.hpp>
 #include <utxx/timestamp.hpp>
+#include <thread>
+#include <vector>
 
 using namespace utxx;
 
@@ -135,3 +138,143 @@ BOOST_AUTO_TEST_CASE( test_rate_throttler_basic )
 
     BOOST_REQUIRE_EQUAL(29.0 / 3, l_throttler.running_avg());
 }
+
+BOOST_AUTO_TEST_CASE( test_rate_throttler_gcra )
+{
+    // 10 permits per millisecond, burst of 5
+    gcra_throttle thr(10, msecs(1), 5);
+    long now = time_val(2015, 6, 1, 12, 0, 0, 0).nanoseconds();
+
+    BOOST_CHECK_EQUAL(5,  thr.burst());
+    BOOST_CHECK_EQUAL(5,  thr.available(now));
+    BOOST_CHECK(thr.try_acquire(3, now));
+    BOOST_CHECK_EQUAL(2,  thr.available(now));
+    BOOST_CHECK(!thr.try_acquire(3, now));
+    // The third permit is 100us away
+    BOOST_CHECK_EQUAL(100000, thr.consume(3, now));
+    BOOST_CHECK(time_val(usecs(100)) == thr.wait_time(3, now));
+    BOOST_CHECK(thr.try_acquire(2, now));
+    BOOST_CHECK_EQUAL(0,  thr.available(now));
+    BOOST_CHECK(time_val(usecs(100)) == thr.wait_time(1, now));
+
+    now += 100000;
+    BOOST_CHECK_EQUAL(1,  thr.available(now));
+    BOOST_CHECK(thr.try_acquire(1, now));
+    BOOST_CHECK(!thr.try_acquire(1, now));
+
+    // Idle time doesn't accumulate permits beyond the burst
+    now += 10000000;
+    BOOST_CHECK_EQUAL(5,  thr.available(now));
+    BOOST_CHECK(!thr.try_acquire(6, now));
+    BOOST_CHECK(thr.try_acquire(5, now));
+    thr.refund(2);
+    BOOST_CHECK_EQUAL(2,  thr.available(now));
+
+    // Over a long period the rate is sustained
+    thr.reset();
+    int granted = 0;
+    for (long t = now; t < now + 100000000; t += 1000)   // 1us steps over 100ms
+        granted += thr.try_acquire(1, t);
+    BOOST_CHECK(granted >= 1000 && granted <= 1005);
+}
+
+BOOST_AUTO_TEST_CASE( test_rate_throttler_gcra_table )
+{
+    // Per-session limits: 2 messages per second by default
+    gcra_table tbl(1000, 2, secs(1));
+    long now = time_val(2015, 6, 1, 12, 0, 0, 0).nanoseconds();
+
+    BOOST_CHECK(tbl.capacity() >= 2000);
+    BOOST_CHECK(tbl.find(1) == nullptr);
+    BOOST_CHECK(tbl.wait_time(1) == time_val());
+
+    // Order entry message type of session 7 is limited to 1 per 10ms
+    const uint64_t ORDER = (7ul << 32) | 'D';
+    tbl.set_limit(ORDER, 1, msecs(10));
+
+    BOOST_CHECK(tbl.try_acquire(7, 1, now));
+    BOOST_CHECK(tbl.try_acquire(7, 1, now));
+    BOOST_CHECK(!tbl.try_acquire(7, 1, now));
+    BOOST_CHECK(tbl.wait_time(7, 1, now) == time_val(msecs(500)));
+
+    BOOST_CHECK(tbl.try_acquire(ORDER, 1, now));
+    BOOST_CHECK(!tbl.try_acquire(ORDER, 1, now + 9999999));
+    BOOST_CHECK(tbl.try_acquire(ORDER, 1, now + 10000000));
+
+    for (uint64_t k = 100; k < 1100; ++k)
+        BOOST_REQUIRE(tbl.try_acquire(k, 1, now));
+    BOOST_CHECK_EQUAL(1002u, tbl.size());
+    BOOST_CHECK(tbl.find(500) != nullptr);
+
+    // Hierarchical limit: account within venue
+    gcra_throttle venue(3, secs(1));
+    gcra_throttle acct1(2, secs(1));
+    gcra_throttle acct2(2, secs(1));
+
+    BOOST_CHECK_EQUAL(0, gcra_consume_all(now, 1, {&acct1.cell(), &venue.cell()}));
+    BOOST_CHECK_EQUAL(0, gcra_consume_all(now, 1, {&acct1.cell(), &venue.cell()}));
+    // Account 1 is exhausted, venue is not charged
+    BOOST_CHECK(gcra_consume_all(now, 1, {&acct1.cell(), &venue.cell()}) > 0);
+    BOOST_CHECK_EQUAL(1, venue.available(now));
+    BOOST_CHECK_EQUAL(0, gcra_consume_all(now, 1, {&acct2.cell(), &venue.cell()}));
+    // Venue is exhausted, account 2 is refunded
+    long wait = gcra_consume_all(now, 1, {&acct2.cell(), &venue.cell()});
+    BOOST_CHECK_EQUAL(333333333, wait);
+    BOOST_CHECK_EQUAL(1, acct2.available(now));
+}
+
+BOOST_AUTO_TEST_CASE( test_rate_throttler_gcra_table_full )
+{
+    gcra_table tbl(8, 2, secs(1));
+    BOOST_REQUIRE_EQUAL(16u, tbl.capacity());
+
+    for (uint64_t k = 1; k <= tbl.capacity(); ++k)
+        tbl.get(k);
+    BOOST_CHECK_EQUAL(tbl.capacity(), tbl.size());
+    BOOST_CHECK_THROW(tbl.get(1000000), utxx::runtime_error);
+
+    // Lookups of a missing key must terminate when no slot is empty
+    BOOST_CHECK(tbl.find(1000000) == nullptr);
+    BOOST_CHECK(tbl.wait_time(1000000) == time_val());
+    BOOST_CHECK(tbl.find(16) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( test_rate_throttler_gcra_threads )
+{
+    // Permits granted to concurrent threads never exceed the limit
+    gcra_throttle thr(1000, secs(1));
+    long now = time_val(2015, 6, 1, 12, 0, 0, 0).nanoseconds();
+    std::atomic<int> granted(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&] {
+            for (int j = 0; j < 10000; ++j)
+                granted += thr.try_acquire(1, now + j * 10000);   // 10us steps
+        });
+    for (auto& t : threads) t.join();
+
+    // 100ms of time allows 1000 (burst) + 100 permits
+    BOOST_CHECK(granted.load() >= 1000);
+    BOOST_CHECK(granted.load() <= 1101);
+}
+
+BOOST_AUTO_TEST_CASE( test_rate_throttler_gcra_set_limit_live )
+{
+    // The limit of a key can be changed while other threads consume it
+    gcra_table tbl(16, 100, secs(1));
+    long now = time_val(2015, 6, 1, 12, 0, 0, 0).nanoseconds();
+    std::atomic<bool> done(false);
+
+    std::thread th([&] {
+        for (long j = 0; !done; ++j)
+            tbl.try_acquire(1, 1, now + j * 1000);
+    });
+    for (int i = 1; i <= 1000; ++i)
+        tbl.set_limit(1, 100 + i % 2, secs(1));
+    done = true;
+    th.join();
+
+    BOOST_CHECK_EQUAL(100, tbl.get(1).burst());
+    BOOST_CHECK_EQUAL(10000000, tbl.get(1).interval());
+}
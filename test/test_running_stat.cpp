@@ -35,6 +35,7 @@ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 #include <boost/concept_check.hpp>
 #include <algorithm>
 #include <utxx/running_stat.hpp>
+#include <utxx/window_stat.hpp>
 #include <utxx/detail/mean_variance.hpp>
 #include <utxx/time_val.hpp>
 #include <utxx/persist_array.hpp>
@@ -412,3 +413,138 @@ BOOST_AUTO_TEST_CASE( test_running_stat_moving_average_check )
         }
     }
 }
+
+namespace {
+    struct window_check {
+        double mean, var, min, max;
+
+        template <class It>
+        window_check(It a_begin, It a_end) : mean(0), var(0) {
+            double n = a_end - a_begin;
+            min = *std::min_element(a_begin, a_end);
+            max = *std::max_element(a_begin, a_end);
+            for (auto p = a_begin; p != a_end; ++p) mean += *p;
+            mean /= n;
+            for (auto p = a_begin; p != a_end; ++p) var += (*p - mean) * (*p - mean);
+            var /= n;
+        }
+    };
+}
+
+BOOST_AUTO_TEST_CASE( test_running_stat_window_count )
+{
+    basic_window_stat<double> ws(size_t(10));
+    BOOST_CHECK(ws.empty());
+    BOOST_CHECK_EQUAL(0.0, ws.mean());
+    BOOST_CHECK_EQUAL(0.0, ws.min());
+    BOOST_CHECK_EQUAL(0.0, ws.max());
+
+    std::vector<double> data(1000);
+    srand(1);
+    for (auto& d : data) d = rand() % 1000 / 10.0;
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        ws.add(data[i]);
+        auto b = data.begin() + (i < 10 ? 0 : i - 9);
+        window_check c(b, data.begin() + i + 1);
+        BOOST_REQUIRE_EQUAL(std::min<size_t>(i+1, 10), ws.size());
+        BOOST_REQUIRE_CLOSE(c.mean, ws.mean(),     1e-9);
+        BOOST_REQUIRE_SMALL(c.var - ws.variance(), 1e-6);
+        BOOST_REQUIRE_EQUAL(c.min,  ws.min());
+        BOOST_REQUIRE_EQUAL(c.max,  ws.max());
+        BOOST_REQUIRE_EQUAL(data[i], ws.last());
+    }
+
+    // Batch update gives the same result as individual updates
+    basic_window_stat<double> wb(size_t(10));
+    wb.add(data.data(), 5);
+    wb.add(data.data()+5, data.size()-5);
+    BOOST_CHECK_EQUAL(ws.total(), wb.total());
+    BOOST_CHECK_CLOSE(ws.mean(),  wb.mean(), 1e-9);
+    BOOST_CHECK_EQUAL(ws.min(),   wb.min());
+    BOOST_CHECK_EQUAL(ws.max(),   wb.max());
+
+    ws.clear();
+    BOOST_CHECK(ws.empty());
+    BOOST_CHECK_EQUAL(0u, ws.total());
+}
+
+BOOST_AUTO_TEST_CASE( test_running_stat_window_time )
+{
+    basic_window_stat<int> ws(secs(1));
+    BOOST_CHECK(ws.time_based());
+
+    std::vector<time_val> times;
+    std::vector<int>      data;
+    time_val now(1000, 0);
+    srand(2);
+    for (int i = 0; i < 5000; ++i) {
+        // Bursts exceeding the initial capacity of the window
+        now += usecs(i % 100 < 50 ? 1000 : 30000);
+        times.push_back(now);
+        data.push_back(rand() % 10000 - 5000);
+        ws.add(now, data.back());
+
+        size_t b = 0;
+        while (times[b] <= now - secs(1)) ++b;
+        window_check c(data.begin() + b, data.end());
+        BOOST_REQUIRE_EQUAL(data.size() - b, ws.size());
+        BOOST_REQUIRE_CLOSE(c.mean, ws.mean(), 1e-9);
+        BOOST_REQUIRE_CLOSE(c.var,  ws.variance(), 1e-6);
+        BOOST_REQUIRE_EQUAL(c.min,  ws.min());
+        BOOST_REQUIRE_EQUAL(c.max,  ws.max());
+    }
+
+    ws.expire(now + secs(1));
+    BOOST_CHECK(ws.empty());
+    BOOST_CHECK_EQUAL(0.0, ws.mean());
+    BOOST_CHECK_EQUAL(0.0, ws.variance());
+}
+
+BOOST_AUTO_TEST_CASE( test_running_stat_window_ewma_quantile )
+{
+    ewma avg(secs(1));
+    BOOST_CHECK(avg.empty());
+    BOOST_CHECK_EQUAL(10.0, avg.add(time_val(100, 0), 10.0));
+    // One tau later the new sample weighs 1 - 1/e
+    BOOST_CHECK_CLOSE(10.0 + (20.0 - 10.0) * (1 - exp(-1.0)),
+                      avg.add(time_val(101, 0), 20.0), 1e-9);
+    // No time elapsed - no change
+    double v = avg.value();
+    BOOST_CHECK_EQUAL(v, avg.add(time_val(101, 0), 1000.0));
+
+    p2_quantile med(0.5), p99(0.99);
+    BOOST_CHECK_EQUAL(0.0, med.value());
+    med.add(3); med.add(1); med.add(2);
+    BOOST_CHECK_EQUAL(2.0, med.value());
+    med.clear();
+
+    srand(3);
+    for (int i = 0; i < 100000; ++i) {
+        double x = double(rand()) / RAND_MAX;
+        med.add(x);
+        p99.add(x);
+    }
+    BOOST_CHECK_SMALL(med.value() - 0.5,  0.01);
+    BOOST_CHECK_SMALL(p99.value() - 0.99, 0.005);
+
+    // Windowed quantiles follow a shift of the distribution
+    basic_window_stat<double> ws(size_t(1000), {0.1, 0.5, 0.9});
+    BOOST_CHECK_EQUAL(3u, ws.quantiles());
+    for (int i = 0; i < 5000; ++i)
+        ws.add(double(rand()) / RAND_MAX);
+    BOOST_CHECK_SMALL(ws.quantile(1) - 0.5, 0.05);
+    for (int i = 0; i < 2000; ++i)
+        ws.add(10.0 + double(rand()) / RAND_MAX);
+    BOOST_CHECK_SMALL(ws.quantile(0) - 10.1, 0.05);
+    BOOST_CHECK_SMALL(ws.quantile(1) - 10.5, 0.05);
+    BOOST_CHECK_SMALL(ws.quantile(2) - 10.9, 0.05);
+
+    // Timestamped samples update EWMA
+    basic_window_stat<double> wt(secs(10), {0.5}, secs(1));
+    wt.add(time_val(100, 0), 1.0);
+    wt.add(time_val(101, 0), 2.0);
+    BOOST_CHECK_CLOSE(1.0 + (1 - exp(-1.0)), wt.average().value(), 1e-9);
+    BOOST_CHECK_EQUAL(2u, wt.size());
+    BOOST_CHECK_EQUAL(1.5, wt.mean());
+}
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------
+/// \file  test_timer_wheel.cpp
+//----------------------------------------------------------------------------
+/// \brief Test cases for hierarchical timer wheel
+//----------------------------------------------------------------------------
+// Copyright (c) 2026 Serge Aleynikov <saleyn@gmail.com>
+// Created: 2026-10-19
+//----------------------------------------------------------------------------
+/*
+***** BEGIN LICENSE BLOCK *****
+
+This file is part of the utxx open-source project.
+
+Copyright (C) 2026 Serge Aleynikov <saleyn@gmail.com>
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***** END LICENSE BLOCK *****
+*/
+#include <boost/test/unit_test.hpp>
+#include <utxx/timer_wheel.hpp>
+#include <utxx/boost/asio_timer_wheel.hpp>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace utxx;
+
+namespace {
+    // Wheel with 1us ticks starting at time 0 (time is given in nanoseconds)
+    typedef basic_timer_wheel<long> wheel_t;
+}
+
+BOOST_AUTO_TEST_CASE( test_timer_wheel_basic )
+{
+    wheel_t w(usecs(1), 0, 0);
+    std::vector<long> fired;
+    auto fun = [&](wheel_t::timer_id, long a_data) { fired.push_back(a_data); };
+
+    BOOST_CHECK(w.empty());
+    BOOST_CHECK_EQUAL(LONG_MAX, w.next_expiration());
+
+    auto t1 = w.schedule_at(5000, 5);
+    auto t2 = w.schedule_at(3000, 3);
+    auto t3 = w.schedule_at(100000, 100);
+    auto t4 = w.schedule_at(2500, 2);   // Rounded up to 3us
+    BOOST_CHECK(t1 != t2);
+    BOOST_CHECK_EQUAL(4u, w.size());
+    BOOST_CHECK_EQUAL(3000, w.next_expiration());
+    BOOST_REQUIRE(w.find(t3));
+    BOOST_CHECK_EQUAL(100, *w.find(t3));
+
+    BOOST_CHECK_EQUAL(0u, w.expire(2999, fun));
+    BOOST_CHECK_EQUAL(2u, w.expire(3000, fun));
+    BOOST_CHECK(!w.cancel(t2));     // Already fired
+    BOOST_CHECK(!w.cancel(t4));
+    BOOST_CHECK(w.cancel(t1));
+    BOOST_CHECK(!w.cancel(t1));
+    BOOST_CHECK(!w.find(t1));
+    BOOST_CHECK_EQUAL(1u, w.size());
+
+    BOOST_CHECK(w.reschedule_at(t3, 7000));
+    BOOST_CHECK_EQUAL(1u, w.expire(1000000, fun));
+    BOOST_REQUIRE_EQUAL(3u, fired.size());
+    BOOST_CHECK_EQUAL(2,   std::min(fired[0], fired[1]));
+    BOOST_CHECK_EQUAL(3,   std::max(fired[0], fired[1]));
+    BOOST_CHECK_EQUAL(100, fired[2]);
+    BOOST_CHECK(w.empty());
+
+    // Timers in the past fire on the next expire() call
+    w.schedule_at(0, 1);
+    BOOST_CHECK_EQUAL(1u, w.expire(1001000, fun));
+
+    // Node ids are reused with a new generation
+    auto id = w.schedule_at(2000000, 1);
+    BOOST_CHECK(w.capacity() >= 1);
+    BOOST_CHECK(id != t1 && id != t2 && id != t3 && id != t4);
+    w.clear();
+    BOOST_CHECK(!w.cancel(id));
+    BOOST_CHECK(w.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_timer_wheel_random )
+{
+    // Compare with a multimap across all levels and random expire() steps
+    wheel_t w(usecs(1), 1000, 0);
+    std::multimap<long, long> expected;     // Tick -> timer data
+    std::map<long, wheel_t::timer_id> ids;
+    std::mt19937_64 rnd(1);
+
+    long now = 0, data = 0;
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = rnd() % 20; i > 0; --i) {
+            int  bits  = 1 + rnd() % 34;
+            long delay = long(rnd() & ((1ul << bits) - 1));
+            long tick  = now/1000 + 1 + delay;
+            ids[data]  = w.schedule_at(tick * 1000, data);
+            expected.emplace(tick, data++);
+        }
+        // Cancel some timers
+        for (int i = rnd() % 5; i > 0 && !ids.empty(); --i) {
+            auto it = ids.lower_bound(long(rnd() % data));
+            if (it == ids.end()) continue;
+            for (auto e = expected.begin(); e != expected.end(); ++e)
+                if (e->second == it->first) { expected.erase(e); break; }
+            BOOST_CHECK(w.cancel(it->second));
+            ids.erase(it);
+        }
+
+        now += long(rnd() % (round % 100 == 0 ? 1000000000000l : 100000000l));
+
+        std::vector<std::pair<long,long>> fired;
+        w.expire(now, [&](wheel_t::timer_id, long a_data) {
+            fired.emplace_back(w.now() / 1000, a_data);
+        });
+
+        std::vector<std::pair<long,long>> exp;
+        for (auto it = expected.begin(); it != expected.end() && it->first <= now/1000; )
+        {
+            exp.emplace_back(*it);
+            ids.erase(it->second);
+            it = expected.erase(it);
+        }
+        std::sort(fired.begin(), fired.end());
+        std::sort(exp.begin(),   exp.end());
+        BOOST_REQUIRE_EQUAL(exp.size(), fired.size());
+        BOOST_REQUIRE(exp == fired);
+        BOOST_REQUIRE_EQUAL(expected.size(), w.size());
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_timer_wheel_reentrant )
+{
+    wheel_t w(usecs(1), 0, 0);
+    int  count = 0;
+    wheel_t::timer_id other;
+
+    // A repeating timer rescheduling itself, and a timer cancelling another
+    std::function<void(wheel_t::timer_id, long)> fun =
+        [&](wheel_t::timer_id, long a_data) {
+            ++count;
+            if (a_data == 1 && count < 10)
+                w.schedule_at(w.now() + 1000, 1);
+            else if (a_data == 2)
+                BOOST_CHECK(w.cancel(other));
+        };
+
+    // Timers of the same slot are fired in the reverse order of scheduling
+    w.schedule_at(1000, 1);
+    other = w.schedule_at(50000, 3);
+    w.schedule_at(50000, 2);
+    w.expire(1000000, fun);
+    BOOST_CHECK_EQUAL(11, count);
+    BOOST_CHECK(w.empty());
+}
+
+BOOST_AUTO_TEST_CASE( test_timer_wheel_asio )
+{
+    boost::asio::io_service io;
+    std::vector<long> fired;
+    asio_timer_wheel<long> w(io,
+        [&](asio_timer_wheel<long>::timer_id, long a_data) { fired.push_back(a_data); },
+        usecs(100));
+
+    w.schedule_after(msecs(20), 2);
+    w.schedule_after(msecs(10), 1);
+    auto id = w.schedule_after(msecs(15), 3);
+    BOOST_CHECK(w.cancel(id));
+
+    auto start = now_utc();
+    io.run();
+    auto elapsed = now_utc() - start;
+
+    BOOST_REQUIRE_EQUAL(2u, fired.size());
+    BOOST_CHECK_EQUAL(1, fired[0]);
+    BOOST_CHECK_EQUAL(2, fired[1]);
+    BOOST_CHECK(elapsed.milliseconds() >= 19);
+}
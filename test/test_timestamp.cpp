@@ -583,3 +583,104 @@ BOOST_AUTO_TEST_CASE( test_timestamp_since_midnight )
     if (env)
         setenv("TZ", env, 1);
 }
+
+BOOST_AUTO_TEST_CASE( test_time_formatter )
+{
+    auto env = getenv("TZ");
+    // US Eastern time zone rules spelled out to not depend on tzdata
+    setenv("TZ", "EST5EDT,M3.2.0,M11.1.0", 1);
+    tzset();
+
+    auto tv = time_val::universal_time(2016, 6, 20, 12, 58, 32, 0) + nsecs(363349876L);
+
+    BOOST_CHECK_EQUAL("20160620-12:58:32.363349876",
+                      time_formatter(DATE_TIME_WITH_NSEC, true).to_string(tv));
+    BOOST_CHECK_EQUAL("20160620-08:58:32.363349",
+                      time_formatter(DATE_TIME_WITH_USEC).to_string(tv));
+    BOOST_CHECK_EQUAL("20160620-12:58:32.363",
+                      time_formatter(DATE_TIME_WITH_MSEC, false,
+                                     time_formatter::FIX).to_string(tv));
+    BOOST_CHECK_EQUAL("12:58:32.363",
+                      time_formatter(TIME_WITH_MSEC, false,
+                                     time_formatter::FIX).to_string(tv));
+    BOOST_CHECK_EQUAL("20160620",   time_formatter(DATE).to_string(tv));
+    BOOST_CHECK_EQUAL("2016-06-20", time_formatter(DATE, false,
+                                        time_formatter::ISO8601).to_string(tv));
+    BOOST_CHECK_EQUAL("2016-06-20T12:58:32.363349Z",
+                      time_formatter(DATE_TIME_WITH_USEC, true,
+                                     time_formatter::ISO8601).to_string(tv));
+    BOOST_CHECK_EQUAL("2016-06-20T08:58:32-04:00",
+                      time_formatter(DATE_TIME, false,
+                                     time_formatter::ISO8601).to_string(tv));
+    BOOST_CHECK_EQUAL("", time_formatter(NO_TIMESTAMP).to_string(tv));
+
+    // Results match timestamp::format() across days and seconds
+    {
+        time_formatter f(DATE_TIME_WITH_USEC, true);
+        BOOST_CHECK_EQUAL(24u, f.size());
+        char buf[64], expected[64];
+        for (long i = 0; i < 3000; ++i) {
+            auto t = tv + nsecs(i * 123456789L) + secs(i / 1000 * 86400);
+            auto p = f.write(buf, t);
+            BOOST_CHECK_EQUAL(24, p - buf);
+            timestamp::format(DATE_TIME_WITH_USEC, t, expected, sizeof(expected),
+                              true, false, false);
+            BOOST_REQUIRE_EQUAL(expected, buf);
+        }
+    }
+
+    // Daylight savings time switches (2016-03-13 02:00 EST, 2016-11-06 02:00 EDT)
+    {
+        time_formatter f(DATE_TIME_WITH_MSEC, false, time_formatter::ISO8601);
+        auto t = time_val::universal_time(2016, 3, 13, 6, 59, 59, 0) + msecs(500);
+        BOOST_CHECK_EQUAL("2016-03-13T01:59:59.500-05:00", f.to_string(t));
+        BOOST_CHECK_EQUAL("2016-03-13T03:00:00.000-04:00", f.to_string(t + msecs(500)));
+        BOOST_CHECK_EQUAL("2016-03-13T01:59:59.999-05:00", f.to_string(t + msecs(499)));
+
+        t = time_val::universal_time(2016, 11, 6, 5, 59, 59, 0);
+        BOOST_CHECK_EQUAL("2016-11-06T01:59:59.000-04:00", f.to_string(t));
+        BOOST_CHECK_EQUAL("2016-11-06T01:00:00.000-05:00", f.to_string(t + secs(1)));
+        BOOST_CHECK_EQUAL("2016-11-06T23:59:59.000-05:00",
+                          f.to_string(time_val::universal_time(2016, 11, 7, 4, 59, 59, 0)));
+        BOOST_CHECK_EQUAL("2016-11-07T00:00:00.000-05:00",
+                          f.to_string(time_val::universal_time(2016, 11, 7, 5, 0, 0, 0)));
+
+        // The timestamp cache notices the offset change as well
+        test_timestamp::reset();
+        test_timestamp ts;
+        ts.update(t);
+        BOOST_CHECK_EQUAL(-4*3600, timestamp::utc_offset());
+        ts.update(t + secs(1));
+        BOOST_CHECK_EQUAL(-5*3600, timestamp::utc_offset());
+        test_timestamp::reset();
+    }
+
+    // Batch rendering matches individual calls
+    {
+        time_formatter f(TIME_WITH_USEC);
+        time_val tvs[8];
+        for (int i = 0; i < 8; ++i)
+            tvs[i] = tv + nsecs(i * 300000017L);
+
+        char out[8*16], buf[32];
+        auto p = f.write(tvs, 8, out, 16);
+        BOOST_CHECK_EQUAL(8*16, p - out);
+        for (int i = 0; i < 8; ++i) {
+            f.write(buf, tvs[i]);
+            BOOST_CHECK_EQUAL(buf, out + i*16);
+        }
+
+        p = f.write(tvs, 8, out);
+        BOOST_CHECK_EQUAL(8*15, p - out);
+        for (int i = 0; i < 8; ++i) {
+            f.write(buf, tvs[i]);
+            BOOST_CHECK_EQUAL(std::string(buf), std::string(out + i*15, 15));
+        }
+    }
+
+    if (env)
+        setenv("TZ", env, 1);
+    else
+        unsetenv("TZ");
+    tzset();
+}
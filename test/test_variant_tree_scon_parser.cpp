@@ -15,6 +15,8 @@
 #include <utxx/variant_tree_parser.hpp>
 #include <utxx/time_val.hpp>
 #include <typeinfo>  //for 'typeid' to work
+#include <thread>
+#include <sys/stat.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 // Test data
@@ -631,5 +633,66 @@ BOOST_AUTO_TEST_CASE( test_variant_tree_scon_parse_macros )
 
 }
 
+BOOST_AUTO_TEST_CASE( test_variant_tree_read_config_buffer )
+{
+    // The buffer is not NUL-terminated: "k3 x" past its end must be ignored
+    const char scon[] = "k1 { k2 = \"a\\tb\", k3 = 10 }\nk4 = 1.5, k5 = true\nk3 x";
+    variant_tree pt;
+    read_config(scon, sizeof(scon) - 6, pt, FORMAT_SCON);
+    BOOST_CHECK_EQUAL("a\tb", pt.get<std::string>("k1.k2"));
+    BOOST_CHECK_EQUAL(10,     pt.get<int>("k1.k3"));
+    BOOST_CHECK_EQUAL(1.5,    pt.get<double>("k4"));
+    BOOST_CHECK(pt.get<bool>("k5"));
+    BOOST_CHECK(!pt.get_child_optional("k3"));
+
+    const char xml[] = "<a><b>1</b><c>str</c></a>";
+    read_config(xml, sizeof(xml) - 1, pt, FORMAT_XML);
+    BOOST_CHECK_EQUAL(1,      pt.get<int>("a.b"));
+    BOOST_CHECK_EQUAL("str",  pt.get<std::string>("a.c"));
+
+    // Memory-mapped files
+    test_file empty("", "test_read_config_empty.config");
+    variant_tree pt2;
+    read_config(empty.name(), pt2);
+    BOOST_CHECK(pt2.empty());
+
+    test_file file(scon, "test_read_config_mmap.config");
+    read_config(file.name(), pt);
+    BOOST_CHECK_EQUAL(10,     pt.get<int>("k1.k3"));
+    BOOST_CHECK_EQUAL("x",    pt.get<std::string>("k3"));
+
+    BOOST_CHECK_THROW(read_config(file.name() + ".missing.config", pt),
+                      variant_tree_parser_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_variant_tree_read_config_fifo )
+{
+    // Files that can't be mapped (pipes, /dev/stdin) are read with a filebuf
+    auto name = (boost::filesystem::temp_directory_path() /
+                 "test_read_config_fifo.config").string();
+    ::unlink(name.c_str());
+    BOOST_REQUIRE_EQUAL(0, ::mkfifo(name.c_str(), 0600));
+    std::thread writer([&name] {
+        std::ofstream out(name.c_str());
+        out << "k1 { k2 = 5 }\n";
+    });
+    variant_tree pt;
+    read_config(name, pt);
+    writer.join();
+    ::unlink(name.c_str());
+    BOOST_CHECK_EQUAL(5, pt.get<int>("k1.k2"));
+
+    // Large files are mapped rather than copied
+    std::string big;
+    for (int i=0; big.size() <= detail::mapped_file::s_copy_size; ++i)
+        big += "key" + std::to_string(i) + " = " + std::to_string(i) + "\n";
+    test_file file(big.c_str(), "test_read_config_big.config");
+    detail::mapped_istream in(file.name());
+    BOOST_REQUIRE(in);
+    BOOST_CHECK_EQUAL(big.size(), in.file().size());
+    read_config(file.name(), pt);
+    BOOST_CHECK_EQUAL(1000, pt.get<int>("key1000"));
+}
+
 
 }} // namespace utxx::test